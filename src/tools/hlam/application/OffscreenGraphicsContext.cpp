@@ -0,0 +1,240 @@
+#include <cstring>
+
+#include <GL/glew.h>
+
+#ifndef HLAM_USE_EGL
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#else
+//Don't let the EGL headers pull in X11, its macros conflict with Qt
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include "application/OffscreenGraphicsContext.hpp"
+
+#include "core/shared/Logging.hpp"
+
+#ifdef HLAM_USE_EGL
+static bool HasExtension(const char* extensions, const char* name)
+{
+	if (!extensions)
+	{
+		return false;
+	}
+
+	const std::size_t length = std::strlen(name);
+
+	for (const char* start = extensions; (start = std::strstr(start, name)) != nullptr; start += length)
+	{
+		if ((start == extensions || start[-1] == ' ') && (start[length] == ' ' || start[length] == '\0'))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static EGLDisplay GetEGLDisplay()
+{
+	//The surfaceless platform works without a display server or a GPU
+	if (HasExtension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_MESA_platform_surfaceless"))
+	{
+		const auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+		if (getPlatformDisplay)
+		{
+			if (const auto display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr); display != EGL_NO_DISPLAY)
+			{
+				return display;
+			}
+		}
+	}
+
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+#endif
+
+OffscreenGraphicsContext::OffscreenGraphicsContext() = default;
+
+OffscreenGraphicsContext::~OffscreenGraphicsContext()
+{
+	Destroy();
+}
+
+bool OffscreenGraphicsContext::Create()
+{
+	Destroy();
+
+#ifndef HLAM_USE_EGL
+	_context = std::make_unique<QOpenGLContext>();
+
+	_context->setFormat(QSurfaceFormat::defaultFormat());
+
+	if (!_context->create())
+	{
+		Error("Couldn't create OpenGL context\n");
+		Destroy();
+		return false;
+	}
+
+	_surface = std::make_unique<QOffscreenSurface>(_context->screen());
+
+	_surface->setFormat(_context->format());
+	_surface->create();
+#else
+	_display = GetEGLDisplay();
+
+	EGLint major, minor;
+
+	if (_display == EGL_NO_DISPLAY || !eglInitialize(_display, &major, &minor))
+	{
+		Error("Couldn't initialize EGL (error 0x%X)\n", eglGetError());
+		_display = nullptr;
+		return false;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		Error("EGL does not support desktop OpenGL\n");
+		Destroy();
+		return false;
+	}
+
+	//Match the settings used for windows. Drawing is done to framebuffer objects, but the surface is used as a fallback
+	const EGLint configAttributes[] =
+	{
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_STENCIL_SIZE, 8,
+		EGL_NONE
+	};
+
+	EGLConfig config{};
+	EGLint configCount = 0;
+
+	if (!eglChooseConfig(_display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		Error("Couldn't find a suitable EGL configuration\n");
+		Destroy();
+		return false;
+	}
+
+	const EGLint contextAttributes[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 0,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	_context = eglCreateContext(_display, config, EGL_NO_CONTEXT, contextAttributes);
+
+	if (_context == EGL_NO_CONTEXT)
+	{
+		Error("Couldn't create OpenGL context (error 0x%X)\n", eglGetError());
+		_context = nullptr;
+		Destroy();
+		return false;
+	}
+
+	if (!HasExtension(eglQueryString(_display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+	{
+		const EGLint surfaceAttributes[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+
+		_surface = eglCreatePbufferSurface(_display, config, surfaceAttributes);
+
+		if (_surface == EGL_NO_SURFACE)
+		{
+			Error("Couldn't create offscreen surface (error 0x%X)\n", eglGetError());
+			_surface = nullptr;
+			Destroy();
+			return false;
+		}
+	}
+#endif
+
+	Begin();
+
+	glewExperimental = GL_TRUE;
+
+	const GLenum error = glewInit();
+
+	//GLEW is built for GLX on Linux and reports an error if there is no GLX display, but the OpenGL functions have been loaded by then
+	const bool initialized = GLEW_VERSION_3_0 != GL_FALSE;
+
+	if (!initialized)
+	{
+		if (error != GLEW_OK)
+		{
+			Error("Error initializing GLEW: %s\n", reinterpret_cast<const char*>(glewGetErrorString(error)));
+		}
+		else
+		{
+			Error("OpenGL 3 or newer is required\n");
+		}
+	}
+
+	End();
+
+	if (!initialized)
+	{
+		Destroy();
+	}
+
+	return initialized;
+}
+
+void OffscreenGraphicsContext::Begin()
+{
+#ifndef HLAM_USE_EGL
+	_context->makeCurrent(_surface.get());
+#else
+	eglMakeCurrent(_display, _surface, _surface, _context);
+#endif
+}
+
+void OffscreenGraphicsContext::End()
+{
+#ifndef HLAM_USE_EGL
+	_context->doneCurrent();
+#else
+	eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+#endif
+}
+
+void OffscreenGraphicsContext::Destroy()
+{
+#ifndef HLAM_USE_EGL
+	_surface.reset();
+	_context.reset();
+#else
+	if (_display)
+	{
+		eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+		if (_surface)
+		{
+			eglDestroySurface(_display, _surface);
+			_surface = nullptr;
+		}
+
+		if (_context)
+		{
+			eglDestroyContext(_display, _context);
+			_context = nullptr;
+		}
+
+		eglTerminate(_display);
+		_display = nullptr;
+	}
+#endif
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+
+#include "graphics/IGraphicsContext.hpp"
+
+#ifndef HLAM_USE_EGL
+class QOffscreenSurface;
+class QOpenGLContext;
+#endif
+
+/**
+*	@brief OpenGL context that isn't tied to a window, used to draw without showing any user interface.
+*	If HLAM_USE_EGL is defined this uses EGL so no display server is needed, for instance on servers without a GPU that use Mesa's software renderer.
+*	Otherwise this uses a Qt offscreen surface, which requires a QGuiApplication and, outside of Windows, a display server.
+*/
+class OffscreenGraphicsContext final : public graphics::IGraphicsContext
+{
+public:
+	OffscreenGraphicsContext();
+	~OffscreenGraphicsContext();
+
+	OffscreenGraphicsContext(const OffscreenGraphicsContext&) = delete;
+	OffscreenGraphicsContext& operator=(const OffscreenGraphicsContext&) = delete;
+
+	/**
+	*	@brief Creates the context and loads the OpenGL functions. Errors are logged
+	*	@return Whether the context was created and supports OpenGL 3
+	*/
+	bool Create();
+
+	void Begin() override;
+
+	void End() override;
+
+private:
+	void Destroy();
+
+private:
+#ifndef HLAM_USE_EGL
+	std::unique_ptr<QOpenGLContext> _context;
+	std::unique_ptr<QOffscreenSurface> _surface;
+#else
+	//EGLDisplay, EGLContext and EGLSurface. The EGL headers are kept out of this header because they can include X11 headers
+	void* _display{};
+	void* _context{};
+
+	//Only used if the driver can't make contexts current without a surface
+	void* _surface{};
+#endif
+};
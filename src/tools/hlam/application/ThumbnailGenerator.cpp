@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+
+#include <glm/trigonometric.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include "application/ThumbnailGenerator.hpp"
+
+#include "assets/AssetIO.hpp"
+
+#include "core/shared/Logging.hpp"
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelIO.hpp"
+#include "engine/shared/studiomodel/StudioModelUtils.hpp"
+
+#include "entity/HLMVStudioModelEntity.hpp"
+
+#include "game/entity/BaseEntity.hpp"
+#include "game/entity/EntityManager.hpp"
+
+#include "graphics/Camera.hpp"
+#include "graphics/Scene.hpp"
+#include "graphics/SoftwareSceneRenderer.hpp"
+#include "graphics/TGAFile.hpp"
+
+#include "ui/assets/studiomodel/StudioModelAsset.hpp"
+#include "ui/assets/studiomodel/StudioModelColors.hpp"
+
+#include "ui/camera_operators/ArcBallCameraOperator.hpp"
+#include "ui/camera_operators/FirstPersonCameraOperator.hpp"
+
+#include "utility/CoordinateSystem.hpp"
+#include "utility/IOUtils.hpp"
+
+using namespace ui::assets;
+
+static glm::vec3 ColorToVector(const QColor& color)
+{
+	return {color.redF(), color.greenF(), color.blueF()};
+}
+
+static bool SaveImageFile(const QString& fileName, const std::vector<std::uint8_t>& pixels, int width, int height)
+{
+	if (QFileInfo{fileName}.suffix().compare("tga", Qt::CaseSensitivity::CaseInsensitive) == 0)
+	{
+		return graphics::tgafile::SaveTGAFile(fileName.toStdString().c_str(), width, height, pixels.data());
+	}
+
+	const QImage image{pixels.data(), width, height, width * 4, QImage::Format::Format_RGBA8888};
+
+	//Pixels are bottom row first. Blending can leave the framebuffer partially transparent, which isn't part of what's shown in the window
+	return image.mirrored().convertToFormat(QImage::Format::Format_RGB888).save(fileName);
+}
+
+/**
+*	@brief Finds a sequence by name, or by index if no sequence has that name
+*	@return Index of the sequence, or -1 if there is no such sequence
+*/
+static int FindSequence(const studiomdl::EditableStudioModel& model, const QString& sequence)
+{
+	const auto label = sequence.toStdString();
+
+	for (std::size_t i = 0; i < model.Sequences.size(); ++i)
+	{
+		if (model.Sequences[i]->Label == label)
+		{
+			return static_cast<int>(i);
+		}
+	}
+
+	bool isIndex = false;
+
+	if (const int index = sequence.toInt(&isIndex); isIndex && index >= 0 && static_cast<std::size_t>(index) < model.Sequences.size())
+	{
+		return index;
+	}
+
+	return -1;
+}
+
+/**
+*	@brief Keep enough images in flight to use every worker without buffering all of them in memory
+*/
+static std::size_t GetMaxPendingSaves()
+{
+	return std::max(2u, std::thread::hardware_concurrency());
+}
+
+ThumbnailGenerator::ThumbnailGenerator(const ThumbnailSettings& settings)
+	: _settings(settings)
+{
+}
+
+ThumbnailGenerator::~ThumbnailGenerator()
+{
+	//Don't abandon saves in progress
+	for (auto& save : _pendingSaves)
+	{
+		save.Result.wait();
+	}
+}
+
+QString ThumbnailGenerator::GetThumbnailFileName(const QString& fileName) const
+{
+	return QString{"%1%2%3.%4"}
+		.arg(_settings.OutputDirectory)
+		.arg(QDir::separator())
+		.arg(QFileInfo{fileName}.completeBaseName())
+		.arg(_settings.Format);
+}
+
+std::size_t ThumbnailGenerator::Generate(const QStringList& fileNames)
+{
+	_fileNames = fileNames;
+	_failedCount = 0;
+
+	if (_settings.Software)
+	{
+		_softwareRenderer = std::make_unique<graphics::SoftwareSceneRenderer>(_workerPool);
+
+		for (int i = 0; i < _fileNames.size(); ++i)
+		{
+			if (!DrawThumbnail(static_cast<std::uint64_t>(i)))
+			{
+				++_failedCount;
+			}
+		}
+
+		CollectSaves(0);
+
+		_softwareRenderer.reset();
+
+		return _failedCount;
+	}
+
+	if (!_framebuffer.Create(_settings.Width, _settings.Height))
+	{
+		_failedCount = _fileNames.size();
+		return _failedCount;
+	}
+
+	_readbackQueue.Create(ReadbackBufferCount, _settings.Width, _settings.Height);
+
+	for (int i = 0; i < _fileNames.size(); ++i)
+	{
+		CollectThumbnails(_readbackQueue.IsFull());
+
+		if (!DrawThumbnail(static_cast<std::uint64_t>(i)))
+		{
+			++_failedCount;
+		}
+	}
+
+	CollectThumbnails(true);
+
+	//Thumbnails that could not be read back were never saved
+	_failedCount += _readbackQueue.GetFailedCount();
+
+	_readbackQueue.Destroy();
+	_framebuffer.Destroy();
+
+	return _failedCount;
+}
+
+bool ThumbnailGenerator::DrawThumbnail(std::uint64_t index)
+{
+	const QString& fileName = _fileNames[static_cast<int>(index)];
+
+	std::unique_ptr<studiomdl::EditableStudioModel> model;
+
+	try
+	{
+		std::unique_ptr<FILE, decltype(::fclose)*> file{utf8_fopen(fileName.toStdString().c_str(), "rb"), &::fclose};
+
+		if (!file)
+		{
+			Error("Could not open model \"%s\"\n", fileName.toStdString().c_str());
+			return false;
+		}
+
+		if (!studiomdl::IsStudioModel(file.get()))
+		{
+			Error("\"%s\" is not a studio model\n", fileName.toStdString().c_str());
+			return false;
+		}
+
+		rewind(file.get());
+
+		const auto studioModel = studiomdl::LoadStudioModel(std::filesystem::u8path(fileName.toStdString()), file.get());
+
+		model = std::make_unique<studiomdl::EditableStudioModel>(studiomdl::ConvertToEditable(*studioModel));
+	}
+	catch (const ::assets::AssetException& e)
+	{
+		Error("Error loading model \"%s\": %s\n", fileName.toStdString().c_str(), e.what());
+		return false;
+	}
+
+	//The renderer caches data per model, so each model gets its own scene like it does in the editor
+	graphics::Scene scene{&_textureLoader, &_soundSystem, &_worldTime, &_workerPool};
+
+	scene.GroundColor = ColorToVector(studiomodel::GroundColor.DefaultColor);
+	scene.BackgroundColor = ColorToVector(studiomodel::BackgroundColor.DefaultColor);
+	scene.CrosshairColor = ColorToVector(studiomodel::CrosshairColor.DefaultColor);
+	scene.SetLightColor(ColorToVector(studiomodel::LightColor.DefaultColor));
+	scene.SetWireframeColor(ColorToVector(studiomodel::WireframeColor.DefaultColor));
+
+	auto entity = static_cast<HLMVStudioModelEntity*>(scene.GetEntityContext()->EntityManager->Create("studiomodel", scene.GetEntityContext(),
+		glm::vec3(), glm::vec3(), false));
+
+	if (!entity)
+	{
+		Error("Could not create entity for model \"%s\"\n", fileName.toStdString().c_str());
+		return false;
+	}
+
+	entity->SetEditableModel(model.get());
+	entity->Spawn();
+	scene.SetEntity(entity);
+
+	if (!_settings.Sequence.isEmpty())
+	{
+		const int sequence = FindSequence(*model, _settings.Sequence);
+
+		if (sequence == -1)
+		{
+			Error("Model \"%s\" has no sequence \"%s\"\n", fileName.toStdString().c_str(), _settings.Sequence.toStdString().c_str());
+			return false;
+		}
+
+		entity->SetSequence(sequence);
+	}
+
+	if (entity->GetSequence() != -1)
+	{
+		entity->SetFrame(_settings.Frame);
+		entity->ResetFrameInterpolation();
+	}
+
+	//Use the same view as the editor does when it opens the model
+	graphics::Camera camera;
+
+	if (QFileInfo{fileName}.fileName().startsWith("v_"))
+	{
+		camera.SetOrigin(glm::vec3{0});
+		camera.SetFieldOfView(ui::camera_operators::FirstPersonCameraOperator::DefaultFirstPersonFieldOfView);
+		scene.CameraIsFirstPerson = true;
+	}
+	else
+	{
+		const auto [height, distance] = studiomodel::GetCenteredValues(entity);
+
+		const glm::vec3 cameraPosition = glm::rotate(glm::radians(studiomodel::InitialCameraYaw), math::UpVector)
+			* glm::vec4{math::ForwardVector * -distance, 1};
+
+		camera.SetProperties(cameraPosition + glm::vec3{0, 0, height}, 0, studiomodel::InitialCameraYaw);
+		camera.SetFieldOfView(ui::camera_operators::ArcBallCameraOperator::DefaultFOV);
+	}
+
+	scene.SetCurrentCamera(&camera);
+
+	if (_softwareRenderer)
+	{
+		const auto& pixels = _softwareRenderer->Draw(scene, _settings.Width, _settings.Height);
+
+		//Wait for the oldest saves if the workers are falling behind
+		CollectSaves(GetMaxPendingSaves() - 1);
+		SaveThumbnail(index, pixels.data(), _settings.Width, _settings.Height);
+
+		scene.SetCurrentCamera(nullptr);
+
+		return true;
+	}
+
+	scene.Initialize();
+
+	_framebuffer.Bind();
+
+	//The whole image is a single tile
+	scene.DrawTile(_settings.Width, _settings.Height,
+		graphics::ImageTile{0, 0, static_cast<unsigned int>(_settings.Width), static_cast<unsigned int>(_settings.Height)});
+
+	//The read is ordered after the draw, so the scene can be destroyed before it finishes
+	_readbackQueue.Read(index, 0, 0, _settings.Width, _settings.Height);
+
+	_framebuffer.Unbind();
+
+	scene.SetCurrentCamera(nullptr);
+
+	scene.Shutdown();
+
+	return true;
+}
+
+void ThumbnailGenerator::SaveThumbnail(std::uint64_t index, const std::uint8_t* pixels, int width, int height)
+{
+	//The pixels are only valid during this call
+	std::vector<std::uint8_t> copy(pixels, pixels + (static_cast<std::size_t>(width) * height * 4));
+
+	_pendingSaves.push_back(PendingSave{static_cast<std::size_t>(index),
+		std::async(std::launch::async, [pixels = std::move(copy), width, height, fileName = GetThumbnailFileName(_fileNames[static_cast<int>(index)])]()
+			{
+				return SaveImageFile(fileName, pixels, width, height);
+			})});
+}
+
+void ThumbnailGenerator::CollectThumbnails(bool wait)
+{
+	const std::size_t maxPendingSaves = GetMaxPendingSaves();
+
+	_readbackQueue.Collect([&, this](auto index, auto pixels, auto width, auto height)
+		{
+			//Wait for the oldest saves if the workers are falling behind
+			CollectSaves(maxPendingSaves - 1);
+			SaveThumbnail(index, pixels, width, height);
+		}, wait);
+
+	CollectSaves(wait ? 0 : maxPendingSaves);
+}
+
+void ThumbnailGenerator::CollectSaves(std::size_t maxPending)
+{
+	while (!_pendingSaves.empty())
+	{
+		auto& save = _pendingSaves.front();
+
+		if (_pendingSaves.size() <= maxPending && save.Result.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+		{
+			break;
+		}
+
+		const auto& fileName = _fileNames[static_cast<int>(save.Index)];
+
+		if (save.Result.get())
+		{
+			Message("Saved thumbnail of \"%s\"\n", fileName.toStdString().c_str());
+		}
+		else
+		{
+			Error("Error saving thumbnail \"%s\"\n", GetThumbnailFileName(fileName).toStdString().c_str());
+			++_failedCount;
+		}
+
+		_pendingSaves.pop_front();
+	}
+}
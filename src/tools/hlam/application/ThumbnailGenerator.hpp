@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+
+#include <QString>
+#include <QStringList>
+
+#include "core/shared/WorldTime.hpp"
+
+#include "graphics/OffscreenFramebuffer.hpp"
+#include "graphics/PixelReadbackQueue.hpp"
+#include "graphics/TextureLoader.hpp"
+
+#include "soundsystem/DummySoundSystem.hpp"
+
+#include "utility/WorkerPool.hpp"
+
+namespace graphics
+{
+class SoftwareSceneRenderer;
+}
+
+/**
+*	@brief Settings used to draw thumbnails of models
+*/
+struct ThumbnailSettings final
+{
+	static constexpr int DefaultSize = 256;
+
+	QString OutputDirectory;
+
+	//Name or index of the sequence to draw. Each model's first sequence is used if empty
+	QString Sequence;
+
+	float Frame = 0;
+
+	int Width = DefaultSize;
+	int Height = DefaultSize;
+
+	//File extension of the images. Determines the image format
+	QString Format{QStringLiteral("png")};
+
+	//Draw with the software rasterizer instead of OpenGL. No graphics context is needed
+	bool Software = false;
+};
+
+/**
+*	@brief Draws thumbnails of models without showing any user interface and saves them to a directory.
+*	Each thumbnail is read back asynchronously while the next model is loaded and drawn, then encoded and saved on worker threads.
+*/
+class ThumbnailGenerator final
+{
+public:
+	//Thumbnails that can be read back at the same time
+	static constexpr std::size_t ReadbackBufferCount = 3;
+
+	explicit ThumbnailGenerator(const ThumbnailSettings& settings);
+	~ThumbnailGenerator();
+
+	ThumbnailGenerator(const ThumbnailGenerator&) = delete;
+	ThumbnailGenerator& operator=(const ThumbnailGenerator&) = delete;
+
+	/**
+	*	@brief Gets the name of the image that the thumbnail of the given model is saved to
+	*/
+	QString GetThumbnailFileName(const QString& fileName) const;
+
+	/**
+	*	@brief Draws and saves the thumbnail of each model.
+	*	A graphics context must be current unless the software rasterizer is used. Errors are logged
+	*	@return Number of models whose thumbnail could not be saved
+	*/
+	std::size_t Generate(const QStringList& fileNames);
+
+private:
+	/**
+	*	@brief Loads a model and draws it to the framebuffer, then starts reading it back.
+	*	When using the software rasterizer the thumbnail is saved right away
+	*	@return Whether the model was drawn
+	*/
+	bool DrawThumbnail(std::uint64_t index);
+
+	void SaveThumbnail(std::uint64_t index, const std::uint8_t* pixels, int width, int height);
+
+	/**
+	*	@brief Passes finished reads to the save workers and removes finished saves from the queue
+	*	@param wait Whether to wait for all reads and saves to finish
+	*/
+	void CollectThumbnails(bool wait);
+
+	/**
+	*	@brief Removes finished saves from the queue, waiting for the oldest ones until at most @p maxPending are left
+	*/
+	void CollectSaves(std::size_t maxPending);
+
+private:
+	struct PendingSave
+	{
+		std::size_t Index;
+		std::future<bool> Result;
+	};
+
+	const ThumbnailSettings _settings;
+
+	WorldTime _worldTime;
+	soundsystem::DummySoundSystem _soundSystem;
+	graphics::TextureLoader _textureLoader;
+
+	//Shared by the scenes of all models and the software renderer
+	WorkerPool _workerPool;
+
+	graphics::OffscreenFramebuffer _framebuffer;
+	graphics::PixelReadbackQueue _readbackQueue;
+
+	std::unique_ptr<graphics::SoftwareSceneRenderer> _softwareRenderer;
+
+	QStringList _fileNames;
+
+	//Saves in progress, oldest first. Limited so readback doesn't run too far ahead of the workers
+	std::deque<PendingSave> _pendingSaves;
+
+	std::size_t _failedCount = 0;
+};
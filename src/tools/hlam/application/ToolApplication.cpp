@@ -1,26 +1,42 @@
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <GL/glew.h>
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QCoreApplication>
 #include <QDebug>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QGuiApplication>
 #include <QLocalServer>
 #include <QLocalSocket>
 #include <QMessageBox>
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
 #include <QOpenGLFunctions>
+#include <QProcess>
+#include <QProcessEnvironment>
 #include <QScopedPointer>
 #include <QSettings>
 #include <QStyleFactory>
 #include <QSurfaceFormat>
 #include <QTextStream>
+#include <QThread>
 
+#include "application/OffscreenGraphicsContext.hpp"
+#include "application/ThumbnailGenerator.hpp"
 #include "application/ToolApplication.hpp"
+
+#include "core/shared/Logging.hpp"
+
 #include "ui/EditorContext.hpp"
 #include "ui/MainWindow.hpp"
 
@@ -44,6 +60,87 @@
 
 using namespace ui::assets;
 
+const QString ThumbnailsOption{QStringLiteral("thumbnails")};
+
+static bool IsThumbnailMode(int argc, char* argv[])
+{
+	const std::string option{"--" + ThumbnailsOption.toStdString()};
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strncmp(argv[i], option.c_str(), option.size()) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+*	@brief Textures and sequence groups can be stored in separate files named after the main file, like modelT.mdl and model01.mdl
+*/
+static bool IsStudioModelCompanionFile(const QFileInfo& fileInfo)
+{
+	const QString baseName{fileInfo.completeBaseName()};
+
+	const auto mainFileExists = [&](int suffixLength)
+	{
+		return baseName.size() > suffixLength
+			&& QFileInfo::exists(fileInfo.dir().filePath(QString{"%1.%2"}.arg(baseName.left(baseName.size() - suffixLength)).arg(fileInfo.suffix())));
+	};
+
+	if (baseName.endsWith('t', Qt::CaseSensitivity::CaseInsensitive) && mainFileExists(1))
+	{
+		return true;
+	}
+
+	return baseName.size() > 2 && baseName.at(baseName.size() - 2).isDigit() && baseName.at(baseName.size() - 1).isDigit() && mainFileExists(2);
+}
+
+/**
+*	@brief Gets the models to draw thumbnails of. Directories are searched for models, and "-" reads file names from standard input
+*/
+static QStringList GetThumbnailFileNames(const QStringList& arguments)
+{
+	QStringList fileNames;
+
+	for (const auto& argument : arguments)
+	{
+		if (argument == "-")
+		{
+			QFile input;
+
+			if (input.open(stdin, QFile::ReadOnly | QFile::Text))
+			{
+				while (!input.atEnd())
+				{
+					if (const QString fileName{QString::fromUtf8(input.readLine()).trimmed()}; !fileName.isEmpty())
+					{
+						fileNames.append(fileName);
+					}
+				}
+			}
+		}
+		else if (const QFileInfo fileInfo{argument}; fileInfo.isDir())
+		{
+			for (const auto& entry : QDir{argument}.entryInfoList({QStringLiteral("*.mdl")}, QDir::Filter::Files, QDir::SortFlag::Name))
+			{
+				if (!IsStudioModelCompanionFile(entry))
+				{
+					fileNames.append(entry.filePath());
+				}
+			}
+		}
+		else
+		{
+			fileNames.append(argument);
+		}
+	}
+
+	return fileNames;
+}
+
 int ToolApplication::Run(int argc, char* argv[])
 {
 	try
@@ -54,6 +151,11 @@ int ToolApplication::Run(int argc, char* argv[])
 
 		ConfigureOpenGL();
 
+		if (IsThumbnailMode(argc, argv))
+		{
+			return RunThumbnailGenerator(argc, argv);
+		}
+
 		QApplication app(argc, argv);
 
 		_application = &app;
@@ -147,6 +249,193 @@ void ToolApplication::ConfigureOpenGL()
 	QSurfaceFormat::setDefaultFormat(defaultFormat);
 }
 
+int ToolApplication::RunThumbnailGenerator(int argc, char* argv[])
+{
+#ifdef HLAM_USE_EGL
+	//Drawing uses EGL, so no display server is needed
+	QCoreApplication app(argc, argv);
+#else
+	//Offscreen surfaces need a GUI application
+	QGuiApplication app(argc, argv);
+#endif
+
+	logging().SetLogListener(GetStdOutLogListener());
+
+	const QCommandLineOption sequenceOption{"sequence", "Name or index of the sequence to draw. Defaults to each model's first sequence", "sequence"};
+	const QCommandLineOption frameOption{"frame", "Frame of the sequence to draw", "frame", "0"};
+	const QCommandLineOption sizeOption{"size", "Size of the thumbnails, as <width>x<height> or a single number for square thumbnails", "size",
+		QString::number(ThumbnailSettings::DefaultSize)};
+	const QCommandLineOption formatOption{"format", "Image format of the thumbnails, like png, jpg, bmp or tga", "format", "png"};
+	const QCommandLineOption jobsOption{"jobs", "Number of worker processes that draw thumbnails. Defaults to the number of processor cores", "count",
+		QString::number(QThread::idealThreadCount())};
+	const QCommandLineOption softwareOption{"software",
+		"Draw with the built-in software rasterizer instead of OpenGL. No graphics driver is needed and each thumbnail is drawn using all processor cores, "
+		"so only one process is used"};
+
+	QCommandLineParser parser;
+
+	parser.setApplicationDescription("Draws a thumbnail of each model and saves it to a directory, without showing any user interface");
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption{ThumbnailsOption, "Directory to save the thumbnails to", "directory"});
+	parser.addOption(sequenceOption);
+	parser.addOption(frameOption);
+	parser.addOption(sizeOption);
+	parser.addOption(formatOption);
+	parser.addOption(jobsOption);
+	parser.addOption(softwareOption);
+
+	parser.addPositionalArgument("fileNames",
+		"Models to draw thumbnails of. Directories are searched for models, and - reads file names from standard input", "[fileNames...]");
+
+	parser.process(app);
+
+	ThumbnailSettings settings;
+
+	settings.OutputDirectory = parser.value(ThumbnailsOption);
+	settings.Sequence = parser.value(sequenceOption);
+	settings.Format = parser.value(formatOption).toLower();
+	settings.Software = parser.isSet(softwareOption);
+
+	bool isValid = false;
+
+	settings.Frame = parser.value(frameOption).toFloat(&isValid);
+
+	if (!isValid)
+	{
+		Error("Invalid frame \"%s\"\n", parser.value(frameOption).toStdString().c_str());
+		return EXIT_FAILURE;
+	}
+
+	{
+		const auto size = parser.value(sizeOption).toLower().split('x');
+
+		bool isHeightValid = true;
+
+		settings.Width = size[0].toInt(&isValid);
+		settings.Height = size.size() > 1 ? size[1].toInt(&isHeightValid) : settings.Width;
+
+		if (!isValid || !isHeightValid || size.size() > 2 || settings.Width <= 0 || settings.Height <= 0)
+		{
+			Error("Invalid thumbnail size \"%s\"\n", parser.value(sizeOption).toStdString().c_str());
+			return EXIT_FAILURE;
+		}
+	}
+
+	const int jobCount = parser.value(jobsOption).toInt(&isValid);
+
+	if (!isValid || jobCount <= 0)
+	{
+		Error("Invalid number of jobs \"%s\"\n", parser.value(jobsOption).toStdString().c_str());
+		return EXIT_FAILURE;
+	}
+
+	if (settings.OutputDirectory.isEmpty() || !QDir{}.mkpath(settings.OutputDirectory))
+	{
+		Error("Could not create output directory \"%s\"\n", settings.OutputDirectory.toStdString().c_str());
+		return EXIT_FAILURE;
+	}
+
+	const QStringList fileNames{GetThumbnailFileNames(parser.positionalArguments())};
+
+	if (fileNames.isEmpty())
+	{
+		Error("No models to draw thumbnails of\n");
+		return EXIT_FAILURE;
+	}
+
+	if (settings.Software)
+	{
+		ThumbnailGenerator generator{settings};
+
+		return generator.Generate(fileNames) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	if (const int workerCount = std::min(jobCount, fileNames.size()); workerCount > 1)
+	{
+		QStringList arguments{"--" + ThumbnailsOption, settings.OutputDirectory};
+
+		for (const auto& option : {sequenceOption, frameOption, sizeOption, formatOption})
+		{
+			if (parser.isSet(option))
+			{
+				arguments << "--" + option.names().first() << parser.value(option);
+			}
+		}
+
+		return RunThumbnailWorkers(arguments, fileNames, workerCount);
+	}
+
+	OffscreenGraphicsContext context;
+
+	if (!context.Create())
+	{
+		return EXIT_FAILURE;
+	}
+
+	ThumbnailGenerator generator{settings};
+
+	context.Begin();
+	const std::size_t failedCount = generator.Generate(fileNames);
+	context.End();
+
+	return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int ToolApplication::RunThumbnailWorkers(const QStringList& arguments, const QStringList& fileNames, int workerCount)
+{
+	auto environment{QProcessEnvironment::systemEnvironment()};
+
+	//Mesa's software renderer starts a thread per processor core in each process, so share the cores between the workers instead
+	if (!environment.contains("LP_NUM_THREADS"))
+	{
+		environment.insert("LP_NUM_THREADS", QString::number(std::max(1, QThread::idealThreadCount() / workerCount)));
+	}
+
+	std::vector<std::unique_ptr<QProcess>> workers;
+
+	for (int i = 0; i < workerCount; ++i)
+	{
+		//Interleave the models so each worker gets a similar mix of them
+		QStringList workerFileNames;
+
+		for (int fileIndex = i; fileIndex < fileNames.size(); fileIndex += workerCount)
+		{
+			workerFileNames.append(fileNames[fileIndex]);
+		}
+
+		auto worker{std::make_unique<QProcess>()};
+
+		worker->setProcessChannelMode(QProcess::ProcessChannelMode::ForwardedChannels);
+		worker->setProcessEnvironment(environment);
+
+		//File names are passed through standard input since command lines have a limited length
+		worker->start(QCoreApplication::applicationFilePath(), QStringList{arguments} << "--jobs" << "1" << "-");
+
+		worker->write(workerFileNames.join('\n').toUtf8());
+		worker->waitForBytesWritten(-1);
+		worker->closeWriteChannel();
+
+		workers.push_back(std::move(worker));
+	}
+
+	int exitCode = EXIT_SUCCESS;
+
+	for (auto& worker : workers)
+	{
+		if (!worker->waitForFinished(-1))
+		{
+			Error("Error running worker process: %s\n", worker->errorString().toStdString().c_str());
+			exitCode = EXIT_FAILURE;
+		}
+		else if (worker->exitStatus() != QProcess::ExitStatus::NormalExit || worker->exitCode() != EXIT_SUCCESS)
+		{
+			exitCode = EXIT_FAILURE;
+		}
+	}
+
+	return exitCode;
+}
+
 std::tuple<bool, QString> ToolApplication::ParseCommandLine(QApplication& application)
 {
 	QCommandLineParser parser;
@@ -8,6 +8,7 @@
 #include <QScopedPointer>
 #include <QSettings>
 #include <QString>
+#include <QStringList>
 
 #include "application/SingleInstance.hpp"
 
@@ -39,6 +40,17 @@ private:
 	
 	void ConfigureOpenGL();
 
+	/**
+	*	@brief Draws thumbnails of the models given on the command line without creating any windows
+	*/
+	int RunThumbnailGenerator(int argc, char* argv[]);
+
+	/**
+	*	@brief Splits the models between worker processes that each draw their thumbnails
+	*	@param arguments Command line arguments passed to each worker, excluding the models
+	*/
+	int RunThumbnailWorkers(const QStringList& arguments, const QStringList& fileNames, int workerCount);
+
 	std::tuple<bool, QString> ParseCommandLine(QApplication& application);
 
 	std::unique_ptr<QSettings> CreateSettings(const QString& programName, bool isPortable);
@@ -12,3 +12,10 @@ void WorldTime::TimeChanged( const double flCurrentTime )
 	SetFrameTime( static_cast<float>( flFrameTime ) );
 	SetPreviousRealTime( GetRealTime() );
 }
+
+void WorldTime::AdvanceTime( const float flTimeStep )
+{
+	SetPreviousTime( GetTime() );
+	SetTime( GetTime() + flTimeStep );
+	SetFrameTime( flTimeStep );
+}
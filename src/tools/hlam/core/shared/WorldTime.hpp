@@ -60,15 +60,32 @@ public:
 	*/
 	void SetPreviousRealTime( const double flRealTime ) { m_flPrevRealTime = flRealTime; }
 
+	/**
+	*	Gets the fraction of a fixed time step that has elapsed since the last simulation step, in the range [0, 1[.
+	*	Used to interpolate between the previous and current simulation state when rendering.
+	*/
+	float GetInterpolationFraction() const { return m_flInterpolationFraction; }
+
+	/**
+	*	Sets the interpolation fraction. Avoid using this.
+	*/
+	void SetInterpolationFraction( const float flFraction ) { m_flInterpolationFraction = flFraction; }
+
 	/**
 	*	Call with the new current time to update world time.
 	*/
 	void TimeChanged( const double flCurrentTime );
 
+	/**
+	*	Advances the current time by a fixed time step. Real time is not affected.
+	*/
+	void AdvanceTime( const float flTimeStep );
+
 private:
 	float m_flCurrentTime	= 1.0f;
 	float m_flPrevTime		= 1.0f;
 	float m_flFrameTime		= 0.0f;
 	double m_flRealTime		= 0.0f;
 	double m_flPrevRealTime = 0.0f;
+	float m_flInterpolationFraction = 0.0f;
 };
@@ -1,9 +1,19 @@
+#include <glm/common.hpp>
+#include <glm/trigonometric.hpp>
+#include <glm/vector_relational.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <string>
 
 #include "core/shared/Logging.hpp"
 
+#include "graphics/FrameProfiler.hpp"
 #include "graphics/GraphicsUtils.hpp"
 
 #include "engine/shared/studiomodel/EditableStudioModel.hpp"
@@ -11,29 +21,245 @@
 #include "engine/renderer/studiomodel/StudioModelRenderer.hpp"
 
 #include "utility/mathlib.hpp"
+#include "utility/WorkerPool.hpp"
 
 //Double to float conversion
 #pragma warning( disable: 4244 )
 
 namespace studiomdl
 {
-StudioModelRenderer::StudioModelRenderer() = default;
+enum SkinningAttribute : GLuint
+{
+	SkinningAttributePosition = 0,
+	SkinningAttributeNormal,
+	SkinningAttributeVertexBone,
+	SkinningAttributeNormalBone,
+	SkinningAttributeTexCoord,
+	SkinningAttributeMeshTexture
+};
+
+//Mirrors LightingParameters::Calculate and LightNormals
+//Texture flags and the number of texels per bone are prepended as defines
+//INSTANCING is defined if GL_ARB_draw_instanced is supported
+static const char* const SkinningVertexShader = R"(
+uniform sampler2D BoneData;
+
+#ifdef INSTANCING
+//Model transforms of the instances drawn by instanced draws, applied before the modelview matrix
+uniform bool UseInstanceTransforms;
+uniform mat4 InstanceTransforms[MAX_DRAW_INSTANCES];
+#endif
+
+uniform float Ambient;
+uniform float Shade;
+uniform float Lambert;
+uniform vec3 LightColor;
+uniform float Transparency;
+//Used for the wireframe overlay and shadows
+uniform bool UseSolidColor;
+uniform vec4 SolidColor;
+
+in vec3 Position;
+in vec3 Normal;
+in float VertexBone;
+in float NormalBone;
+in vec2 TexCoord;
+//Texture layer and flags
+in vec2 MeshTexture;
+
+out vec2 FragTexCoord;
+flat out float FragTextureLayer;
+
+vec4 FetchBoneData(int bone, int texel)
+{
+	return texelFetch(BoneData, ivec2(texel, bone), 0);
+}
+
+vec3 Lighting(int bone, int flags)
+{
+	if ((flags & STUDIO_NF_FULLBRIGHT) != 0)
+	{
+		return vec3(1.0);
+	}
+
+	vec3 illum = vec3(Ambient);
+
+	if ((flags & STUDIO_NF_FLATSHADE) != 0)
+	{
+		illum += 0.8 * Shade;
+	}
+	else
+	{
+		float lightcos = min(dot(Normal, FetchBoneData(bone, BONE_LIGHT_VECTOR).xyz), 1.0);
+
+		illum += Shade;
+
+		lightcos = (lightcos + (Lambert - 1.0)) / Lambert;
+
+		if (lightcos > 0.0)
+		{
+			illum -= lightcos * Shade;
+		}
+
+		illum = max(illum, vec3(0.0));
+	}
+
+	float maxComponent = max(illum.r, max(illum.g, illum.b));
+
+	if (maxComponent > 1.0)
+	{
+		illum *= 1.0 / maxComponent;
+	}
+
+	return illum * LightColor;
+}
+
+void main()
+{
+	int vertexBone = int(VertexBone);
+	int normalBone = int(NormalBone);
+	int flags = int(MeshTexture.y);
+
+	vec4 position = vec4(Position, 1.0);
+
+	vec4 transformed = vec4(
+		dot(position, FetchBoneData(vertexBone, 0)),
+		dot(position, FetchBoneData(vertexBone, 1)),
+		dot(position, FetchBoneData(vertexBone, 2)),
+		1.0);
+
+#ifdef INSTANCING
+	if (UseInstanceTransforms)
+	{
+		transformed = InstanceTransforms[gl_InstanceIDARB] * transformed;
+	}
+#endif
+
+	gl_Position = gl_ModelViewProjectionMatrix * transformed;
+
+	//Use the built-in color so glShadeModel still applies
+	if (UseSolidColor)
+	{
+		gl_FrontColor = SolidColor;
+	}
+	else if ((flags & STUDIO_NF_ADDITIVE) != 0)
+	{
+		gl_FrontColor = vec4(1.0, 1.0, 1.0, Transparency);
+	}
+	else
+	{
+		gl_FrontColor = vec4(Lighting(normalBone, flags), Transparency);
+	}
+
+	gl_BackColor = gl_FrontColor;
+
+	FragTextureLayer = MeshTexture.x;
+
+	if ((flags & STUDIO_NF_CHROME) != 0)
+	{
+		FragTexCoord = (vec2(
+			dot(Normal, FetchBoneData(normalBone, BONE_CHROME_RIGHT).xyz),
+			dot(Normal, FetchBoneData(normalBone, BONE_CHROME_UP).xyz)) + 1.0) * 0.5;
+	}
+	else
+	{
+		FragTexCoord = TexCoord;
+	}
+}
+)";
+
+static const char* const SkinningFragmentShader = R"(
+uniform sampler2D Texture;
+uniform sampler2DArray TextureArray;
+uniform bool Texturing;
+uniform bool UseTextureArray;
+
+in vec2 FragTexCoord;
+flat in float FragTextureLayer;
+
+void main()
+{
+	if (Texturing)
+	{
+		if (UseTextureArray)
+		{
+			gl_FragColor = texture(TextureArray, vec3(FragTexCoord, FragTextureLayer)) * gl_Color;
+		}
+		else
+		{
+			gl_FragColor = texture(Texture, FragTexCoord) * gl_Color;
+		}
+	}
+	else
+	{
+		gl_FragColor = gl_Color;
+	}
+}
+)";
+
+//Each hitbox edge is drawn once, this matches the opacity of two overlapping faces drawn at 50%
+static const glm::vec4 HitboxColor{1, 0, 0, 0.75f};
+
+//Models with the same pose have the same skinned vertices, the origin and angles are applied afterwards
+static bool HaveSamePose(const ModelRenderInfo& lhs, const ModelRenderInfo& rhs)
+{
+	return lhs.Model == rhs.Model
+		&& lhs.Scale == rhs.Scale
+		&& lhs.Transparency == rhs.Transparency
+		&& lhs.Sequence == rhs.Sequence
+		&& lhs.Frame == rhs.Frame
+		&& lhs.Bodygroup == rhs.Bodygroup
+		&& lhs.Skin == rhs.Skin
+		&& lhs.Blender == rhs.Blender
+		&& lhs.Controller == rhs.Controller
+		&& lhs.Mouth == rhs.Mouth;
+}
+
+StudioModelRenderer::StudioModelRenderer(WorkerPool* workerPool)
+	: _workerPool(workerPool)
+{
+	assert(_workerPool);
+}
+
 StudioModelRenderer::~StudioModelRenderer() = default;
 
 bool StudioModelRenderer::Initialize()
 {
 	_modelsDrawnCount = 0;
 	_drawnPolygonsCount = 0;
+	_renderStateCounters = {};
+
+	_boneSetup = {};
+	_poseState = {};
+	_skinnedModels.clear();
+	_submodelBounds.clear();
 
 	return true;
 }
 
 void StudioModelRenderer::Shutdown()
 {
+	DestroySkinningProgram();
+	DestroyModelBuffers();
+	DestroyPackedTextures();
+
+	_drawCommands.Clear();
+
+	_boneSetup = {};
+	_poseState = {};
+	_skinnedModels.clear();
+	_submodelBounds.clear();
+	_skinnedModel = nullptr;
 }
 
 void StudioModelRenderer::RunFrame()
 {
+	//Bone data can be edited between frames, so poses are only shared by the passes of a single frame
+	_boneSetup.StudioModel = nullptr;
+
+	++_frameNumber;
+
+	ReleaseUnusedModelData();
 }
 
 unsigned int StudioModelRenderer::DrawModel(studiomdl::ModelRenderInfo* const renderInfo, const renderer::DrawFlags flags)
@@ -63,7 +289,10 @@ unsigned int StudioModelRenderer::DrawModel(studiomdl::ModelRenderInfo* const re
 		return 0;
 	}
 
-	glPushMatrix();
+	//Models without textures have no skin families
+	_renderInfo->Skin = !_studioModel->SkinFamilies.empty()
+		? std::clamp(_renderInfo->Skin, 0, static_cast<int>(_studioModel->SkinFamilies.size()) - 1)
+		: 0;
 
 	auto origin = _renderInfo->Origin;
 
@@ -75,89 +304,311 @@ unsigned int StudioModelRenderer::DrawModel(studiomdl::ModelRenderInfo* const re
 		origin.z -= 1;
 	}
 
+	//Shadows are drawn using the skinned vertices of all submodels
+	_cullSubmodels = false;
+
+	if (_cullingViewProjection)
+	{
+		_cullingFrustum = graphics::Frustum{*_cullingViewProjection * GetModelMatrix(origin, _renderInfo->Angles)};
+
+		//Skips bone setup and skinning entirely
+		if (IsModelOutsideView(flags))
+		{
+			++_renderStateCounters.ModelsCulled;
+			return 0;
+		}
+
+		_cullSubmodels = !(flags & renderer::DrawFlag::DRAW_SHADOWS);
+	}
+
+	SetupTexturing(flags);
+
+	_drawCommands.PushMatrix();
+
 	SetupPosition(origin, _renderInfo->Angles);
 
-	SetUpBones();
+	{
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::BoneSetup};
+
+		const bool bonesChanged = SetUpBones();
 
-	SetupLighting();
+		SetupLighting();
+
+		UpdatePoseGeneration(bonesChanged);
+	}
 
 	unsigned int uiDrawnPolys = 0;
 
 	const bool fixShadowZFighting = (flags & renderer::DrawFlag::FIX_SHADOW_Z_FIGHTING) != 0;
 
-	if (!(flags & renderer::DrawFlag::NODRAW))
+	if (!(flags & renderer::DrawFlag::NODRAW) && _renderInfo->Transparency > 0.0f)
 	{
-		for (int i = 0; i < _studioModel->Bodyparts.size(); i++)
-		{
-			SetupModel(i);
-			if (_renderInfo->Transparency > 0.0f)
-			{
-				uiDrawnPolys += DrawPoints(false);
+		uiDrawnPolys += QueueAndDrawRenderItems(false);
 
-				if (flags & renderer::DrawFlag::DRAW_SHADOWS)
-				{
-					uiDrawnPolys += DrawShadows(fixShadowZFighting, false);
-				}
-			}
+		//Shadows are drawn after all meshes so they don't interrupt the sorted meshes
+		if (flags & renderer::DrawFlag::DRAW_SHADOWS)
+		{
+			graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Shadows};
+			uiDrawnPolys += DrawShadows(fixShadowZFighting, false);
 		}
 	}
 
 	if (flags & renderer::DrawFlag::WIREFRAME_OVERLAY)
 	{
 		//TODO: restore render mode after this?
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-		glDisable(GL_TEXTURE_2D);
-		glDisable(GL_CULL_FACE);
-		glEnable(GL_DEPTH_TEST);
+		_drawCommands.PolygonMode(GL_LINE);
+		_drawCommands.Disable(GL_TEXTURE_2D);
+		_drawCommands.Disable(GL_CULL_FACE);
+		_drawCommands.Enable(GL_DEPTH_TEST);
 
-		for (int i = 0; i < _studioModel->Bodyparts.size(); i++)
+		if (_renderInfo->Transparency > 0.0f)
 		{
-			SetupModel(i);
-			if (_renderInfo->Transparency > 0.0f)
+			uiDrawnPolys += QueueAndDrawRenderItems(true);
+
+			if (flags & renderer::DrawFlag::DRAW_SHADOWS)
 			{
-				uiDrawnPolys += DrawPoints(true);
+				graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Shadows};
+				uiDrawnPolys += DrawShadows(fixShadowZFighting, true);
+			}
+		}
+	}
 
-				if (flags & renderer::DrawFlag::DRAW_SHADOWS)
-				{
-					uiDrawnPolys += DrawShadows(fixShadowZFighting, true);
-				}
+	{
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::DebugOverlays};
+
+		// draw bones
+		if (flags & renderer::DrawFlag::DRAW_BONES)
+		{
+			DrawBones();
+		}
+
+		if (flags & renderer::DrawFlag::DRAW_ATTACHMENTS)
+		{
+			DrawAttachments();
+		}
+
+		if (flags & renderer::DrawFlag::DRAW_EYE_POSITION)
+		{
+			DrawEyePosition();
+		}
+
+		if (flags & renderer::DrawFlag::DRAW_HITBOXES)
+		{
+			DrawHitBoxes();
+		}
+
+		if (flags & renderer::DrawFlag::DRAW_NORMALS)
+		{
+			DrawNormals();
+		}
+	}
+
+	_drawCommands.PopMatrix();
+
+	{
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Submission};
+		FlushDrawCommands();
+	}
+
+	_drawnPolygonsCount += uiDrawnPolys;
+
+	return uiDrawnPolys;
+}
+
+unsigned int StudioModelRenderer::DrawModelInstances(ModelRenderInfo* const renderInfos, const std::size_t count, const renderer::DrawFlags flags)
+{
+	if (!renderInfos)
+	{
+		Error("StudioModelRenderer::DrawModelInstances: Called with null render info!\n");
+		return 0;
+	}
+
+	const auto perModelFlags = renderer::DrawFlag::DRAW_SHADOWS | renderer::DrawFlag::IS_VIEW_MODEL
+		| renderer::DrawFlag::DRAW_BONES | renderer::DrawFlag::DRAW_ATTACHMENTS | renderer::DrawFlag::DRAW_EYE_POSITION
+		| renderer::DrawFlag::DRAW_HITBOXES | renderer::DrawFlag::DRAW_NORMALS;
+
+	unsigned int uiDrawnPolys = 0;
+
+	for (std::size_t first = 0; first < count;)
+	{
+		std::size_t end = first + 1;
+
+		if (!(flags & perModelFlags))
+		{
+			while (end < count && HaveSamePose(renderInfos[first], renderInfos[end]))
+			{
+				++end;
 			}
 		}
+
+		//The wireframe overlay leaves lines enabled and texturing disabled, which must not carry over to the next instances
+		if (flags & renderer::DrawFlag::WIREFRAME_OVERLAY)
+		{
+			_drawCommands.PushAttrib(GL_ENABLE_BIT | GL_POLYGON_BIT);
+		}
+
+		if (end - first > 1)
+		{
+			uiDrawnPolys += DrawInstancesWithSamePose(renderInfos + first, end - first, flags);
+		}
+		else
+		{
+			uiDrawnPolys += DrawModel(renderInfos + first, flags);
+		}
+
+		if (flags & renderer::DrawFlag::WIREFRAME_OVERLAY)
+		{
+			_drawCommands.PopAttrib();
+			FlushDrawCommands();
+		}
+
+		first = end;
+	}
+
+	return uiDrawnPolys;
+}
+
+unsigned int StudioModelRenderer::DrawInstancesWithSamePose(ModelRenderInfo* const renderInfos, const std::size_t count, const renderer::DrawFlags flags)
+{
+	_renderInfo = renderInfos;
+
+	if (_renderInfo->Model)
+	{
+		_studioModel = _renderInfo->Model;
+	}
+	else
+	{
+		Error("StudioModelRenderer::DrawModelInstances: Called with null model!\n");
+		return 0;
+	}
+
+	_modelsDrawnCount += count;
+
+	if (_studioModel->Bodyparts.empty())
+	{
+		return 0;
 	}
 
-	// draw bones
-	if (flags & renderer::DrawFlag::DRAW_BONES)
+	_instanceTransforms.clear();
+
+	for (std::size_t i = 0; i < count; ++i)
 	{
-		DrawBones();
+		auto& renderInfo = renderInfos[i];
+
+		renderInfo.Skin = !_studioModel->SkinFamilies.empty()
+			? std::clamp(renderInfo.Skin, 0, static_cast<int>(_studioModel->SkinFamilies.size()) - 1)
+			: 0;
+
+		const auto modelMatrix = GetModelMatrix(renderInfo.Origin, renderInfo.Angles);
+
+		if (_cullingViewProjection)
+		{
+			_renderInfo = &renderInfo;
+			_cullingFrustum = graphics::Frustum{*_cullingViewProjection * modelMatrix};
+
+			if (IsModelOutsideView(flags))
+			{
+				++_renderStateCounters.ModelsCulled;
+				continue;
+			}
+		}
+
+		_instanceTransforms.push_back(modelMatrix);
 	}
 
-	if (flags & renderer::DrawFlag::DRAW_ATTACHMENTS)
+	if (_instanceTransforms.empty())
 	{
-		DrawAttachments();
+		return 0;
 	}
 
-	if (flags & renderer::DrawFlag::DRAW_EYE_POSITION)
+	//Submodels are shared by all instances, so they can't be culled against the frustum of one of them
+	_cullSubmodels = false;
+
+	SetupTexturing(flags);
+
+	_renderInfo = renderInfos;
+
 	{
-		DrawEyePosition();
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::BoneSetup};
+
+		const bool bonesChanged = SetUpBones();
+
+		SetupLighting();
+
+		UpdatePoseGeneration(bonesChanged);
 	}
 
-	if (flags & renderer::DrawFlag::DRAW_HITBOXES)
+	unsigned int uiDrawnPolys = 0;
+
+	if (!(flags & renderer::DrawFlag::NODRAW) && _renderInfo->Transparency > 0.0f)
 	{
-		DrawHitBoxes();
+		uiDrawnPolys += QueueAndDrawInstances(false);
 	}
 
-	if (flags & renderer::DrawFlag::DRAW_NORMALS)
+	if (flags & renderer::DrawFlag::WIREFRAME_OVERLAY)
 	{
-		DrawNormals();
+		_drawCommands.PolygonMode(GL_LINE);
+		_drawCommands.Disable(GL_TEXTURE_2D);
+		_drawCommands.Disable(GL_CULL_FACE);
+		_drawCommands.Enable(GL_DEPTH_TEST);
+
+		if (_renderInfo->Transparency > 0.0f)
+		{
+			uiDrawnPolys += QueueAndDrawInstances(true);
+		}
 	}
 
-	glPopMatrix();
+	{
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Submission};
+		FlushDrawCommands();
+	}
 
 	_drawnPolygonsCount += uiDrawnPolys;
 
 	return uiDrawnPolys;
 }
 
+unsigned int StudioModelRenderer::QueueAndDrawInstances(const bool bWireframe)
+{
+	{
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Skinning};
+		QueueRenderItems(bWireframe);
+	}
+
+	graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Submission};
+
+	unsigned int uiDrawnPolys = 0;
+
+	if (_useGPUSkinning && SetupSkinningProgram() && _supportsInstancing)
+	{
+		for (std::size_t first = 0; first < _instanceTransforms.size(); first += MaxDrawInstances)
+		{
+			_firstDrawInstance = first;
+			_drawInstanceCount = std::min<std::size_t>(MaxDrawInstances, _instanceTransforms.size() - first);
+
+			uiDrawnPolys += DrawRenderItems(bWireframe);
+		}
+
+		_firstDrawInstance = 0;
+		_drawInstanceCount = 0;
+	}
+	else
+	{
+		//The draws are repeated for each instance, which still skins the vertices only once
+		for (const auto& transform : _instanceTransforms)
+		{
+			_drawCommands.PushMatrix();
+			_drawCommands.MultMatrix(transform);
+
+			uiDrawnPolys += DrawRenderItems(bWireframe);
+
+			_drawCommands.PopMatrix();
+		}
+	}
+
+	return uiDrawnPolys;
+}
+
 void StudioModelRenderer::DrawSingleBone(ModelRenderInfo& renderInfo, const int iBone)
 {
 	//TODO: rework how stuff is passed in
@@ -173,8 +624,8 @@ void StudioModelRenderer::DrawSingleBone(ModelRenderInfo& renderInfo, const int
 
 	SetUpBones();
 
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_DEPTH_TEST);
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_DEPTH_TEST);
 
 	const auto& bone = *model->Bones[iBone];
 
@@ -186,31 +637,27 @@ void StudioModelRenderer::DrawSingleBone(ModelRenderInfo& renderInfo, const int
 
 		const auto& parentBoneTransform = _bonetransform[parentBone.ArrayIndex];
 
-		glPointSize(10.0f);
-		glColor3f(0, 0.7f, 1);
-		glBegin(GL_LINES);
-		glVertex3f(parentBoneTransform[0][3], parentBoneTransform[1][3], parentBoneTransform[2][3]);
-		glVertex3f(_bonetransform[iBone][0][3], _bonetransform[iBone][1][3], _bonetransform[iBone][2][3]);
-		glEnd();
+		const glm::vec3 parentOrigin{parentBoneTransform[0][3], parentBoneTransform[1][3], parentBoneTransform[2][3]};
+		const glm::vec3 origin{boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]};
+
+		_debugDraw.AddLine(parentOrigin, origin, glm::vec4{0, 0.7f, 1, 1});
 
-		glColor3f(0, 0, 0.8f);
-		glBegin(GL_POINTS);
 		if (parentBone.Parent)
-			glVertex3f(parentBoneTransform[0][3], parentBoneTransform[1][3], parentBoneTransform[2][3]);
-		glVertex3f(boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]);
-		glEnd();
+		{
+			_debugDraw.AddPoint(parentOrigin, glm::vec4{0, 0, 0.8f, 1}, 10.0f);
+		}
+
+		_debugDraw.AddPoint(origin, glm::vec4{0, 0, 0.8f, 1}, 10.0f);
 	}
 	else
 	{
 		// draw parent bone node
-		glPointSize(10.0f);
-		glColor3f(0.8f, 0, 0);
-		glBegin(GL_POINTS);
-		glVertex3f(boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]);
-		glEnd();
+		_debugDraw.AddPoint(glm::vec3{boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]}, glm::vec4{0.8f, 0, 0, 1}, 10.0f);
 	}
 
-	glPointSize(1.0f);
+	_debugDraw.Flush(_drawCommands);
+
+	FlushDrawCommands();
 
 	_studioModel = nullptr;
 	_renderInfo = nullptr;
@@ -231,9 +678,9 @@ void StudioModelRenderer::DrawSingleAttachment(ModelRenderInfo& renderInfo, cons
 
 	SetUpBones();
 
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_CULL_FACE);
+	_drawCommands.Disable(GL_DEPTH_TEST);
 
 	const auto& attachment = *_studioModel->Attachments[iAttachment];
 
@@ -244,27 +691,17 @@ void StudioModelRenderer::DrawSingleAttachment(ModelRenderInfo& renderInfo, cons
 	VectorTransform(attachment.Vectors[0], attachmentBoneTransform, v[1]);
 	VectorTransform(attachment.Vectors[1], attachmentBoneTransform, v[2]);
 	VectorTransform(attachment.Vectors[2], attachmentBoneTransform, v[3]);
-	glBegin(GL_LINES);
-	glColor3f(0, 1, 1);
-	glVertex3fv(glm::value_ptr(v[0]));
-	glColor3f(1, 1, 1);
-	glVertex3fv(glm::value_ptr(v[1]));
-	glColor3f(0, 1, 1);
-	glVertex3fv(glm::value_ptr(v[0]));
-	glColor3f(1, 1, 1);
-	glVertex3fv(glm::value_ptr(v[2]));
-	glColor3f(0, 1, 1);
-	glVertex3fv(glm::value_ptr(v[0]));
-	glColor3f(1, 1, 1);
-	glVertex3fv(glm::value_ptr(v[3]));
-	glEnd();
-
-	glPointSize(10);
-	glColor3f(0, 1, 0);
-	glBegin(GL_POINTS);
-	glVertex3fv(glm::value_ptr(v[0]));
-	glEnd();
-	glPointSize(1);
+
+	for (int i = 1; i < 4; ++i)
+	{
+		_debugDraw.AddLine(v[0], v[i], glm::vec4{0, 1, 1, 1}, glm::vec4{1, 1, 1, 1});
+	}
+
+	_debugDraw.AddPoint(v[0], glm::vec4{0, 1, 0, 1}, 10.0f);
+
+	_debugDraw.Flush(_drawCommands);
+
+	FlushDrawCommands();
 
 	_studioModel = nullptr;
 	_renderInfo = nullptr;
@@ -285,18 +722,16 @@ void StudioModelRenderer::DrawSingleHitbox(ModelRenderInfo& renderInfo, const in
 
 	SetUpBones();
 
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_CULL_FACE);
 	if (_renderInfo->Transparency < 1.0f)
-		glDisable(GL_DEPTH_TEST);
+		_drawCommands.Disable(GL_DEPTH_TEST);
 	else
-		glEnable(GL_DEPTH_TEST);
+		_drawCommands.Enable(GL_DEPTH_TEST);
 
-	glColor4f(1, 0, 0, 0.5f);
-
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	_drawCommands.PolygonMode(GL_LINE);
+	_drawCommands.Enable(GL_BLEND);
+	_drawCommands.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	const auto& hitbox = *_studioModel->Hitboxes[hitboxIndex];
 
@@ -315,69 +750,214 @@ void StudioModelRenderer::DrawSingleHitbox(ModelRenderInfo& renderInfo, const in
 	VectorTransform(v[6], hitboxBoneTransform, v2[6]);
 	VectorTransform(v[7], hitboxBoneTransform, v2[7]);
 
-	graphics::DrawBox(v2);
+	_debugDraw.AddBox(v2, HitboxColor);
+	_debugDraw.Flush(_drawCommands);
+
+	FlushDrawCommands();
 
 	_studioModel = nullptr;
 	_renderInfo = nullptr;
 }
 
+void StudioModelRenderer::SetupTexturing(const renderer::DrawFlags flags)
+{
+	//Recorded so the state is known without querying the graphics context
+	if (flags & renderer::DrawFlag::NO_TEXTURES)
+	{
+		_drawCommands.Disable(GL_TEXTURE_2D);
+	}
+	else
+	{
+		_drawCommands.Enable(GL_TEXTURE_2D);
+	}
+}
+
+glm::mat4 StudioModelRenderer::GetModelMatrix(const glm::vec3& origin, const glm::vec3& angles)
+{
+	auto modelMatrix = glm::translate(glm::mat4{1.f}, origin);
+
+	modelMatrix = glm::rotate(modelMatrix, glm::radians(angles[1]), glm::vec3{0, 0, 1});
+	modelMatrix = glm::rotate(modelMatrix, glm::radians(angles[0]), glm::vec3{0, 1, 0});
+	modelMatrix = glm::rotate(modelMatrix, glm::radians(angles[2]), glm::vec3{1, 0, 0});
+
+	return modelMatrix;
+}
+
 void StudioModelRenderer::SetupPosition(const glm::vec3& origin, const glm::vec3& angles)
 {
-	glTranslatef(origin[0], origin[1], origin[2]);
+	_drawCommands.Translate(origin);
 
-	glRotatef(angles[1], 0, 0, 1);
-	glRotatef(angles[0], 0, 1, 0);
-	glRotatef(angles[2], 1, 0, 0);
+	_drawCommands.Rotate(angles[1], glm::vec3{0, 0, 1});
+	_drawCommands.Rotate(angles[0], glm::vec3{0, 1, 0});
+	_drawCommands.Rotate(angles[2], glm::vec3{1, 0, 0});
 }
 
-void StudioModelRenderer::DrawBones()
+bool StudioModelRenderer::IsModelOutsideView(const renderer::DrawFlags flags) const
 {
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_DEPTH_TEST);
+	const auto overlayFlags = renderer::DrawFlag::DRAW_BONES | renderer::DrawFlag::DRAW_ATTACHMENTS | renderer::DrawFlag::DRAW_EYE_POSITION
+		| renderer::DrawFlag::DRAW_HITBOXES | renderer::DrawFlag::DRAW_NORMALS;
 
-	for (int i = 0; i < _studioModel->Bones.size(); i++)
+	if ((flags & overlayFlags) || _renderInfo->Sequence < 0 || _renderInfo->Sequence >= _studioModel->Sequences.size())
 	{
-		const auto& bone = *_studioModel->Bones[i];
+		return false;
+	}
+
+	const auto& sequence = *_studioModel->Sequences[_renderInfo->Sequence];
+
+	//Some models don't have bounds
+	if (glm::any(glm::greaterThanEqual(sequence.BBMin, sequence.BBMax)))
+	{
+		return false;
+	}
+
+	auto mins = sequence.BBMin;
+	auto maxs = sequence.BBMax;
+
+	//Scale is applied to vertices around their bone, not to the bone positions, so scaled vertices can leave the bounds.
+	//Both are inside the bounds, so a vertex is at most radius + (scale * diameter) away from the center
+	const float scale = static_cast<float>(VectorMax(glm::abs(_renderInfo->Scale)));
+
+	if (scale > 1)
+	{
+		const auto center = (mins + maxs) * 0.5f;
+		const float radius = glm::length(maxs - center) * (1 + (2 * scale));
+
+		mins = center - glm::vec3{radius};
+		maxs = center + glm::vec3{radius};
+	}
+
+	if (!_cullingFrustum.IsBoxOutside(mins, maxs))
+	{
+		return false;
+	}
+
+	if (flags & renderer::DrawFlag::DRAW_SHADOWS)
+	{
+		const auto shadowProjection = GetShadowProjection();
+
+		glm::vec3 shadowMins{std::numeric_limits<float>::max()};
+		glm::vec3 shadowMaxs{std::numeric_limits<float>::lowest()};
+
+		for (int i = 0; i < 8; ++i)
+		{
+			const glm::vec3 corner{(i & 1) ? maxs.x : mins.x, (i & 2) ? maxs.y : mins.y, (i & 4) ? maxs.z : mins.z};
+			const glm::vec3 projected{shadowProjection * glm::vec4{corner, 1}};
+
+			shadowMins = glm::min(shadowMins, projected);
+			shadowMaxs = glm::max(shadowMaxs, projected);
+		}
+
+		if (!_cullingFrustum.IsBoxOutside(shadowMins, shadowMaxs))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool StudioModelRenderer::IsSubmodelOutsideView()
+{
+	auto& bounds = _submodelBounds[_model];
+
+	bounds.LastUsedFrame = _frameNumber;
+
+	if (bounds.StudioModel != _studioModel || bounds.GeometryRevision != _studioModel->GeometryRevision)
+	{
+		bounds.StudioModel = _studioModel;
+		bounds.GeometryRevision = _studioModel->GeometryRevision;
+		bounds.BoneRadii.clear();
+
+		std::array<float, MAXSTUDIOBONES> radii;
+		radii.fill(-1.f);
+
+		for (const auto& vertex : _model->Vertices)
+		{
+			auto& radius = radii[vertex.Bone->ArrayIndex];
+			radius = std::max(radius, glm::length(vertex.Vertex));
+		}
+
+		for (int i = 0; i < radii.size(); ++i)
+		{
+			if (radii[i] >= 0)
+			{
+				bounds.BoneRadii.emplace_back(i, radii[i]);
+			}
+		}
+	}
+
+	//Bone transforms include the scale
+	const float scale = std::max(1.f, static_cast<float>(VectorMax(glm::abs(_renderInfo->Scale))));
+
+	for (const auto& [bone, radius] : bounds.BoneRadii)
+	{
+		const glm::vec3 origin{_bonetransform[bone][0][3], _bonetransform[bone][1][3], _bonetransform[bone][2][3]};
+
+		if (!_cullingFrustum.IsSphereOutside(origin, radius * scale))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+glm::mat4 StudioModelRenderer::GetShadowProjection() const
+{
+	//Flattens the skinned geometry onto a plane just above the entity origin, moving it away from the light
+	const auto lightSampleHeight = _renderInfo->Origin.z;
+
+	glm::mat4x4 shadowProjection{1.f};
+
+	shadowProjection[2] = glm::vec4{-_lightvec.x, -_lightvec.y, 0.f, 0.f};
+	shadowProjection[3] = glm::vec4{_lightvec.x * lightSampleHeight, _lightvec.y * lightSampleHeight, lightSampleHeight + 1.f, 1.f};
+
+	return shadowProjection;
+}
+
+void StudioModelRenderer::DrawBones()
+{
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_DEPTH_TEST);
+
+	for (int i = 0; i < _studioModel->Bones.size(); i++)
+	{
+		const auto& bone = *_studioModel->Bones[i];
 
 		const auto& boneTransform = _bonetransform[i];
 
+		const glm::vec3 origin{boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]};
+
 		if (bone.Parent)
 		{
 			const auto& parentBoneTransform = _bonetransform[bone.Parent->ArrayIndex];
 
-			glPointSize(3.0f);
-			glColor3f(1, 0.7f, 0);
-			glBegin(GL_LINES);
-			glVertex3f(parentBoneTransform[0][3], parentBoneTransform[1][3], parentBoneTransform[2][3]);
-			glVertex3f(_bonetransform[i][0][3], _bonetransform[i][1][3], _bonetransform[i][2][3]);
-			glEnd();
+			const glm::vec3 parentOrigin{parentBoneTransform[0][3], parentBoneTransform[1][3], parentBoneTransform[2][3]};
+
+			_debugDraw.AddLine(parentOrigin, origin, glm::vec4{1, 0.7f, 0, 1});
 
-			glColor3f(0, 0, 0.8f);
-			glBegin(GL_POINTS);
 			if (bone.Parent->Parent)
-				glVertex3f(parentBoneTransform[0][3], parentBoneTransform[1][3], parentBoneTransform[2][3]);
-			glVertex3f(boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]);
-			glEnd();
+			{
+				_debugDraw.AddPoint(parentOrigin, glm::vec4{0, 0, 0.8f, 1}, 3.0f);
+			}
+
+			_debugDraw.AddPoint(origin, glm::vec4{0, 0, 0.8f, 1}, 3.0f);
 		}
 		else
 		{
 			// draw parent bone node
-			glPointSize(5.0f);
-			glColor3f(0.8f, 0, 0);
-			glBegin(GL_POINTS);
-			glVertex3f(boneTransform[0][3], boneTransform[1][3], boneTransform[2][3]);
-			glEnd();
+			_debugDraw.AddPoint(origin, glm::vec4{0.8f, 0, 0, 1}, 5.0f);
 		}
 	}
 
-	glPointSize(1.0f);
+	_debugDraw.Flush(_drawCommands);
 }
 
 void StudioModelRenderer::DrawAttachments()
 {
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_CULL_FACE);
+	_drawCommands.Disable(GL_DEPTH_TEST);
 
 	for (int i = 0; i < _studioModel->Attachments.size(); i++)
 	{
@@ -390,58 +970,40 @@ void StudioModelRenderer::DrawAttachments()
 		VectorTransform(attachment.Vectors[0], attachmentBoneTransform, v[1]);
 		VectorTransform(attachment.Vectors[1], attachmentBoneTransform, v[2]);
 		VectorTransform(attachment.Vectors[2], attachmentBoneTransform, v[3]);
-		glBegin(GL_LINES);
-		glColor3f(1, 0, 0);
-		glVertex3fv(glm::value_ptr(v[0]));
-		glColor3f(1, 1, 1);
-		glVertex3fv(glm::value_ptr(v[1]));
-		glColor3f(1, 0, 0);
-		glVertex3fv(glm::value_ptr(v[0]));
-		glColor3f(1, 1, 1);
-		glVertex3fv(glm::value_ptr(v[2]));
-		glColor3f(1, 0, 0);
-		glVertex3fv(glm::value_ptr(v[0]));
-		glColor3f(1, 1, 1);
-		glVertex3fv(glm::value_ptr(v[3]));
-		glEnd();
-
-		glPointSize(5);
-		glColor3f(0, 1, 0);
-		glBegin(GL_POINTS);
-		glVertex3fv(glm::value_ptr(v[0]));
-		glEnd();
-		glPointSize(1);
+
+		for (int j = 1; j < 4; ++j)
+		{
+			_debugDraw.AddLine(v[0], v[j], glm::vec4{1, 0, 0, 1}, glm::vec4{1, 1, 1, 1});
+		}
+
+		_debugDraw.AddPoint(v[0], glm::vec4{0, 1, 0, 1}, 5.0f);
 	}
+
+	_debugDraw.Flush(_drawCommands);
 }
 
 void StudioModelRenderer::DrawEyePosition()
 {
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
-	glDisable(GL_DEPTH_TEST);
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_CULL_FACE);
+	_drawCommands.Disable(GL_DEPTH_TEST);
 
-	glPointSize(7);
-	glColor3f(1, 0, 1);
-	glBegin(GL_POINTS);
-	glVertex3fv(glm::value_ptr(_studioModel->EyePosition));
-	glEnd();
-	glPointSize(1);
+	_debugDraw.AddPoint(_studioModel->EyePosition, glm::vec4{1, 0, 1, 1}, 7.0f);
+	_debugDraw.Flush(_drawCommands);
 }
 
 void StudioModelRenderer::DrawHitBoxes()
 {
-	glDisable(GL_TEXTURE_2D);
-	glDisable(GL_CULL_FACE);
+	_drawCommands.Disable(GL_TEXTURE_2D);
+	_drawCommands.Disable(GL_CULL_FACE);
 	if (_renderInfo->Transparency < 1.0f)
-		glDisable(GL_DEPTH_TEST);
+		_drawCommands.Disable(GL_DEPTH_TEST);
 	else
-		glEnable(GL_DEPTH_TEST);
-
-	glColor4f(1, 0, 0, 0.5f);
+		_drawCommands.Enable(GL_DEPTH_TEST);
 
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	_drawCommands.PolygonMode(GL_LINE);
+	_drawCommands.Enable(GL_BLEND);
+	_drawCommands.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	for (int i = 0; i < _studioModel->Hitboxes.size(); i++)
 	{
@@ -462,30 +1024,25 @@ void StudioModelRenderer::DrawHitBoxes()
 		VectorTransform(v[6], hitboxTransform, v2[6]);
 		VectorTransform(v[7], hitboxTransform, v2[7]);
 
-		graphics::DrawBox(v2);
+		_debugDraw.AddBox(v2, HitboxColor);
 	}
+
+	_debugDraw.Flush(_drawCommands);
 }
 
 void StudioModelRenderer::DrawNormals()
 {
-	glDisable(GL_TEXTURE_2D);
-
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-	glBegin(GL_LINES);
+	_drawCommands.Disable(GL_TEXTURE_2D);
 
 	for (int iBodyPart = 0; iBodyPart < _studioModel->Bodyparts.size(); ++iBodyPart)
 	{
 		SetupModel(iBodyPart);
 
-		for (int i = 0; i < _model->Vertices.size(); i++)
-		{
-			VectorTransform(_model->Vertices[i].Vertex, _bonetransform[_model->Vertices[i].Bone->ArrayIndex], _xformverts[i]);
-		}
+		SetupSkinnedModel();
 
-		for (int i = 0; i < _model->Normals.size(); i++)
-		{
-			VectorRotate(_model->Normals[i].Vertex, _bonetransform[_model->Normals[i].Bone->ArrayIndex], _xformnorms[i]);
-		}
+		auto& data = _skinnedModels[_model];
+
+		SetupSkinnedNormals(data);
 
 		for (int j = 0; j < _model->Meshes.size(); j++)
 		{
@@ -503,22 +1060,32 @@ void StudioModelRenderer::DrawNormals()
 
 				for (; i > 0; --i, ptricmds += 4)
 				{
-					const auto& vertex = _xformverts[ptricmds[0]];
+					const auto& vertex = data.Vertices[ptricmds[0]];
 
-					const auto absoluteNormalEnd = vertex + _xformnorms[ptricmds[1]];
+					const auto absoluteNormalEnd = vertex + data.Normals[ptricmds[1]];
 
-					glVertex3fv(glm::value_ptr(vertex));
-					glVertex3fv(glm::value_ptr(absoluteNormalEnd));
+					_debugDraw.AddLine(vertex, absoluteNormalEnd, glm::vec4{1.0f, 1.0f, 1.0f, 1.0f});
 				}
 			}
 		}
 	}
 
-	glEnd();
+	_debugDraw.Flush(_drawCommands);
 }
 
-void StudioModelRenderer::SetUpBones()
+bool StudioModelRenderer::SetUpBones()
 {
+	if (_boneSetup.StudioModel == _studioModel
+		&& _boneSetup.Sequence == _renderInfo->Sequence
+		&& _boneSetup.Frame == _renderInfo->Frame
+		&& _boneSetup.Scale == _renderInfo->Scale
+		&& _boneSetup.Blender == _renderInfo->Blender
+		&& _boneSetup.Controller == _renderInfo->Controller
+		&& _boneSetup.Mouth == _renderInfo->Mouth)
+	{
+		return false;
+	}
+
 	_bonetransform = _boneTransformer.SetUpBones(*_studioModel,
 		{
 			_renderInfo->Sequence,
@@ -528,6 +1095,16 @@ void StudioModelRenderer::SetUpBones()
 			_renderInfo->Controller,
 			_renderInfo->Mouth
 		}).data();
+
+	_boneSetup.StudioModel = _studioModel;
+	_boneSetup.Sequence = _renderInfo->Sequence;
+	_boneSetup.Frame = _renderInfo->Frame;
+	_boneSetup.Scale = _renderInfo->Scale;
+	_boneSetup.Blender = _renderInfo->Blender;
+	_boneSetup.Controller = _renderInfo->Controller;
+	_boneSetup.Mouth = _renderInfo->Mouth;
+
+	return true;
 }
 
 void StudioModelRenderer::SetupLighting()
@@ -552,334 +1129,1692 @@ void StudioModelRenderer::SetupModel(int bodypart)
 	_model = _studioModel->GetModelByBodyPart(_renderInfo->Bodygroup, bodypart);
 }
 
-unsigned int StudioModelRenderer::DrawPoints(const bool bWireframe)
+void StudioModelRenderer::UpdatePoseGeneration(const bool bonesChanged)
 {
-	unsigned int uiDrawnPolys = 0;
+	const auto boneCount = _studioModel->Bones.size();
+
+	//Reused bones are the same ones that were last compared
+	const bool changed = _poseState.StudioModel != _studioModel
+		|| _poseState.GeometryRevision != _studioModel->GeometryRevision
+		|| _poseState.BoneCount != boneCount
+		|| (bonesChanged && !std::equal(_bonetransform, _bonetransform + boneCount, _poseState.BoneTransforms.begin()))
+		|| _poseState.LightVector != _lightvec
+		|| _poseState.LightColor != _lightcolor
+		|| _poseState.Lambert != _lambert
+		|| _poseState.AmbientLight != _ambientlight
+		|| _poseState.ShadeLight != _shadelight;
+
+	if (!changed)
+	{
+		return;
+	}
+
+	_poseState.StudioModel = _studioModel;
+	_poseState.GeometryRevision = _studioModel->GeometryRevision;
+	_poseState.BoneCount = boneCount;
+	std::copy(_bonetransform, _bonetransform + boneCount, _poseState.BoneTransforms.begin());
+	_poseState.LightVector = _lightvec;
+	_poseState.LightColor = _lightcolor;
+	_poseState.Lambert = _lambert;
+	_poseState.AmbientLight = _ambientlight;
+	_poseState.ShadeLight = _shadelight;
 
-	//TODO: do this earlier
-	_renderInfo->Skin = std::clamp(_renderInfo->Skin, 0, static_cast<int>(_studioModel->SkinFamilies.size()));
+	++_poseGeneration;
 
-	for (int i = 0; i < _model->Vertices.size(); i++)
+	//Never use 0, it marks data that was never calculated
+	if (_poseGeneration == 0)
 	{
-		VectorTransform(_model->Vertices[i].Vertex, _bonetransform[_model->Vertices[i].Bone->ArrayIndex], _xformverts[i]);
+		_poseGeneration = 1;
 	}
+}
 
-	SortedMesh meshes[MAXSTUDIOMESHES]{};
+void StudioModelRenderer::SetupSkinnedModel()
+{
+	auto& data = _skinnedModels[_model];
 
-	//
-	// clip and draw all triangles
-	//
+	_skinnedModel = &data;
 
-	auto normals = _model->Normals.data();
+	data.LastUsedFrame = _frameNumber;
 
-	glm::vec3* lv = _lightvalues;
-	for (int j = 0; j < _model->Meshes.size(); j++)
-	{
-		const auto& mesh = _model->Meshes[j];
+	bool upToDate = data.PoseGeneration == _poseGeneration
+		&& data.MeshFlags.size() == _model->Meshes.size();
 
-		const int flags = _studioModel->SkinFamilies[_renderInfo->Skin][mesh.SkinRef]->Flags;
+	bool hasChrome = false;
 
-		meshes[j].Mesh = &mesh;
-		meshes[j].Flags = flags;
+	//Texture flags can be changed at any time, and the skin can be changed without affecting the pose
+	for (int j = 0; j < _model->Meshes.size(); j++)
+	{
+		const int flags = _studioModel->SkinFamilies[_renderInfo->Skin][_model->Meshes[j].SkinRef]->Flags;
 
-		for (int i = 0; i < mesh.NumNorms; i++, ++lv, ++normals)
+		if (upToDate && data.MeshFlags[j] != flags)
 		{
-			Lighting(*lv, normals->Bone->ArrayIndex, flags, normals->Vertex);
-
-			// FIX: move this check out of the inner loop
-			if (flags & STUDIO_NF_CHROME)
-			{
-				auto& c = _chrome[reinterpret_cast<glm::vec3*>(lv) - _lightvalues];
+			upToDate = false;
+		}
 
-				Chrome(c, normals->Bone->ArrayIndex, normals->Vertex);
-			}
+		if (flags & STUDIO_NF_CHROME)
+		{
+			hasChrome = true;
 		}
 	}
 
-	//Sort meshes by render modes so additive meshes are drawn after solid meshes.
-	//Masked meshes are drawn before solid meshes.
-	std::stable_sort(meshes, meshes + _model->Meshes.size(), CompareSortedMeshes);
-
-	uiDrawnPolys += DrawMeshes(bWireframe, meshes);
-
-	glDepthMask(GL_TRUE);
-
-	return uiDrawnPolys;
-}
-
-unsigned int StudioModelRenderer::DrawMeshes(const bool bWireframe, const SortedMesh* pMeshes)
-{
-	//Set here since it never changes. Much more efficient.
-	if (bWireframe)
+	//Chrome depends on the viewer as well
+	if (upToDate && hasChrome && (data.ViewerOrigin != _viewerOrigin || data.ViewerRight != _viewerRight))
 	{
-		glColor4fv(glm::value_ptr(glm::vec4{_wireframeColor, _renderInfo->Transparency}));
+		upToDate = false;
 	}
 
-	unsigned int uiDrawnPolys = 0;
-
-	//Polygons may overlap, so make sure they can blend together.
-	glDepthFunc(GL_LEQUAL);
-
-	for (int j = 0; j < _model->Meshes.size(); j++)
+	if (upToDate)
 	{
-		const auto& mesh = *pMeshes[j].Mesh;
-		auto ptricmds = mesh.Triangles.data();
+		return;
+	}
 
-		const auto& texture = *_studioModel->SkinFamilies[_renderInfo->Skin][mesh.SkinRef];
+	data.PoseGeneration = _poseGeneration;
+	data.HasChrome = hasChrome;
+	data.ViewerOrigin = _viewerOrigin;
+	data.ViewerRight = _viewerRight;
 
-		const auto s = 1.0 / (float)texture.Width;
-		const auto t = 1.0 / (float)texture.Height;
+	data.MeshFlags.resize(_model->Meshes.size());
+	data.Vertices.resize(_model->Vertices.size());
+	data.LightValues.resize(_model->Normals.size());
+	data.Chrome.resize(hasChrome ? _model->Normals.size() : 0);
 
-		if (!bWireframe)
-		{
-			if (texture.Flags & STUDIO_NF_ADDITIVE)
-				glDepthMask(GL_FALSE);
-			else
-				glDepthMask(GL_TRUE);
+	_skinningMeshes.resize(_model->Meshes.size());
 
-			if (texture.Flags & STUDIO_NF_ADDITIVE)
-			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE);
-			}
-			else if (_renderInfo->Transparency < 1.0f)
-			{
-				glEnable(GL_BLEND);
-				glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-			}
-			else
-			{
-				glDisable(GL_BLEND);
-			}
+	std::size_t firstNormal = 0;
 
-			if (texture.Flags & STUDIO_NF_MASKED)
-			{
-				glEnable(GL_ALPHA_TEST);
-				glAlphaFunc(GL_GREATER, 0.5f);
-			}
+	for (int j = 0; j < _model->Meshes.size(); j++)
+	{
+		const auto& mesh = _model->Meshes[j];
 
-			glBindTexture(GL_TEXTURE_2D, texture.TextureId);
-		}
+		const int flags = _studioModel->SkinFamilies[_renderInfo->Skin][mesh.SkinRef]->Flags;
 
-		int i;
+		data.MeshFlags[j] = flags;
 
-		while (i = *(ptricmds++))
-		{
-			if (i < 0)
-			{
-				glBegin(GL_TRIANGLE_FAN);
-				i = -i;
-			}
-			else
-			{
-				glBegin(GL_TRIANGLE_STRIP);
-			}
+		_skinningMeshes[j] = {firstNormal, static_cast<std::size_t>(mesh.NumNorms), flags};
 
-			uiDrawnPolys += i - 2;
+		firstNormal += mesh.NumNorms;
+	}
 
-			for (; i > 0; i--, ptricmds += 4)
-			{
-				if (!bWireframe)
-				{
-					if (texture.Flags & STUDIO_NF_CHROME)
-					{
-						const auto& c = _chrome[ptricmds[1]];
+	//Set up on this thread so the workers only read shared state
+	if (hasChrome)
+	{
+		SetupChromeVectors();
+	}
 
-						glTexCoord2f(c[0], c[1]);
-					}
-					else
-					{
-						glTexCoord2f(ptricmds[2] * s, ptricmds[3] * t);
-					}
+	const auto lighting = GetLightingParameters();
 
-					if (texture.Flags & STUDIO_NF_ADDITIVE)
-					{
-						glColor4f(1.0f, 1.0f, 1.0f, _renderInfo->Transparency);
-					}
-					else
-					{
-						const glm::vec3& lightVec = _lightvalues[ptricmds[1]];
-						glColor4f(lightVec[0], lightVec[1], lightVec[2], _renderInfo->Transparency);
-					}
-				}
+	const auto vertexCount = _model->Vertices.size();
+	const auto normalCount = std::min(firstNormal, _model->Normals.size());
 
-				glVertex3fv(glm::value_ptr(_xformverts[ptricmds[0]]));
-			}
-			glEnd();
-		}
+	//Vertices and normals are processed as one range so large submodels are split evenly
+	const NormalLightingVectors vectors{_blightvec, _chromeright, _chromeup};
 
-		if (!bWireframe)
+	_workerPool->ParallelFor(vertexCount + normalCount, SkinningBatchSize, [&](std::size_t begin, std::size_t end)
 		{
-			if (texture.Flags & STUDIO_NF_ADDITIVE)
+			if (begin < vertexCount)
 			{
-				glDisable(GL_BLEND);
+				SkinVertices(_model->Vertices.data(), _bonetransform, data.Vertices.data(), begin, std::min(end, vertexCount));
 			}
 
-			if (texture.Flags & STUDIO_NF_MASKED)
+			if (end > vertexCount)
 			{
-				glDisable(GL_ALPHA_TEST);
+				LightNormals(_model->Normals.data(), _skinningMeshes.data(), _skinningMeshes.size(), lighting, vectors,
+					data.LightValues.data(), data.Chrome.data(), std::max(begin, vertexCount) - vertexCount, end - vertexCount);
 			}
-		}
-	}
-
-	return uiDrawnPolys;
+		});
 }
 
-unsigned int StudioModelRenderer::DrawShadows(const bool fixZFighting, const bool wireframe)
+void StudioModelRenderer::SetupSkinnedNormals(SkinnedModelData& data)
 {
-	if (!(_studioModel->Flags & EF_NOSHADELIGHT))
+	if (data.NormalsPoseGeneration == data.PoseGeneration && data.Normals.size() == _model->Normals.size())
 	{
-		GLint oldDepthMask;
-		glGetIntegerv(GL_DEPTH_WRITEMASK, &oldDepthMask);
-
-		if (fixZFighting)
-		{
-			glDepthMask(GL_FALSE);
-		}
-		else
-		{
-			glDepthMask(GL_TRUE);
-		}
-
-		const float r_blend = _renderInfo->Transparency;
+		return;
+	}
 
-		const auto alpha = 0.5 * r_blend;
+	data.NormalsPoseGeneration = data.PoseGeneration;
+	data.Normals.resize(_model->Normals.size());
 
-		const GLboolean texture2DWasEnabled = glIsEnabled(GL_TEXTURE_2D);
+	for (int i = 0; i < _model->Normals.size(); i++)
+	{
+		VectorRotate(_model->Normals[i].Vertex, _bonetransform[_model->Normals[i].Bone->ArrayIndex], data.Normals[i]);
+	}
+}
 
-		glDisable(GL_TEXTURE_2D);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-		glEnable(GL_BLEND);
+LightingParameters StudioModelRenderer::GetLightingParameters() const
+{
+	LightingParameters lighting;
 
-		if (wireframe)
-		{
-			glColor4fv(glm::value_ptr(glm::vec4{_wireframeColor, _renderInfo->Transparency}));
-		}
-		else
-		{
-			//Render shadows as black
-			glColor4f(0.f, 0.f, 0.f, alpha);
-		}
+	lighting.Ambient = std::max(0.1f, (float)_ambientlight / 255.0f); // to avoid divison by zero
+	lighting.Shade = _shadelight / 255.0f;
+	lighting.Lambert = std::max(1.0f, _lambert);
+	lighting.LightColor = _lightcolor;
 
-		glDepthFunc(GL_LESS);
+	lighting.AmbientAndShade = lighting.Ambient + lighting.Shade;
+	lighting.InverseLambert = 1.0f / lighting.Lambert;
+	lighting.LambertOffset = (lighting.Lambert - 1.0f) * lighting.InverseLambert;
 
-		const auto drawnPolys = InternalDrawShadows();
+	glm::vec3 illum{lighting.Ambient};
 
-		glDepthFunc(GL_LEQUAL);
+	VectorMA(illum, 0.8f, glm::vec3{lighting.Shade}, illum);
 
-		if (texture2DWasEnabled)
-		{
-			glEnable(GL_TEXTURE_2D);
-		}
+	const float max = VectorMax(illum);
 
-		glDisable(GL_BLEND);
-		glColor4f(1.f, 1.f, 1.f, 1.f);
+	lighting.FlatShadeLight = (max > 1.0f ? illum * (1.0f / max) : illum) * lighting.LightColor;
 
-		glDepthMask(static_cast<GLboolean>(oldDepthMask));
+	return lighting;
+}
 
-		return drawnPolys;
-	}
-	else
+unsigned int StudioModelRenderer::QueueAndDrawRenderItems(const bool bWireframe)
+{
 	{
-		return 0;
+		graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Skinning};
+		QueueRenderItems(bWireframe);
 	}
+
+	graphics::ScopedProfile profile{_frameProfiler, graphics::ProfileStage::Submission};
+	return DrawRenderItems(bWireframe);
 }
 
-unsigned int StudioModelRenderer::InternalDrawShadows()
+void StudioModelRenderer::QueueRenderItems(const bool bWireframe)
 {
-	unsigned int drawnPolys = 0;
+	//Vertex data is uploaded directly, so earlier draws that may still use the buffers have to be executed first
+	FlushDrawCommands();
 
-	//Always at the entity origin
-	const auto lightSampleHeight = _renderInfo->Origin.z;
-	const auto shadowHeight = lightSampleHeight + 1.0;
+	_renderItems.clear();
+
+	const bool gpuSkinning = _useGPUSkinning && SetupSkinningProgram();
+
+	//Only the skinning shader can sample array textures
+	_currentPackedTextures = nullptr;
+
+	if (gpuSkinning)
+	{
+		UploadBoneData();
+
+		if (_useTextureArrays)
+		{
+			_currentPackedTextures = SetupPackedTextures();
+		}
+	}
 
-	for (int i = 0; i < _model->Meshes.size(); ++i)
+	for (int i = 0; i < _studioModel->Bodyparts.size(); i++)
 	{
-		const auto& mesh = _model->Meshes[i];
-		drawnPolys += mesh.NumTriangles;
+		SetupModel(i);
 
-		auto triCmds = mesh.Triangles.data();
+		if (_cullSubmodels && IsSubmodelOutsideView())
+		{
+			++_renderStateCounters.SubmodelsCulled;
+			continue;
+		}
 
-		for (int i; (i = *triCmds++) != 0;)
+		//The shader transforms and lights the vertices itself
+		if (gpuSkinning)
 		{
-			if (i < 0)
-			{
-				i = -i;
-				glBegin(GL_TRIANGLE_FAN);
-			}
-			else
-			{
-				glBegin(GL_TRIANGLE_STRIP);
-			}
+			SetupSkinningBuffer(SetupModelBuffers());
+		}
+		else
+		{
+			SetupSkinnedModel();
 
-			for (; i > 0; --i, triCmds += 4)
+			if (_useVertexBuffers)
 			{
-				const auto vertex{_xformverts[triCmds[0]]};
+				UploadStreamedVertices(SetupModelBuffers(), bWireframe);
+			}
+		}
 
-				const auto lightDistance = vertex.z - lightSampleHeight;
+		for (int j = 0; j < _model->Meshes.size(); j++)
+		{
+			const auto& texture = *_studioModel->SkinFamilies[_renderInfo->Skin][_model->Meshes[j].SkinRef];
 
-				glm::vec3 point;
+			const auto pass = GetRenderPass(texture.Flags);
 
-				point.x = vertex.x - _lightvec.x * lightDistance;
-				point.y = vertex.y - _lightvec.y * lightDistance;
-				point.z = shadowHeight;
+			RenderBlendMode blendMode = RenderBlendMode::None;
 
-				glVertex3fv(glm::value_ptr(point));
+			if (pass == RenderPass::Additive)
+			{
+				blendMode = RenderBlendMode::Additive;
 			}
+			else if (_renderInfo->Transparency < 1.0f)
+			{
+				blendMode = RenderBlendMode::Alpha;
+			}
+
+			const int layer = _currentPackedTextures ? _currentPackedTextures->Layers[texture.ArrayIndex] : -1;
 
-			glEnd();
+			_renderItems.push_back(RenderItem{i, j, &texture, pass, blendMode,
+				layer != -1 ? _currentPackedTextures->ArrayTexture : texture.TextureId, layer});
 		}
 	}
 
-	return drawnPolys;
+	//Items that compare equal stay in submodel order, which keeps submodel switches to a minimum
+	std::stable_sort(_renderItems.begin(), _renderItems.end(), CompareRenderItems);
 }
 
-void StudioModelRenderer::Lighting(glm::vec3& lv, int bone, int flags, const glm::vec3& normal)
+unsigned int StudioModelRenderer::DrawRenderItems(const bool bWireframe)
 {
-	const float ambient = std::max(0.1f, (float)_ambientlight / 255.0f); // to avoid divison by zero
-	const float shade = _shadelight / 255.0f;
-	glm::vec3 illum{ambient};
+	//Set here since it never changes. Much more efficient.
+	if (bWireframe)
+	{
+		_drawCommands.Color(glm::vec4{_wireframeColor, _renderInfo->Transparency});
+	}
+
+	unsigned int uiDrawnPolys = 0;
+
+	//Polygons may overlap, so make sure they can blend together.
+	_drawCommands.DepthFunc(GL_LEQUAL);
+
+	//Anything may have changed the state since the last draw
+	_renderState = {};
 
-	if (flags & STUDIO_NF_FULLBRIGHT)
+	if (bWireframe)
 	{
-		lv = glm::vec3{1, 1, 1};
-		return;
+		//The overlay is blended the same way as the model itself, the depth mask is left as-is
+		SetBlendMode(_renderInfo->Transparency < 1.0f ? RenderBlendMode::Alpha : RenderBlendMode::None);
 	}
-	else if (flags & STUDIO_NF_FLATSHADE)
+
+	const bool gpuSkinning = _useGPUSkinning && SetupSkinningProgram();
+	const bool useBuffers = gpuSkinning || _useVertexBuffers;
+
+	if (gpuSkinning)
 	{
-		VectorMA(illum, 0.8f, glm::vec3{shade}, illum);
+		BeginGPUSkinning(bWireframe, glm::vec4{_wireframeColor, _renderInfo->Transparency});
 	}
-	else
+	else if (useBuffers)
 	{
-		auto lightcos = glm::dot(normal, _blightvec[bone]); // -1 colinear, 1 opposite
+		_drawCommands.EnableClientState(GL_VERTEX_ARRAY);
 
-		if (lightcos > 1.0f) lightcos = 1;
+		if (!bWireframe)
+		{
+			_drawCommands.EnableClientState(GL_COLOR_ARRAY);
+			_drawCommands.EnableClientState(GL_TEXTURE_COORD_ARRAY);
+		}
+	}
 
-		illum += _shadelight / 255.0f;
+	int currentBodypart = -1;
+	const ModelBufferData* buffers = nullptr;
 
-		auto r = _lambert;
-		if (r < 1.0f) r = 1.0f;
-		lightcos = (lightcos + (r - 1.0f)) / r; // do modified hemispherical lighting
-		if (lightcos > 0.0f) VectorMA(illum, -lightcos, glm::vec3{shade}, illum);
+	//Texture coordinate source of the current submodel: 0 for texture coordinates, 1 for chrome
+	int texCoordSource = -1;
 
-		if (illum[0] <= 0) illum[0] = 0;
-		if (illum[1] <= 0) illum[1] = 0;
-		if (illum[2] <= 0) illum[2] = 0;
-	}
+	//Whether the skinning shader samples the array texture: -1 if not set yet
+	int sampleTextureArray = -1;
 
-	float max = VectorMax(illum);
+	//Samplers of different types can't share a unit, so the array texture is bound to its own
+	const bool useTextureArrays = gpuSkinning && !bWireframe && _currentPackedTextures;
 
-	if (max > 1.0f)
-		lv = illum * (1.0f / max);
-	else lv = illum;
+	if (useTextureArrays)
+	{
+		_drawCommands.ActiveTexture(GL_TEXTURE2);
+		_drawCommands.BindTexture(_currentPackedTextures->ArrayTexture, GL_TEXTURE_2D_ARRAY);
+		_drawCommands.ActiveTexture(GL_TEXTURE0);
+		++_renderStateCounters.TextureBinds;
+	}
+
+	for (std::size_t itemIndex = 0; itemIndex < _renderItems.size(); ++itemIndex)
+	{
+		const auto& item = _renderItems[itemIndex];
+
+		if (currentBodypart != item.Bodypart)
+		{
+			currentBodypart = item.Bodypart;
+
+			if (BindRenderItemModel(item.Bodypart, useBuffers, gpuSkinning, bWireframe))
+			{
+				buffers = &_modelBuffers.find(_model)->second;
+			}
+			else
+			{
+				buffers = nullptr;
+			}
+
+			texCoordSource = -1;
+		}
+
+		const auto& mesh = _model->Meshes[item.MeshIndex];
+		auto ptricmds = mesh.Triangles.data();
+
+		const auto& texture = *item.Texture;
+
+		const auto s = 1.0 / (float)texture.Width;
+		const auto t = 1.0 / (float)texture.Height;
+
+		if (!bWireframe)
+		{
+			SetDepthMask(item.Pass != RenderPass::Additive);
+			SetBlendMode(item.BlendMode);
+			SetAlphaTest(item.Pass == RenderPass::Masked);
+
+			if (item.TextureLayer == -1)
+			{
+				SetTexture(item.TextureId);
+			}
+
+			if (useTextureArrays)
+			{
+				const int sampleArray = item.TextureLayer != -1 ? 1 : 0;
+
+				if (sampleTextureArray != sampleArray)
+				{
+					sampleTextureArray = sampleArray;
+					_drawCommands.Uniform(_skinningUniforms.UseTextureArray, sampleArray);
+				}
+			}
+		}
+
+		//Instanced draws draw each mesh once per instance
+		const unsigned int instanceCount = _drawInstanceCount > 0 ? static_cast<unsigned int>(_drawInstanceCount) : 1;
+
+		_renderStateCounters.MeshesDrawn += instanceCount;
+
+		if (buffers)
+		{
+			const auto& range = buffers->Meshes[item.MeshIndex];
+
+			GLsizei indexCount = range.IndexCount;
+			unsigned int polygonCount = range.PolygonCount;
+
+			if (gpuSkinning)
+			{
+				//Texture flags and layers are part of the vertex data, so meshes that share all other state
+				//and follow each other in the index buffer are drawn together
+				while (itemIndex + 1 < _renderItems.size())
+				{
+					const auto& next = _renderItems[itemIndex + 1];
+					const auto& nextRange = buffers->Meshes[next.MeshIndex];
+
+					if (next.Bodypart != item.Bodypart
+						|| nextRange.IndexOffset != range.IndexOffset + indexCount * sizeof(GLuint))
+					{
+						break;
+					}
+
+					if (!bWireframe
+						&& (next.Pass != item.Pass || next.BlendMode != item.BlendMode || next.TextureId != item.TextureId))
+					{
+						break;
+					}
+
+					++itemIndex;
+					indexCount += nextRange.IndexCount;
+					polygonCount += nextRange.PolygonCount;
+					_renderStateCounters.MeshesDrawn += instanceCount;
+				}
+			}
+			else if (!bWireframe)
+			{
+				const int source = (texture.Flags & STUDIO_NF_CHROME) ? 1 : 0;
+
+				if (texCoordSource != source)
+				{
+					texCoordSource = source;
+
+					if (source == 1)
+					{
+						_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers->StreamBuffer);
+						_drawCommands.ArrayPointer(GL_TEXTURE_COORD_ARRAY, 2, buffers->StreamChromeOffset);
+					}
+					else
+					{
+						_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers->TexCoordBuffer);
+						_drawCommands.ArrayPointer(GL_TEXTURE_COORD_ARRAY, 2, 0);
+					}
+
+					++_renderStateCounters.BufferBinds;
+				}
+			}
+
+			if (_drawInstanceCount > 0)
+			{
+				_drawCommands.DrawElementsInstanced(GL_TRIANGLES, indexCount, range.IndexOffset, static_cast<GLsizei>(_drawInstanceCount));
+				++_renderStateCounters.InstancedDraws;
+			}
+			else
+			{
+				_drawCommands.DrawElements(GL_TRIANGLES, indexCount, range.IndexOffset);
+			}
+
+			uiDrawnPolys += polygonCount * instanceCount;
+		}
+		else
+		{
+			int i;
+
+			while (i = *(ptricmds++))
+			{
+				if (i < 0)
+				{
+					_drawCommands.Begin(GL_TRIANGLE_FAN);
+					i = -i;
+				}
+				else
+				{
+					_drawCommands.Begin(GL_TRIANGLE_STRIP);
+				}
+
+				uiDrawnPolys += i - 2;
+
+				for (; i > 0; i--, ptricmds += 4)
+				{
+					if (!bWireframe)
+					{
+						if (texture.Flags & STUDIO_NF_CHROME)
+						{
+							const auto& c = _skinnedModel->Chrome[ptricmds[1]];
+
+							_drawCommands.TexCoord(glm::vec2{c[0], c[1]});
+						}
+						else
+						{
+							_drawCommands.TexCoord(glm::vec2{ptricmds[2] * s, ptricmds[3] * t});
+						}
+
+						if (texture.Flags & STUDIO_NF_ADDITIVE)
+						{
+							_drawCommands.Color(glm::vec4{1.0f, 1.0f, 1.0f, _renderInfo->Transparency});
+						}
+						else
+						{
+							const glm::vec3& lightVec = _skinnedModel->LightValues[ptricmds[1]];
+							_drawCommands.Color(glm::vec4{lightVec[0], lightVec[1], lightVec[2], _renderInfo->Transparency});
+						}
+					}
+
+					_drawCommands.Vertex(_skinnedModel->Vertices[ptricmds[0]]);
+				}
+				_drawCommands.End();
+			}
+		}
+	}
+
+	if (useTextureArrays)
+	{
+		_drawCommands.ActiveTexture(GL_TEXTURE2);
+		_drawCommands.BindTexture(0, GL_TEXTURE_2D_ARRAY);
+		_drawCommands.ActiveTexture(GL_TEXTURE0);
+	}
+
+	if (gpuSkinning)
+	{
+		EndGPUSkinning();
+	}
+	else if (useBuffers)
+	{
+		_drawCommands.DisableClientState(GL_TEXTURE_COORD_ARRAY);
+		_drawCommands.DisableClientState(GL_COLOR_ARRAY);
+		_drawCommands.DisableClientState(GL_VERTEX_ARRAY);
+
+		_drawCommands.BindBuffer(GL_ARRAY_BUFFER, 0);
+		_drawCommands.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	//Leave the state the way the rest of the scene expects it
+	SetBlendMode(RenderBlendMode::None);
+	SetDepthMask(true);
+	SetAlphaTest(false);
+
+	return uiDrawnPolys;
+}
+
+bool StudioModelRenderer::BindRenderItemModel(int bodypart, const bool useBuffers, const bool gpuSkinning, const bool bWireframe)
+{
+	SetupModel(bodypart);
+
+	if (!gpuSkinning)
+	{
+		_skinnedModel = &_skinnedModels.find(_model)->second;
+	}
+
+	if (!useBuffers)
+	{
+		return false;
+	}
+
+	const auto& buffers = _modelBuffers.find(_model)->second;
+
+	//The skinned vertices could not be uploaded this frame
+	if (!gpuSkinning && buffers.StreamBufferDirty)
+	{
+		return false;
+	}
+
+	if (gpuSkinning)
+	{
+		BindSkinningBuffers(buffers);
+	}
+	else
+	{
+		_drawCommands.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.IndexBuffer);
+		_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers.StreamBuffer);
+
+		_drawCommands.ArrayPointer(GL_VERTEX_ARRAY, 3, 0);
+
+		if (!bWireframe)
+		{
+			_drawCommands.ArrayPointer(GL_COLOR_ARRAY, 4, buffers.StreamColorsOffset);
+		}
+	}
+
+	++_renderStateCounters.BufferBinds;
+
+	return true;
+}
+
+void StudioModelRenderer::SetTexture(GLuint textureId)
+{
+	if (_renderState.TextureId != textureId)
+	{
+		_renderState.TextureId = textureId;
+		_drawCommands.BindTexture(textureId);
+		++_renderStateCounters.TextureBinds;
+	}
+}
+
+void StudioModelRenderer::SetBlendMode(RenderBlendMode blendMode)
+{
+	if (_renderState.BlendMode == blendMode)
+	{
+		return;
+	}
+
+	switch (blendMode)
+	{
+	case RenderBlendMode::None:
+		_drawCommands.Disable(GL_BLEND);
+		break;
+
+	case RenderBlendMode::Alpha:
+		_drawCommands.Enable(GL_BLEND);
+		_drawCommands.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		break;
+
+	case RenderBlendMode::Additive:
+		_drawCommands.Enable(GL_BLEND);
+		_drawCommands.BlendFunc(GL_SRC_ALPHA, GL_ONE);
+		break;
+	}
+
+	_renderState.BlendMode = blendMode;
+	++_renderStateCounters.BlendChanges;
+}
+
+void StudioModelRenderer::SetDepthMask(bool enable)
+{
+	if (_renderState.DepthMask != enable)
+	{
+		_renderState.DepthMask = enable;
+		_drawCommands.DepthMask(enable);
+		++_renderStateCounters.DepthMaskChanges;
+	}
+}
+
+void StudioModelRenderer::SetAlphaTest(bool enable)
+{
+	if (_renderState.AlphaTest == enable)
+	{
+		return;
+	}
+
+	if (enable)
+	{
+		_drawCommands.Enable(GL_ALPHA_TEST);
+		_drawCommands.AlphaFunc(GL_GREATER, 0.5f);
+	}
+	else
+	{
+		_drawCommands.Disable(GL_ALPHA_TEST);
+	}
+
+	_renderState.AlphaTest = enable;
+	++_renderStateCounters.AlphaTestChanges;
+}
+
+void StudioModelRenderer::FlushDrawCommands()
+{
+	if (!_drawCommands.IsEmpty())
+	{
+		_drawCommandBackend->Execute(_drawCommands);
+		_drawCommands.Clear();
+	}
+}
+
+StudioModelRenderer::ModelBufferData& StudioModelRenderer::SetupModelBuffers()
+{
+	auto& buffers = _modelBuffers[_model];
+
+	buffers.LastUsedFrame = _frameNumber;
+
+	//Any edit can change the triangle commands or texture coordinates
+	if (buffers.StudioModel != _studioModel || buffers.Revision != _studioModel->Revision)
+	{
+		buffers.StudioModel = _studioModel;
+		buffers.Revision = _studioModel->Revision;
+		buffers.HasSkinningData = false;
+		buffers.Meshes.clear();
+		buffers.Meshes.resize(_model->Meshes.size());
+		buffers.Commands.clear();
+
+		std::vector<GLuint> indices;
+
+		for (int j = 0; j < _model->Meshes.size(); j++)
+		{
+			auto& range = buffers.Meshes[j];
+
+			range.FirstVertex = buffers.Commands.size();
+			range.IndexOffset = indices.size() * sizeof(GLuint);
+
+			auto ptricmds = _model->Meshes[j].Triangles.data();
+
+			int i;
+
+			while (i = *(ptricmds++))
+			{
+				const bool isFan = i < 0;
+
+				if (isFan)
+				{
+					i = -i;
+				}
+
+				const auto first = static_cast<GLuint>(buffers.Commands.size());
+
+				for (int k = 0; k < i; ++k, ptricmds += 4)
+				{
+					buffers.Commands.push_back({ptricmds[0], ptricmds[1], ptricmds[2], ptricmds[3]});
+				}
+
+				//Convert to a triangle list, keeping the winding order and the last vertex of each triangle the same
+				for (GLuint k = 0; k + 2 < static_cast<GLuint>(i); ++k)
+				{
+					if (isFan)
+					{
+						indices.insert(indices.end(), {first, first + k + 1, first + k + 2});
+					}
+					else if ((k % 2) == 0)
+					{
+						indices.insert(indices.end(), {first + k, first + k + 1, first + k + 2});
+					}
+					else
+					{
+						indices.insert(indices.end(), {first + k + 1, first + k, first + k + 2});
+					}
+				}
+
+				range.PolygonCount += i - 2;
+			}
+
+			range.VertexCount = buffers.Commands.size() - range.FirstVertex;
+			range.IndexCount = static_cast<GLsizei>(indices.size() - (range.IndexOffset / sizeof(GLuint)));
+		}
+
+		buffers.IndexCount = static_cast<GLsizei>(indices.size());
+
+		if (!buffers.IndexBuffer)
+		{
+			glGenBuffers(1, &buffers.IndexBuffer);
+		}
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.IndexBuffer);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	//Texture coordinates depend on the texture dimensions, which differ between skins and change when a texture is replaced
+	bool texCoordsValid = true;
+
+	for (int j = 0; j < _model->Meshes.size(); j++)
+	{
+		const auto& texture = *_studioModel->SkinFamilies[_renderInfo->Skin][_model->Meshes[j].SkinRef];
+		const auto& range = buffers.Meshes[j];
+
+		if (range.TextureWidth != texture.Width || range.TextureHeight != texture.Height)
+		{
+			texCoordsValid = false;
+			break;
+		}
+	}
+
+	if (!texCoordsValid)
+	{
+		std::vector<glm::vec2> texCoords(buffers.Commands.size());
+
+		for (int j = 0; j < _model->Meshes.size(); j++)
+		{
+			const auto& texture = *_studioModel->SkinFamilies[_renderInfo->Skin][_model->Meshes[j].SkinRef];
+			auto& range = buffers.Meshes[j];
+
+			//Calculated the same way as in immediate mode
+			const auto s = 1.0 / (float)texture.Width;
+			const auto t = 1.0 / (float)texture.Height;
+
+			for (std::size_t k = range.FirstVertex; k < range.FirstVertex + range.VertexCount; ++k)
+			{
+				const auto& command = buffers.Commands[k];
+
+				texCoords[k] = glm::vec2{command[2] * s, command[3] * t};
+			}
+
+			range.TextureWidth = texture.Width;
+			range.TextureHeight = texture.Height;
+		}
+
+		if (!buffers.TexCoordBuffer)
+		{
+			glGenBuffers(1, &buffers.TexCoordBuffer);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, buffers.TexCoordBuffer);
+		glBufferData(GL_ARRAY_BUFFER, texCoords.size() * sizeof(glm::vec2), texCoords.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	return buffers;
+}
+
+void StudioModelRenderer::UploadStreamedVertices(ModelBufferData& buffers, const bool bWireframe)
+{
+	const auto vertexCount = buffers.Commands.size();
+
+	const bool hasColors = !bWireframe;
+	const bool hasChrome = !bWireframe && _skinnedModel->HasChrome;
+
+	const auto positionsSize = vertexCount * sizeof(glm::vec3);
+	const auto colorsSize = hasColors ? vertexCount * sizeof(glm::vec4) : 0;
+	const auto chromeSize = hasChrome ? vertexCount * sizeof(glm::vec2) : 0;
+
+	buffers.StreamColorsOffset = positionsSize;
+	buffers.StreamChromeOffset = positionsSize + colorsSize;
+
+	//Storage that lost its contents is replaced entirely
+	if (buffers.StreamBufferDirty)
+	{
+		glDeleteBuffers(1, &buffers.StreamBuffer);
+		buffers.StreamBuffer = 0;
+		buffers.StreamBufferDirty = false;
+	}
+
+	if (!buffers.StreamBuffer)
+	{
+		glGenBuffers(1, &buffers.StreamBuffer);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.StreamBuffer);
+
+	for (int attempt = 1;; ++attempt)
+	{
+		//Orphan the previous contents so the driver doesn't have to wait for draws that still use them
+		glBufferData(GL_ARRAY_BUFFER, positionsSize + colorsSize + chromeSize, nullptr, GL_STREAM_DRAW);
+
+		//Write directly into the buffer so no copy of the data has to be kept around
+		auto data = static_cast<std::byte*>(glMapBuffer(GL_ARRAY_BUFFER, GL_WRITE_ONLY));
+
+		if (!data)
+		{
+			Error("StudioModelRenderer::UploadStreamedVertices: Could not map stream buffer\n");
+			buffers.StreamBufferDirty = true;
+			break;
+		}
+
+		WriteStreamedVertices(buffers, data, hasColors, hasChrome);
+
+		//The contents can be lost while mapped, for example when the display mode changes
+		if (glUnmapBuffer(GL_ARRAY_BUFFER) == GL_TRUE)
+		{
+			break;
+		}
+
+		if (attempt >= MaxStreamUploadAttempts)
+		{
+			Error("StudioModelRenderer::UploadStreamedVertices: Stream buffer contents were lost while mapped\n");
+			buffers.StreamBufferDirty = true;
+			break;
+		}
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void StudioModelRenderer::WriteStreamedVertices(const ModelBufferData& buffers, std::byte* data, const bool hasColors, const bool hasChrome)
+{
+	const auto vertexCount = buffers.Commands.size();
+
+	const auto positions = reinterpret_cast<glm::vec3*>(data);
+	const auto colors = reinterpret_cast<glm::vec4*>(data + buffers.StreamColorsOffset);
+	const auto chrome = reinterpret_cast<glm::vec2*>(data + buffers.StreamChromeOffset);
+
+	for (std::size_t k = 0; k < vertexCount; ++k)
+	{
+		positions[k] = _skinnedModel->Vertices[buffers.Commands[k][0]];
+	}
+
+	if (hasColors)
+	{
+		for (int j = 0; j < _model->Meshes.size(); j++)
+		{
+			const auto& range = buffers.Meshes[j];
+			const int flags = _skinnedModel->MeshFlags[j];
+
+			for (std::size_t k = range.FirstVertex; k < range.FirstVertex + range.VertexCount; ++k)
+			{
+				const auto normalIndex = buffers.Commands[k][1];
+
+				if (flags & STUDIO_NF_ADDITIVE)
+				{
+					colors[k] = glm::vec4{1.0f, 1.0f, 1.0f, _renderInfo->Transparency};
+				}
+				else
+				{
+					colors[k] = glm::vec4{_skinnedModel->LightValues[normalIndex], _renderInfo->Transparency};
+				}
+
+				if (flags & STUDIO_NF_CHROME)
+				{
+					chrome[k] = _skinnedModel->Chrome[normalIndex];
+				}
+			}
+		}
+	}
+}
+
+void StudioModelRenderer::ReleaseUnusedModelData()
+{
+	for (auto it = _skinnedModels.begin(); it != _skinnedModels.end();)
+	{
+		if (_frameNumber - it->second.LastUsedFrame > UnusedModelDataFrames)
+		{
+			it = _skinnedModels.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (auto it = _submodelBounds.begin(); it != _submodelBounds.end();)
+	{
+		if (_frameNumber - it->second.LastUsedFrame > UnusedModelDataFrames)
+		{
+			it = _submodelBounds.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (auto it = _modelBuffers.begin(); it != _modelBuffers.end();)
+	{
+		if (_frameNumber - it->second.LastUsedFrame > UnusedModelDataFrames)
+		{
+			DeleteModelBuffers(it->second);
+			it = _modelBuffers.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	for (auto it = _packedTextures.begin(); it != _packedTextures.end();)
+	{
+		if (_frameNumber - it->second.LastUsedFrame > UnusedModelDataFrames)
+		{
+			if (_currentPackedTextures == &it->second)
+			{
+				_currentPackedTextures = nullptr;
+			}
+
+			glDeleteTexture(it->second.ArrayTexture);
+			it = _packedTextures.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void StudioModelRenderer::DeleteModelBuffers(ModelBufferData& buffers)
+{
+	glDeleteBuffers(1, &buffers.TexCoordBuffer);
+	glDeleteBuffers(1, &buffers.IndexBuffer);
+	glDeleteBuffers(1, &buffers.StreamBuffer);
+	glDeleteBuffers(1, &buffers.SkinningBuffer);
+	glDeleteBuffers(1, &buffers.MeshTextureBuffer);
+}
+
+void StudioModelRenderer::DestroyModelBuffers()
+{
+	for (auto& [model, buffers] : _modelBuffers)
+	{
+		DeleteModelBuffers(buffers);
+	}
+
+	_modelBuffers.clear();
+}
+
+const StudioModelRenderer::PackedTextureData* StudioModelRenderer::SetupPackedTextures()
+{
+	auto& packed = _packedTextures[_studioModel];
+
+	packed.LastUsedFrame = _frameNumber;
+
+	bool isValid = packed.TextureRevision == _studioModel->TextureRevision
+		&& packed.SourceTextures.size() == _studioModel->Textures.size();
+
+	//Another model may have been loaded at the same address
+	for (std::size_t i = 0; isValid && i < packed.SourceTextures.size(); ++i)
+	{
+		isValid = packed.SourceTextures[i] == _studioModel->Textures[i]->TextureId;
+	}
+
+	if (!isValid)
+	{
+		PackTextures(packed);
+	}
+
+	return packed.ArrayTexture != 0 ? &packed : nullptr;
+}
+
+void StudioModelRenderer::PackTextures(PackedTextureData& packed)
+{
+	glDeleteTexture(packed.ArrayTexture);
+
+	packed.TextureRevision = _studioModel->TextureRevision;
+	packed.SourceTextures.clear();
+	packed.Layers.assign(_studioModel->Textures.size(), -1);
+
+	struct SourceTexture
+	{
+		int Index;
+		GLint Width;
+		GLint Height;
+		GLint MinFilter;
+	};
+
+	std::vector<SourceTexture> sources;
+
+	//The uploaded textures are copied since they can differ from the texture data, for instance while previewing palette changes
+	for (int i = 0; i < _studioModel->Textures.size(); ++i)
+	{
+		const auto textureId = _studioModel->Textures[i]->TextureId;
+
+		packed.SourceTextures.push_back(textureId);
+
+		if (textureId == 0)
+		{
+			continue;
+		}
+
+		SourceTexture source{i};
+
+		glBindTexture(GL_TEXTURE_2D, textureId);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &source.Width);
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &source.Height);
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &source.MinFilter);
+
+		if (source.Width > 0 && source.Height > 0)
+		{
+			sources.push_back(source);
+		}
+	}
+
+	if (sources.empty())
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return;
+	}
+
+	//All layers share the same filters. Textures differ in whether they use mipmaps, so only the most common filter is packed
+	GLint minFilter = sources.front().MinFilter;
+	std::ptrdiff_t minFilterCount = 0;
+
+	for (const auto& candidate : sources)
+	{
+		const auto count = std::count_if(sources.begin(), sources.end(), [&](const auto& source)
+			{
+				return source.MinFilter == candidate.MinFilter;
+			});
+
+		if (count > minFilterCount)
+		{
+			minFilter = candidate.MinFilter;
+			minFilterCount = count;
+		}
+	}
+
+	sources.erase(std::remove_if(sources.begin(), sources.end(), [&](const auto& source)
+		{
+			return source.MinFilter != minFilter;
+		}), sources.end());
+
+	GLint magFilter = GL_LINEAR;
+
+	glBindTexture(GL_TEXTURE_2D, _studioModel->Textures[sources.front().Index]->TextureId);
+	glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, &magFilter);
+
+	//Every layer has the size of the largest packed texture, so leave out the largest textures until the array fits in the budget
+	std::stable_sort(sources.begin(), sources.end(), [](const auto& lhs, const auto& rhs)
+		{
+			return (lhs.Width * lhs.Height) > (rhs.Width * rhs.Height);
+		});
+
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+	std::size_t first = 0;
+	GLint width = 0;
+	GLint height = 0;
+
+	for (; first < sources.size(); ++first)
+	{
+		const auto layerCount = sources.size() - first;
+
+		width = 0;
+		height = 0;
+
+		for (std::size_t i = first; i < sources.size(); ++i)
+		{
+			width = std::max(width, sources[i].Width);
+			height = std::max(height, sources[i].Height);
+		}
+
+		if (layerCount <= static_cast<std::size_t>(maxLayers)
+			&& layerCount * width * height * 4 <= MaxPackedTextureBytes)
+		{
+			break;
+		}
+	}
+
+	//Textures are scaled up by whole texels so they look the same as before.
+	//This is always possible with power of 2 textures, others may not be packed
+	sources.erase(std::remove_if(sources.begin() + first, sources.end(), [&](const auto& source)
+		{
+			return (width % source.Width) != 0 || (height % source.Height) != 0;
+		}), sources.end());
+
+	const auto layerCount = sources.size() - first;
+
+	//A single texture doesn't need packing
+	if (layerCount < 2)
+	{
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return;
+	}
+
+	glGenTextures(1, &packed.ArrayTexture);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, packed.ArrayTexture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA, width, height, static_cast<GLsizei>(layerCount), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minFilter);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magFilter);
+
+	std::vector<byte> pixels;
+	std::vector<byte> layerPixels(width * height * 4);
+
+	for (std::size_t i = first; i < sources.size(); ++i)
+	{
+		const auto& source = sources[i];
+		const int layer = static_cast<int>(i - first);
+
+		pixels.resize(source.Width * source.Height * 4);
+
+		glBindTexture(GL_TEXTURE_2D, _studioModel->Textures[source.Index]->TextureId);
+		glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		const byte* layerData = pixels.data();
+
+		//Smaller textures are scaled up to fill the layer so texture coordinates and wrapping stay the same
+		if (source.Width != width || source.Height != height)
+		{
+			const int xScale = width / source.Width;
+			const int yScale = height / source.Height;
+
+			const auto texel = [&](int x, int y)
+			{
+				//Textures repeat, so wrap around the edges
+				x = (x + source.Width) % source.Width;
+				y = (y + source.Height) % source.Height;
+
+				return &pixels[(y * source.Width + x) * 4];
+			};
+
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					byte* const pixel = &layerPixels[(y * width + x) * 4];
+
+					if (magFilter == GL_NEAREST)
+					{
+						const auto sample = texel(x / xScale, y / yScale);
+						std::copy(sample, sample + 4, pixel);
+						continue;
+					}
+
+					//Interpolate between texel centers the same way linear filtering of the original texture does
+					const float sourceX = (x + 0.5f) / xScale - 0.5f;
+					const float sourceY = (y + 0.5f) / yScale - 0.5f;
+
+					const int x0 = static_cast<int>(std::floor(sourceX));
+					const int y0 = static_cast<int>(std::floor(sourceY));
+
+					const float fractionX = sourceX - x0;
+					const float fractionY = sourceY - y0;
+
+					const auto topLeft = texel(x0, y0);
+					const auto topRight = texel(x0 + 1, y0);
+					const auto bottomLeft = texel(x0, y0 + 1);
+					const auto bottomRight = texel(x0 + 1, y0 + 1);
+
+					for (int p = 0; p < 4; ++p)
+					{
+						const float top = topLeft[p] + (topRight[p] - topLeft[p]) * fractionX;
+						const float bottom = bottomLeft[p] + (bottomRight[p] - bottomLeft[p]) * fractionX;
+
+						pixel[p] = static_cast<byte>(top + (bottom - top) * fractionY + 0.5f);
+					}
+				}
+			}
+
+			layerData = layerPixels.data();
+		}
+
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, layerData);
+
+		packed.Layers[source.Index] = layer;
+	}
+
+	if (minFilter != GL_NEAREST && minFilter != GL_LINEAR)
+	{
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void StudioModelRenderer::DestroyPackedTextures()
+{
+	for (auto& [studioModel, packed] : _packedTextures)
+	{
+		glDeleteTexture(packed.ArrayTexture);
+	}
+
+	_packedTextures.clear();
+	_currentPackedTextures = nullptr;
+}
+
+bool StudioModelRenderer::SetupSkinningProgram()
+{
+	if (_skinningProgram.IsValid())
+	{
+		return true;
+	}
+
+	if (_skinningProgramFailed)
+	{
+		return false;
+	}
+
+	//Prevent repeated attempts if anything goes wrong
+	_skinningProgramFailed = true;
+
+	//Vertex texture fetches of float textures are required, which are part of OpenGL 3.0
+	if (!GLEW_VERSION_3_0)
+	{
+		Error("StudioModelRenderer::SetupSkinningProgram: GPU skinning requires OpenGL 3.0\n");
+		return false;
+	}
+
+	GLint vertexTextureUnits = 0;
+	glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &vertexTextureUnits);
+
+	if (vertexTextureUnits < 1)
+	{
+		Error("StudioModelRenderer::SetupSkinningProgram: GPU skinning requires vertex texture fetch support\n");
+		return false;
+	}
+
+	const std::string version{"#version 130\n"};
+
+	std::string header;
+
+	const auto addDefine = [&](const char* name, int value)
+	{
+		header += "#define ";
+		header += name;
+		header += ' ';
+		header += std::to_string(value);
+		header += '\n';
+	};
+
+	addDefine("STUDIO_NF_FLATSHADE", STUDIO_NF_FLATSHADE);
+	addDefine("STUDIO_NF_CHROME", STUDIO_NF_CHROME);
+	addDefine("STUDIO_NF_FULLBRIGHT", STUDIO_NF_FULLBRIGHT);
+	addDefine("STUDIO_NF_ADDITIVE", STUDIO_NF_ADDITIVE);
+	addDefine("BONE_LIGHT_VECTOR", 3);
+	addDefine("BONE_CHROME_RIGHT", 4);
+	addDefine("BONE_CHROME_UP", 5);
+
+	//Instancing is optional, models are drawn one at a time without it
+	_supportsInstancing = GLEW_ARB_draw_instanced != 0;
+
+	std::string instancingHeader;
+
+	if (_supportsInstancing)
+	{
+		instancingHeader = "#extension GL_ARB_draw_instanced : require\n#define INSTANCING\n";
+		instancingHeader += "#define MAX_DRAW_INSTANCES " + std::to_string(MaxDrawInstances) + '\n';
+	}
+
+	const std::string vertexSource = version + instancingHeader + header + SkinningVertexShader;
+	const std::string fragmentSource = version + header + SkinningFragmentShader;
+
+	if (!_skinningProgram.Create("StudioModelSkinning", vertexSource.c_str(), fragmentSource.c_str(),
+		{
+			{"Position", SkinningAttributePosition},
+			{"Normal", SkinningAttributeNormal},
+			{"VertexBone", SkinningAttributeVertexBone},
+			{"NormalBone", SkinningAttributeNormalBone},
+			{"TexCoord", SkinningAttributeTexCoord},
+			{"MeshTexture", SkinningAttributeMeshTexture}
+		}))
+	{
+		Error("StudioModelRenderer::SetupSkinningProgram: Couldn't create the skinning program, skinning on the CPU instead\n");
+		return false;
+	}
+
+	_skinningUniforms.Ambient = _skinningProgram.GetUniformLocation("Ambient");
+	_skinningUniforms.Shade = _skinningProgram.GetUniformLocation("Shade");
+	_skinningUniforms.Lambert = _skinningProgram.GetUniformLocation("Lambert");
+	_skinningUniforms.LightColor = _skinningProgram.GetUniformLocation("LightColor");
+	_skinningUniforms.Transparency = _skinningProgram.GetUniformLocation("Transparency");
+	_skinningUniforms.UseSolidColor = _skinningProgram.GetUniformLocation("UseSolidColor");
+	_skinningUniforms.Texturing = _skinningProgram.GetUniformLocation("Texturing");
+	_skinningUniforms.UseTextureArray = _skinningProgram.GetUniformLocation("UseTextureArray");
+	_skinningUniforms.SolidColor = _skinningProgram.GetUniformLocation("SolidColor");
+	_skinningUniforms.UseInstanceTransforms = _skinningProgram.GetUniformLocation("UseInstanceTransforms");
+	_skinningUniforms.InstanceTransforms = _skinningProgram.GetUniformLocation("InstanceTransforms");
+
+	glUseProgram(_skinningProgram.GetProgram());
+	glUniform1i(_skinningProgram.GetUniformLocation("Texture"), 0);
+	glUniform1i(_skinningProgram.GetUniformLocation("BoneData"), 1);
+	glUniform1i(_skinningProgram.GetUniformLocation("TextureArray"), 2);
+	glUseProgram(0);
+
+	glGenTextures(1, &_boneDataTexture);
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, _boneDataTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, BoneDataTexelsPerBone, MAXSTUDIOBONES, 0, GL_RGBA, GL_FLOAT, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	//Force an upload for the current model
+	_boneDataPoseGeneration = 0;
+
+	_skinningProgramFailed = false;
+
+	return true;
+}
+
+void StudioModelRenderer::DestroySkinningProgram()
+{
+	_skinningProgram.Destroy();
+	glDeleteTexture(_boneDataTexture);
+	_skinningProgramFailed = false;
+}
+
+void StudioModelRenderer::SetupSkinningBuffer(ModelBufferData& buffers)
+{
+	SetupMeshTextureBuffer(buffers);
+
+	if (buffers.HasSkinningData && buffers.SkinningGeometryRevision == _studioModel->GeometryRevision)
+	{
+		return;
+	}
+
+	std::vector<SkinningVertex> vertices(buffers.Commands.size());
+
+	for (std::size_t k = 0; k < vertices.size(); ++k)
+	{
+		const auto& command = buffers.Commands[k];
+		const auto& vertex = _model->Vertices[command[0]];
+		const auto& normal = _model->Normals[command[1]];
+
+		vertices[k] = SkinningVertex{
+			vertex.Vertex,
+			normal.Vertex,
+			static_cast<float>(vertex.Bone->ArrayIndex),
+			static_cast<float>(normal.Bone->ArrayIndex)
+		};
+	}
+
+	if (!buffers.SkinningBuffer)
+	{
+		glGenBuffers(1, &buffers.SkinningBuffer);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.SkinningBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(SkinningVertex), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	buffers.HasSkinningData = true;
+	buffers.SkinningGeometryRevision = _studioModel->GeometryRevision;
+}
+
+void StudioModelRenderer::SetupMeshTextureBuffer(ModelBufferData& buffers)
+{
+	bool isValid = buffers.MeshTextureBuffer != 0;
+
+	for (int j = 0; j < _model->Meshes.size(); j++)
+	{
+		const auto& texture = *_studioModel->SkinFamilies[_renderInfo->Skin][_model->Meshes[j].SkinRef];
+		auto& range = buffers.Meshes[j];
+
+		const int layer = _currentPackedTextures ? _currentPackedTextures->Layers[texture.ArrayIndex] : -1;
+
+		if (range.TextureLayer != layer || range.TextureFlags != texture.Flags)
+		{
+			range.TextureLayer = layer;
+			range.TextureFlags = texture.Flags;
+			isValid = false;
+		}
+	}
+
+	if (isValid)
+	{
+		return;
+	}
+
+	std::vector<MeshTextureVertex> vertices(buffers.Commands.size());
+
+	for (const auto& range : buffers.Meshes)
+	{
+		const MeshTextureVertex vertex{static_cast<float>(range.TextureLayer), static_cast<float>(range.TextureFlags)};
+
+		std::fill_n(vertices.begin() + range.FirstVertex, range.VertexCount, vertex);
+	}
+
+	if (!buffers.MeshTextureBuffer)
+	{
+		glGenBuffers(1, &buffers.MeshTextureBuffer);
+	}
 
-	lv *= _lightcolor;
+	glBindBuffer(GL_ARRAY_BUFFER, buffers.MeshTextureBuffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(MeshTextureVertex), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void StudioModelRenderer::UploadBoneData()
+{
+	if (_boneDataPoseGeneration == _poseGeneration
+		&& _boneDataViewerOrigin == _viewerOrigin
+		&& _boneDataViewerRight == _viewerRight)
+	{
+		return;
+	}
+
+	_boneDataPoseGeneration = _poseGeneration;
+	_boneDataViewerOrigin = _viewerOrigin;
+	_boneDataViewerRight = _viewerRight;
+
+	SetupChromeVectors();
+
+	const int boneCount = static_cast<int>(_studioModel->Bones.size());
+
+	for (int i = 0; i < boneCount; ++i)
+	{
+		auto data = &_boneData[i * BoneDataTexelsPerBone];
+
+		data[0] = _bonetransform[i][0];
+		data[1] = _bonetransform[i][1];
+		data[2] = _bonetransform[i][2];
+		data[3] = glm::vec4{_blightvec[i], 0};
+		data[4] = glm::vec4{_chromeright[i], 0};
+		data[5] = glm::vec4{_chromeup[i], 0};
+	}
+
+	if (boneCount > 0)
+	{
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, _boneDataTexture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, BoneDataTexelsPerBone, boneCount, GL_RGBA, GL_FLOAT, _boneData.data());
+		glActiveTexture(GL_TEXTURE0);
+	}
+}
+
+void StudioModelRenderer::BeginGPUSkinning(const bool useSolidColor, const glm::vec4& solidColor)
+{
+	_drawCommands.UseProgram(_skinningProgram.GetProgram());
+
+	_drawCommands.Uniform(_skinningUniforms.Ambient, std::max(0.1f, (float)_ambientlight / 255.0f));
+	_drawCommands.Uniform(_skinningUniforms.Shade, _shadelight / 255.0f);
+	_drawCommands.Uniform(_skinningUniforms.Lambert, std::max(1.0f, _lambert));
+	_drawCommands.Uniform(_skinningUniforms.LightColor, _lightcolor);
+	_drawCommands.Uniform(_skinningUniforms.Transparency, _renderInfo->Transparency);
+	_drawCommands.Uniform(_skinningUniforms.UseSolidColor, useSolidColor ? 1 : 0);
+	//Render modes without textures disable texturing instead of changing how the model is drawn
+	_drawCommands.Uniform(_skinningUniforms.Texturing, _drawCommands.IsTexturingEnabled() ? 1 : 0);
+	_drawCommands.Uniform(_skinningUniforms.UseTextureArray, 0);
+	_drawCommands.Uniform(_skinningUniforms.SolidColor, solidColor);
+
+	if (_supportsInstancing)
+	{
+		_drawCommands.Uniform(_skinningUniforms.UseInstanceTransforms, _drawInstanceCount > 0 ? 1 : 0);
+
+		if (_drawInstanceCount > 0)
+		{
+			_drawCommands.Uniform(_skinningUniforms.InstanceTransforms, &_instanceTransforms[_firstDrawInstance], _drawInstanceCount);
+		}
+	}
+
+	_drawCommands.ActiveTexture(GL_TEXTURE1);
+	_drawCommands.BindTexture(_boneDataTexture);
+	_drawCommands.ActiveTexture(GL_TEXTURE0);
+
+	_drawCommands.EnableVertexAttribArray(SkinningAttributePosition);
+	_drawCommands.EnableVertexAttribArray(SkinningAttributeNormal);
+	_drawCommands.EnableVertexAttribArray(SkinningAttributeVertexBone);
+	_drawCommands.EnableVertexAttribArray(SkinningAttributeNormalBone);
+	_drawCommands.EnableVertexAttribArray(SkinningAttributeTexCoord);
+	_drawCommands.EnableVertexAttribArray(SkinningAttributeMeshTexture);
+}
+
+void StudioModelRenderer::BindSkinningBuffers(const ModelBufferData& buffers)
+{
+	_drawCommands.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.IndexBuffer);
+
+	_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers.SkinningBuffer);
+
+	_drawCommands.VertexAttribPointer(SkinningAttributePosition, 3, sizeof(SkinningVertex), offsetof(SkinningVertex, Position));
+	_drawCommands.VertexAttribPointer(SkinningAttributeNormal, 3, sizeof(SkinningVertex), offsetof(SkinningVertex, Normal));
+	_drawCommands.VertexAttribPointer(SkinningAttributeVertexBone, 1, sizeof(SkinningVertex), offsetof(SkinningVertex, VertexBone));
+	_drawCommands.VertexAttribPointer(SkinningAttributeNormalBone, 1, sizeof(SkinningVertex), offsetof(SkinningVertex, NormalBone));
+
+	_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers.TexCoordBuffer);
+	_drawCommands.VertexAttribPointer(SkinningAttributeTexCoord, 2, 0, 0);
+
+	_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers.MeshTextureBuffer);
+	_drawCommands.VertexAttribPointer(SkinningAttributeMeshTexture, 2, 0, 0);
+}
+
+void StudioModelRenderer::EndGPUSkinning()
+{
+	_drawCommands.DisableVertexAttribArray(SkinningAttributeMeshTexture);
+	_drawCommands.DisableVertexAttribArray(SkinningAttributeTexCoord);
+	_drawCommands.DisableVertexAttribArray(SkinningAttributeNormalBone);
+	_drawCommands.DisableVertexAttribArray(SkinningAttributeVertexBone);
+	_drawCommands.DisableVertexAttribArray(SkinningAttributeNormal);
+	_drawCommands.DisableVertexAttribArray(SkinningAttributePosition);
+
+	_drawCommands.BindBuffer(GL_ARRAY_BUFFER, 0);
+	_drawCommands.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	_drawCommands.UseProgram(0);
+}
+
+unsigned int StudioModelRenderer::DrawShadows(const bool fixZFighting, const bool wireframe)
+{
+	if (!(_studioModel->Flags & EF_NOSHADELIGHT))
+	{
+		//Restores the depth mask and texturing afterwards
+		_drawCommands.PushAttrib(GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT);
+
+		if (fixZFighting)
+		{
+			_drawCommands.DepthMask(false);
+		}
+		else
+		{
+			_drawCommands.DepthMask(true);
+		}
+
+		const float r_blend = _renderInfo->Transparency;
+
+		const auto alpha = 0.5 * r_blend;
+
+		_drawCommands.Disable(GL_TEXTURE_2D);
+		_drawCommands.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		_drawCommands.Enable(GL_BLEND);
+
+		//Render shadows as black
+		const auto color = wireframe ? glm::vec4{_wireframeColor, _renderInfo->Transparency} : glm::vec4{0.f, 0.f, 0.f, alpha};
+
+		_drawCommands.Color(color);
+
+		_drawCommands.DepthFunc(GL_LESS);
+
+		//The same vertices are drawn as for the model itself, with the projection done by the modelview matrix
+		_drawCommands.PushMatrix();
+		_drawCommands.MultMatrix(GetShadowProjection());
+
+		const auto drawnPolys = InternalDrawShadows(color);
+
+		_drawCommands.PopMatrix();
+
+		_drawCommands.PopAttrib();
+
+		_drawCommands.DepthFunc(GL_LEQUAL);
+		_drawCommands.Disable(GL_BLEND);
+		_drawCommands.Color(glm::vec4{1.f, 1.f, 1.f, 1.f});
+
+		return drawnPolys;
+	}
+	else
+	{
+		return 0;
+	}
+}
+
+unsigned int StudioModelRenderer::InternalDrawShadows(const glm::vec4& color)
+{
+	unsigned int drawnPolys = 0;
+
+	const bool gpuSkinning = _useGPUSkinning && SetupSkinningProgram();
+	const bool useBuffers = gpuSkinning || _useVertexBuffers;
+
+	if (gpuSkinning)
+	{
+		//The current color isn't used by the shader
+		BeginGPUSkinning(true, color);
+		_drawCommands.Uniform(_skinningUniforms.Texturing, 0);
+	}
+	else if (useBuffers)
+	{
+		_drawCommands.EnableClientState(GL_VERTEX_ARRAY);
+	}
+
+	//Vertex data was set up for every submodel when the meshes were queued
+	for (int i = 0; i < _studioModel->Bodyparts.size(); i++)
+	{
+		SetupModel(i);
+
+		for (const auto& mesh : _model->Meshes)
+		{
+			drawnPolys += mesh.NumTriangles;
+		}
+
+		const ModelBufferData* buffers = useBuffers ? &_modelBuffers.find(_model)->second : nullptr;
+
+		//Submodels whose skinned vertices could not be uploaded are drawn in immediate mode
+		if (buffers && (gpuSkinning || !buffers->StreamBufferDirty))
+		{
+			//Every mesh is drawn the same way, so the whole submodel is drawn at once
+			if (gpuSkinning)
+			{
+				BindSkinningBuffers(*buffers);
+			}
+			else
+			{
+				_drawCommands.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->IndexBuffer);
+				_drawCommands.BindBuffer(GL_ARRAY_BUFFER, buffers->StreamBuffer);
+				_drawCommands.ArrayPointer(GL_VERTEX_ARRAY, 3, 0);
+			}
+
+			_drawCommands.DrawElements(GL_TRIANGLES, buffers->IndexCount, 0);
+			continue;
+		}
+
+		const auto& skinnedModel = _skinnedModels.find(_model)->second;
+
+		for (const auto& mesh : _model->Meshes)
+		{
+			auto triCmds = mesh.Triangles.data();
 
-void StudioModelRenderer::Chrome(glm::vec2& chrome, int bone, const glm::vec3& normal)
+			for (int i; (i = *triCmds++) != 0;)
+			{
+				if (i < 0)
+				{
+					i = -i;
+					_drawCommands.Begin(GL_TRIANGLE_FAN);
+				}
+				else
+				{
+					_drawCommands.Begin(GL_TRIANGLE_STRIP);
+				}
+
+				for (; i > 0; --i, triCmds += 4)
+				{
+					_drawCommands.Vertex(skinnedModel.Vertices[triCmds[0]]);
+				}
+
+				_drawCommands.End();
+			}
+		}
+	}
+
+	if (gpuSkinning)
+	{
+		EndGPUSkinning();
+	}
+	else if (useBuffers)
+	{
+		_drawCommands.DisableClientState(GL_VERTEX_ARRAY);
+		_drawCommands.BindBuffer(GL_ARRAY_BUFFER, 0);
+		_drawCommands.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	return drawnPolys;
+}
+
+void StudioModelRenderer::SetupChromeVectors()
 {
-	if (_chromeage[bone] != _modelsDrawnCount)
+	if (_chromePoseGeneration == _poseGeneration
+		&& _chromeViewerOrigin == _viewerOrigin
+		&& _chromeViewerRight == _viewerRight)
+	{
+		return;
+	}
+
+	_chromePoseGeneration = _poseGeneration;
+	_chromeViewerOrigin = _viewerOrigin;
+	_chromeViewerRight = _viewerRight;
+
+	for (int bone = 0; bone < _studioModel->Bones.size(); ++bone)
 	{
 		// calculate vectors from the viewer to the bone. This roughly adjusts for position
 		// vector pointing at bone in world reference frame
@@ -899,16 +2834,6 @@ void StudioModelRenderer::Chrome(glm::vec2& chrome, int bone, const glm::vec3& n
 
 		VectorIRotate(-chromeupvec, _bonetransform[bone], _chromeup[bone]);
 		VectorIRotate(chromerightvec, _bonetransform[bone], _chromeright[bone]);
-
-		_chromeage[bone] = _modelsDrawnCount;
 	}
-
-	// calc s coord
-	auto n = glm::dot(normal, _chromeright[bone]);
-	chrome[0] = (n + 1.0) * 0.5;
-
-	// calc t coord
-	n = glm::dot(normal, _chromeup[bone]);
-	chrome[1] = (n + 1.0) * 0.5;
 }
-}
\ No newline at end of file
+}
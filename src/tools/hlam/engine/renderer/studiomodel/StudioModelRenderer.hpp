@@ -1,18 +1,34 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include <GL/glew.h>
+
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
 #include <glm/mat3x4.hpp>
 
+#include "engine/renderer/studiomodel/StudioSkinning.hpp"
 #include "engine/renderer/studiomodel/StudioSorting.hpp"
 #include "engine/shared/renderer/studiomodel/IStudioModelRenderer.hpp"
 #include "engine/shared/studiomodel/BoneTransformer.hpp"
 #include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
 
+#include "graphics/DebugDrawBatch.hpp"
+#include "graphics/DrawCommandList.hpp"
+#include "graphics/Frustum.hpp"
+#include "graphics/OpenGLDrawCommandBackend.hpp"
+#include "graphics/ShaderProgram.hpp"
+
+class WorkerPool;
+
 namespace studiomdl
 {
 struct Animation;
@@ -22,8 +38,201 @@ struct Sequence;
 
 class StudioModelRenderer final : public studiomdl::IStudioModelRenderer
 {
+private:
+	/**
+	*	@brief Inputs of the last bone setup. Every pass that draws the same pose in a frame reuses its result
+	*/
+	struct BoneSetupState
+	{
+		const EditableStudioModel* StudioModel = nullptr;
+		int Sequence = 0;
+		float Frame = 0;
+		glm::vec3 Scale{0};
+		std::array<byte, SequenceBlendCount> Blender{};
+		std::array<byte, ControllerCount> Controller{};
+		byte Mouth = 0;
+	};
+
+	/**
+	*	@brief Inputs that affect the transformed and lit vertices of a model
+	*/
+	struct PoseState
+	{
+		const EditableStudioModel* StudioModel = nullptr;
+		unsigned int GeometryRevision = 0;
+		std::size_t BoneCount = 0;
+		std::array<glm::mat3x4, MAXSTUDIOBONES> BoneTransforms;
+		glm::vec3 LightVector{0};
+		glm::vec3 LightColor{0};
+		float Lambert = 0;
+		int AmbientLight = 0;
+		float ShadeLight = 0;
+	};
+
+	/**
+	*	@brief Transformed vertices, light values and chrome coordinates for a submodel, reused while the pose is unchanged
+	*/
+	struct SkinnedModelData
+	{
+		//Frame in which the submodel was last drawn
+		unsigned int LastUsedFrame = 0;
+
+		//0 if never calculated
+		unsigned int PoseGeneration = 0;
+
+		std::vector<int> MeshFlags;
+
+		bool HasChrome = false;
+		glm::vec3 ViewerOrigin{0};
+		glm::vec3 ViewerRight{0};
+
+		std::vector<glm::vec3> Vertices;
+		std::vector<glm::vec3> LightValues;
+		std::vector<glm::vec2> Chrome;
+
+		//Rotated normals are only needed to draw the normals themselves, so they are calculated on demand
+		unsigned int NormalsPoseGeneration = 0;
+		std::vector<glm::vec3> Normals;
+	};
+
+	/**
+	*	@brief Range of a mesh in the index buffer of a submodel
+	*/
+	struct MeshBufferRange
+	{
+		std::size_t FirstVertex = 0;
+		std::size_t VertexCount = 0;
+
+		std::size_t IndexOffset = 0;
+		GLsizei IndexCount = 0;
+		unsigned int PolygonCount = 0;
+
+		//Dimensions of the texture that the texture coordinates were calculated for
+		int TextureWidth = 0;
+		int TextureHeight = 0;
+
+		//Array texture layer and flags of the texture that the mesh texture data was created for
+		int TextureLayer = -1;
+		int TextureFlags = -1;
+	};
+
+	/**
+	*	@brief Vertex data used to skin a submodel on the GPU
+	*/
+	struct SkinningVertex
+	{
+		glm::vec3 Position;
+		glm::vec3 Normal;
+		float VertexBone;
+		float NormalBone;
+	};
+
+	/**
+	*	@brief Per vertex texture data used to skin a submodel on the GPU.
+	*	Stored per vertex so meshes with different textures can be drawn in a single call
+	*/
+	struct MeshTextureVertex
+	{
+		//Array texture layer, or -1 if the texture is bound by itself
+		float Layer;
+		float Flags;
+	};
+
+	/**
+	*	@brief Static buffers used to draw a submodel in retained mode
+	*	Triangle strips and fans are unrolled so every triangle command vertex has its own buffer vertex
+	*/
+	struct ModelBufferData
+	{
+		const EditableStudioModel* StudioModel = nullptr;
+
+		//Revision of the model the buffers were created from
+		unsigned int Revision = 0;
+
+		//Frame in which the submodel was last drawn
+		unsigned int LastUsedFrame = 0;
+
+		GLuint TexCoordBuffer = 0;
+		GLuint IndexBuffer = 0;
+
+		//Skinned vertex data streamed in every draw, created on demand
+		GLuint StreamBuffer = 0;
+
+		//Set if the stream buffer's contents were lost. The submodel is drawn in immediate mode until it is uploaded successfully
+		bool StreamBufferDirty = false;
+
+		//Offsets of the arrays in the stream buffer
+		std::size_t StreamColorsOffset = 0;
+		std::size_t StreamChromeOffset = 0;
+
+		//Untransformed vertices for GPU skinning, created on demand
+		GLuint SkinningBuffer = 0;
+		bool HasSkinningData = false;
+		unsigned int SkinningGeometryRevision = 0;
+
+		//Texture layers and flags for GPU skinning, created on demand. Depends on the skin
+		GLuint MeshTextureBuffer = 0;
+
+		std::vector<MeshBufferRange> Meshes;
+
+		//Indices of all meshes, which are stored contiguously
+		GLsizei IndexCount = 0;
+
+		//Per buffer vertex: vertex index, normal index and texture coordinates in texels, as stored in the triangle commands
+		std::vector<std::array<short, 4>> Commands;
+	};
+
+	/**
+	*	@brief Bounding spheres of the vertices of a submodel, one around each bone they are attached to
+	*/
+	struct SubmodelBounds
+	{
+		const EditableStudioModel* StudioModel = nullptr;
+		unsigned int GeometryRevision = 0;
+
+		//Frame in which the submodel was last drawn
+		unsigned int LastUsedFrame = 0;
+
+		//Bone index and distance of the furthest vertex from the bone origin, in bone space
+		std::vector<std::pair<int, float>> BoneRadii;
+	};
+
+	/**
+	*	@brief Skin textures of a model copied into the layers of an array texture,
+	*	so meshes using different textures can be drawn without switching textures
+	*/
+	struct PackedTextureData
+	{
+		unsigned int TextureRevision = 0;
+
+		//Frame in which the model was last drawn
+		unsigned int LastUsedFrame = 0;
+
+		//Textures the layers were copied from
+		std::vector<GLuint> SourceTextures;
+
+		GLuint ArrayTexture = 0;
+
+		//Layer of each texture, or -1 if the texture was not packed
+		std::vector<int> Layers;
+	};
+
+	/**
+	*	@brief Render state last set while drawing queued meshes. Unknown states are always set
+	*/
+	struct RenderStateCache
+	{
+		std::optional<GLuint> TextureId;
+		std::optional<RenderBlendMode> BlendMode;
+		std::optional<bool> DepthMask;
+		std::optional<bool> AlphaTest;
+	};
+
 public:
-	StudioModelRenderer();
+	/**
+	*	@param workerPool Threads used to skin large submodels. Must outlive the renderer
+	*/
+	explicit StudioModelRenderer(WorkerPool* workerPool);
 	~StudioModelRenderer();
 
 	StudioModelRenderer(const StudioModelRenderer&) = delete;
@@ -39,6 +248,8 @@ public:
 
 	unsigned int GetDrawnPolygonsCount() const override final { return _drawnPolygonsCount; }
 
+	const RenderStateCounters& GetRenderStateCounters() const override final { return _renderStateCounters; }
+
 	float GetLambert() const override final { return _lambert; }
 
 	const glm::vec3& GetViewerOrigin() const override final { return _viewerOrigin; }
@@ -76,8 +287,48 @@ public:
 		_wireframeColor = color;
 	}
 
+	bool ShouldUseVertexBuffers() const override final { return _useVertexBuffers; }
+
+	void SetUseVertexBuffers(bool value) override final
+	{
+		_useVertexBuffers = value;
+	}
+
+	bool ShouldUseGPUSkinning() const override final { return _useGPUSkinning; }
+
+	void SetUseGPUSkinning(bool value) override final
+	{
+		_useGPUSkinning = value;
+	}
+
+	bool IsGPUSkinningSupported() override final { return SetupSkinningProgram(); }
+
+	bool ShouldUseTextureArrays() const override final { return _useTextureArrays; }
+
+	void SetUseTextureArrays(bool value) override final
+	{
+		_useTextureArrays = value;
+	}
+
+	void SetDrawCommandBackend(graphics::IDrawCommandBackend* backend) override final
+	{
+		_drawCommandBackend = backend ? backend : &_openGLBackend;
+	}
+
+	void SetFrameProfiler(graphics::FrameProfiler* profiler) override final
+	{
+		_frameProfiler = profiler;
+	}
+
+	void SetCullingViewProjection(const std::optional<glm::mat4>& viewProjection) override final
+	{
+		_cullingViewProjection = viewProjection;
+	}
+
 	unsigned int DrawModel(ModelRenderInfo* const renderInfo, const renderer::DrawFlags flags) override final;
 
+	unsigned int DrawModelInstances(ModelRenderInfo* const renderInfos, const std::size_t count, const renderer::DrawFlags flags) override final;
+
 	void DrawSingleBone(ModelRenderInfo& renderInfo, const int iBone) override final;
 
 	void DrawSingleAttachment(ModelRenderInfo& renderInfo, const int iAttachment) override final;
@@ -85,8 +336,45 @@ public:
 	void DrawSingleHitbox(ModelRenderInfo& renderInfo, const int hitboxIndex) override final;
 
 private:
+	/**
+	*	@brief Draws instances that share the same pose. Instances are culled individually
+	*/
+	unsigned int DrawInstancesWithSamePose(ModelRenderInfo* const renderInfos, const std::size_t count, const renderer::DrawFlags flags);
+
+	/**
+	*	@brief Queues all meshes once and draws them for each visible instance
+	*	@return Number of polygons that were drawn
+	*/
+	unsigned int QueueAndDrawInstances(const bool bWireframe);
+
+	/**
+	*	@brief Enables or disables texturing for the model's meshes depending on the NO_TEXTURES flag
+	*/
+	void SetupTexturing(const renderer::DrawFlags flags);
+
+	/**
+	*	@brief Matrix that SetupPosition applies
+	*/
+	static glm::mat4 GetModelMatrix(const glm::vec3& origin, const glm::vec3& angles);
+
 	void SetupPosition(const glm::vec3& origin, const glm::vec3& angles);
 
+	/**
+	*	@brief Whether the model and its shadow are outside the culling frustum, based on the bounds of the current sequence.
+	*	Models drawn with overlays are never culled since these can extend past the bounds.
+	*/
+	bool IsModelOutsideView(const renderer::DrawFlags flags) const;
+
+	/**
+	*	@brief Whether all vertices of the current submodel are outside the culling frustum. Bones must be set up
+	*/
+	bool IsSubmodelOutsideView();
+
+	/**
+	*	@brief Matrix that flattens the model onto the plane its shadow is drawn on
+	*/
+	glm::mat4 GetShadowProjection() const;
+
 	void DrawBones();
 
 	void DrawAttachments();
@@ -97,7 +385,11 @@ private:
 
 	void DrawNormals();
 
-	void SetUpBones();
+	/**
+	*	@brief Sets up the bones for the current render info, unless the same pose was already set up this frame
+	*	@return Whether the bone transforms were recalculated
+	*/
+	bool SetUpBones();
 
 	/**
 	*	@brief set some global variables based on entity position
@@ -109,21 +401,137 @@ private:
 	*/
 	void SetupModel(int bodypart);
 
-	unsigned int DrawPoints(const bool bWireframe);
+	/**
+	*	@brief Increments the pose generation if any input that affects skinning has changed since the last draw
+	*	@param bonesChanged Whether the bone transforms may differ from the last draw
+	*/
+	void UpdatePoseGeneration(const bool bonesChanged);
+
+	/**
+	*	@brief Transforms and lights the vertices of the current submodel, or reuses the results of a previous draw if nothing has changed
+	*/
+	void SetupSkinnedModel();
+
+	/**
+	*	@brief Rotates the normals of the current submodel if they haven't been rotated for the current pose yet
+	*	@pre SetupSkinnedModel has been called for the current submodel
+	*/
+	void SetupSkinnedNormals(SkinnedModelData& data);
+
+	LightingParameters GetLightingParameters() const;
+
+	/**
+	*	@brief Queues and draws all meshes, reporting the skinning and submission times separately
+	*	@return Number of polygons that were drawn
+	*/
+	unsigned int QueueAndDrawRenderItems(const bool bWireframe);
+
+	/**
+	*	@brief Sets up the vertex data of all submodels and queues their meshes, sorted by render state
+	*/
+	void QueueRenderItems(const bool bWireframe);
+
+	unsigned int DrawRenderItems(const bool bWireframe);
+
+	/**
+	*	@brief Releases skinned data, buffers and bounds of submodels that haven't been drawn recently
+	*/
+	void ReleaseUnusedModelData();
+
+	/**
+	*	@brief Makes the submodel of the given body part current and binds its buffers if it is drawn using buffers
+	*	@return Whether the buffers were bound. If not, the submodel has to be drawn in immediate mode
+	*/
+	bool BindRenderItemModel(int bodypart, const bool useBuffers, const bool gpuSkinning, const bool bWireframe);
+
+	void SetTexture(GLuint textureId);
+
+	void SetBlendMode(RenderBlendMode blendMode);
+
+	void SetDepthMask(bool enable);
+
+	void SetAlphaTest(bool enable);
+
+	/**
+	*	@brief Executes and clears the recorded draw commands
+	*/
+	void FlushDrawCommands();
+
+	/**
+	*	@brief Creates or updates the static buffers for the current submodel
+	*/
+	ModelBufferData& SetupModelBuffers();
+
+	/**
+	*	@brief Streams the skinned vertex data of the current submodel into its stream buffer.
+	*	Marks the buffer as dirty if the data could not be uploaded
+	*/
+	void UploadStreamedVertices(ModelBufferData& buffers, const bool bWireframe);
+
+	/**
+	*	@brief Writes the skinned vertex data of the current submodel into mapped stream buffer memory
+	*/
+	void WriteStreamedVertices(const ModelBufferData& buffers, std::byte* data, const bool hasColors, const bool hasChrome);
+
+	static void DeleteModelBuffers(ModelBufferData& buffers);
+
+	void DestroyModelBuffers();
+
+	/**
+	*	@brief Creates the skinning shader and bone data texture if needed
+	*	@return Whether the GPU skinning path can be used
+	*/
+	bool SetupSkinningProgram();
+
+	void DestroySkinningProgram();
+
+	/**
+	*	@brief Creates or updates the untransformed vertex buffer for the current submodel
+	*/
+	void SetupSkinningBuffer(ModelBufferData& buffers);
+
+	/**
+	*	@brief Creates or updates the per vertex texture layers and flags for the current submodel and skin
+	*/
+	void SetupMeshTextureBuffer(ModelBufferData& buffers);
+
+	/**
+	*	@brief Packs the textures of the current model into an array texture if they changed since they were last packed
+	*	@return The packed textures, or null if too few textures could be packed to be worth using
+	*/
+	const PackedTextureData* SetupPackedTextures();
+
+	void PackTextures(PackedTextureData& packed);
+
+	void DestroyPackedTextures();
+
+	/**
+	*	@brief Uploads the bone transforms and per bone light and chrome vectors of the current model, once per model drawn
+	*/
+	void UploadBoneData();
 
-	unsigned int DrawMeshes(const bool bWireframe, const SortedMesh* pMeshes);
+	/**
+	*	@brief Sets up the skinning program. If @p useSolidColor is true, vertices are colored @p solidColor instead of being lit
+	*/
+	void BeginGPUSkinning(const bool useSolidColor, const glm::vec4& solidColor);
+
+	void BindSkinningBuffers(const ModelBufferData& buffers);
+
+	void EndGPUSkinning();
 
+	/**
+	*	@brief Draws the shadows of all submodels by projecting the vertices set up by QueueRenderItems onto the ground
+	*/
 	unsigned int DrawShadows(const bool fixZFighting, const bool wireframe);
 
-	unsigned int InternalDrawShadows();
+	unsigned int InternalDrawShadows(const glm::vec4& color);
 
-	void Lighting(glm::vec3& lv, int bone, int flags, const glm::vec3& normal);
-	void Chrome(glm::vec2& chrome, int bone, const glm::vec3& normal);
+	/**
+	*	@brief Calculates the chrome vectors of all bones if the pose or viewer changed since they were last calculated
+	*/
+	void SetupChromeVectors();
 
 private:
-	//TODO: need to validate model on load to ensure it does not exceed this limit
-	static constexpr int MaxVertices = 0xFFFF;
-
 	/**
 	*	Total number of models drawn by this renderer since the last time it was initialized.
 	*/
@@ -140,9 +548,49 @@ private:
 	*/
 	unsigned int _drawnPolygonsCount = 0;
 
-	glm::vec3		_xformverts[MaxVertices];		// transformed vertices
-	glm::vec3		_xformnorms[MaxVertices];
-	glm::vec3		_lightvalues[MaxVertices];	// light surface normals
+	RenderStateCounters _renderStateCounters;
+
+	std::vector<RenderItem> _renderItems;
+
+	RenderStateCache _renderState;
+
+	//All drawing is recorded here and executed by the backend at the end of each pass
+	graphics::DrawCommandList _drawCommands;
+
+	graphics::OpenGLDrawCommandBackend _openGLBackend;
+	graphics::IDrawCommandBackend* _drawCommandBackend = &_openGLBackend;
+
+	graphics::FrameProfiler* _frameProfiler = nullptr;
+
+	//Debug overlays are collected here and flushed into the command list once per overlay
+	graphics::DebugDrawBatch _debugDraw;
+
+	BoneSetupState _boneSetup;
+
+	PoseState _poseState;
+	unsigned int _poseGeneration = 1;
+
+	//Incremented by RunFrame
+	unsigned int _frameNumber = 0;
+
+	//Skinned data, buffers and bounds of submodels that haven't been drawn for this many frames are released,
+	//so memory use follows the submodels being drawn rather than every submodel drawn since the model was opened
+	static constexpr unsigned int UnusedModelDataFrames = 300;
+
+	//Number of times streamed vertices are written before giving up if the buffer's contents are lost while it is mapped
+	static constexpr int MaxStreamUploadAttempts = 2;
+
+	std::unordered_map<const Model*, SkinnedModelData> _skinnedModels;
+
+	//Skinned data for _model, valid after SetupSkinnedModel
+	const SkinnedModelData* _skinnedModel{};
+
+	//Number of vertices and normals per skinning batch. Smaller submodels are skinned on the calling thread only
+	static constexpr std::size_t SkinningBatchSize = 2048;
+
+	std::vector<SkinningMesh> _skinningMeshes;
+
+	WorkerPool* const _workerPool;
 
 	BoneTransformer _boneTransformer;
 
@@ -155,15 +603,89 @@ private:
 	glm::vec3		_lightcolor{255, 255, 255};
 	glm::vec3		_blightvec[MAXSTUDIOBONES];		// light vectors in bone reference frames
 
-	glm::vec2		_chrome[MaxVertices];			// texture coords for surface normals
-	unsigned int	_chromeage[MAXSTUDIOBONES];		// last time chrome vectors were updated
 	glm::vec3		_chromeup[MAXSTUDIOBONES];		// chrome vector "up" in bone reference frames
 	glm::vec3		_chromeright[MAXSTUDIOBONES];	// chrome vector "right" in bone reference frames
 
+	//Pose and viewer that the chrome vectors were last calculated for
+	unsigned int	_chromePoseGeneration = 0;
+	glm::vec3		_chromeViewerOrigin{0};
+	glm::vec3		_chromeViewerRight{0};
+
 	glm::vec3		_viewerOrigin;
 	glm::vec3		_viewerRight = {50, 50, 0};	// needs to be set to viewer's right in order for chrome to work
 	float			_lambert = 1.5f;					// modifier for pseudo-hemispherical lighting
 
 	glm::vec3 _wireframeColor{255, 0, 0};
+
+	bool _useVertexBuffers = false;
+
+	std::unordered_map<const Model*, ModelBufferData> _modelBuffers;
+
+	std::optional<glm::mat4> _cullingViewProjection;
+
+	//Frustum of the model being drawn, in model space
+	graphics::Frustum _cullingFrustum;
+
+	//Submodels are only culled if nothing else needs their skinned data
+	bool _cullSubmodels = false;
+
+	std::unordered_map<const Model*, SubmodelBounds> _submodelBounds;
+
+	//Number of texels used by each bone in the bone data texture: transform rows, light vector, chrome right and up vectors
+	static constexpr int BoneDataTexelsPerBone = 6;
+
+	bool _useGPUSkinning = false;
+
+	//Set if the skinning shader could not be created so it isn't retried every frame
+	bool _skinningProgramFailed = false;
+
+	graphics::ShaderProgram _skinningProgram;
+
+	struct
+	{
+		GLint Ambient = -1;
+		GLint Shade = -1;
+		GLint Lambert = -1;
+		GLint LightColor = -1;
+		GLint Transparency = -1;
+		GLint UseSolidColor = -1;
+		GLint Texturing = -1;
+		GLint UseTextureArray = -1;
+		GLint SolidColor = -1;
+		GLint UseInstanceTransforms = -1;
+		GLint InstanceTransforms = -1;
+	} _skinningUniforms;
+
+	//Number of instance transforms the skinning shader can use in a single draw
+	static constexpr int MaxDrawInstances = 32;
+
+	//Set if the skinning shader was created with instancing support
+	bool _supportsInstancing = false;
+
+	//Transforms of the visible instances being drawn by DrawModelInstances
+	std::vector<glm::mat4> _instanceTransforms;
+
+	//Range of _instanceTransforms drawn by each draw call. Empty if instancing isn't used
+	std::size_t _firstDrawInstance = 0;
+	std::size_t _drawInstanceCount = 0;
+
+	GLuint _boneDataTexture = 0;
+
+	//Pose and viewer that the bone data was last uploaded for. Chrome vectors depend on the viewer
+	unsigned int _boneDataPoseGeneration = 0;
+	glm::vec3 _boneDataViewerOrigin{0};
+	glm::vec3 _boneDataViewerRight{0};
+
+	std::array<glm::vec4, MAXSTUDIOBONES * BoneDataTexelsPerBone> _boneData;
+
+	bool _useTextureArrays = false;
+
+	//Upper limit of the memory used by a single array texture. The largest textures are left out until the rest fits
+	static constexpr std::size_t MaxPackedTextureBytes = 32 * 1024 * 1024;
+
+	std::unordered_map<const EditableStudioModel*, PackedTextureData> _packedTextures;
+
+	//Packed textures of the model being drawn, if any
+	const PackedTextureData* _currentPackedTextures = nullptr;
 };
 }
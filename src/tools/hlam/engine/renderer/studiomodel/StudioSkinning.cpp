@@ -0,0 +1,211 @@
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
+#include "engine/renderer/studiomodel/StudioSkinning.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+#include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
+
+#include "utility/Float4.hpp"
+
+namespace studiomdl
+{
+namespace
+{
+/**
+*	@brief Vectors of 4 elements, one per lane
+*/
+struct Vector4
+{
+	Float4 X;
+	Float4 Y;
+	Float4 Z;
+};
+
+inline Vector4 LoadNormals(const ModelVertexInfo* normals)
+{
+	return {
+		{normals[0].Vertex.x, normals[1].Vertex.x, normals[2].Vertex.x, normals[3].Vertex.x},
+		{normals[0].Vertex.y, normals[1].Vertex.y, normals[2].Vertex.y, normals[3].Vertex.y},
+		{normals[0].Vertex.z, normals[1].Vertex.z, normals[2].Vertex.z, normals[3].Vertex.z}};
+}
+
+/**
+*	@brief Loads the vectors of the bones that 4 normals are attached to
+*/
+inline Vector4 LoadBoneVectors(const ModelVertexInfo* normals, const glm::vec3* vectors)
+{
+	const auto& v0 = vectors[normals[0].Bone->ArrayIndex];
+	const auto& v1 = vectors[normals[1].Bone->ArrayIndex];
+	const auto& v2 = vectors[normals[2].Bone->ArrayIndex];
+	const auto& v3 = vectors[normals[3].Bone->ArrayIndex];
+
+	return {{v0.x, v1.x, v2.x, v3.x}, {v0.y, v1.y, v2.y, v3.y}, {v0.z, v1.z, v2.z, v3.z}};
+}
+
+//Same order of operations as glm::dot
+inline Float4 Dot(const Vector4& lhs, const Vector4& rhs)
+{
+	return lhs.X * rhs.X + lhs.Y * rhs.Y + lhs.Z * rhs.Z;
+}
+
+void LightShadedNormals(const ModelVertexInfo* normals, const LightingParameters& lighting, const glm::vec3* lightVectors,
+	glm::vec3* lightValues, std::size_t begin, std::size_t end)
+{
+	const Float4 zero{0.0f};
+	const Float4 one{1.0f};
+	const Float4 ambientAndShade{lighting.AmbientAndShade};
+	const Float4 shade{lighting.Shade};
+	const Float4 inverseLambert{lighting.InverseLambert};
+	const Float4 lambertOffset{lighting.LambertOffset};
+
+	std::size_t i = begin;
+
+	for (; i + 4 <= end; i += 4)
+	{
+		//Same operations as LightingParameters::Calculate, with the comparisons replaced by Min and Max.
+		//The operand order makes these return the same value as the comparisons if the light cosine is NaN
+		Float4 lightcos = Min(one, Dot(LoadNormals(normals + i), LoadBoneVectors(normals + i, lightVectors)));
+
+		lightcos = lightcos * inverseLambert + lambertOffset;
+
+		const Float4 illum = Min(one, Max(zero, ambientAndShade - Max(lightcos, zero) * shade));
+
+		float values[4];
+		illum.Store(values);
+
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			lightValues[i + lane] = glm::vec3{values[lane]} * lighting.LightColor;
+		}
+	}
+
+	for (; i < end; ++i)
+	{
+		lightValues[i] = lighting.Calculate(glm::dot(normals[i].Vertex, lightVectors[normals[i].Bone->ArrayIndex])); // -1 colinear, 1 opposite
+	}
+}
+
+void CalculateChromeCoordinates(const ModelVertexInfo* normals, const NormalLightingVectors& vectors,
+	glm::vec2* chrome, std::size_t begin, std::size_t end)
+{
+	const Float4 one{1.0f};
+	const Float4 half{0.5f};
+
+	std::size_t i = begin;
+
+	for (; i + 4 <= end; i += 4)
+	{
+		const auto normal = LoadNormals(normals + i);
+
+		const Float4 s = (Dot(normal, LoadBoneVectors(normals + i, vectors.ChromeRight)) + one) * half;
+		const Float4 t = (Dot(normal, LoadBoneVectors(normals + i, vectors.ChromeUp)) + one) * half;
+
+		float sValues[4];
+		float tValues[4];
+		s.Store(sValues);
+		t.Store(tValues);
+
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			chrome[i + lane] = glm::vec2{sValues[lane], tValues[lane]};
+		}
+	}
+
+	for (; i < end; ++i)
+	{
+		const auto& normal = normals[i].Vertex;
+		const int bone = normals[i].Bone->ArrayIndex;
+
+		//Single precision gives the same result as double here, without the conversions
+		chrome[i] = glm::vec2{
+			(glm::dot(normal, vectors.ChromeRight[bone]) + 1.0f) * 0.5f,
+			(glm::dot(normal, vectors.ChromeUp[bone]) + 1.0f) * 0.5f};
+	}
+}
+}
+
+glm::vec3 LightingParameters::Calculate(float lightcos) const
+{
+	//All components are equal until the light color is applied
+	float illum = AmbientAndShade;
+
+	if (lightcos > 1.0f) lightcos = 1;
+
+	lightcos = lightcos * InverseLambert + LambertOffset; // do modified hemispherical lighting
+	if (lightcos > 0.0f) illum -= lightcos * Shade;
+
+	illum = std::clamp(illum, 0.0f, 1.0f);
+
+	return glm::vec3{illum} * LightColor;
+}
+
+void SkinVertices(const ModelVertexInfo* vertices, const glm::mat3x4* boneTransforms, glm::vec3* output, std::size_t begin, std::size_t end)
+{
+	for (std::size_t i = begin; i < end;)
+	{
+		const auto bone = vertices[i].Bone;
+		const auto& transform = boneTransforms[bone->ArrayIndex];
+
+		//Each row of the transform is a row of the bone matrix followed by its translation.
+		//The columns are multiplied by the vertex components so each vertex takes 3 multiplies and adds
+		const Float4 column0{transform[0][0], transform[1][0], transform[2][0], 0};
+		const Float4 column1{transform[0][1], transform[1][1], transform[2][1], 0};
+		const Float4 column2{transform[0][2], transform[1][2], transform[2][2], 0};
+		const Float4 translation{transform[0][3], transform[1][3], transform[2][3], 0};
+
+		std::size_t runEnd = i + 1;
+
+		while (runEnd < end && vertices[runEnd].Bone == bone)
+		{
+			++runEnd;
+		}
+
+		for (; i < runEnd; ++i)
+		{
+			const auto& vertex = vertices[i].Vertex;
+
+			//Same order of operations as glm::dot(vertex, row) + translation
+			const Float4 result = Float4{vertex.x} * column0 + Float4{vertex.y} * column1 + Float4{vertex.z} * column2 + translation;
+
+			result.Store3(&output[i].x);
+		}
+	}
+}
+
+void LightNormals(const ModelVertexInfo* normals, const SkinningMesh* meshes, std::size_t meshCount,
+	const LightingParameters& lighting, const NormalLightingVectors& vectors,
+	glm::vec3* lightValues, glm::vec2* chrome, std::size_t begin, std::size_t end)
+{
+	for (std::size_t j = 0; j < meshCount; ++j)
+	{
+		const auto& mesh = meshes[j];
+
+		const auto meshBegin = std::max(begin, mesh.FirstNormal);
+		const auto meshEnd = std::min(end, mesh.FirstNormal + mesh.NormalCount);
+
+		if (meshBegin >= meshEnd)
+		{
+			continue;
+		}
+
+		if (mesh.Flags & STUDIO_NF_FULLBRIGHT)
+		{
+			std::fill(lightValues + meshBegin, lightValues + meshEnd, glm::vec3{1, 1, 1});
+		}
+		else if (mesh.Flags & STUDIO_NF_FLATSHADE)
+		{
+			std::fill(lightValues + meshBegin, lightValues + meshEnd, lighting.FlatShadeLight);
+		}
+		else
+		{
+			LightShadedNormals(normals, lighting, vectors.Light, lightValues, meshBegin, meshEnd);
+		}
+
+		if (mesh.Flags & STUDIO_NF_CHROME)
+		{
+			CalculateChromeCoordinates(normals, vectors, chrome, meshBegin, meshEnd);
+		}
+	}
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <glm/mat3x4.hpp>
+
+namespace studiomdl
+{
+struct ModelVertexInfo;
+
+/**
+*	@brief Lighting inputs shared by all normals of a model
+*/
+struct LightingParameters
+{
+	float Ambient = 0;
+	float Shade = 0;
+	float Lambert = 0;
+	glm::vec3 LightColor{0};
+
+	//Terms of the per-normal calculation that only depend on the inputs above
+	float AmbientAndShade = 0;
+	float InverseLambert = 0;
+	float LambertOffset = 0;
+
+	//Result for flat shaded meshes, which doesn't depend on the normal
+	glm::vec3 FlatShadeLight{0};
+
+	glm::vec3 Calculate(float lightcos) const;
+};
+
+/**
+*	@brief Normals of a mesh and the texture flags that affect how they are lit
+*/
+struct SkinningMesh
+{
+	std::size_t FirstNormal = 0;
+	std::size_t NormalCount = 0;
+	int Flags = 0;
+};
+
+/**
+*	@brief Per-bone vectors used to light normals, in bone reference frames
+*/
+struct NormalLightingVectors
+{
+	const glm::vec3* Light = nullptr;
+	const glm::vec3* ChromeRight = nullptr;
+	const glm::vec3* ChromeUp = nullptr;
+};
+
+/**
+*	@brief Transforms vertices [begin, end) by the transform of their bone.
+*	Runs of vertices attached to the same bone are transformed with 4-wide SIMD operations where available.
+*/
+void SkinVertices(const ModelVertexInfo* vertices, const glm::mat3x4* boneTransforms, glm::vec3* output, std::size_t begin, std::size_t end);
+
+/**
+*	@brief Lights normals [begin, end) and calculates their chrome coordinates for meshes that have chrome.
+*	Normals are processed 4 at a time where available. The results are identical to lighting each normal with LightingParameters::Calculate.
+*	@param meshes Meshes that the normals belong to, in order
+*	@param chrome Only written for chrome meshes. May be null if there are none
+*/
+void LightNormals(const ModelVertexInfo* normals, const SkinningMesh* meshes, std::size_t meshCount,
+	const LightingParameters& lighting, const NormalLightingVectors& vectors,
+	glm::vec3* lightValues, glm::vec2* chrome, std::size_t begin, std::size_t end);
+}
@@ -7,18 +7,33 @@
 
 namespace studiomdl
 {
-bool CompareSortedMeshes(const SortedMesh& lhs, const SortedMesh& rhs)
+RenderPass GetRenderPass(int textureFlags)
 {
-	if ((lhs.Flags & (STUDIO_NF_ADDITIVE)) == 0 && rhs.Flags & (STUDIO_NF_ADDITIVE))
+	if (textureFlags & STUDIO_NF_ADDITIVE)
 	{
-		return true;
+		return RenderPass::Additive;
 	}
 
-	if (lhs.Flags & (STUDIO_NF_MASKED) && (rhs.Flags & (STUDIO_NF_MASKED)) == 0)
+	if (textureFlags & STUDIO_NF_MASKED)
 	{
-		return true;
+		return RenderPass::Masked;
 	}
 
-	return false;
+	return RenderPass::Solid;
+}
+
+bool CompareRenderItems(const RenderItem& lhs, const RenderItem& rhs)
+{
+	if (lhs.Pass != rhs.Pass)
+	{
+		return lhs.Pass < rhs.Pass;
+	}
+
+	if (lhs.BlendMode != rhs.BlendMode)
+	{
+		return lhs.BlendMode < rhs.BlendMode;
+	}
+
+	return lhs.TextureId < rhs.TextureId;
 }
 }
@@ -1,14 +1,50 @@
 #pragma once
 
+#include <GL/glew.h>
+
 namespace studiomdl
 {
-struct Mesh;
+struct Texture;
+
+/**
+*	@brief Passes that meshes are drawn in, in drawing order.
+*	Masked meshes are drawn before solid meshes, additive meshes are drawn last since they don't write depth.
+*/
+enum class RenderPass
+{
+	Masked = 0,
+	Solid,
+	Additive
+};
+
+enum class RenderBlendMode
+{
+	None = 0,
+	Alpha,
+	Additive
+};
 
-struct SortedMesh
+/**
+*	@brief A single mesh queued for drawing
+*/
+struct RenderItem
 {
-	const Mesh* Mesh;
-	int Flags;
+	int Bodypart;
+	int MeshIndex;
+	const studiomdl::Texture* Texture;
+
+	RenderPass Pass;
+	RenderBlendMode BlendMode;
+
+	//Array texture if the texture was packed, in which case TextureLayer is its layer. Otherwise -1
+	GLuint TextureId;
+	int TextureLayer;
 };
 
-bool CompareSortedMeshes(const SortedMesh& lhs, const SortedMesh& rhs);
+RenderPass GetRenderPass(int textureFlags);
+
+/**
+*	@brief Orders items by pass, blend mode and texture so items that share state are drawn together
+*/
+bool CompareRenderItems(const RenderItem& lhs, const RenderItem& rhs);
 }
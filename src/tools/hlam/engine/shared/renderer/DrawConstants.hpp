@@ -45,6 +45,11 @@ enum DrawFlag : DrawFlags
 	DRAW_EYE_POSITION = Bit(8),
 
 	DRAW_NORMALS = Bit(9),
+
+	/**
+	*	Draw without textures, as in the wireframe and shaded render modes.
+	*/
+	NO_TEXTURES = Bit(10),
 };
 }
 }
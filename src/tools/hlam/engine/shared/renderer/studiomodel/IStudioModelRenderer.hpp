@@ -1,5 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <optional>
+
+#include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
 
 #include "core/shared/Const.hpp"
@@ -14,8 +18,63 @@
 *	@{
 */
 
+namespace graphics
+{
+class FrameProfiler;
+class IDrawCommandBackend;
+}
+
 namespace studiomdl
 {
+/**
+*	Number of render state changes made to draw models.
+*/
+struct RenderStateCounters
+{
+	unsigned int TextureBinds = 0;
+	unsigned int BlendChanges = 0;
+	unsigned int DepthMaskChanges = 0;
+	unsigned int AlphaTestChanges = 0;
+
+	/**
+	*	Vertex and index buffer bindings made when switching between submodels drawn using buffers.
+	*/
+	unsigned int BufferBinds = 0;
+
+	unsigned int MeshesDrawn = 0;
+
+	/**
+	*	Models and submodels that were skipped because they were outside the view.
+	*/
+	unsigned int ModelsCulled = 0;
+	unsigned int SubmodelsCulled = 0;
+
+	/**
+	*	Draw calls that drew multiple instances of a model at once.
+	*/
+	unsigned int InstancedDraws = 0;
+
+	unsigned int GetStateChangesCount() const
+	{
+		return TextureBinds + BlendChanges + DepthMaskChanges + AlphaTestChanges + BufferBinds;
+	}
+
+	RenderStateCounters operator-(const RenderStateCounters& other) const
+	{
+		return {
+			TextureBinds - other.TextureBinds,
+			BlendChanges - other.BlendChanges,
+			DepthMaskChanges - other.DepthMaskChanges,
+			AlphaTestChanges - other.AlphaTestChanges,
+			BufferBinds - other.BufferBinds,
+			MeshesDrawn - other.MeshesDrawn,
+			ModelsCulled - other.ModelsCulled,
+			SubmodelsCulled - other.SubmodelsCulled,
+			InstancedDraws - other.InstancedDraws
+		};
+	}
+};
+
 /**
 *	Used to render studio models. Only one instance of this class should be used, and should be kept around, in order to achieve reasonably performant and consistent rendering.
 */
@@ -50,6 +109,11 @@ public:
 	*/
 	virtual unsigned int GetDrawnPolygonsCount() const = 0;
 
+	/**
+	*	@return The number of render state changes made since the last call to Initialize.
+	*/
+	virtual const RenderStateCounters& GetRenderStateCounters() const = 0;
+
 	/**
 	*	@return The current lambert value. Modifier for pseudo-hemispherical lighting.
 	*/
@@ -95,6 +159,64 @@ public:
 
 	virtual void SetWireframeColor(const glm::vec3& color) = 0;
 
+	/**
+	*	@return Whether models are drawn using vertex buffers instead of immediate mode.
+	*/
+	virtual bool ShouldUseVertexBuffers() const = 0;
+
+	/**
+	*	Sets whether models are drawn using vertex buffers instead of immediate mode.
+	*	Both modes produce the same output.
+	*/
+	virtual void SetUseVertexBuffers(bool value) = 0;
+
+	/**
+	*	@return Whether vertices are transformed and lit on the GPU.
+	*/
+	virtual bool ShouldUseGPUSkinning() const = 0;
+
+	/**
+	*	Sets whether vertices are transformed and lit on the GPU using a shader.
+	*	Falls back to skinning on the CPU if the shader is not supported.
+	*/
+	virtual void SetUseGPUSkinning(bool value) = 0;
+
+	/**
+	*	Creates the skinning shader if it hasn't been created yet. Requires a current OpenGL context.
+	*	@return Whether vertices can be transformed and lit on the GPU.
+	*/
+	virtual bool IsGPUSkinningSupported() = 0;
+
+	/**
+	*	@return Whether skin textures are packed into an array texture when using GPU skinning.
+	*/
+	virtual bool ShouldUseTextureArrays() const = 0;
+
+	/**
+	*	Sets whether skin textures are packed into an array texture when using GPU skinning,
+	*	which allows meshes with different textures to be drawn together.
+	*	Textures that don't fit are still drawn by themselves.
+	*/
+	virtual void SetUseTextureArrays(bool value) = 0;
+
+	/**
+	*	Sets the backend that executes the draw commands recorded by this renderer.
+	*	The default backend replays them using OpenGL. Pass nullptr to restore it.
+	*	Resources such as vertex buffers and shaders are still created using OpenGL.
+	*/
+	virtual void SetDrawCommandBackend(graphics::IDrawCommandBackend* backend) = 0;
+
+	/**
+	*	Sets the profiler that the time spent in each stage of drawing a model is reported to. May be null.
+	*/
+	virtual void SetFrameProfiler(graphics::FrameProfiler* profiler) = 0;
+
+	/**
+	*	Sets the view and projection matrix that models and submodels are culled against.
+	*	Pass an empty value to draw everything.
+	*/
+	virtual void SetCullingViewProjection(const std::optional<glm::mat4>& viewProjection) = 0;
+
 	/**
 	*	Draws the given model.
 	*	@param renderInfo Render info that describes the model.
@@ -103,6 +225,19 @@ public:
 	*/
 	virtual unsigned int DrawModel(ModelRenderInfo* const renderInfo, const renderer::DrawFlags flags = renderer::DrawFlag::NONE) = 0;
 
+	/**
+	*	Draws multiple instances of models.
+	*	Consecutive instances that only differ in origin and angles share bone setup and skinning,
+	*	and are drawn using instancing when using GPU skinning.
+	*	Flags that draw overlays or shadows cause each instance to be drawn separately.
+	*	@param renderInfos Render info that describes each instance.
+	*	@param count Number of instances.
+	*	@param flags Flags.
+	*	@return Number of polygons that were drawn.
+	*/
+	virtual unsigned int DrawModelInstances(ModelRenderInfo* const renderInfos, const std::size_t count,
+		const renderer::DrawFlags flags = renderer::DrawFlag::NONE) = 0;
+
 	/*
 	*	Tool only operations.
 	*/
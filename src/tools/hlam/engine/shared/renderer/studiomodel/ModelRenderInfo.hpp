@@ -42,6 +42,27 @@ struct ModelRenderInfo
 	std::array<byte, ControllerCount> Controller;
 	byte Mouth;
 };
+
+inline bool operator==(const ModelRenderInfo& lhs, const ModelRenderInfo& rhs)
+{
+	return lhs.Origin == rhs.Origin
+		&& lhs.Angles == rhs.Angles
+		&& lhs.Scale == rhs.Scale
+		&& lhs.Model == rhs.Model
+		&& lhs.Transparency == rhs.Transparency
+		&& lhs.Sequence == rhs.Sequence
+		&& lhs.Frame == rhs.Frame
+		&& lhs.Bodygroup == rhs.Bodygroup
+		&& lhs.Skin == rhs.Skin
+		&& lhs.Blender == rhs.Blender
+		&& lhs.Controller == rhs.Controller
+		&& lhs.Mouth == rhs.Mouth;
+}
+
+inline bool operator!=(const ModelRenderInfo& lhs, const ModelRenderInfo& rhs)
+{
+	return !(lhs == rhs);
+}
 }
 
 /** @} */
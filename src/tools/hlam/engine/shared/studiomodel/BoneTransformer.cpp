@@ -133,6 +133,19 @@ const std::array<glm::mat3x4, MAXSTUDIOBONES>& BoneTransformer::SetUpBones(const
 	return _boneTransform;
 }
 
+void BoneTransformer::CalculateMotionBoneTransform(const EditableStudioModel& studioModel, const Sequence& sequence, const int frame,
+	glm::vec3& position, glm::vec4& quaternion)
+{
+	const auto& bone = *studioModel.Bones[sequence.MotionBone];
+	const auto& anim = sequence.AnimationBlends[0][sequence.MotionBone];
+
+	//Controllers are not part of the sequence's motion
+	const std::array<float, MAXSTUDIOCONTROLLERS> boneAdjust{};
+
+	CalculateBoneQuaternion(frame, 0, bone, anim, boneAdjust, quaternion);
+	CalculateBonePosition(frame, 0, bone, anim, boneAdjust, position);
+}
+
 void BoneTransformer::CalculateRotations(const EditableStudioModel& studioModel, const BoneTransformInfo& transformInfo,
 	const Sequence& sequence, const std::vector<Animation>& anims, TransformState& transformState)
 {
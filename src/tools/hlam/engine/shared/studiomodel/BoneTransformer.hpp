@@ -53,6 +53,13 @@ public:
 	*/
 	const std::array<glm::mat3x4, MAXSTUDIOBONES>& SetUpBones(const EditableStudioModel& studioModel, const BoneTransformInfo& transformInfo);
 
+	/**
+	*	@brief Calculates the local transform of a sequence's motion bone at the given frame
+	*	Only the first animation blend is used and bone controllers are not applied
+	*/
+	static void CalculateMotionBoneTransform(const EditableStudioModel& studioModel, const Sequence& sequence, const int frame,
+		glm::vec3& position, glm::vec4& quaternion);
+
 private:
 	static void CalculateRotations(const EditableStudioModel& studioModel, const BoneTransformInfo& transformInfo,
 		const Sequence& sequence, const std::vector<Animation>& anims, TransformState& transformState);
@@ -1,11 +1,23 @@
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
 
 #include "core/shared/Logging.hpp"
 
+#include "engine/shared/studiomodel/BoneTransformer.hpp"
 #include "engine/shared/studiomodel/EditableStudioModel.hpp"
 
 #include "graphics/TextureLoader.hpp"
 
+#include "utility/WorkerPool.hpp"
+#include "utility/mathlib.hpp"
+
 namespace studiomdl
 {
 EditableStudioModel::~EditableStudioModel()
@@ -76,6 +88,8 @@ void EditableStudioModel::CreateTextures(graphics::TextureLoader& textureLoader)
 
 		texture->TextureId = name;
 	}
+
+	++TextureRevision;
 }
 
 void EditableStudioModel::ReplaceTexture(graphics::TextureLoader& textureLoader, Texture* texture, const byte* data, const graphics::RGBPalette& pal)
@@ -87,6 +101,8 @@ void EditableStudioModel::ReplaceTexture(graphics::TextureLoader& textureLoader,
 		pal,
 		(texture->Flags & STUDIO_NF_NOMIPS) != 0,
 		(texture->Flags & STUDIO_NF_MASKED) != 0);
+
+	++TextureRevision;
 }
 
 void EditableStudioModel::ReuploadTexture(graphics::TextureLoader& textureLoader, Texture* texture)
@@ -114,9 +130,11 @@ void EditableStudioModel::UpdateFilters(graphics::TextureLoader& textureLoader)
 		if (texture->TextureId)
 		{
 			glBindTexture(GL_TEXTURE_2D, texture->TextureId);
-			textureLoader.SetFilters(texture->TextureId, (texture->Flags & STUDIO_NF_NOMIPS) != 0);
+			textureLoader.SetFilters((texture->Flags & STUDIO_NF_NOMIPS) != 0);
 		}
 	}
+
+	++TextureRevision;
 }
 
 void EditableStudioModel::ReuploadTextures(graphics::TextureLoader& textureLoader)
@@ -233,6 +251,8 @@ void ApplyScaleMeshesData(EditableStudioModel& studioModel, const ScaleMeshesDat
 		}
 	}
 
+	++studioModel.GeometryRevision;
+
 	// scale complex hitboxes
 	for (int i = 0; i < studioModel.Hitboxes.size(); ++i)
 	{
@@ -296,6 +316,225 @@ void ApplyScaleBonesData(EditableStudioModel& studioModel, const std::vector<stu
 			bone.Axes[j].Scale = boneData.Scale[j];
 		}
 	}
+
+	//Bone positions are part of the root motion
+	CalculateRootMotion(studioModel);
+}
+
+namespace
+{
+/**
+*	@brief A single pose to evaluate when calculating sequence bounding boxes
+*/
+struct BBoxPose
+{
+	int Sequence;
+	int Frame;
+	byte BlenderX;
+	byte BlenderY;
+};
+
+std::vector<BBoxPose> GetSequenceBBoxPoses(const EditableStudioModel& studioModel)
+{
+	std::vector<BBoxPose> poses;
+
+	for (int i = 0; i < studioModel.Sequences.size(); ++i)
+	{
+		const auto& sequence = *studioModel.Sequences[i];
+
+		if (sequence.AnimationBlends.empty())
+		{
+			continue;
+		}
+
+		//Evaluate the extremes of each blend axis, plus the center for 3x3 blends
+		std::vector<byte> blendersX{0};
+		std::vector<byte> blendersY{0};
+
+		if (sequence.AnimationBlends.size() == 9)
+		{
+			blendersX = blendersY = {0, 127, 255};
+		}
+		else if (sequence.AnimationBlends.size() > 1)
+		{
+			blendersX = {0, 255};
+
+			if (sequence.AnimationBlends[0].size() == 4)
+			{
+				blendersY = {0, 255};
+			}
+		}
+
+		for (int frame = 0; frame < std::max(1, sequence.NumFrames); ++frame)
+		{
+			for (auto x : blendersX)
+			{
+				for (auto y : blendersY)
+				{
+					poses.push_back({i, frame, x, y});
+				}
+			}
+		}
+	}
+
+	return poses;
+}
+
+using BBoxList = std::vector<std::pair<glm::vec3, glm::vec3>>;
+
+void AddPoseToSequenceBBoxes(const EditableStudioModel& studioModel, BoneTransformer& boneTransformer, const BBoxPose& pose, BBoxList& bboxes)
+{
+	std::array<byte, ControllerCount> controllers{};
+
+	//Evaluate controllers at their rest position
+	for (const auto& controller : studioModel.BoneControllers)
+	{
+		if (controller->Index >= 0 && controller->Index < controllers.size())
+		{
+			controllers[controller->Index] = static_cast<byte>(controller->Rest);
+		}
+	}
+
+	const auto& bones = boneTransformer.SetUpBones(studioModel,
+		{
+			pose.Sequence,
+			static_cast<float>(pose.Frame),
+			glm::vec3{1},
+			{pose.BlenderX, pose.BlenderY},
+			controllers,
+			0
+		});
+
+	auto& bbox = bboxes[pose.Sequence];
+
+	glm::vec3 vertex;
+
+	for (const auto& bodypart : studioModel.Bodyparts)
+	{
+		for (const auto& model : bodypart->Models)
+		{
+			for (const auto& vertexInfo : model.Vertices)
+			{
+				VectorTransform(vertexInfo.Vertex, bones[vertexInfo.Bone->ArrayIndex], vertex);
+
+				bbox.first = glm::min(bbox.first, vertex);
+				bbox.second = glm::max(bbox.second, vertex);
+			}
+		}
+	}
+}
+}
+
+std::optional<std::pair<SequenceBBoxesData, SequenceBBoxesData>> CalculateSequenceBBoxesData(const EditableStudioModel& studioModel,
+	WorkerPool& workerPool, const BBoxesProgressCallback& progress)
+{
+	const auto poses = GetSequenceBBoxPoses(studioModel);
+
+	const BBoxList emptyBBoxes(studioModel.Sequences.size(),
+		{glm::vec3{std::numeric_limits<float>::max()}, glm::vec3{std::numeric_limits<float>::lowest()}});
+
+	BBoxList sequenceBBoxes{emptyBBoxes};
+	std::mutex sequenceBBoxesMutex;
+
+	//Each batch accumulates into its own list, merged into the shared list once the batch is done.
+	//Minimum and maximum don't depend on the order, so the result is the same for any number of threads
+	const auto addPoses = [&](std::size_t begin, std::size_t end)
+	{
+		auto boneTransformer = std::make_unique<BoneTransformer>();
+		BBoxList bboxes{emptyBBoxes};
+
+		for (std::size_t index = begin; index < end; ++index)
+		{
+			AddPoseToSequenceBBoxes(studioModel, *boneTransformer, poses[index], bboxes);
+		}
+
+		std::lock_guard lock{sequenceBBoxesMutex};
+
+		for (std::size_t i = 0; i < bboxes.size(); ++i)
+		{
+			sequenceBBoxes[i].first = glm::min(sequenceBBoxes[i].first, bboxes[i].first);
+			sequenceBBoxes[i].second = glm::max(sequenceBBoxes[i].second, bboxes[i].second);
+		}
+	};
+
+	//Evaluate a few batches per thread at a time so progress can be reported and the operation cancelled from the calling thread
+	const std::size_t batchSize = 8;
+	const std::size_t posesPerUpdate = workerPool.GetThreadCount() * batchSize * 4;
+
+	bool cancelled = false;
+
+	for (std::size_t first = 0; first < poses.size() && !cancelled; first += posesPerUpdate)
+	{
+		const std::size_t count = std::min(posesPerUpdate, poses.size() - first);
+
+		workerPool.ParallelFor(count, batchSize, [&](std::size_t begin, std::size_t end)
+			{
+				addPoses(first + begin, first + end);
+			});
+
+		if (progress && !progress(first + count, poses.size()))
+		{
+			cancelled = true;
+		}
+	}
+
+	if (cancelled)
+	{
+		return {};
+	}
+
+	BBoxList oldBBoxes;
+	BBoxList newBBoxes;
+
+	oldBBoxes.reserve(studioModel.Sequences.size());
+	newBBoxes.reserve(studioModel.Sequences.size());
+
+	//Keep the existing hull if there are no sequences
+	std::pair<glm::vec3, glm::vec3> hull{studioModel.BoundingMin, studioModel.BoundingMax};
+
+	for (std::size_t i = 0; i < studioModel.Sequences.size(); ++i)
+	{
+		const auto& sequence = *studioModel.Sequences[i];
+
+		auto bbox = sequenceBBoxes[i];
+
+		//Keep the existing bounds if there was nothing to evaluate
+		if (bbox.first.x > bbox.second.x)
+		{
+			bbox = std::make_pair(sequence.BBMin, sequence.BBMax);
+		}
+
+		if (i == 0)
+		{
+			hull = bbox;
+		}
+		else
+		{
+			hull.first = glm::min(hull.first, bbox.first);
+			hull.second = glm::max(hull.second, bbox.second);
+		}
+
+		oldBBoxes.emplace_back(std::make_pair(sequence.BBMin, sequence.BBMax));
+		newBBoxes.emplace_back(std::move(bbox));
+	}
+
+	return std::make_pair(
+		SequenceBBoxesData{std::move(oldBBoxes), {studioModel.BoundingMin, studioModel.BoundingMax}},
+		SequenceBBoxesData{std::move(newBBoxes), hull});
+}
+
+void ApplySequenceBBoxesData(EditableStudioModel& studioModel, const SequenceBBoxesData& data)
+{
+	for (int i = 0; i < studioModel.Sequences.size(); ++i)
+	{
+		auto& sequence = *studioModel.Sequences[i];
+
+		sequence.BBMin = data.SequenceBBoxes[i].first;
+		sequence.BBMax = data.SequenceBBoxes[i].second;
+	}
+
+	studioModel.BoundingMin = data.Hull.first;
+	studioModel.BoundingMax = data.Hull.second;
 }
 
 std::pair<ScaleSTCoordinatesData, ScaleSTCoordinatesData> CalculateScaledSTCoordinatesData(const EditableStudioModel& studioModel,
@@ -433,4 +672,166 @@ void SortEventsList(std::vector<SequenceEvent*>& events)
 			return lhs->Frame < rhs->Frame;
 		});
 }
+
+void CalculateRootMotion(const EditableStudioModel& studioModel, Sequence& sequence)
+{
+	auto& rootMotion = sequence.RootMotion;
+
+	rootMotion = {};
+
+	if (sequence.NumFrames <= 0
+		|| sequence.AnimationBlends.empty()
+		|| sequence.MotionBone < 0 || sequence.MotionBone >= studioModel.Bones.size())
+	{
+		return;
+	}
+
+	rootMotion.Positions.reserve(sequence.NumFrames);
+	rootMotion.Yaws.reserve(sequence.NumFrames);
+	rootMotion.CumulativeDistances.reserve(sequence.NumFrames);
+
+	glm::vec3 firstMotion{0};
+
+	for (int frame = 0; frame < sequence.NumFrames; ++frame)
+	{
+		glm::vec3 position;
+		glm::vec4 quaternion;
+
+		BoneTransformer::CalculateMotionBoneTransform(studioModel, sequence, frame, position, quaternion);
+
+		//Only movement along the motion axes moves the entity, the rest is part of the pose
+		glm::vec3 motion{0};
+
+		if (sequence.MotionType & STUDIO_X)
+		{
+			motion.x = position.x;
+		}
+
+		if (sequence.MotionType & STUDIO_Y)
+		{
+			motion.y = position.y;
+		}
+
+		if (sequence.MotionType & STUDIO_Z)
+		{
+			motion.z = position.z;
+		}
+
+		if (frame == 0)
+		{
+			firstMotion = motion;
+		}
+
+		motion -= firstMotion;
+
+		if (sequence.NumFrames > 1)
+		{
+			motion += sequence.LinearMovement * (static_cast<float>(frame) / (sequence.NumFrames - 1));
+		}
+
+		float distance = 0;
+
+		if (frame > 0)
+		{
+			const auto delta = motion - rootMotion.Positions.back();
+
+			distance = rootMotion.CumulativeDistances.back() + glm::length(glm::vec2{delta.x, delta.y});
+		}
+
+		const float yaw = std::atan2(
+			2 * (quaternion[0] * quaternion[1] + quaternion[3] * quaternion[2]),
+			1 - 2 * (quaternion[1] * quaternion[1] + quaternion[2] * quaternion[2]));
+
+		rootMotion.Positions.push_back(motion);
+		rootMotion.Yaws.push_back(yaw);
+		rootMotion.CumulativeDistances.push_back(distance);
+	}
+
+	rootMotion.TotalDistance = rootMotion.CumulativeDistances.back();
+}
+
+void CalculateRootMotion(EditableStudioModel& studioModel)
+{
+	for (auto& sequence : studioModel.Sequences)
+	{
+		CalculateRootMotion(studioModel, *sequence);
+	}
+}
+
+glm::vec3 GetRootMotionPosition(const SequenceRootMotion& rootMotion, float frame)
+{
+	if (rootMotion.Positions.empty())
+	{
+		return glm::vec3{0};
+	}
+
+	const int lastFrame = static_cast<int>(rootMotion.Positions.size()) - 1;
+
+	frame = std::clamp(frame, 0.f, static_cast<float>(lastFrame));
+
+	const int index = std::min(static_cast<int>(frame), lastFrame);
+	const int nextIndex = std::min(index + 1, lastFrame);
+
+	const float s = frame - index;
+
+	return rootMotion.Positions[index] * (1 - s) + rootMotion.Positions[nextIndex] * s;
+}
+
+float GetRootMotionYaw(const SequenceRootMotion& rootMotion, float frame)
+{
+	if (rootMotion.Yaws.empty())
+	{
+		return 0;
+	}
+
+	const int lastFrame = static_cast<int>(rootMotion.Yaws.size()) - 1;
+
+	frame = std::clamp(frame, 0.f, static_cast<float>(lastFrame));
+
+	const int index = std::min(static_cast<int>(frame), lastFrame);
+	const int nextIndex = std::min(index + 1, lastFrame);
+
+	const float s = frame - index;
+
+	const float yaw = rootMotion.Yaws[index];
+
+	//Yaws are in [-pi, pi], so take the shortest way around when they cross that boundary
+	float difference = rootMotion.Yaws[nextIndex] - yaw;
+
+	if (difference > PI<float>)
+	{
+		difference -= 2 * PI<float>;
+	}
+	else if (difference < -PI<float>)
+	{
+		difference += 2 * PI<float>;
+	}
+
+	return yaw + difference * s;
+}
+
+glm::vec3 GetRootMotionDelta(const SequenceRootMotion& rootMotion, float previousFrame, float currentFrame)
+{
+	if (currentFrame >= previousFrame)
+	{
+		return GetRootMotionPosition(rootMotion, currentFrame) - GetRootMotionPosition(rootMotion, previousFrame);
+	}
+
+	//Wrapped around, include the movement up to the end of the sequence
+	const float lastFrame = static_cast<float>(rootMotion.Positions.size()) - 1;
+
+	return GetRootMotionPosition(rootMotion, lastFrame)
+		- GetRootMotionPosition(rootMotion, previousFrame)
+		+ GetRootMotionPosition(rootMotion, currentFrame);
+}
+
+float GetRootMotionSpeed(const Sequence& sequence)
+{
+	if (sequence.NumFrames <= 1)
+	{
+		return 0;
+	}
+
+	return sequence.RootMotion.TotalDistance * sequence.FPS / (sequence.NumFrames - 1);
+}
 }
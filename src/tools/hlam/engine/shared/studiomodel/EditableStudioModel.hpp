@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -15,6 +17,8 @@
 #include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
 #include "graphics/Palette.hpp"
 
+class WorkerPool;
+
 namespace graphics
 {
 class TextureLoader;
@@ -52,7 +56,7 @@ struct Bone
 
 struct Hitbox
 {
-	Bone* Bone = nullptr;
+	studiomdl::Bone* Bone = nullptr;
 	int Group = 0;
 
 	glm::vec3 Min{0};
@@ -92,6 +96,23 @@ struct SequencePivot
 	int End = 0;
 };
 
+/**
+*	@brief Motion of a sequence's motion bone, precomputed per frame from the first animation blend
+*/
+struct SequenceRootMotion
+{
+	//Movement relative to frame 0, including linear movement
+	std::vector<glm::vec3> Positions;
+
+	//Yaw of the motion bone in radians
+	std::vector<float> Yaws;
+
+	//Distance travelled along the ground plane up to each frame
+	std::vector<float> CumulativeDistances;
+
+	float TotalDistance = 0;
+};
+
 struct Sequence
 {
 	std::string Label;
@@ -129,6 +150,9 @@ struct Sequence
 	int NodeFlags = 0;
 
 	int NextSequence = 0;
+
+	//Derived from the animation data, must be recalculated when bones or animations change
+	SequenceRootMotion RootMotion;
 };
 
 struct Attachment
@@ -137,7 +161,7 @@ struct Attachment
 
 	int Type = 0;
 
-	Bone* Bone = nullptr;
+	studiomdl::Bone* Bone = nullptr;
 
 	glm::vec3 Origin{0};
 
@@ -156,7 +180,7 @@ struct Mesh
 struct ModelVertexInfo
 {
 	glm::vec3 Vertex{0};
-	Bone* Bone = nullptr;
+	studiomdl::Bone* Bone = nullptr;
 };
 
 struct Model
@@ -234,6 +258,15 @@ public:
 	//TODO: temporary until a better system can be put into place
 	bool TexturesNeedCreating = true;
 
+	//Incremented whenever the model is edited so any data derived from it can be recalculated
+	unsigned int Revision = 0;
+
+	//Incremented whenever vertex or normal data changes so data derived from it can be recalculated
+	unsigned int GeometryRevision = 0;
+
+	//Incremented whenever textures are uploaded or their filters change so copies of the uploaded textures can be recreated
+	unsigned int TextureRevision = 0;
+
 	std::vector<std::vector<byte>> Transitions;
 
 	Model* GetModelByBodyPart(const int iBody, const int iBodyPart);
@@ -317,6 +350,32 @@ std::pair<std::vector<ScaleBonesBoneData>, std::vector<ScaleBonesBoneData>> Calc
 
 void ApplyScaleBonesData(EditableStudioModel& studioModel, const std::vector<studiomdl::ScaleBonesBoneData>& data);
 
+struct SequenceBBoxesData
+{
+	std::vector<std::pair<glm::vec3, glm::vec3>> SequenceBBoxes;
+
+	//The model's bounding box (BoundingMin, BoundingMax)
+	std::pair<glm::vec3, glm::vec3> Hull;
+};
+
+/**
+*	@brief Called with the number of poses that have been evaluated and the total number of poses
+*	@return false to cancel the operation
+*/
+using BBoxesProgressCallback = std::function<bool(std::size_t completed, std::size_t total)>;
+
+/**
+*	@brief Recalculates the bounding box of every sequence from the vertices of all submodels in every frame,
+*	and the model's hull as the union of all sequence bounding boxes
+*	Poses are evaluated on the threads of @p workerPool, including the calling thread.
+*	@param progress Invoked on the calling thread only. May be empty
+*	@return Old and new data, or an empty optional if the operation was cancelled
+*/
+std::optional<std::pair<SequenceBBoxesData, SequenceBBoxesData>> CalculateSequenceBBoxesData(const EditableStudioModel& studioModel,
+	WorkerPool& workerPool, const BBoxesProgressCallback& progress);
+
+void ApplySequenceBBoxesData(EditableStudioModel& studioModel, const SequenceBBoxesData& data);
+
 struct ScaleSTCoordinatesData
 {
 	struct STCoordinate
@@ -347,4 +406,36 @@ std::pair<ScaleSTCoordinatesData, ScaleSTCoordinatesData> CalculateScaledSTCoord
 void ApplyScaledSTCoordinatesData(const EditableStudioModel& studioModel, const int textureIndex, const ScaleSTCoordinatesData& data);
 
 void SortEventsList(std::vector<SequenceEvent*>& events);
+
+/**
+*	@brief Recalculates the root motion curve of the given sequence
+*/
+void CalculateRootMotion(const EditableStudioModel& studioModel, Sequence& sequence);
+
+/**
+*	@brief Recalculates the root motion curves of all sequences
+*/
+void CalculateRootMotion(EditableStudioModel& studioModel);
+
+/**
+*	@brief Gets the root motion position at the given frame, interpolating between frames
+*/
+glm::vec3 GetRootMotionPosition(const SequenceRootMotion& rootMotion, float frame);
+
+/**
+*	@brief Gets the root motion yaw in radians at the given frame, interpolating between frames along the shortest arc
+*/
+float GetRootMotionYaw(const SequenceRootMotion& rootMotion, float frame);
+
+/**
+*	@brief Gets the root motion between two frames of a looping sequence.
+*	If @p currentFrame is before @p previousFrame the sequence is assumed to have wrapped around once,
+*	so the movement up to the last frame is included.
+*/
+glm::vec3 GetRootMotionDelta(const SequenceRootMotion& rootMotion, float previousFrame, float currentFrame);
+
+/**
+*	@brief Gets the average ground speed of a sequence in units per second, based on its root motion
+*/
+float GetRootMotionSpeed(const Sequence& sequence);
 }
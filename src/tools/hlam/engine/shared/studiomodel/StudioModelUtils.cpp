@@ -673,6 +673,8 @@ EditableStudioModel ConvertToEditable(const StudioModel& studioModel)
 
 	result.Transitions = ConvertTransitionsToEditable(studioModel);
 
+	CalculateRootMotion(result);
+
 	return result;
 }
 
@@ -72,4 +72,8 @@ void HLMVStudioModelEntity::AnimThink()
 
 		DispatchAnimEvents(true);
 	}
+	else
+	{
+		ResetFrameInterpolation();
+	}
 }
@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <cmath>
 
 #include <glm/geometric.hpp>
 
@@ -45,7 +46,7 @@ studiomdl::ModelRenderInfo StudioModelEntity::GetRenderInfo() const
 
 	renderInfo.Transparency = GetTransparency();
 	renderInfo.Sequence = GetSequence();
-	renderInfo.Frame = GetFrame();
+	renderInfo.Frame = GetInterpolatedFrame();
 	renderInfo.Bodygroup = GetBodygroup();
 	renderInfo.Skin = GetSkin();
 
@@ -78,6 +79,8 @@ float StudioModelEntity::AdvanceFrame(float deltaTime, const float maximum)
 
 	const auto& sequenceDescriptor = *_editableModel->Sequences[_sequence];
 
+	_previousFrame = _frame;
+
 	if (deltaTime == 0)
 	{
 		deltaTime = (GetContext()->Time->GetTime() - _animTime);
@@ -144,6 +147,8 @@ float StudioModelEntity::AdvanceFrame(float deltaTime, const float maximum)
 		if (oldFrame > _frame)
 		{
 			_lastEventCheck = _frame - increment;
+			//Keep the previous frame continuous with the current one, even if the increment spans multiple loops
+			_previousFrame = _frame - increment;
 		}
 	}
 
@@ -263,9 +268,43 @@ void StudioModelEntity::SetFrame(float frame)
 		_frame -= (int)(_frame / (sequenceDescriptor.NumFrames - 1)) * (sequenceDescriptor.NumFrames - 1);
 	}
 
+	//Don't interpolate from the frame that was replaced
+	_previousFrame = _frame;
+
 	_animTime = GetContext()->Time->GetTime();
 }
 
+float StudioModelEntity::GetInterpolatedFrame() const
+{
+	const float fraction = GetContext()->Time->GetInterpolationFraction();
+
+	float frame = _previousFrame + ((_frame - _previousFrame) * fraction);
+
+	//The previous frame is negative if the sequence wrapped during the last step
+	if (frame < 0 && _editableModel && _sequence >= 0 && _sequence < _editableModel->Sequences.size())
+	{
+		const int numFrames = _editableModel->Sequences[_sequence]->NumFrames;
+
+		if (numFrames > 1)
+		{
+			const float length = static_cast<float>(numFrames - 1);
+
+			frame = std::fmod(frame, length) + length;
+
+			if (frame >= length)
+			{
+				frame = 0;
+			}
+		}
+		else
+		{
+			frame = 0;
+		}
+	}
+
+	return frame;
+}
+
 void StudioModelEntity::SetEditableModel(studiomdl::EditableStudioModel* model)
 {
 	//TODO: release old model.
@@ -298,6 +337,7 @@ void StudioModelEntity::SetSequence(int sequence)
 
 	_sequence = sequence;
 	_frame = 0;
+	_previousFrame = 0;
 	_lastEventCheck = 0;
 }
 
@@ -318,6 +358,11 @@ void StudioModelEntity::GetSequenceInfo(float& frameRate, float& groundSpeed) co
 	}
 }
 
+float StudioModelEntity::GetRootMotionSpeed() const
+{
+	return studiomdl::GetRootMotionSpeed(*_editableModel->Sequences[_sequence]);
+}
+
 int StudioModelEntity::GetBodyValueForGroup(int group) const
 {
 	if (!_editableModel)
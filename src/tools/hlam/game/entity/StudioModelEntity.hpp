@@ -79,6 +79,19 @@ public:
 	*/
 	void SetFrame(float frame);
 
+	/**
+	*	@brief Gets the frame to render, interpolated between the previous and current simulation step.
+	*/
+	float GetInterpolatedFrame() const;
+
+	/**
+	*	@brief Makes the interpolated frame equal to the current frame until the next call to AdvanceFrame.
+	*/
+	void ResetFrameInterpolation()
+	{
+		_previousFrame = _frame;
+	}
+
 private:
 	studiomdl::EditableStudioModel* _editableModel = nullptr;
 
@@ -94,6 +107,7 @@ private:
 
 	float	_lastEventCheck = 0;				//Last time we checked for animation events.
 	float	_animTime = 0;				//Time when the frame was set.
+	float	_previousFrame = 0;			//Frame before the last call to AdvanceFrame. Can be negative if the frame wrapped.
 
 	StudioLoopingMode _loopingMode = StudioLoopingMode::AlwaysLoop;
 
@@ -163,6 +177,12 @@ public:
 	*/
 	void GetSequenceInfo(float& frameRate, float& groundSpeed) const;
 
+	/**
+	*	Gets the average ground speed of the current sequence, including movement of the motion bone.
+	*	Unlike the ground speed from GetSequenceInfo this is not limited to linear movement.
+	*/
+	float GetRootMotionSpeed() const;
+
 	/**
 	*	Gets the bodygroup.
 	*/
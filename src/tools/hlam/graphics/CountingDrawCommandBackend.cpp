@@ -0,0 +1,31 @@
+#include "graphics/CountingDrawCommandBackend.hpp"
+
+namespace graphics
+{
+void CountingDrawCommandBackend::Execute(const DrawCommandList& commands)
+{
+	++_listCount;
+
+	for (const auto& command : commands.GetCommands())
+	{
+		++_counts[static_cast<std::size_t>(command.Type)];
+	}
+
+	_commandCount += commands.GetCommands().size();
+
+	const auto& statistics = commands.GetStatistics();
+
+	_statistics.DrawCalls += statistics.DrawCalls;
+	_statistics.StateChanges += statistics.StateChanges;
+	_statistics.TextureBinds += statistics.TextureBinds;
+	_statistics.VertexCount += statistics.VertexCount;
+}
+
+void CountingDrawCommandBackend::Reset()
+{
+	_listCount = 0;
+	_commandCount = 0;
+	_counts.fill(0);
+	_statistics = {};
+}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "graphics/DrawCommandList.hpp"
+#include "graphics/IDrawCommandBackend.hpp"
+
+namespace graphics
+{
+/**
+*	@brief Counts the commands it is given instead of executing them. Does not require a graphics context.
+*	Used to check how many draw calls and state changes a frame makes
+*/
+class CountingDrawCommandBackend final : public IDrawCommandBackend
+{
+public:
+	void Execute(const DrawCommandList& commands) override;
+
+	/**
+	*	@brief Resets all counts, for instance at the start of a frame
+	*/
+	void Reset();
+
+	/**
+	*	@brief Number of lists that were executed
+	*/
+	unsigned int GetListCount() const { return _listCount; }
+
+	std::size_t GetCommandCount() const { return _commandCount; }
+
+	std::size_t GetCount(DrawCommandType type) const { return _counts[static_cast<std::size_t>(type)]; }
+
+	/**
+	*	@brief Totals of the statistics of all executed lists
+	*/
+	const DrawCommandStatistics& GetStatistics() const { return _statistics; }
+
+private:
+	//UniformMat4 is the last command type
+	static constexpr std::size_t CommandTypeCount = static_cast<std::size_t>(DrawCommandType::UniformMat4) + 1;
+
+	unsigned int _listCount = 0;
+	std::size_t _commandCount = 0;
+
+	std::array<std::size_t, CommandTypeCount> _counts{};
+
+	DrawCommandStatistics _statistics;
+};
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+
+#include "graphics/DebugDrawBatch.hpp"
+#include "graphics/DrawCommandList.hpp"
+
+namespace graphics
+{
+void DebugDrawBatch::Clear()
+{
+	_lines.clear();
+	_points.clear();
+}
+
+void DebugDrawBatch::AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& startColor, const glm::vec4& endColor)
+{
+	_lines.push_back(LineVertex{start, startColor});
+	_lines.push_back(LineVertex{end, endColor});
+}
+
+void DebugDrawBatch::AddPoint(const glm::vec3& position, const glm::vec4& color, float size)
+{
+	_points.push_back(Point{position, color, size});
+}
+
+void DebugDrawBatch::AddBox(const std::array<glm::vec3, 8>& points, const glm::vec4& color)
+{
+	//Even and odd points each form a face, with each even point connected to the next odd point
+	for (std::size_t i = 0; i < points.size(); i += 2)
+	{
+		AddLine(points[i], points[(i + 2) % points.size()], color);
+		AddLine(points[i + 1], points[(i + 3) % points.size()], color);
+		AddLine(points[i], points[i + 1], color);
+	}
+}
+
+void DebugDrawBatch::Flush(DrawCommandList& commands)
+{
+	if (!_lines.empty())
+	{
+		commands.Begin(GL_LINES);
+
+		for (const auto& vertex : _lines)
+		{
+			commands.Color(vertex.Color);
+			commands.Vertex(vertex.Position);
+		}
+
+		commands.End();
+	}
+
+	if (!_points.empty())
+	{
+		//Points keep the order they were added in within each size
+		std::stable_sort(_points.begin(), _points.end(), [](const auto& lhs, const auto& rhs)
+			{
+				return lhs.Size < rhs.Size;
+			});
+
+		for (auto it = _points.begin(); it != _points.end();)
+		{
+			const auto size = it->Size;
+
+			commands.PointSize(size);
+			commands.Begin(GL_POINTS);
+
+			for (; it != _points.end() && it->Size == size; ++it)
+			{
+				commands.Color(it->Color);
+				commands.Vertex(it->Position);
+			}
+
+			commands.End();
+		}
+
+		commands.PointSize(1.0f);
+	}
+
+	Clear();
+}
+}
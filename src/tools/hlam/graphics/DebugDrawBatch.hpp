@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace graphics
+{
+class DrawCommandList;
+
+/**
+*	@brief Accumulates debug lines, points and boxes so they can be drawn with one primitive per type
+*	instead of one per element. Memory is kept between flushes so a batch can be reused every frame.
+*/
+class DebugDrawBatch final
+{
+private:
+	struct LineVertex
+	{
+		glm::vec3 Position;
+		glm::vec4 Color;
+	};
+
+	struct Point
+	{
+		glm::vec3 Position;
+		glm::vec4 Color;
+		float Size;
+	};
+
+public:
+	DebugDrawBatch() = default;
+	~DebugDrawBatch() = default;
+
+	DebugDrawBatch(const DebugDrawBatch&) = delete;
+	DebugDrawBatch& operator=(const DebugDrawBatch&) = delete;
+
+	bool IsEmpty() const { return _lines.empty() && _points.empty(); }
+
+	void Clear();
+
+	void AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& startColor, const glm::vec4& endColor);
+
+	void AddLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color)
+	{
+		AddLine(start, end, color, color);
+	}
+
+	void AddPoint(const glm::vec3& position, const glm::vec4& color, float size);
+
+	/**
+	*	@brief Adds the 12 edges of a box. The points are in the order returned by CreateBoxFromBounds
+	*/
+	void AddBox(const std::array<glm::vec3, 8>& points, const glm::vec4& color);
+
+	/**
+	*	@brief Records all lines as one primitive and all points as one primitive per point size, then clears the batch.
+	*	The point size is reset to 1 afterwards. Other state is left to the caller
+	*/
+	void Flush(DrawCommandList& commands);
+
+private:
+	std::vector<LineVertex> _lines;
+	std::vector<Point> _points;
+};
+}
@@ -0,0 +1,312 @@
+#include <cassert>
+
+#include "graphics/DrawCommandList.hpp"
+
+namespace graphics
+{
+void DrawCommandList::Clear()
+{
+	assert(!_inPrimitive);
+
+	_commands.clear();
+	_vertices.clear();
+	_matrices.clear();
+	_statistics = {};
+}
+
+DrawCommand& DrawCommandList::Add(DrawCommandType type, GLenum target, GLuint value)
+{
+	assert(!_inPrimitive);
+
+	auto& command = _commands.emplace_back();
+
+	command.Type = type;
+	command.Target = target;
+	command.Value = value;
+
+	return command;
+}
+
+DrawCommand& DrawCommandList::AddStateChange(DrawCommandType type, GLenum target, GLuint value)
+{
+	++_statistics.StateChanges;
+	return Add(type, target, value);
+}
+
+void DrawCommandList::Enable(GLenum capability)
+{
+	if (capability == GL_TEXTURE_2D)
+	{
+		_texturing = true;
+	}
+
+	AddStateChange(DrawCommandType::Enable, capability);
+}
+
+void DrawCommandList::Disable(GLenum capability)
+{
+	if (capability == GL_TEXTURE_2D)
+	{
+		_texturing = false;
+	}
+
+	AddStateChange(DrawCommandType::Disable, capability);
+}
+
+void DrawCommandList::BlendFunc(GLenum source, GLenum destination)
+{
+	AddStateChange(DrawCommandType::BlendFunc, source, destination);
+}
+
+void DrawCommandList::DepthMask(bool enable)
+{
+	AddStateChange(DrawCommandType::DepthMask, 0, enable ? GL_TRUE : GL_FALSE);
+}
+
+void DrawCommandList::DepthFunc(GLenum function)
+{
+	AddStateChange(DrawCommandType::DepthFunc, function);
+}
+
+void DrawCommandList::AlphaFunc(GLenum function, float reference)
+{
+	AddStateChange(DrawCommandType::AlphaFunc, function).Vector.x = reference;
+}
+
+void DrawCommandList::PolygonMode(GLenum mode)
+{
+	AddStateChange(DrawCommandType::PolygonMode, mode);
+}
+
+void DrawCommandList::PointSize(float size)
+{
+	AddStateChange(DrawCommandType::PointSize).Vector.x = size;
+}
+
+void DrawCommandList::PushAttrib(GLbitfield mask)
+{
+	_attribStack.emplace_back(mask, _texturing);
+	Add(DrawCommandType::PushAttrib, mask);
+}
+
+void DrawCommandList::PopAttrib()
+{
+	assert(!_attribStack.empty());
+
+	const auto [mask, texturing] = _attribStack.back();
+
+	if (mask & GL_ENABLE_BIT)
+	{
+		_texturing = texturing;
+	}
+
+	_attribStack.pop_back();
+
+	AddStateChange(DrawCommandType::PopAttrib);
+}
+
+void DrawCommandList::ActiveTexture(GLenum unit)
+{
+	AddStateChange(DrawCommandType::ActiveTexture, unit);
+}
+
+void DrawCommandList::BindTexture(GLuint texture, GLenum target)
+{
+	++_statistics.TextureBinds;
+	AddStateChange(DrawCommandType::BindTexture, target, texture);
+}
+
+void DrawCommandList::PushMatrix()
+{
+	Add(DrawCommandType::PushMatrix);
+}
+
+void DrawCommandList::PopMatrix()
+{
+	Add(DrawCommandType::PopMatrix);
+}
+
+void DrawCommandList::Translate(const glm::vec3& translation)
+{
+	Add(DrawCommandType::Translate).Vector = glm::vec4{translation, 0};
+}
+
+void DrawCommandList::Rotate(float degrees, const glm::vec3& axis)
+{
+	Add(DrawCommandType::Rotate).Vector = glm::vec4{axis, degrees};
+}
+
+void DrawCommandList::MultMatrix(const glm::mat4& matrix)
+{
+	Add(DrawCommandType::MultMatrix).Offset = _matrices.size();
+	_matrices.push_back(matrix);
+}
+
+void DrawCommandList::Color(const glm::vec4& color)
+{
+	_currentColor = color;
+
+	if (_inPrimitive)
+	{
+		_hasColor = true;
+	}
+	else
+	{
+		Add(DrawCommandType::Color).Vector = color;
+	}
+}
+
+void DrawCommandList::TexCoord(const glm::vec2& texCoord)
+{
+	assert(_inPrimitive);
+
+	_currentTexCoord = texCoord;
+	_hasTexCoord = true;
+}
+
+void DrawCommandList::Begin(GLenum mode)
+{
+	auto& command = Add(DrawCommandType::Primitive, mode);
+
+	command.Offset = _vertices.size();
+
+	_primitive = _commands.size() - 1;
+	_inPrimitive = true;
+	_hasColor = false;
+	_hasTexCoord = false;
+
+	++_statistics.DrawCalls;
+}
+
+void DrawCommandList::Vertex(const glm::vec3& position)
+{
+	assert(_inPrimitive);
+
+	_vertices.push_back(DrawVertex{position, _currentColor, _currentTexCoord, _hasColor, _hasTexCoord});
+}
+
+void DrawCommandList::End()
+{
+	assert(_inPrimitive);
+
+	auto& command = _commands[_primitive];
+
+	command.Count = static_cast<GLsizei>(_vertices.size() - command.Offset);
+
+	_statistics.VertexCount += command.Count;
+
+	//Color changes inside the primitive persist after it, as they do in OpenGL
+	_inPrimitive = false;
+}
+
+void DrawCommandList::BindBuffer(GLenum target, GLuint buffer)
+{
+	AddStateChange(DrawCommandType::BindBuffer, target, buffer);
+}
+
+void DrawCommandList::EnableClientState(GLenum array)
+{
+	AddStateChange(DrawCommandType::EnableClientState, array);
+}
+
+void DrawCommandList::DisableClientState(GLenum array)
+{
+	AddStateChange(DrawCommandType::DisableClientState, array);
+}
+
+void DrawCommandList::ArrayPointer(GLenum array, GLint components, std::size_t offset)
+{
+	auto& command = AddStateChange(DrawCommandType::ArrayPointer, array);
+
+	command.Index = components;
+	command.Offset = offset;
+}
+
+void DrawCommandList::DrawElements(GLenum mode, GLsizei count, std::size_t offset)
+{
+	auto& command = Add(DrawCommandType::DrawElements, mode);
+
+	command.Count = count;
+	command.Offset = offset;
+
+	++_statistics.DrawCalls;
+	_statistics.VertexCount += count;
+}
+
+void DrawCommandList::DrawElementsInstanced(GLenum mode, GLsizei count, std::size_t offset, GLsizei instanceCount)
+{
+	auto& command = Add(DrawCommandType::DrawElementsInstanced, mode, static_cast<GLuint>(instanceCount));
+
+	command.Count = count;
+	command.Offset = offset;
+
+	++_statistics.DrawCalls;
+	_statistics.VertexCount += static_cast<std::size_t>(count) * instanceCount;
+}
+
+void DrawCommandList::UseProgram(GLuint program)
+{
+	AddStateChange(DrawCommandType::UseProgram, 0, program);
+}
+
+void DrawCommandList::EnableVertexAttribArray(GLuint index)
+{
+	AddStateChange(DrawCommandType::EnableVertexAttribArray, 0, index);
+}
+
+void DrawCommandList::DisableVertexAttribArray(GLuint index)
+{
+	AddStateChange(DrawCommandType::DisableVertexAttribArray, 0, index);
+}
+
+void DrawCommandList::VertexAttribPointer(GLuint index, GLint components, GLsizei stride, std::size_t offset)
+{
+	auto& command = AddStateChange(DrawCommandType::VertexAttribPointer, 0, index);
+
+	command.Index = components;
+	command.Count = stride;
+	command.Offset = offset;
+}
+
+void DrawCommandList::Uniform(GLint location, int value)
+{
+	auto& command = Add(DrawCommandType::UniformInt, 0, static_cast<GLuint>(value));
+
+	command.Index = location;
+}
+
+void DrawCommandList::Uniform(GLint location, float value)
+{
+	auto& command = Add(DrawCommandType::UniformFloat);
+
+	command.Index = location;
+	command.Vector.x = value;
+}
+
+void DrawCommandList::Uniform(GLint location, const glm::vec3& value)
+{
+	auto& command = Add(DrawCommandType::UniformVec3);
+
+	command.Index = location;
+	command.Vector = glm::vec4{value, 0};
+}
+
+void DrawCommandList::Uniform(GLint location, const glm::vec4& value)
+{
+	auto& command = Add(DrawCommandType::UniformVec4);
+
+	command.Index = location;
+	command.Vector = value;
+}
+
+void DrawCommandList::Uniform(GLint location, const glm::mat4* matrices, std::size_t count)
+{
+	auto& command = Add(DrawCommandType::UniformMat4);
+
+	command.Index = location;
+	command.Count = static_cast<GLsizei>(count);
+	command.Offset = _matrices.size();
+
+	_matrices.insert(_matrices.end(), matrices, matrices + count);
+}
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "graphics/OpenGL.hpp"
+
+namespace graphics
+{
+enum class DrawCommandType
+{
+	Enable = 0,
+	Disable,
+	BlendFunc,
+	DepthMask,
+	DepthFunc,
+	AlphaFunc,
+	PolygonMode,
+	PointSize,
+	PushAttrib,
+	PopAttrib,
+
+	ActiveTexture,
+	BindTexture,
+
+	PushMatrix,
+	PopMatrix,
+	Translate,
+	Rotate,
+	//Offset is the index of the recorded matrix
+	MultMatrix,
+
+	Color,
+
+	//Immediate mode primitive. Offset and Count refer to the recorded vertices
+	Primitive,
+
+	BindBuffer,
+	EnableClientState,
+	DisableClientState,
+	ArrayPointer,
+	DrawElements,
+	//Value is the number of instances
+	DrawElementsInstanced,
+
+	UseProgram,
+	EnableVertexAttribArray,
+	DisableVertexAttribArray,
+	VertexAttribPointer,
+	UniformInt,
+	UniformFloat,
+	UniformVec3,
+	UniformVec4,
+	//Offset is the index of the first recorded matrix, Count the number of matrices
+	UniformMat4
+};
+
+/**
+*	@brief A single recorded command. Which members are used depends on the type
+*/
+struct DrawCommand
+{
+	DrawCommandType Type;
+
+	//Capability, mode, target or function
+	GLenum Target = 0;
+
+	//Second enum argument, object name or boolean value
+	GLuint Value = 0;
+
+	//Uniform location, attribute index or number of components
+	GLint Index = 0;
+
+	//Vertex or index count, or attribute stride
+	GLsizei Count = 0;
+
+	//First vertex or buffer offset
+	std::size_t Offset = 0;
+
+	glm::vec4 Vector{0};
+};
+
+/**
+*	@brief A vertex of an immediate mode primitive, with the attributes that were current when it was emitted
+*/
+struct DrawVertex
+{
+	glm::vec3 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+
+	//Whether the attributes were set inside the primitive. Otherwise the current state is used
+	bool HasColor;
+	bool HasTexCoord;
+};
+
+/**
+*	@brief Totals of the commands recorded in a list
+*/
+struct DrawCommandStatistics
+{
+	//Primitives and element draws
+	unsigned int DrawCalls = 0;
+
+	//Commands that change state other than the current color, matrices and uniforms
+	unsigned int StateChanges = 0;
+
+	unsigned int TextureBinds = 0;
+
+	//Immediate mode vertices and drawn elements
+	std::size_t VertexCount = 0;
+};
+
+/**
+*	@brief Records draw calls and state changes so they can be inspected or replayed by a backend.
+*	Mirrors the subset of OpenGL used to draw models and debug geometry.
+*	Recording does not require a graphics context; resource uploads and state queries are not recorded.
+*/
+class DrawCommandList final
+{
+public:
+	DrawCommandList() = default;
+	~DrawCommandList() = default;
+
+	DrawCommandList(const DrawCommandList&) = delete;
+	DrawCommandList& operator=(const DrawCommandList&) = delete;
+
+	const std::vector<DrawCommand>& GetCommands() const { return _commands; }
+
+	const std::vector<DrawVertex>& GetVertices() const { return _vertices; }
+
+	const std::vector<glm::mat4>& GetMatrices() const { return _matrices; }
+
+	const DrawCommandStatistics& GetStatistics() const { return _statistics; }
+
+	bool IsEmpty() const { return _commands.empty(); }
+
+	/**
+	*	@brief Whether GL_TEXTURE_2D is enabled according to the commands recorded so far, including those of earlier lists.
+	*	Lets recorders depend on the texturing state without querying the graphics context
+	*/
+	bool IsTexturingEnabled() const { return _texturing; }
+
+	/**
+	*	@brief Removes all commands. Memory is kept so lists can be reused every frame.
+	*	Tracked state is kept since it still applies once the commands have been executed
+	*/
+	void Clear();
+
+	void Enable(GLenum capability);
+	void Disable(GLenum capability);
+	void BlendFunc(GLenum source, GLenum destination);
+	void DepthMask(bool enable);
+	void DepthFunc(GLenum function);
+	void AlphaFunc(GLenum function, float reference);
+	void PolygonMode(GLenum mode);
+	void PointSize(float size);
+	void PushAttrib(GLbitfield mask);
+	void PopAttrib();
+
+	void ActiveTexture(GLenum unit);
+	void BindTexture(GLuint texture, GLenum target = GL_TEXTURE_2D);
+
+	void PushMatrix();
+	void PopMatrix();
+	void Translate(const glm::vec3& translation);
+	void Rotate(float degrees, const glm::vec3& axis);
+	void MultMatrix(const glm::mat4& matrix);
+
+	/**
+	*	@brief Sets the current color. Inside a primitive it is stored with the vertices emitted after it
+	*/
+	void Color(const glm::vec4& color);
+
+	void Color(const glm::vec3& color)
+	{
+		Color(glm::vec4{color, 1});
+	}
+
+	/**
+	*	@brief Sets the current texture coordinates. Only valid inside a primitive
+	*/
+	void TexCoord(const glm::vec2& texCoord);
+
+	void Begin(GLenum mode);
+	void Vertex(const glm::vec3& position);
+	void End();
+
+	void BindBuffer(GLenum target, GLuint buffer);
+	void EnableClientState(GLenum array);
+	void DisableClientState(GLenum array);
+
+	/**
+	*	@brief Sets the float pointer of a client state array to an offset in the bound array buffer
+	*/
+	void ArrayPointer(GLenum array, GLint components, std::size_t offset);
+
+	/**
+	*	@brief Draws unsigned int indices from the bound element array buffer
+	*/
+	void DrawElements(GLenum mode, GLsizei count, std::size_t offset);
+
+	/**
+	*	@brief Draws unsigned int indices from the bound element array buffer multiple times.
+	*	Requires GL_ARB_draw_instanced
+	*/
+	void DrawElementsInstanced(GLenum mode, GLsizei count, std::size_t offset, GLsizei instanceCount);
+
+	void UseProgram(GLuint program);
+	void EnableVertexAttribArray(GLuint index);
+	void DisableVertexAttribArray(GLuint index);
+
+	/**
+	*	@brief Sets a float attribute pointer to an offset in the bound array buffer
+	*/
+	void VertexAttribPointer(GLuint index, GLint components, GLsizei stride, std::size_t offset);
+
+	void Uniform(GLint location, int value);
+	void Uniform(GLint location, float value);
+	void Uniform(GLint location, const glm::vec3& value);
+	void Uniform(GLint location, const glm::vec4& value);
+
+	/**
+	*	@brief Sets an array of matrices. The matrices are copied
+	*/
+	void Uniform(GLint location, const glm::mat4* matrices, std::size_t count);
+
+private:
+	DrawCommand& Add(DrawCommandType type, GLenum target = 0, GLuint value = 0);
+
+	DrawCommand& AddStateChange(DrawCommandType type, GLenum target = 0, GLuint value = 0);
+
+private:
+	std::vector<DrawCommand> _commands;
+	std::vector<DrawVertex> _vertices;
+	std::vector<glm::mat4> _matrices;
+
+	DrawCommandStatistics _statistics;
+
+	//Index of the primitive being recorded, if any
+	std::size_t _primitive = 0;
+	bool _inPrimitive = false;
+
+	//Disabled by default, like in OpenGL
+	bool _texturing = false;
+
+	//Attribute masks pushed by PushAttrib, with the texturing state to restore if the enable bit was pushed
+	std::vector<std::pair<GLbitfield, bool>> _attribStack;
+
+	glm::vec4 _currentColor{1};
+	glm::vec2 _currentTexCoord{0};
+	bool _hasColor = false;
+	bool _hasTexCoord = false;
+};
+}
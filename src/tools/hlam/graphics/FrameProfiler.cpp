@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+
+#include "graphics/FrameProfiler.hpp"
+
+namespace graphics
+{
+const char* ProfileStageToString(ProfileStage stage)
+{
+	switch (stage)
+	{
+	case ProfileStage::Simulation: return "Simulation";
+	case ProfileStage::SceneDraw: return "Scene draw";
+	case ProfileStage::BoneSetup: return "Bone setup";
+	case ProfileStage::Skinning: return "Skinning and lighting";
+	case ProfileStage::Submission: return "Submission";
+	case ProfileStage::Shadows: return "Shadows";
+	case ProfileStage::DebugOverlays: return "Debug overlays";
+	case ProfileStage::MirroredModel: return "Mirrored model";
+	case ProfileStage::Crowd: return "Crowd preview";
+
+	default: return "Unknown";
+	}
+}
+
+void FrameProfiler::SetEnabled(bool value)
+{
+	if (_enabled == value)
+	{
+		return;
+	}
+
+	_enabled = value;
+
+	if (_enabled)
+	{
+		//Keep numbering frames so GPU results still in flight can't be matched to new frames
+		const auto nextFrameNumber = _current.FrameNumber + 1;
+
+		_frames.clear();
+		_current = {};
+		_current.FrameNumber = nextFrameNumber;
+	}
+
+	_inFrame = false;
+}
+
+void FrameProfiler::BeginFrame()
+{
+	if (!_enabled)
+	{
+		return;
+	}
+
+	_inFrame = true;
+	_frameStart = Clock::now();
+}
+
+void FrameProfiler::EndFrame()
+{
+	if (!_enabled || !_inFrame)
+	{
+		return;
+	}
+
+	_inFrame = false;
+
+	const std::chrono::duration<double, std::milli> elapsed = Clock::now() - _frameStart;
+
+	_current.FrameTime = elapsed.count();
+
+	if (_frames.size() >= MaxFrames)
+	{
+		_frames.pop_front();
+	}
+
+	_frames.push_back(_current);
+
+	const auto nextFrameNumber = _current.FrameNumber + 1;
+
+	_current = {};
+	_current.FrameNumber = nextFrameNumber;
+}
+
+void FrameProfiler::AddStageTime(ProfileStage stage, double milliseconds)
+{
+	assert(stage >= ProfileStage::Simulation && stage < ProfileStage::Count);
+
+	if (!_enabled)
+	{
+		return;
+	}
+
+	_current.Stages[static_cast<std::size_t>(stage)] += milliseconds;
+}
+
+void FrameProfiler::SetGPUTime(std::uint64_t frameNumber, double milliseconds)
+{
+	if (!_enabled)
+	{
+		return;
+	}
+
+	//Frame numbers are sequential, so the frame can be found from the back
+	for (auto it = _frames.rbegin(); it != _frames.rend(); ++it)
+	{
+		if (it->FrameNumber == frameNumber)
+		{
+			it->GPUTime = milliseconds;
+			break;
+		}
+
+		if (it->FrameNumber < frameNumber)
+		{
+			break;
+		}
+	}
+}
+
+FrameTimings FrameProfiler::GetAverage() const
+{
+	FrameTimings average;
+
+	if (_frames.empty())
+	{
+		return average;
+	}
+
+	double gpuTime = 0;
+	std::size_t gpuFrames = 0;
+
+	for (const auto& frame : _frames)
+	{
+		average.FrameTime += frame.FrameTime;
+
+		if (frame.GPUTime >= 0)
+		{
+			gpuTime += frame.GPUTime;
+			++gpuFrames;
+		}
+
+		for (std::size_t i = 0; i < ProfileStageCount; ++i)
+		{
+			average.Stages[i] += frame.Stages[i];
+		}
+	}
+
+	average.FrameNumber = _frames.back().FrameNumber;
+	average.FrameTime /= _frames.size();
+
+	if (gpuFrames > 0)
+	{
+		average.GPUTime = gpuTime / gpuFrames;
+	}
+
+	for (auto& stage : average.Stages)
+	{
+		stage /= _frames.size();
+	}
+
+	return average;
+}
+
+FrameTimings FrameProfiler::GetMaximum() const
+{
+	FrameTimings maximum;
+
+	if (_frames.empty())
+	{
+		return maximum;
+	}
+
+	for (const auto& frame : _frames)
+	{
+		maximum.FrameTime = std::max(maximum.FrameTime, frame.FrameTime);
+		maximum.GPUTime = std::max(maximum.GPUTime, frame.GPUTime);
+
+		for (std::size_t i = 0; i < ProfileStageCount; ++i)
+		{
+			maximum.Stages[i] = std::max(maximum.Stages[i], frame.Stages[i]);
+		}
+	}
+
+	maximum.FrameNumber = _frames.back().FrameNumber;
+
+	return maximum;
+}
+
+void FrameProfiler::WriteCSV(FILE* file) const
+{
+	assert(file);
+
+	fprintf(file, "Frame,Frame time (ms),GPU time (ms)");
+
+	for (std::size_t i = 0; i < ProfileStageCount; ++i)
+	{
+		fprintf(file, ",%s (ms)", ProfileStageToString(static_cast<ProfileStage>(i)));
+	}
+
+	fprintf(file, "\n");
+
+	for (const auto& frame : _frames)
+	{
+		fprintf(file, "%" PRIu64 ",%.4f,", frame.FrameNumber, frame.FrameTime);
+
+		//Leave the GPU time empty if it wasn't measured
+		if (frame.GPUTime >= 0)
+		{
+			fprintf(file, "%.4f", frame.GPUTime);
+		}
+
+		for (const auto stage : frame.Stages)
+		{
+			fprintf(file, ",%.4f", stage);
+		}
+
+		fprintf(file, "\n");
+	}
+}
+
+GPUFrameTimer::~GPUFrameTimer()
+{
+	//Must be destroyed while the context is current
+	assert(!_created);
+}
+
+void GPUFrameTimer::Create()
+{
+	if (_created)
+	{
+		return;
+	}
+
+	//Timestamp queries are core in OpenGL 3.3
+	if (!GLEW_ARB_timer_query && !GLEW_VERSION_3_3)
+	{
+		return;
+	}
+
+	for (auto& query : _queries)
+	{
+		glGenQueries(1, &query.BeginQuery);
+		glGenQueries(1, &query.EndQuery);
+		query.Pending = false;
+	}
+
+	_nextQuery = 0;
+	_activeQuery = nullptr;
+	_created = true;
+}
+
+void GPUFrameTimer::Destroy()
+{
+	if (!_created)
+	{
+		return;
+	}
+
+	for (auto& query : _queries)
+	{
+		glDeleteQueries(1, &query.BeginQuery);
+		glDeleteQueries(1, &query.EndQuery);
+		query = {};
+	}
+
+	_activeQuery = nullptr;
+	_created = false;
+}
+
+void GPUFrameTimer::BeginFrame(FrameProfiler& profiler)
+{
+	_activeQuery = nullptr;
+
+	if (!_created || !profiler.IsEnabled())
+	{
+		return;
+	}
+
+	CollectResults(profiler);
+
+	auto& query = _queries[_nextQuery];
+
+	//All queries are still in flight; skip this frame instead of waiting for the GPU
+	if (query.Pending)
+	{
+		return;
+	}
+
+	glQueryCounter(query.BeginQuery, GL_TIMESTAMP);
+
+	query.FrameNumber = profiler.GetCurrentFrameNumber();
+
+	_activeQuery = &query;
+	_nextQuery = (_nextQuery + 1) % _queries.size();
+}
+
+void GPUFrameTimer::EndFrame()
+{
+	if (!_activeQuery)
+	{
+		return;
+	}
+
+	glQueryCounter(_activeQuery->EndQuery, GL_TIMESTAMP);
+
+	_activeQuery->Pending = true;
+	_activeQuery = nullptr;
+}
+
+void GPUFrameTimer::CollectResults(FrameProfiler& profiler)
+{
+	for (auto& query : _queries)
+	{
+		if (!query.Pending)
+		{
+			continue;
+		}
+
+		GLint available = GL_FALSE;
+
+		//The end timestamp is written last, so the begin timestamp is available if it is
+		glGetQueryObjectiv(query.EndQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available == GL_FALSE)
+		{
+			continue;
+		}
+
+		GLuint64 begin = 0;
+		GLuint64 end = 0;
+
+		glGetQueryObjectui64v(query.BeginQuery, GL_QUERY_RESULT, &begin);
+		glGetQueryObjectui64v(query.EndQuery, GL_QUERY_RESULT, &end);
+
+		query.Pending = false;
+
+		profiler.SetGPUTime(query.FrameNumber, (end - begin) / 1'000'000.0);
+	}
+}
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+
+#include "graphics/OpenGL.hpp"
+
+namespace graphics
+{
+enum class ProfileStage
+{
+	//Fixed rate simulation updates, including everything connected to the editor tick
+	Simulation = 0,
+	SceneDraw,
+	BoneSetup,
+
+	//Vertex transformation, lighting and buffer uploads. On the GPU skinning path this only uploads the bone data
+	Skinning,
+
+	//Recording mesh draws and executing all recorded commands
+	Submission,
+
+	//Shadows and overlays are only recorded here; executing them is part of submission
+	Shadows,
+	DebugOverlays,
+	MirroredModel,
+
+	//Drawing the additional instances of the crowd preview
+	Crowd,
+
+	Count
+};
+
+constexpr std::size_t ProfileStageCount = static_cast<std::size_t>(ProfileStage::Count);
+
+const char* ProfileStageToString(ProfileStage stage);
+
+/**
+*	@brief Times measured for a single frame, in milliseconds
+*/
+struct FrameTimings
+{
+	std::uint64_t FrameNumber = 0;
+
+	//CPU time between the start and end of the frame
+	double FrameTime = 0;
+
+	//Time the GPU spent executing the frame. Negative if it was not measured
+	double GPUTime = -1;
+
+	//Stages can be nested (e.g. the mirrored model includes a model draw), so these don't add up to the frame time
+	std::array<double, ProfileStageCount> Stages{};
+};
+
+/**
+*	@brief Collects per-stage CPU timings and GPU frame times for the most recent frames.
+*	Does nothing while disabled, so scoped timers can be left in place.
+*/
+class FrameProfiler final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t MaxFrames = 120;
+
+	FrameProfiler() = default;
+	~FrameProfiler() = default;
+
+	FrameProfiler(const FrameProfiler&) = delete;
+	FrameProfiler& operator=(const FrameProfiler&) = delete;
+
+	bool IsEnabled() const { return _enabled; }
+
+	/**
+	*	@brief Enabling the profiler discards previously collected frames
+	*/
+	void SetEnabled(bool value);
+
+	std::uint64_t GetCurrentFrameNumber() const { return _current.FrameNumber; }
+
+	const std::deque<FrameTimings>& GetFrames() const { return _frames; }
+
+	void BeginFrame();
+
+	void EndFrame();
+
+	void AddStageTime(ProfileStage stage, double milliseconds);
+
+	/**
+	*	@brief Stores the GPU time of a frame. GPU results arrive a few frames late
+	*/
+	void SetGPUTime(std::uint64_t frameNumber, double milliseconds);
+
+	/**
+	*	@brief Average of all collected frames. GPUTime is averaged over the frames that have it
+	*/
+	FrameTimings GetAverage() const;
+
+	FrameTimings GetMaximum() const;
+
+	void WriteCSV(FILE* file) const;
+
+private:
+	bool _enabled = false;
+	bool _inFrame = false;
+
+	Clock::time_point _frameStart;
+
+	//Stage times recorded between frames, like simulation updates, are counted towards the next frame
+	FrameTimings _current;
+
+	std::deque<FrameTimings> _frames;
+};
+
+/**
+*	@brief Adds the time spent in a scope to a stage. The profiler may be null
+*/
+class ScopedProfile final
+{
+public:
+	ScopedProfile(FrameProfiler* profiler, ProfileStage stage)
+		: _profiler(profiler && profiler->IsEnabled() ? profiler : nullptr)
+		, _stage(stage)
+	{
+		if (_profiler)
+		{
+			_start = FrameProfiler::Clock::now();
+		}
+	}
+
+	~ScopedProfile()
+	{
+		if (_profiler)
+		{
+			const std::chrono::duration<double, std::milli> elapsed = FrameProfiler::Clock::now() - _start;
+			_profiler->AddStageTime(_stage, elapsed.count());
+		}
+	}
+
+	ScopedProfile(const ScopedProfile&) = delete;
+	ScopedProfile& operator=(const ScopedProfile&) = delete;
+
+private:
+	FrameProfiler* const _profiler;
+	const ProfileStage _stage;
+	FrameProfiler::Clock::time_point _start;
+};
+
+/**
+*	@brief Measures GPU frame times using timestamp queries and reports them to a profiler.
+*	Query objects are not shared between contexts, so each context needs its own timer.
+*	Results are only read once available to avoid stalling the pipeline.
+*/
+class GPUFrameTimer final
+{
+public:
+	GPUFrameTimer() = default;
+	~GPUFrameTimer();
+
+	GPUFrameTimer(const GPUFrameTimer&) = delete;
+	GPUFrameTimer& operator=(const GPUFrameTimer&) = delete;
+
+	/**
+	*	@brief Creates the queries if supported. The context must be current
+	*/
+	void Create();
+
+	/**
+	*	@brief Destroys the queries. The context must be current
+	*/
+	void Destroy();
+
+	void BeginFrame(FrameProfiler& profiler);
+
+	void EndFrame();
+
+private:
+	void CollectResults(FrameProfiler& profiler);
+
+	struct PendingQuery
+	{
+		GLuint BeginQuery = 0;
+		GLuint EndQuery = 0;
+		std::uint64_t FrameNumber = 0;
+		bool Pending = false;
+	};
+
+	static constexpr std::size_t QueryCount = 4;
+
+	bool _created = false;
+
+	std::array<PendingQuery, QueryCount> _queries{};
+
+	std::size_t _nextQuery = 0;
+
+	//Query being recorded this frame, if any
+	PendingQuery* _activeQuery = nullptr;
+};
+}
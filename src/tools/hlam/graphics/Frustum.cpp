@@ -0,0 +1,65 @@
+#include <glm/geometric.hpp>
+
+#include "graphics/Frustum.hpp"
+
+namespace graphics
+{
+Frustum::Frustum(const glm::mat4& matrix)
+{
+	//Planes are combinations of the matrix rows, bounding clip space to -w <= x, y, z <= w
+	const glm::vec4 row0{matrix[0][0], matrix[1][0], matrix[2][0], matrix[3][0]};
+	const glm::vec4 row1{matrix[0][1], matrix[1][1], matrix[2][1], matrix[3][1]};
+	const glm::vec4 row2{matrix[0][2], matrix[1][2], matrix[2][2], matrix[3][2]};
+	const glm::vec4 row3{matrix[0][3], matrix[1][3], matrix[2][3], matrix[3][3]};
+
+	_planes[0] = row3 + row0;
+	_planes[1] = row3 - row0;
+	_planes[2] = row3 + row1;
+	_planes[3] = row3 - row1;
+	_planes[4] = row3 + row2;
+	_planes[5] = row3 - row2;
+
+	//Normalized so sphere radii can be compared with the distances
+	for (auto& plane : _planes)
+	{
+		const float length = glm::length(glm::vec3{plane});
+
+		if (length > 0)
+		{
+			plane /= length;
+		}
+	}
+}
+
+bool Frustum::IsBoxOutside(const glm::vec3& mins, const glm::vec3& maxs) const
+{
+	for (const auto& plane : _planes)
+	{
+		//Test the corner furthest along the plane normal. If it is outside, the whole box is
+		const glm::vec3 corner{
+			plane.x >= 0 ? maxs.x : mins.x,
+			plane.y >= 0 ? maxs.y : mins.y,
+			plane.z >= 0 ? maxs.z : mins.z};
+
+		if (glm::dot(glm::vec3{plane}, corner) + plane.w < 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool Frustum::IsSphereOutside(const glm::vec3& center, float radius) const
+{
+	for (const auto& plane : _planes)
+	{
+		if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace graphics
+{
+/**
+*	@brief The six planes of a view frustum, used to skip drawing objects that can't be visible
+*/
+class Frustum final
+{
+public:
+	Frustum() = default;
+
+	/**
+	*	@brief Extracts the planes from a model-view-projection matrix.
+	*	The planes are in the space the matrix transforms from, so a frustum built with a model's matrix can test its local bounds.
+	*/
+	explicit Frustum(const glm::mat4& matrix);
+
+	/**
+	*	@brief Whether the axis-aligned box is completely outside the frustum. Boxes that may be partially visible are not outside
+	*/
+	bool IsBoxOutside(const glm::vec3& mins, const glm::vec3& maxs) const;
+
+	bool IsSphereOutside(const glm::vec3& center, float radius) const;
+
+private:
+	//Normals point inwards. A point is inside a plane if dot(normal, point) + distance >= 0
+	std::array<glm::vec4, 6> _planes{};
+};
+}
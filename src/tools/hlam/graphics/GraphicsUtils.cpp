@@ -16,6 +16,7 @@
 
 #include "game/entity/StudioModelEntity.hpp"
 
+#include "graphics/DrawCommandList.hpp"
 #include "graphics/GraphicsUtils.hpp"
 #include "graphics/Palette.hpp"
 
@@ -59,7 +60,7 @@ void FlipImageVertically( const int iWidth, const int iHeight, byte* const pData
 	}
 }
 
-void DrawBackground( GLuint backgroundTexture )
+void DrawBackground( GLuint backgroundTexture, const glm::mat4& projection )
 {
 	if( backgroundTexture == GL_INVALID_TEXTURE_ID )
 		return;
@@ -67,7 +68,7 @@ void DrawBackground( GLuint backgroundTexture )
 	glDisable(GL_BLEND);
 
 	glMatrixMode( GL_PROJECTION );
-	glLoadIdentity();
+	glLoadMatrixf( glm::value_ptr( projection ) );
 
 	glOrtho( 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, -1.0f );
 
@@ -105,63 +106,61 @@ void DrawBackground( GLuint backgroundTexture )
 	glBindTexture( GL_TEXTURE_2D, 0 );
 }
 
-void DrawBox(const std::array<glm::vec3, 8>& points)
+void DrawBox(DrawCommandList& commands, const std::array<glm::vec3, 8>& points)
 {
-	glBegin(GL_QUAD_STRIP);
+	commands.Begin(GL_QUAD_STRIP);
 	for (int i = 0; i < 10; ++i)
 	{
-		glVertex3fv(glm::value_ptr(points[i & 7]));
+		commands.Vertex(points[i & 7]);
 	}
-	glEnd();
-
-	glBegin(GL_QUAD_STRIP);
-	glVertex3fv(glm::value_ptr(points[6]));
-	glVertex3fv(glm::value_ptr(points[0]));
-	glVertex3fv(glm::value_ptr(points[4]));
-	glVertex3fv(glm::value_ptr(points[2]));
-	glEnd();
-
-	glBegin(GL_QUAD_STRIP);
-	glVertex3fv(glm::value_ptr(points[1]));
-	glVertex3fv(glm::value_ptr(points[7]));
-	glVertex3fv(glm::value_ptr(points[3]));
-	glVertex3fv(glm::value_ptr(points[5]));
-	glEnd();
+	commands.End();
+
+	commands.Begin(GL_QUAD_STRIP);
+	commands.Vertex(points[6]);
+	commands.Vertex(points[0]);
+	commands.Vertex(points[4]);
+	commands.Vertex(points[2]);
+	commands.End();
+
+	commands.Begin(GL_QUAD_STRIP);
+	commands.Vertex(points[1]);
+	commands.Vertex(points[7]);
+	commands.Vertex(points[3]);
+	commands.Vertex(points[5]);
+	commands.End();
 }
 
-void DrawOutlinedBox(const std::array<glm::vec3, 8>& points, const glm::vec4& faceColor, const glm::vec4& borderColor)
+void DrawOutlinedBox(DrawCommandList& commands, const std::array<glm::vec3, 8>& points, const glm::vec4& faceColor, const glm::vec4& borderColor)
 {
-	glDisable(GL_TEXTURE_2D);
-	glEnable(GL_DEPTH_TEST);
+	commands.Disable(GL_TEXTURE_2D);
+	commands.Enable(GL_DEPTH_TEST);
 
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	commands.Enable(GL_BLEND);
+	commands.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	//Cull interior faces to avoid overlap
-	glEnable(GL_CULL_FACE);
+	commands.Enable(GL_CULL_FACE);
 
-	//Disable depth mask so lines can draw over the box itself
-	GLint depthMaskWasEnabled = GL_FALSE;
+	//Disable depth mask so lines can draw over the box itself, restored to its previous value afterwards
+	commands.PushAttrib(GL_DEPTH_BUFFER_BIT);
 
-	glGetIntegerv(GL_DEPTH_WRITEMASK, &depthMaskWasEnabled);
+	commands.DepthMask(false);
 
-	glDepthMask(GL_FALSE);
-
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-	glColor4fv(glm::value_ptr(faceColor));
+	commands.PolygonMode(GL_FILL);
+	commands.Color(faceColor);
 
-	DrawBox(points);
+	DrawBox(commands, points);
 
-	glDepthMask(GL_TRUE);
+	commands.DepthMask(true);
 
 	//Draw edges
-	glDisable(GL_CULL_FACE);
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	glColor4fv(glm::value_ptr(borderColor));
+	commands.Disable(GL_CULL_FACE);
+	commands.PolygonMode(GL_LINE);
+	commands.Color(borderColor);
 
-	DrawBox(points);
+	DrawBox(commands, points);
 
-	glDepthMask(depthMaskWasEnabled ? GL_TRUE : GL_FALSE);
+	commands.PopAttrib();
 }
 
 const std::string_view DmBaseName{"DM_Base.bmp"};
@@ -525,6 +524,11 @@ unsigned int DrawMirroredModel(studiomdl::IStudioModelRenderer& studioModelRende
 		flags |= renderer::DrawFlag::WIREFRAME_OVERLAY;
 	}
 
+	if (renderMode != RenderMode::TEXTURE_SHADED)
+	{
+		flags |= renderer::DrawFlag::NO_TEXTURES;
+	}
+
 	pEntity->Draw(flags);
 
 	glDisable(GL_CLIP_PLANE0);
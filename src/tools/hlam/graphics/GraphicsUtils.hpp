@@ -4,6 +4,7 @@
 #include <array>
 #include <string_view>
 
+#include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -23,6 +24,8 @@ class IStudioModelRenderer;
 
 namespace graphics
 {
+class DrawCommandList;
+
 /**
 *	Converts an 8 bit image to a 24 bit RGB image.
 */
@@ -39,8 +42,9 @@ void FlipImageVertically( const int iWidth, const int iHeight, byte* const pData
 /**
 *	Draws a background texture, fitted to the viewport.
 *	@param backgroundTexture OpenGL texture id that represents the background texture
+*	@param projection Matrix applied after the background's own projection, used to draw part of the viewport
 */
-void DrawBackground( GLuint backgroundTexture );
+void DrawBackground( GLuint backgroundTexture, const glm::mat4& projection = glm::mat4{1} );
 
 inline std::array<glm::vec3, 8> CreateBoxFromBounds(const glm::vec3& min, const glm::vec3& max)
 {
@@ -60,11 +64,11 @@ inline std::array<glm::vec3, 8> CreateBoxFromBounds(const glm::vec3& min, const
 }
 
 /**
-*	Draws a box using an array of 8 vectors as corner points.
+*	Records a box using an array of 8 vectors as corner points.
 */
-void DrawBox(const std::array<glm::vec3, 8>& points);
+void DrawBox(DrawCommandList& commands, const std::array<glm::vec3, 8>& points);
 
-void DrawOutlinedBox(const std::array<glm::vec3, 8>& points, const glm::vec4& faceColor, const glm::vec4& borderColor);
+void DrawOutlinedBox(DrawCommandList& commands, const std::array<glm::vec3, 8>& points, const glm::vec4& faceColor, const glm::vec4& borderColor);
 
 /**
 *	@brief Tests if the given filename is a remap name, and returns the remap ranges if so
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace graphics
+{
+class DrawCommandList;
+
+/**
+*	@brief Executes recorded draw commands
+*/
+class IDrawCommandBackend
+{
+public:
+	virtual ~IDrawCommandBackend() {}
+
+	virtual void Execute(const DrawCommandList& commands) = 0;
+};
+}
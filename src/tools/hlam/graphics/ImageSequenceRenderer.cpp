@@ -0,0 +1,85 @@
+#include <cassert>
+
+#include "graphics/ImageSequenceRenderer.hpp"
+#include "graphics/Scene.hpp"
+
+namespace graphics
+{
+ImageSequenceRenderer::ImageSequenceRenderer(Scene* scene, int width, int height, std::size_t imageCount)
+	: _scene(scene)
+	, _width(width)
+	, _height(height)
+	, _imageCount(imageCount)
+{
+	assert(_scene);
+	assert(_width > 0 && _height > 0);
+}
+
+ImageSequenceRenderer::~ImageSequenceRenderer()
+{
+	assert(!_framebuffer.IsValid());
+}
+
+bool ImageSequenceRenderer::Initialize()
+{
+	Shutdown();
+
+	if (!_framebuffer.Create(_width, _height))
+	{
+		return false;
+	}
+
+	_readbackQueue.Create(ReadbackBufferCount, _width, _height);
+
+	_nextImage = 0;
+	_completedImageCount = 0;
+
+	return true;
+}
+
+void ImageSequenceRenderer::Shutdown()
+{
+	_readbackQueue.Destroy();
+	_framebuffer.Destroy();
+}
+
+bool ImageSequenceRenderer::Step(const PrepareImage& prepareImage, const PixelReadbackQueue::Callback& imageReady, bool drawMore)
+{
+	if (!_framebuffer.IsValid() || IsComplete() || HasFailed())
+	{
+		return IsComplete();
+	}
+
+	_completedImageCount += _readbackQueue.Collect(imageReady);
+
+	//Drawing the remaining images is pointless
+	if (HasFailed())
+	{
+		return false;
+	}
+
+	if (drawMore && _nextImage < _imageCount && !_readbackQueue.IsFull())
+	{
+		_framebuffer.Bind();
+
+		//The whole image is a single tile
+		const ImageTile tile{0, 0, static_cast<unsigned int>(_width), static_cast<unsigned int>(_height)};
+
+		do
+		{
+			prepareImage(_nextImage);
+
+			_scene->DrawTile(_width, _height, tile);
+
+			_readbackQueue.Read(_nextImage, 0, 0, _width, _height);
+
+			++_nextImage;
+		}
+		while (_nextImage < _imageCount && !_readbackQueue.IsFull());
+
+		_framebuffer.Unbind();
+	}
+
+	return IsComplete();
+}
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "graphics/OffscreenFramebuffer.hpp"
+#include "graphics/PixelReadbackQueue.hpp"
+
+namespace graphics
+{
+class Scene;
+
+/**
+*	@brief Draws a sequence of images of the same size to an offscreen framebuffer and reads them back asynchronously.
+*	Each image is read into one of a ring of pixel buffers, so drawing the next images overlaps the copies.
+*	Drawing is split into steps that the caller can run in between handling events.
+*/
+class ImageSequenceRenderer final
+{
+public:
+	//Images that can be read back at the same time
+	static constexpr std::size_t ReadbackBufferCount = 3;
+
+	/**
+	*	@brief Sets up the scene to draw the image with the given index
+	*/
+	using PrepareImage = std::function<void(std::size_t index)>;
+
+	ImageSequenceRenderer(Scene* scene, int width, int height, std::size_t imageCount);
+	~ImageSequenceRenderer();
+
+	ImageSequenceRenderer(const ImageSequenceRenderer&) = delete;
+	ImageSequenceRenderer& operator=(const ImageSequenceRenderer&) = delete;
+
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+
+	std::size_t GetImageCount() const { return _imageCount; }
+
+	std::size_t GetCompletedImageCount() const { return _completedImageCount; }
+
+	bool IsComplete() const { return _completedImageCount == _imageCount; }
+
+	/**
+	*	@brief Whether an image could not be read back. The sequence can't be completed if so
+	*/
+	bool HasFailed() const { return _readbackQueue.GetFailedCount() > 0; }
+
+	/**
+	*	@brief Creates the framebuffer and readback buffers. The scene's graphics context must be current
+	*	@return Whether the resources were created successfully. Errors are logged
+	*/
+	bool Initialize();
+
+	/**
+	*	@brief Destroys the framebuffer and readback buffers. The scene's graphics context must be current
+	*/
+	void Shutdown();
+
+	/**
+	*	@brief Passes images that have been read back to @p imageReady, in order,
+	*	then draws images until all readback buffers are in use. The scene's graphics context must be current.
+	*	Does nothing once an image has failed to be read back
+	*	@param drawMore Whether to draw more images. Pass false to only collect images, for instance when their consumer is falling behind
+	*	@return Whether all images have been passed to @p imageReady
+	*/
+	bool Step(const PrepareImage& prepareImage, const PixelReadbackQueue::Callback& imageReady, bool drawMore = true);
+
+private:
+	Scene* const _scene;
+
+	const int _width;
+	const int _height;
+
+	const std::size_t _imageCount;
+
+	std::size_t _nextImage = 0;
+	std::size_t _completedImageCount = 0;
+
+	OffscreenFramebuffer _framebuffer;
+	PixelReadbackQueue _readbackQueue;
+};
+}
@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "core/shared/Logging.hpp"
+
+#include "graphics/OffscreenFramebuffer.hpp"
+
+namespace graphics
+{
+OffscreenFramebuffer::~OffscreenFramebuffer()
+{
+	Destroy();
+}
+
+int OffscreenFramebuffer::GetMaximumSize()
+{
+	GLint maxRenderbufferSize = 0;
+	glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+
+	GLint maxViewportSize[2]{};
+	glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewportSize);
+
+	return std::min({maxRenderbufferSize, maxViewportSize[0], maxViewportSize[1]});
+}
+
+bool OffscreenFramebuffer::Create(int width, int height)
+{
+	Destroy();
+
+	if (!GLEW_VERSION_3_0 && !GLEW_ARB_framebuffer_object)
+	{
+		Error("Cannot create offscreen framebuffer: framebuffer objects are not supported\n");
+		return false;
+	}
+
+	glGenRenderbuffers(1, &_colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, _colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+	//The scene uses the stencil buffer to draw mirrored models
+	glGenRenderbuffers(1, &_depthStencilBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, _depthStencilBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffers(1, &_framebuffer);
+
+	Bind();
+
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, _colorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, _depthStencilBuffer);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	Unbind();
+
+	if (status != GL_FRAMEBUFFER_COMPLETE)
+	{
+		Error("Error creating %d x %d offscreen framebuffer: %s\n", width, height, glFrameBufferStatusToString(status));
+		Destroy();
+		return false;
+	}
+
+	_width = width;
+	_height = height;
+
+	return true;
+}
+
+void OffscreenFramebuffer::Destroy()
+{
+	if (_framebuffer != 0)
+	{
+		glDeleteFramebuffers(1, &_framebuffer);
+		_framebuffer = 0;
+	}
+
+	if (_colorBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &_colorBuffer);
+		_colorBuffer = 0;
+	}
+
+	if (_depthStencilBuffer != 0)
+	{
+		glDeleteRenderbuffers(1, &_depthStencilBuffer);
+		_depthStencilBuffer = 0;
+	}
+
+	_width = 0;
+	_height = 0;
+}
+
+void OffscreenFramebuffer::Bind()
+{
+	//Windows may draw to a framebuffer object of their own instead of the default framebuffer
+	glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_previousFramebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, _framebuffer);
+}
+
+void OffscreenFramebuffer::Unbind()
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(_previousFramebuffer));
+	_previousFramebuffer = 0;
+}
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "graphics/OpenGL.hpp"
+
+namespace graphics
+{
+/**
+*	@brief Owns a framebuffer object with a color and a depth-stencil renderbuffer, used to draw without a window
+*/
+class OffscreenFramebuffer final
+{
+public:
+	OffscreenFramebuffer() = default;
+	~OffscreenFramebuffer();
+
+	OffscreenFramebuffer(const OffscreenFramebuffer&) = delete;
+	OffscreenFramebuffer& operator=(const OffscreenFramebuffer&) = delete;
+
+	/**
+	*	@brief Largest width and height supported by the current context
+	*/
+	static int GetMaximumSize();
+
+	bool IsValid() const { return _framebuffer != 0; }
+
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+
+	/**
+	*	@brief Creates the framebuffer, replacing the current one
+	*	@return Whether the framebuffer was created successfully. Errors are logged
+	*/
+	bool Create(int width, int height);
+
+	void Destroy();
+
+	/**
+	*	@brief Binds the framebuffer for drawing and reading. The previous binding is restored by Unbind
+	*/
+	void Bind();
+
+	void Unbind();
+
+private:
+	GLuint _framebuffer = 0;
+	GLuint _colorBuffer = 0;
+	GLuint _depthStencilBuffer = 0;
+
+	int _width = 0;
+	int _height = 0;
+
+	GLint _previousFramebuffer = 0;
+};
+}
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <vector>
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include "graphics/DrawCommandList.hpp"
+#include "graphics/OpenGLDrawCommandBackend.hpp"
+
+namespace graphics
+{
+namespace
+{
+/**
+*	@brief Draws recorded primitives with one call each, using client side arrays that point into the recorded vertices.
+*	Arrays stay enabled between consecutive primitives and are disabled before any other command.
+*/
+class PrimitiveArrays final
+{
+public:
+	explicit PrimitiveArrays(const std::vector<DrawVertex>& vertices)
+		: _vertices(vertices)
+	{
+	}
+
+	void Draw(const DrawCommand& command)
+	{
+		if (command.Count <= 0)
+		{
+			return;
+		}
+
+		const auto first = _vertices.begin() + command.Offset;
+		const auto last = first + command.Count;
+
+		const auto colors = std::count_if(first, last, [](const auto& vertex) { return vertex.HasColor; });
+		const auto texCoords = std::count_if(first, last, [](const auto& vertex) { return vertex.HasTexCoord; });
+
+		//Attributes that only some vertices set take the current value for the others, which arrays can't express
+		if ((colors != 0 && colors != command.Count) || (texCoords != 0 && texCoords != command.Count))
+		{
+			DrawImmediate(command);
+			return;
+		}
+
+		SetupPointers();
+
+		SetArrayEnabled(GL_VERTEX_ARRAY, _vertexArray, true);
+		SetArrayEnabled(GL_COLOR_ARRAY, _colorArray, colors != 0);
+		SetArrayEnabled(GL_TEXTURE_COORD_ARRAY, _texCoordArray, texCoords != 0);
+
+		glDrawArrays(command.Target, static_cast<GLint>(command.Offset), command.Count);
+
+		//Attributes set inside a primitive remain current after it
+		const auto& lastVertex = *(last - 1);
+
+		if (colors != 0)
+		{
+			glColor4fv(glm::value_ptr(lastVertex.Color));
+		}
+
+		if (texCoords != 0)
+		{
+			glTexCoord2fv(glm::value_ptr(lastVertex.TexCoord));
+		}
+	}
+
+	void Disable()
+	{
+		SetArrayEnabled(GL_VERTEX_ARRAY, _vertexArray, false);
+		SetArrayEnabled(GL_COLOR_ARRAY, _colorArray, false);
+		SetArrayEnabled(GL_TEXTURE_COORD_ARRAY, _texCoordArray, false);
+	}
+
+	void SetArrayBuffer(GLuint buffer)
+	{
+		_arrayBuffer = buffer;
+	}
+
+	/**
+	*	@brief Must be called when other commands set the array pointers
+	*/
+	void InvalidatePointers()
+	{
+		_pointersSet = false;
+	}
+
+private:
+	void SetupPointers()
+	{
+		if (_pointersSet)
+		{
+			return;
+		}
+
+		//Client side pointers are only used as such if no buffer is bound
+		//The binding state before the list is unknown, so it's always reset the first time
+		if (_arrayBuffer != 0)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+			_arrayBuffer = 0;
+		}
+
+		const auto& base = _vertices.front();
+
+		glVertexPointer(3, GL_FLOAT, sizeof(DrawVertex), glm::value_ptr(base.Position));
+		glColorPointer(4, GL_FLOAT, sizeof(DrawVertex), glm::value_ptr(base.Color));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(DrawVertex), glm::value_ptr(base.TexCoord));
+
+		_pointersSet = true;
+	}
+
+	static void SetArrayEnabled(GLenum array, bool& current, bool enable)
+	{
+		if (current != enable)
+		{
+			if (enable)
+			{
+				glEnableClientState(array);
+			}
+			else
+			{
+				glDisableClientState(array);
+			}
+
+			current = enable;
+		}
+	}
+
+	void DrawImmediate(const DrawCommand& command)
+	{
+		glBegin(command.Target);
+
+		for (std::size_t i = command.Offset; i < command.Offset + command.Count; ++i)
+		{
+			const auto& vertex = _vertices[i];
+
+			if (vertex.HasTexCoord)
+			{
+				glTexCoord2fv(glm::value_ptr(vertex.TexCoord));
+			}
+
+			if (vertex.HasColor)
+			{
+				glColor4fv(glm::value_ptr(vertex.Color));
+			}
+
+			glVertex3fv(glm::value_ptr(vertex.Position));
+		}
+
+		glEnd();
+	}
+
+private:
+	const std::vector<DrawVertex>& _vertices;
+
+	GLuint _arrayBuffer = ~0U;
+	bool _pointersSet = false;
+
+	bool _vertexArray = false;
+	bool _colorArray = false;
+	bool _texCoordArray = false;
+};
+}
+
+void OpenGLDrawCommandBackend::Execute(const DrawCommandList& commands)
+{
+	PrimitiveArrays primitives{commands.GetVertices()};
+
+	for (const auto& command : commands.GetCommands())
+	{
+		if (command.Type != DrawCommandType::Primitive)
+		{
+			primitives.Disable();
+		}
+
+		switch (command.Type)
+		{
+		case DrawCommandType::Enable:
+			glEnable(command.Target);
+			break;
+
+		case DrawCommandType::Disable:
+			glDisable(command.Target);
+			break;
+
+		case DrawCommandType::BlendFunc:
+			glBlendFunc(command.Target, command.Value);
+			break;
+
+		case DrawCommandType::DepthMask:
+			glDepthMask(static_cast<GLboolean>(command.Value));
+			break;
+
+		case DrawCommandType::DepthFunc:
+			glDepthFunc(command.Target);
+			break;
+
+		case DrawCommandType::AlphaFunc:
+			glAlphaFunc(command.Target, command.Vector.x);
+			break;
+
+		case DrawCommandType::PolygonMode:
+			glPolygonMode(GL_FRONT_AND_BACK, command.Target);
+			break;
+
+		case DrawCommandType::PointSize:
+			glPointSize(command.Vector.x);
+			break;
+
+		case DrawCommandType::PushAttrib:
+			glPushAttrib(command.Target);
+			break;
+
+		case DrawCommandType::PopAttrib:
+			glPopAttrib();
+			break;
+
+		case DrawCommandType::ActiveTexture:
+			glActiveTexture(command.Target);
+			break;
+
+		case DrawCommandType::BindTexture:
+			glBindTexture(command.Target, command.Value);
+			break;
+
+		case DrawCommandType::PushMatrix:
+			glPushMatrix();
+			break;
+
+		case DrawCommandType::PopMatrix:
+			glPopMatrix();
+			break;
+
+		case DrawCommandType::Translate:
+			glTranslatef(command.Vector.x, command.Vector.y, command.Vector.z);
+			break;
+
+		case DrawCommandType::Rotate:
+			glRotatef(command.Vector.w, command.Vector.x, command.Vector.y, command.Vector.z);
+			break;
+
+		case DrawCommandType::MultMatrix:
+			glMultMatrixf(glm::value_ptr(commands.GetMatrices()[command.Offset]));
+			break;
+
+		case DrawCommandType::Color:
+			glColor4fv(glm::value_ptr(command.Vector));
+			break;
+
+		case DrawCommandType::Primitive:
+			primitives.Draw(command);
+			break;
+
+		case DrawCommandType::BindBuffer:
+			glBindBuffer(command.Target, command.Value);
+
+			if (command.Target == GL_ARRAY_BUFFER)
+			{
+				primitives.SetArrayBuffer(command.Value);
+			}
+			break;
+
+		case DrawCommandType::EnableClientState:
+			glEnableClientState(command.Target);
+			break;
+
+		case DrawCommandType::DisableClientState:
+			glDisableClientState(command.Target);
+			break;
+
+		case DrawCommandType::ArrayPointer:
+		{
+			primitives.InvalidatePointers();
+
+			const auto pointer = reinterpret_cast<const void*>(command.Offset);
+
+			switch (command.Target)
+			{
+			case GL_VERTEX_ARRAY:
+				glVertexPointer(command.Index, GL_FLOAT, 0, pointer);
+				break;
+
+			case GL_COLOR_ARRAY:
+				glColorPointer(command.Index, GL_FLOAT, 0, pointer);
+				break;
+
+			case GL_TEXTURE_COORD_ARRAY:
+				glTexCoordPointer(command.Index, GL_FLOAT, 0, pointer);
+				break;
+			}
+			break;
+		}
+
+		case DrawCommandType::DrawElements:
+			glDrawElements(command.Target, command.Count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(command.Offset));
+			break;
+
+		case DrawCommandType::DrawElementsInstanced:
+			glDrawElementsInstancedARB(command.Target, command.Count, GL_UNSIGNED_INT, reinterpret_cast<const void*>(command.Offset),
+				static_cast<GLsizei>(command.Value));
+			break;
+
+		case DrawCommandType::UseProgram:
+			glUseProgram(command.Value);
+			break;
+
+		case DrawCommandType::EnableVertexAttribArray:
+			glEnableVertexAttribArray(command.Value);
+			break;
+
+		case DrawCommandType::DisableVertexAttribArray:
+			glDisableVertexAttribArray(command.Value);
+			break;
+
+		case DrawCommandType::VertexAttribPointer:
+			glVertexAttribPointer(command.Value, command.Index, GL_FLOAT, GL_FALSE, command.Count,
+				reinterpret_cast<const void*>(command.Offset));
+			break;
+
+		case DrawCommandType::UniformInt:
+			glUniform1i(command.Index, static_cast<GLint>(command.Value));
+			break;
+
+		case DrawCommandType::UniformFloat:
+			glUniform1f(command.Index, command.Vector.x);
+			break;
+
+		case DrawCommandType::UniformVec3:
+			glUniform3fv(command.Index, 1, glm::value_ptr(command.Vector));
+			break;
+
+		case DrawCommandType::UniformVec4:
+			glUniform4fv(command.Index, 1, glm::value_ptr(command.Vector));
+			break;
+
+		case DrawCommandType::UniformMat4:
+			glUniformMatrix4fv(command.Index, command.Count, GL_FALSE, glm::value_ptr(commands.GetMatrices()[command.Offset]));
+			break;
+		}
+	}
+
+	primitives.Disable();
+}
+}
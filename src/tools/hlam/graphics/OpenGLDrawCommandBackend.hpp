@@ -0,0 +1,15 @@
+#pragma once
+
+#include "graphics/IDrawCommandBackend.hpp"
+
+namespace graphics
+{
+/**
+*	@brief Replays recorded draw commands using the current OpenGL context
+*/
+class OpenGLDrawCommandBackend final : public IDrawCommandBackend
+{
+public:
+	void Execute(const DrawCommandList& commands) override;
+};
+}
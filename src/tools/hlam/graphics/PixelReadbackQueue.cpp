@@ -0,0 +1,149 @@
+#include <cassert>
+
+#include "core/shared/Logging.hpp"
+
+#include "graphics/PixelReadbackQueue.hpp"
+
+namespace graphics
+{
+PixelReadbackQueue::~PixelReadbackQueue()
+{
+	assert(!IsValid());
+}
+
+void PixelReadbackQueue::Create(std::size_t bufferCount, int maxWidth, int maxHeight)
+{
+	Destroy();
+
+	assert(bufferCount > 0);
+
+	//Fences are core in OpenGL 3.2. Without them mapping a buffer waits for its read to finish
+	_supportsFences = GLEW_ARB_sync || GLEW_VERSION_3_2;
+
+	_bufferSize = static_cast<std::size_t>(maxWidth) * maxHeight * 4;
+
+	_reads.resize(bufferCount);
+
+	for (auto& read : _reads)
+	{
+		glGenBuffers(1, &read.Buffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, read.Buffer);
+		glBufferData(GL_PIXEL_PACK_BUFFER, _bufferSize, nullptr, GL_STREAM_READ);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	_firstRead = 0;
+	_pendingCount = 0;
+	_failedCount = 0;
+}
+
+void PixelReadbackQueue::Destroy()
+{
+	for (auto& read : _reads)
+	{
+		if (read.Fence)
+		{
+			glDeleteSync(read.Fence);
+		}
+
+		glDeleteBuffers(1, &read.Buffer);
+	}
+
+	_reads.clear();
+	_bufferSize = 0;
+	_firstRead = 0;
+	_pendingCount = 0;
+}
+
+void PixelReadbackQueue::Read(std::uint64_t id, int x, int y, int width, int height)
+{
+	assert(!IsFull());
+	assert(static_cast<std::size_t>(width) * height * 4 <= _bufferSize);
+
+	auto& read = _reads[(_firstRead + _pendingCount) % _reads.size()];
+
+	read.Id = id;
+	read.Width = width;
+	read.Height = height;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, read.Buffer);
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 4);
+
+	//With a buffer bound this only queues the copy
+	glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (_supportsFences)
+	{
+		read.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+	else
+	{
+		read.CollectCount = _collectCount;
+		glFlush();
+	}
+
+	++_pendingCount;
+}
+
+std::size_t PixelReadbackQueue::Collect(const Callback& callback, bool wait)
+{
+	std::size_t collected = 0;
+
+	while (_pendingCount > 0)
+	{
+		auto& read = _reads[_firstRead];
+
+		if (!wait && !IsFinished(read))
+		{
+			break;
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, read.Buffer);
+
+		if (auto pixels = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY); pixels)
+		{
+			callback(read.Id, reinterpret_cast<const std::uint8_t*>(pixels), read.Width, read.Height);
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			++collected;
+		}
+		else
+		{
+			Error("PixelReadbackQueue::Collect: Could not map the buffer of read %llu (%d x %d)\n",
+				static_cast<unsigned long long>(read.Id), read.Width, read.Height);
+			++_failedCount;
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (read.Fence)
+		{
+			glDeleteSync(read.Fence);
+			read.Fence = nullptr;
+		}
+
+		_firstRead = (_firstRead + 1) % _reads.size();
+		--_pendingCount;
+	}
+
+	++_collectCount;
+
+	return collected;
+}
+
+bool PixelReadbackQueue::IsFinished(const PendingRead& read) const
+{
+	if (!read.Fence)
+	{
+		//Can't tell without fences, so give the read until the next call to finish
+		return read.CollectCount != _collectCount;
+	}
+
+	const GLenum result = glClientWaitSync(read.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+	return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED;
+}
+}
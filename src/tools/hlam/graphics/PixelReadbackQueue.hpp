@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "graphics/OpenGL.hpp"
+
+namespace graphics
+{
+/**
+*	@brief Reads pixels from the bound framebuffer into a ring of pixel buffer objects,
+*	so the GPU can keep drawing while earlier reads are copied.
+*	Results are only mapped once a fence says they are available, to avoid stalling the pipeline.
+*/
+class PixelReadbackQueue final
+{
+public:
+	/**
+	*	@brief Receives the pixels of a finished read as RGBA, tightly packed, bottom row first.
+	*	The pointer is only valid during the call
+	*/
+	using Callback = std::function<void(std::uint64_t id, const std::uint8_t* pixels, int width, int height)>;
+
+	PixelReadbackQueue() = default;
+	~PixelReadbackQueue();
+
+	PixelReadbackQueue(const PixelReadbackQueue&) = delete;
+	PixelReadbackQueue& operator=(const PixelReadbackQueue&) = delete;
+
+	bool IsValid() const { return !_reads.empty(); }
+
+	/**
+	*	@brief Creates @p bufferCount buffers large enough to read @p maxWidth x @p maxHeight pixels. The context must be current
+	*/
+	void Create(std::size_t bufferCount, int maxWidth, int maxHeight);
+
+	/**
+	*	@brief Destroys the buffers, discarding reads that have not been collected. The context must be current
+	*/
+	void Destroy();
+
+	std::size_t GetPendingCount() const { return _pendingCount; }
+
+	bool IsFull() const { return _pendingCount == _reads.size(); }
+
+	/**
+	*	@brief Starts reading a region of the framebuffer bound for reading. The queue must not be full
+	*	@param id Passed to the callback when the read is collected
+	*/
+	void Read(std::uint64_t id, int x, int y, int width, int height);
+
+	/**
+	*	@brief Passes finished reads to @p callback in the order they were started.
+	*	Reads whose buffer can't be mapped are logged, discarded and counted as failed instead
+	*	@param wait Whether to wait for all pending reads instead of only collecting those that have finished
+	*	@return Number of reads that were passed to @p callback
+	*/
+	std::size_t Collect(const Callback& callback, bool wait = false);
+
+	/**
+	*	@brief Number of reads that were discarded because their buffer could not be mapped since the queue was created
+	*/
+	std::size_t GetFailedCount() const { return _failedCount; }
+
+private:
+	struct PendingRead
+	{
+		GLuint Buffer = 0;
+		GLsync Fence = nullptr;
+		std::uint64_t Id = 0;
+		int Width = 0;
+		int Height = 0;
+
+		//Value of _collectCount when the read was started
+		std::uint64_t CollectCount = 0;
+	};
+
+	bool IsFinished(const PendingRead& read) const;
+
+	std::vector<PendingRead> _reads;
+
+	std::size_t _bufferSize = 0;
+
+	//Oldest pending read
+	std::size_t _firstRead = 0;
+	std::size_t _pendingCount = 0;
+
+	std::uint64_t _collectCount = 0;
+
+	std::size_t _failedCount = 0;
+
+	bool _supportsFences = false;
+};
+}
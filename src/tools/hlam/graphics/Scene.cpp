@@ -1,5 +1,8 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
 #include <utility>
 
 #include <GL/glew.h>
@@ -20,6 +23,7 @@
 #include "game/entity/BaseEntityList.hpp"
 #include "game/entity/EntityManager.hpp"
 
+#include "graphics/FrameProfiler.hpp"
 #include "graphics/GraphicsUtils.hpp"
 #include "graphics/IGraphicsContext.hpp"
 #include "graphics/Scene.hpp"
@@ -40,10 +44,10 @@ static const int GUIDELINES_OFFSET = GUIDELINES_LINE_LENGTH + (GUIDELINES_POINT_
 
 static const int GUIDELINES_EDGE_WIDTH = 4;
 
-Scene::Scene(TextureLoader* textureLoader, soundsystem::ISoundSystem* soundSystem, WorldTime* worldTime)
+Scene::Scene(TextureLoader* textureLoader, soundsystem::ISoundSystem* soundSystem, WorldTime* worldTime, WorkerPool* workerPool)
 	: _textureLoader(textureLoader)
 	, _spriteRenderer(std::make_unique<sprite::SpriteRenderer>(worldTime))
-	, _studioModelRenderer(std::make_unique<studiomdl::StudioModelRenderer>())
+	, _studioModelRenderer(std::make_unique<studiomdl::StudioModelRenderer>(workerPool))
 	, _worldTime(worldTime)
 	//Use the default list class for now
 	, _entityManager(std::make_unique<EntityManager>(std::make_unique<BaseEntityList>(), _worldTime))
@@ -95,6 +99,42 @@ void Scene::SetWireframeColor(const glm::vec3& value)
 	_studioModelRenderer->SetWireframeColor(value);
 }
 
+bool Scene::ShouldUseVertexBuffers() const
+{
+	return _studioModelRenderer->ShouldUseVertexBuffers();
+}
+
+void Scene::SetUseVertexBuffers(bool value)
+{
+	_studioModelRenderer->SetUseVertexBuffers(value);
+}
+
+bool Scene::ShouldUseGPUSkinning() const
+{
+	return _studioModelRenderer->ShouldUseGPUSkinning();
+}
+
+void Scene::SetUseGPUSkinning(bool value)
+{
+	_studioModelRenderer->SetUseGPUSkinning(value);
+}
+
+bool Scene::ShouldUseTextureArrays() const
+{
+	return _studioModelRenderer->ShouldUseTextureArrays();
+}
+
+void Scene::SetUseTextureArrays(bool value)
+{
+	_studioModelRenderer->SetUseTextureArrays(value);
+}
+
+void Scene::SetFrameProfiler(FrameProfiler* profiler)
+{
+	_frameProfiler = profiler;
+	_studioModelRenderer->SetFrameProfiler(_frameProfiler);
+}
+
 void Scene::AlignOnGround()
 {
 	auto entity = GetEntity();
@@ -165,6 +205,10 @@ void Scene::Tick()
 
 void Scene::Draw()
 {
+	ScopedProfile profile{_frameProfiler, ProfileStage::SceneDraw};
+
+	_studioModelRenderer->RunFrame();
+
 	//TODO: really ugly, needs reworking
 	if (nullptr != _entity)
 	{
@@ -188,11 +232,19 @@ void Scene::Draw()
 	else
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	glViewport(0, 0, _windowWidth, _windowHeight);
+	if (_tile)
+	{
+		glViewport(0, 0, _tile->Width, _tile->Height);
+	}
+	else
+	{
+		glViewport(0, 0, _windowWidth, _windowHeight);
+	}
 
 	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
 	_drawnPolygonsCount = 0;
+	_renderStateCounters = {};
 
 	if (ShowTexture)
 	{
@@ -209,7 +261,7 @@ void Scene::Draw()
 	if (ShowCrosshair)
 	{
 		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
+		glLoadMatrixf(glm::value_ptr(_tileProjection));
 
 		glOrtho(0.0f, (float)_windowWidth, (float)_windowHeight, 0.0f, 1.0f, -1.0f);
 
@@ -259,7 +311,7 @@ void Scene::Draw()
 	if (ShowGuidelines)
 	{
 		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
+		glLoadMatrixf(glm::value_ptr(_tileProjection));
 
 		glOrtho(0.0f, (float)_windowWidth, (float)_windowHeight, 0.0f, 1.0f, -1.0f);
 
@@ -320,6 +372,35 @@ void Scene::Draw()
 	}
 }
 
+void Scene::DrawTile(unsigned int imageWidth, unsigned int imageHeight, const ImageTile& tile)
+{
+	assert(tile.Width > 0 && tile.Height > 0);
+
+	const unsigned int windowWidth = _windowWidth;
+	const unsigned int windowHeight = _windowHeight;
+
+	//Cameras and overlays use the size of the whole image
+	UpdateWindowSize(imageWidth, imageHeight);
+
+	//Scale and move the tile's part of the image so it covers the viewport
+	const glm::vec2 imageSize{imageWidth, imageHeight};
+	const glm::vec2 tileSize{tile.Width, tile.Height};
+	const glm::vec2 tileCenter{glm::vec2{tile.X, tile.Y} + (tileSize * 0.5f)};
+
+	const glm::vec2 scale{imageSize / tileSize};
+	const glm::vec2 offset{(glm::vec2{1} - ((tileCenter / imageSize) * 2.f)) * scale};
+
+	_tileProjection = glm::translate(glm::vec3{offset, 0}) * glm::scale(glm::vec3{scale, 1});
+	_tile = tile;
+
+	Draw();
+
+	_tile.reset();
+	_tileProjection = glm::mat4{1};
+
+	UpdateWindowSize(windowWidth, windowHeight);
+}
+
 void Scene::SetupRenderMode(RenderMode renderMode)
 {
 	if (renderMode == RenderMode::INVALID)
@@ -338,12 +419,14 @@ void Scene::DrawModel()
 
 	if (ShowBackground && BackgroundTexture != GL_INVALID_TEXTURE_ID && !ShowTexture)
 	{
-		graphics::DrawBackground(BackgroundTexture);
+		graphics::DrawBackground(BackgroundTexture, _tileProjection);
 	}
 
+	const glm::mat4 projection = _tileProjection * camera->GetProjectionMatrix();
+
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
-	glLoadMatrixf(glm::value_ptr(camera->GetProjectionMatrix()));
+	glLoadMatrixf(glm::value_ptr(projection));
 
 	glMatrixMode(GL_MODELVIEW);
 	glPushMatrix();
@@ -382,18 +465,31 @@ void Scene::DrawModel()
 	_studioModelRenderer->SetViewerOrigin(camera->GetOrigin());
 	_studioModelRenderer->SetViewerRight(camera->GetRightVector());
 
+	//Models entirely outside the view are skipped
+	const glm::mat4 viewProjection = projection * camera->GetViewMatrix();
+
+	_studioModelRenderer->SetCullingViewProjection(viewProjection);
+
 	const unsigned int uiOldPolys = _studioModelRenderer->GetDrawnPolygonsCount();
+	const auto oldRenderStateCounters = _studioModelRenderer->GetRenderStateCounters();
 
 	if (nullptr != _entity)
 	{
 		// setup stencil buffer and draw mirror
 		if (MirrorOnGround)
 		{
+			ScopedProfile mirrorProfile{_frameProfiler, ProfileStage::MirroredModel};
+
+			//The mirrored model is drawn flipped along the z axis
+			_studioModelRenderer->SetCullingViewProjection(viewProjection * glm::scale(glm::vec3{1, 1, -1}));
+
 			graphics::DrawMirroredModel(*_studioModelRenderer, _entity,
 				CurrentRenderMode,
 				ShowWireframeOverlay,
 				FloorLength,
 				EnableBackfaceCulling);
+
+			_studioModelRenderer->SetCullingViewProjection(viewProjection);
 		}
 	}
 
@@ -420,6 +516,11 @@ void Scene::DrawModel()
 			flags |= renderer::DrawFlag::IS_VIEW_MODEL;
 		}
 
+		if (CurrentRenderMode != RenderMode::TEXTURE_SHADED)
+		{
+			flags |= renderer::DrawFlag::NO_TEXTURES;
+		}
+
 		if (DrawShadows)
 		{
 			flags |= renderer::DrawFlag::DRAW_SHADOWS;
@@ -458,6 +559,15 @@ void Scene::DrawModel()
 
 		_entity->Draw(flags);
 
+		if (ShowCrowd && !CameraIsFirstPerson)
+		{
+			DrawCrowd(flags);
+		}
+		else
+		{
+			_crowdStatistics = {};
+		}
+
 		auto renderInfo = _entity->GetRenderInfo();
 
 		//TODO: this is a temporary hack. The graphics scene architecture needs a complete overhaul first,
@@ -483,6 +593,9 @@ void Scene::DrawModel()
 		}
 	}
 
+	//Other users of the renderer don't provide matrices to cull with
+	_studioModelRenderer->SetCullingViewProjection(std::nullopt);
+
 	//
 	// draw ground
 	//
@@ -502,19 +615,12 @@ void Scene::DrawModel()
 			{
 				const auto& sequence = *model->Sequences[_entity->GetSequence()];
 
-				//Scale offset to current frame
-				const float currentFrame = _entity->GetFrame() / (sequence.NumFrames - 1);
+				//Follow the precomputed root motion so non-linear movement scrolls the floor correctly
+				const auto& rootMotion = sequence.RootMotion;
 
-				float delta;
+				const float currentFrame = _entity->GetInterpolatedFrame();
 
-				if (currentFrame >= _previousFloorFrame)
-				{
-					delta = currentFrame - _previousFloorFrame;
-				}
-				else
-				{
-					delta = (currentFrame + 1) - _previousFloorFrame;
-				}
+				const glm::vec3 movement = studiomdl::GetRootMotionDelta(rootMotion, _previousFloorFrame, currentFrame);
 
 				_previousFloorFrame = currentFrame;
 
@@ -522,8 +628,8 @@ void Scene::DrawModel()
 				const int xDirection = _entity->GetScale().x > 0 ? 1 : -1;
 				const int yDirection = _entity->GetScale().y > 0 ? 1 : -1;
 
-				textureOffset.x = sequence.LinearMovement.x * delta * xDirection;
-				textureOffset.y = -(sequence.LinearMovement.y * delta * yDirection);
+				textureOffset.x = movement.x * xDirection;
+				textureOffset.y = -(movement.y * yDirection);
 
 				if (_floorSequence != _entity->GetSequence())
 				{
@@ -546,6 +652,7 @@ void Scene::DrawModel()
 	}
 
 	_drawnPolygonsCount = _studioModelRenderer->GetDrawnPolygonsCount() - uiOldPolys;
+	_renderStateCounters = _studioModelRenderer->GetRenderStateCounters() - oldRenderStateCounters;
 
 	if (ShowPlayerHitbox)
 	{
@@ -555,7 +662,7 @@ void Scene::DrawModel()
 
 		auto v = CreateBoxFromBounds(bbmin, bbmax);
 
-		DrawOutlinedBox(v, {0.0f, 1.0f, 0.0f, 0.5f}, {0.0f, 0.5f, 0.0f, 1.f});
+		DrawOutlinedBox(_drawCommands, v, {0.0f, 1.0f, 0.0f, 0.5f}, {0.0f, 0.5f, 0.0f, 1.f});
 	}
 
 	if (ShowBBox)
@@ -567,7 +674,7 @@ void Scene::DrawModel()
 
 			const auto v = CreateBoxFromBounds(model->BoundingMin, model->BoundingMax);
 
-			DrawOutlinedBox(v, {1.0f, 1.0f, 0.0f, 0.5f}, {0.5f, 0.5f, 0.0f, 1.0f});
+			DrawOutlinedBox(_drawCommands, v, {1.0f, 1.0f, 0.0f, 0.5f}, {0.5f, 0.5f, 0.0f, 1.0f});
 		}
 	}
 
@@ -580,13 +687,116 @@ void Scene::DrawModel()
 
 			const auto v = CreateBoxFromBounds(model->ClippingMin, model->ClippingMax);
 
-			DrawOutlinedBox(v, {1.0f, 0.5f, 0.0f, 0.5f}, {0.5f, 0.25f, 0.0f, 1.0f});
+			DrawOutlinedBox(_drawCommands, v, {1.0f, 0.5f, 0.0f, 0.5f}, {0.5f, 0.25f, 0.0f, 1.0f});
 		}
 	}
 
+	_drawCommandBackend.Execute(_drawCommands);
+	_drawCommands.Clear();
+
 	glPopMatrix();
 }
 
+void Scene::DrawCrowd(renderer::DrawFlags flags)
+{
+	ScopedProfile profile{_frameProfiler, ProfileStage::Crowd};
+
+	const auto start = std::chrono::steady_clock::now();
+
+	_crowdStatistics = {};
+
+	auto model = _entity->GetEditableModel();
+
+	const auto renderInfo = _entity->GetRenderInfo();
+
+	const int sequenceCount = static_cast<int>(model->Sequences.size());
+
+	if (CrowdSize <= 0 || renderInfo.Sequence < 0 || renderInfo.Sequence >= sequenceCount)
+	{
+		return;
+	}
+
+	//Overlays are only drawn for the model itself
+	flags &= ~(renderer::DrawFlag::DRAW_BONES | renderer::DrawFlag::DRAW_ATTACHMENTS | renderer::DrawFlag::DRAW_EYE_POSITION
+		| renderer::DrawFlag::DRAW_HITBOXES | renderer::DrawFlag::DRAW_NORMALS);
+
+	const auto& currentSequence = *model->Sequences[renderInfo.Sequence];
+
+	//Keep the copies far enough apart that they don't overlap while playing the current sequence
+	const glm::vec3 size = currentSequence.BBMax - currentSequence.BBMin;
+	const float spacing = std::max(std::max(size.x, size.y), 32.f) * 1.25f;
+
+	//Fill rings of cells around the model, nearest first
+	_crowdCells.clear();
+
+	for (int ring = 1; _crowdCells.size() < static_cast<std::size_t>(CrowdSize); ++ring)
+	{
+		for (int y = -ring; y <= ring; ++y)
+		{
+			for (int x = -ring; x <= ring; ++x)
+			{
+				if (std::max(std::abs(x), std::abs(y)) == ring)
+				{
+					_crowdCells.emplace_back(x, y);
+				}
+			}
+		}
+	}
+
+	const int poseSequences = std::clamp(CrowdSequenceCount, 1, sequenceCount);
+	const int frameOffsets = std::max(1, CrowdFrameOffsetCount);
+
+	//All copies follow the playback of the current sequence, at their own offset into their own sequence
+	const float cycle = currentSequence.NumFrames > 1 ? renderInfo.Frame / (currentSequence.NumFrames - 1) : 0.f;
+
+	_crowdRenderInfos.clear();
+
+	for (int i = 0; i < CrowdSize; ++i)
+	{
+		const int pose = i % (poseSequences * frameOffsets);
+		const int sequenceIndex = (renderInfo.Sequence + (pose % poseSequences)) % sequenceCount;
+		const int frameOffset = pose / poseSequences;
+
+		const auto& sequence = *model->Sequences[sequenceIndex];
+
+		const float instanceCycle = std::fmod(cycle + (static_cast<float>(frameOffset) / frameOffsets), 1.f);
+
+		auto& instance = _crowdRenderInfos.emplace_back(renderInfo);
+
+		instance.Origin += glm::vec3{_crowdCells[i].x * spacing, _crowdCells[i].y * spacing, 0};
+		instance.Sequence = sequenceIndex;
+		instance.Frame = instanceCycle * std::max(0, sequence.NumFrames - 1);
+	}
+
+	//Copies with the same pose are drawn together
+	std::stable_sort(_crowdRenderInfos.begin(), _crowdRenderInfos.end(), [](const auto& lhs, const auto& rhs)
+		{
+			if (lhs.Sequence != rhs.Sequence)
+			{
+				return lhs.Sequence < rhs.Sequence;
+			}
+
+			return lhs.Frame < rhs.Frame;
+		});
+
+	_crowdStatistics.InstanceCount = static_cast<unsigned int>(_crowdRenderInfos.size());
+
+	for (std::size_t i = 0; i < _crowdRenderInfos.size(); ++i)
+	{
+		if (i == 0 || _crowdRenderInfos[i].Sequence != _crowdRenderInfos[i - 1].Sequence
+			|| _crowdRenderInfos[i].Frame != _crowdRenderInfos[i - 1].Frame)
+		{
+			++_crowdStatistics.PoseCount;
+		}
+	}
+
+	_studioModelRenderer->DrawModelInstances(_crowdRenderInfos.data(), _crowdRenderInfos.size(), flags);
+
+	const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	_crowdStatistics.DrawTime = elapsed.count();
+}
+
 void Scene::DrawTexture(const int xOffset, const int yOffset, const int width, const int height, StudioModelEntity* entity,
 	const int textureIndex, const float textureScale, const bool showUVMap, const bool overlayUVMap)
 {
@@ -602,7 +812,7 @@ void Scene::DrawTexture(const int xOffset, const int yOffset, const int width, c
 	}
 
 	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
+	glLoadMatrixf(glm::value_ptr(_tileProjection));
 
 	glOrtho(0.0f, (float)width, (float)height, 0.0f, 1.0f, -1.0f);
 
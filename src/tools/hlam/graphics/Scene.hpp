@@ -1,20 +1,27 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include <GL/glew.h>
 
+#include <glm/mat4x4.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
+#include "engine/shared/renderer/studiomodel/IStudioModelRenderer.hpp"
 #include "engine/shared/studiomodel/StudioModelFileFormat.hpp"
 
 #include "graphics/Camera.hpp"
 #include "graphics/Constants.hpp"
+#include "graphics/DrawCommandList.hpp"
+#include "graphics/OpenGLDrawCommandBackend.hpp"
 
 class EntityManager;
 class HLMVStudioModelEntity;
 class StudioModelEntity;
+class WorkerPool;
 class WorldTime;
 struct EntityContext;
 
@@ -23,11 +30,6 @@ namespace sprite
 class ISpriteRenderer;
 }
 
-namespace studiomdl
-{
-class IStudioModelRenderer;
-}
-
 namespace soundsystem
 {
 class ISoundSystem;
@@ -35,16 +37,45 @@ class ISoundSystem;
 
 namespace graphics
 {
+class FrameProfiler;
 class IGraphicsContext;
 class TextureLoader;
 
+/**
+*	@brief Cost of drawing the crowd preview in the last frame
+*/
+struct CrowdStatistics
+{
+	unsigned int InstanceCount = 0;
+
+	//Number of different poses. Each pose is set up and skinned once
+	unsigned int PoseCount = 0;
+
+	//CPU time spent drawing the crowd, in milliseconds
+	double DrawTime = 0;
+};
+
+/**
+*	@brief Part of an image drawn by Scene::DrawTile, in pixels from the bottom left corner of the image
+*/
+struct ImageTile
+{
+	unsigned int X = 0;
+	unsigned int Y = 0;
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+};
+
 /**
 *	@brief Contains all entities to be rendered for a particular scene
 */
 class Scene
 {
 public:
-	Scene(graphics::TextureLoader* textureLoader, soundsystem::ISoundSystem* soundSystem, WorldTime* worldTime);
+	/**
+	*	@param workerPool Threads used to skin models. Shared with other scenes since they are drawn one at a time
+	*/
+	Scene(graphics::TextureLoader* textureLoader, soundsystem::ISoundSystem* soundSystem, WorldTime* worldTime, WorkerPool* workerPool);
 	~Scene();
 	Scene(const Scene&) = delete;
 	Scene& operator=(const Scene&) = delete;
@@ -55,6 +86,8 @@ public:
 
 	EntityContext* GetEntityContext() const { return _entityContext.get(); }
 
+	TextureLoader* GetTextureLoader() const { return _textureLoader; }
+
 	Camera* GetCurrentCamera() { return _currentCamera; }
 
 	void SetCurrentCamera(Camera* camera)
@@ -70,6 +103,10 @@ public:
 		_currentCamera->SetWindowSize(_windowWidth, _windowHeight);
 	}
 
+	unsigned int GetWindowWidth() const { return _windowWidth; }
+
+	unsigned int GetWindowHeight() const { return _windowHeight; }
+
 	void UpdateWindowSize(unsigned int width, unsigned int height)
 	{
 		//Avoid constantly updating cameras
@@ -97,8 +134,34 @@ public:
 
 	void SetWireframeColor(const glm::vec3& value);
 
+	bool ShouldUseVertexBuffers() const;
+
+	void SetUseVertexBuffers(bool value);
+
+	bool ShouldUseGPUSkinning() const;
+
+	void SetUseGPUSkinning(bool value);
+
+	bool ShouldUseTextureArrays() const;
+
+	void SetUseTextureArrays(bool value);
+
+	FrameProfiler* GetFrameProfiler() const { return _frameProfiler; }
+
+	/**
+	*	@brief Sets the profiler that drawing times are reported to. May be null
+	*/
+	void SetFrameProfiler(FrameProfiler* profiler);
+
 	unsigned int GetDrawnPolygonsCount() const { return _drawnPolygonsCount; }
 
+	/**
+	*	@brief Render state changes made to draw models in the last frame
+	*/
+	const studiomdl::RenderStateCounters& GetRenderStateCounters() const { return _renderStateCounters; }
+
+	const CrowdStatistics& GetCrowdStatistics() const { return _crowdStatistics; }
+
 	HLMVStudioModelEntity* GetEntity() { return _entity; }
 
 	void SetEntity(HLMVStudioModelEntity* entity)
@@ -116,11 +179,22 @@ public:
 
 	void Draw();
 
+	/**
+	*	@brief Draws part of an image of the given size, so images larger than the window can be drawn one tile at a time.
+	*	Draws to the bottom left corner of the currently bound framebuffer. The window size is restored afterwards
+	*/
+	void DrawTile(unsigned int imageWidth, unsigned int imageHeight, const ImageTile& tile);
+
 private:
 	void SetupRenderMode(RenderMode renderMode = RenderMode::INVALID);
 
 	void DrawModel();
 
+	/**
+	*	@brief Draws copies of the entity's model in a grid around it, using different sequences and frames
+	*/
+	void DrawCrowd(renderer::DrawFlags flags);
+
 	void DrawTexture(const int xOffset, const int yOffset, const int width, const int height, StudioModelEntity* entity,
 		const int textureIndex, const float textureScale, const bool showUVMap, const bool overlayUVMap);
 
@@ -147,6 +221,16 @@ public:
 	bool ShowGuidelines = false;
 	bool ShowPlayerHitbox = false;
 
+	bool ShowCrowd = false;
+
+	//Number of copies drawn around the model
+	int CrowdSize{64};
+
+	//The crowd cycles through this many sequences, starting at the current one, and frame offsets per sequence.
+	//Copies that use the same sequence and offset share their pose
+	int CrowdSequenceCount{4};
+	int CrowdFrameOffsetCount{4};
+
 	int FloorLength = 0;
 	bool EnableFloorTextureTiling{false};
 	int FloorTextureLength{16};
@@ -191,6 +275,8 @@ private:
 
 	WorldTime* const _worldTime;
 
+	FrameProfiler* _frameProfiler{};
+
 	std::unique_ptr<EntityManager> _entityManager;
 
 	std::unique_ptr<EntityContext> _entityContext;
@@ -201,8 +287,22 @@ private:
 
 	unsigned int _windowWidth = 0, _windowHeight = 0;
 
+	//Set while drawing a tile. Applied after all projection matrices
+	std::optional<ImageTile> _tile;
+	glm::mat4 _tileProjection{1};
+
 	unsigned int _drawnPolygonsCount = 0;
 
+	studiomdl::RenderStateCounters _renderStateCounters;
+
+	std::vector<glm::ivec2> _crowdCells;
+	std::vector<studiomdl::ModelRenderInfo> _crowdRenderInfos;
+
+	CrowdStatistics _crowdStatistics;
+
+	DrawCommandList _drawCommands;
+	OpenGLDrawCommandBackend _drawCommandBackend;
+
 	HLMVStudioModelEntity* _entity{};
 
 	int _floorSequence{-1};
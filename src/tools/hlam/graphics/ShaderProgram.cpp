@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <string>
+
+#include "core/shared/Logging.hpp"
+
+#include "graphics/ShaderProgram.hpp"
+
+namespace graphics
+{
+static std::string GetInfoLog(GLuint object, bool isProgram)
+{
+	GLint length = 0;
+
+	if (isProgram)
+	{
+		glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+	}
+	else
+	{
+		glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+	}
+
+	std::string log(std::max(length, 1), '\0');
+
+	if (isProgram)
+	{
+		glGetProgramInfoLog(object, length, nullptr, log.data());
+	}
+	else
+	{
+		glGetShaderInfoLog(object, length, nullptr, log.data());
+	}
+
+	return log;
+}
+
+static GLuint CompileShader(std::string_view name, GLenum type, const char* source)
+{
+	const GLuint shader = glCreateShader(type);
+
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+
+	if (status != GL_TRUE)
+	{
+		Error("Error compiling %s shader \"%.*s\":\n%s\n", type == GL_VERTEX_SHADER ? "vertex" : "fragment",
+			static_cast<int>(name.size()), name.data(), GetInfoLog(shader, false).c_str());
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+ShaderProgram::~ShaderProgram()
+{
+	Destroy();
+}
+
+bool ShaderProgram::Create(std::string_view name, const char* vertexSource, const char* fragmentSource,
+	std::initializer_list<std::pair<const char*, GLuint>> attributeLocations)
+{
+	Destroy();
+
+	const GLuint vertexShader = CompileShader(name, GL_VERTEX_SHADER, vertexSource);
+
+	if (!vertexShader)
+	{
+		return false;
+	}
+
+	const GLuint fragmentShader = CompileShader(name, GL_FRAGMENT_SHADER, fragmentSource);
+
+	if (!fragmentShader)
+	{
+		glDeleteShader(vertexShader);
+		return false;
+	}
+
+	const GLuint program = glCreateProgram();
+
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
+
+	for (const auto& [attributeName, location] : attributeLocations)
+	{
+		glBindAttribLocation(program, location, attributeName);
+	}
+
+	glLinkProgram(program);
+
+	//The program keeps the shaders alive for as long as they're attached
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint status = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+	if (status != GL_TRUE)
+	{
+		Error("Error linking shader program \"%.*s\":\n%s\n", static_cast<int>(name.size()), name.data(), GetInfoLog(program, true).c_str());
+		glDeleteProgram(program);
+		return false;
+	}
+
+	_program = program;
+
+	return true;
+}
+
+void ShaderProgram::Destroy()
+{
+	if (_program)
+	{
+		glDeleteProgram(_program);
+		_program = 0;
+	}
+}
+
+GLint ShaderProgram::GetUniformLocation(const char* name) const
+{
+	return glGetUniformLocation(_program, name);
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <initializer_list>
+#include <string_view>
+#include <utility>
+
+#include "graphics/OpenGL.hpp"
+
+namespace graphics
+{
+/**
+*	@brief Owns a linked GLSL program object
+*/
+class ShaderProgram final
+{
+public:
+	ShaderProgram() = default;
+	~ShaderProgram();
+
+	ShaderProgram(const ShaderProgram&) = delete;
+	ShaderProgram& operator=(const ShaderProgram&) = delete;
+
+	bool IsValid() const { return _program != 0; }
+
+	GLuint GetProgram() const { return _program; }
+
+	/**
+	*	@brief Compiles and links a program from the given sources, replacing the current program
+	*	@param name Name used in error messages
+	*	@param attributeLocations Vertex attribute names and the locations to bind them to before linking
+	*	@return Whether the program was created successfully. Errors are logged
+	*/
+	bool Create(std::string_view name, const char* vertexSource, const char* fragmentSource,
+		std::initializer_list<std::pair<const char*, GLuint>> attributeLocations);
+
+	void Destroy();
+
+	GLint GetUniformLocation(const char* name) const;
+
+private:
+	GLuint _program = 0;
+};
+}
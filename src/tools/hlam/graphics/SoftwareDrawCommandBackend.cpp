@@ -0,0 +1,343 @@
+#include <utility>
+
+#include <glm/trigonometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "graphics/DrawCommandList.hpp"
+#include "graphics/SoftwareDrawCommandBackend.hpp"
+
+namespace graphics
+{
+SoftwareDrawCommandBackend::SoftwareDrawCommandBackend(SoftwareRasterizer& rasterizer)
+	: _rasterizer(rasterizer)
+{
+}
+
+void SoftwareDrawCommandBackend::SetTexture(GLuint texture, SoftwareTexture&& image)
+{
+	_textures.insert_or_assign(texture, std::move(image));
+}
+
+void SoftwareDrawCommandBackend::ClearTextures()
+{
+	_textures.clear();
+}
+
+void SoftwareDrawCommandBackend::ResetState(const glm::mat4& projection, const glm::mat4& modelView)
+{
+	_state = {};
+	_attributeStack.clear();
+	_activeTexture = GL_TEXTURE0;
+
+	_projection = projection;
+
+	_modelViewStack.clear();
+	_modelViewStack.push_back(modelView);
+}
+
+void SoftwareDrawCommandBackend::SetEnabled(GLenum capability, bool enabled)
+{
+	switch (capability)
+	{
+	case GL_BLEND:
+		_state.Blend = enabled;
+		break;
+
+	case GL_ALPHA_TEST:
+		_state.AlphaTest = enabled;
+		break;
+
+	case GL_DEPTH_TEST:
+		_state.DepthTest = enabled;
+		break;
+
+	case GL_CULL_FACE:
+		_state.CullFace = enabled;
+		break;
+
+	case GL_TEXTURE_2D:
+		//Each texture unit has its own texturing state
+		if (_activeTexture == GL_TEXTURE0)
+		{
+			_state.Texture2D = enabled;
+		}
+		break;
+	}
+}
+
+void SoftwareDrawCommandBackend::SetCullFace(GLenum face)
+{
+	_state.CullFaceMode = face;
+}
+
+void SoftwareDrawCommandBackend::SetShadeModel(GLenum model)
+{
+	_state.ShadeModel = model;
+}
+
+void SoftwareDrawCommandBackend::SetPolygonMode(GLenum mode)
+{
+	_state.PolygonMode = mode;
+}
+
+void SoftwareDrawCommandBackend::Execute(const DrawCommandList& commands)
+{
+	for (const auto& command : commands.GetCommands())
+	{
+		switch (command.Type)
+		{
+		case DrawCommandType::Enable:
+			SetEnabled(command.Target, true);
+			break;
+
+		case DrawCommandType::Disable:
+			SetEnabled(command.Target, false);
+			break;
+
+		case DrawCommandType::BlendFunc:
+			_state.BlendSource = command.Target;
+			_state.BlendDestination = command.Value;
+			break;
+
+		case DrawCommandType::DepthMask:
+			_state.DepthMask = command.Value != GL_FALSE;
+			break;
+
+		case DrawCommandType::DepthFunc:
+			_state.DepthFunc = command.Target;
+			break;
+
+		case DrawCommandType::AlphaFunc:
+			_state.AlphaFunc = command.Target;
+			_state.AlphaReference = command.Vector.x;
+			break;
+
+		case DrawCommandType::PolygonMode:
+			SetPolygonMode(command.Target);
+			break;
+
+		case DrawCommandType::PushAttrib:
+			_attributeStack.push_back(SavedAttributes{command.Target, _state});
+			break;
+
+		case DrawCommandType::PopAttrib:
+			PopAttributes();
+			break;
+
+		case DrawCommandType::ActiveTexture:
+			_activeTexture = command.Target;
+			break;
+
+		case DrawCommandType::BindTexture:
+			if (_activeTexture == GL_TEXTURE0 && command.Target == GL_TEXTURE_2D)
+			{
+				_state.Texture = command.Value;
+			}
+			break;
+
+		case DrawCommandType::PushMatrix:
+			_modelViewStack.push_back(_modelViewStack.back());
+			break;
+
+		case DrawCommandType::PopMatrix:
+			if (_modelViewStack.size() > 1)
+			{
+				_modelViewStack.pop_back();
+			}
+			break;
+
+		case DrawCommandType::Translate:
+			_modelViewStack.back() = glm::translate(_modelViewStack.back(), glm::vec3{command.Vector});
+			break;
+
+		case DrawCommandType::Rotate:
+			_modelViewStack.back() = glm::rotate(_modelViewStack.back(), glm::radians(command.Vector.w), glm::vec3{command.Vector});
+			break;
+
+		case DrawCommandType::MultMatrix:
+			_modelViewStack.back() *= commands.GetMatrices()[command.Offset];
+			break;
+
+		case DrawCommandType::Color:
+			_state.Color = command.Vector;
+			break;
+
+		case DrawCommandType::Primitive:
+			DrawPrimitive(commands, command);
+			break;
+
+		//Buffers and shaders are only used when the renderer is configured to use them, which this backend doesn't support
+		default: break;
+		}
+	}
+}
+
+void SoftwareDrawCommandBackend::PopAttributes()
+{
+	if (_attributeStack.empty())
+	{
+		return;
+	}
+
+	const auto [mask, saved] = _attributeStack.back();
+
+	_attributeStack.pop_back();
+
+	//Only the groups that were pushed are restored, as in OpenGL
+	if (mask & GL_CURRENT_BIT)
+	{
+		_state.Color = saved.Color;
+		_state.TexCoord = saved.TexCoord;
+	}
+
+	if (mask & GL_ENABLE_BIT)
+	{
+		_state.Blend = saved.Blend;
+		_state.AlphaTest = saved.AlphaTest;
+		_state.DepthTest = saved.DepthTest;
+		_state.CullFace = saved.CullFace;
+		_state.Texture2D = saved.Texture2D;
+	}
+
+	if (mask & GL_COLOR_BUFFER_BIT)
+	{
+		_state.Blend = saved.Blend;
+		_state.BlendSource = saved.BlendSource;
+		_state.BlendDestination = saved.BlendDestination;
+		_state.AlphaTest = saved.AlphaTest;
+		_state.AlphaFunc = saved.AlphaFunc;
+		_state.AlphaReference = saved.AlphaReference;
+	}
+
+	if (mask & GL_DEPTH_BUFFER_BIT)
+	{
+		_state.DepthTest = saved.DepthTest;
+		_state.DepthFunc = saved.DepthFunc;
+		_state.DepthMask = saved.DepthMask;
+	}
+
+	if (mask & GL_POLYGON_BIT)
+	{
+		_state.CullFace = saved.CullFace;
+		_state.CullFaceMode = saved.CullFaceMode;
+		_state.PolygonMode = saved.PolygonMode;
+	}
+
+	if (mask & GL_LIGHTING_BIT)
+	{
+		_state.ShadeModel = saved.ShadeModel;
+	}
+
+	if (mask & GL_TEXTURE_BIT)
+	{
+		_state.Texture = saved.Texture;
+	}
+}
+
+SoftwareRasterState SoftwareDrawCommandBackend::GetRasterState() const
+{
+	SoftwareRasterState state;
+
+	//Textures that were never registered are incomplete, which disables texturing in OpenGL
+	if (_state.Texture2D)
+	{
+		if (auto it = _textures.find(_state.Texture); it != _textures.end() && it->second.Width > 0 && it->second.Height > 0)
+		{
+			state.Texture = &it->second;
+		}
+	}
+
+	if (_state.Blend)
+	{
+		//These are the only functions used to draw models
+		state.BlendMode = _state.BlendDestination == GL_ONE ? SoftwareBlendMode::Additive : SoftwareBlendMode::Alpha;
+	}
+
+	state.AlphaTest = _state.AlphaTest;
+	state.AlphaFunc = _state.AlphaFunc;
+	state.AlphaReference = _state.AlphaReference;
+
+	state.DepthTest = _state.DepthTest;
+	state.DepthFunc = _state.DepthFunc;
+	state.DepthWrite = _state.DepthMask;
+
+	state.FlatShading = _state.ShadeModel == GL_FLAT;
+
+	state.Cull = _state.CullFace;
+	state.CullFace = _state.CullFaceMode;
+
+	return state;
+}
+
+void SoftwareDrawCommandBackend::DrawPrimitive(const DrawCommandList& commands, const DrawCommand& command)
+{
+	const auto& vertices = commands.GetVertices();
+
+	const glm::mat4 modelViewProjection = _projection * _modelViewStack.back();
+
+	_vertices.clear();
+
+	//Vertices that don't set an attribute use the current value, which includes values set by earlier vertices
+	for (std::size_t i = command.Offset; i < command.Offset + command.Count; ++i)
+	{
+		const auto& vertex = vertices[i];
+
+		if (vertex.HasColor)
+		{
+			_state.Color = vertex.Color;
+		}
+
+		if (vertex.HasTexCoord)
+		{
+			_state.TexCoord = vertex.TexCoord;
+		}
+
+		_vertices.push_back(SoftwareVertex{modelViewProjection * glm::vec4{vertex.Position, 1}, _state.Color, _state.TexCoord});
+	}
+
+	if (_state.PolygonMode != GL_FILL)
+	{
+		return;
+	}
+
+	const auto state = GetRasterState();
+
+	const std::size_t count = _vertices.size();
+
+	//Vertices are passed so that the last one is the one OpenGL uses for flat shading
+	switch (command.Target)
+	{
+	case GL_TRIANGLES:
+		for (std::size_t i = 2; i < count; i += 3)
+		{
+			_rasterizer.DrawTriangle(state, _vertices[i - 2], _vertices[i - 1], _vertices[i]);
+		}
+		break;
+
+	case GL_TRIANGLE_STRIP:
+		for (std::size_t i = 2; i < count; ++i)
+		{
+			//Every other triangle is reversed so they all have the same winding
+			if (i % 2 == 0)
+			{
+				_rasterizer.DrawTriangle(state, _vertices[i - 2], _vertices[i - 1], _vertices[i]);
+			}
+			else
+			{
+				_rasterizer.DrawTriangle(state, _vertices[i - 1], _vertices[i - 2], _vertices[i]);
+			}
+		}
+		break;
+
+	case GL_TRIANGLE_FAN:
+		for (std::size_t i = 2; i < count; ++i)
+		{
+			_rasterizer.DrawTriangle(state, _vertices[0], _vertices[i - 1], _vertices[i]);
+		}
+		break;
+
+	//Lines and points are only used for debug overlays
+	default: break;
+	}
+}
+}
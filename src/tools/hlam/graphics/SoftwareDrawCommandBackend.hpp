@@ -0,0 +1,110 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include "graphics/IDrawCommandBackend.hpp"
+#include "graphics/OpenGL.hpp"
+#include "graphics/SoftwareRasterizer.hpp"
+
+namespace graphics
+{
+struct DrawCommand;
+
+/**
+*	@brief Draws recorded draw commands with a software rasterizer.
+*	Only immediate mode triangles are drawn: lines, points, wireframe and commands that use buffers or shaders are ignored.
+*	Textures are looked up by the OpenGL texture name they were registered with. Only texture unit 0 is used.
+*	Triangles are drawn when the rasterizer is flushed.
+*/
+class SoftwareDrawCommandBackend final : public IDrawCommandBackend
+{
+public:
+	explicit SoftwareDrawCommandBackend(SoftwareRasterizer& rasterizer);
+
+	/**
+	*	@brief Sets the image used when @p texture is bound
+	*/
+	void SetTexture(GLuint texture, SoftwareTexture&& image);
+
+	void ClearTextures();
+
+	/**
+	*	@brief Resets the state to the OpenGL defaults and sets the matrices. State that is not recorded is set using the functions below
+	*/
+	void ResetState(const glm::mat4& projection, const glm::mat4& modelView);
+
+	void SetEnabled(GLenum capability, bool enabled);
+
+	void SetCullFace(GLenum face);
+
+	void SetShadeModel(GLenum model);
+
+	void SetPolygonMode(GLenum mode);
+
+	void Execute(const DrawCommandList& commands) override;
+
+private:
+	/**
+	*	@brief State that affects how triangles are drawn
+	*/
+	struct State
+	{
+		bool Blend = false;
+		bool AlphaTest = false;
+		bool DepthTest = false;
+		bool CullFace = false;
+		bool Texture2D = false;
+
+		GLenum BlendSource = GL_ONE;
+		GLenum BlendDestination = GL_ZERO;
+
+		GLenum AlphaFunc = GL_ALWAYS;
+		float AlphaReference = 0;
+
+		GLenum DepthFunc = GL_LESS;
+		bool DepthMask = true;
+
+		GLenum CullFaceMode = GL_BACK;
+		GLenum ShadeModel = GL_SMOOTH;
+		GLenum PolygonMode = GL_FILL;
+
+		GLuint Texture = 0;
+
+		glm::vec4 Color{1};
+		glm::vec2 TexCoord{0};
+	};
+
+	struct SavedAttributes
+	{
+		GLbitfield Mask;
+		State Attributes;
+	};
+
+	void PopAttributes();
+
+	SoftwareRasterState GetRasterState() const;
+
+	void DrawPrimitive(const DrawCommandList& commands, const DrawCommand& command);
+
+private:
+	SoftwareRasterizer& _rasterizer;
+
+	std::unordered_map<GLuint, SoftwareTexture> _textures;
+
+	State _state;
+	std::vector<SavedAttributes> _attributeStack;
+
+	GLenum _activeTexture = GL_TEXTURE0;
+
+	glm::mat4 _projection{1};
+	std::vector<glm::mat4> _modelViewStack{glm::mat4{1}};
+
+	//Vertices of the current primitive, reused to avoid allocations
+	std::vector<SoftwareVertex> _vertices;
+};
+}
@@ -0,0 +1,550 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <glm/common.hpp>
+
+#include "graphics/SoftwareRasterizer.hpp"
+
+#include "utility/Float4.hpp"
+
+namespace graphics
+{
+namespace
+{
+constexpr int AllLanes = 0b1111;
+
+inline int DepthTest(GLenum function, Float4 depth, Float4 bufferDepth)
+{
+	switch (function)
+	{
+	case GL_NEVER: return 0;
+	case GL_LESS: return Less(depth, bufferDepth);
+	case GL_EQUAL: return Equal(depth, bufferDepth);
+	case GL_LEQUAL: return LessEqual(depth, bufferDepth);
+	case GL_GREATER: return Less(bufferDepth, depth);
+	case GL_NOTEQUAL: return ~Equal(depth, bufferDepth) & AllLanes;
+	case GL_GEQUAL: return LessEqual(bufferDepth, depth);
+	default: return AllLanes;
+	}
+}
+
+inline bool AlphaTest(GLenum function, float alpha, float reference)
+{
+	switch (function)
+	{
+	case GL_NEVER: return false;
+	case GL_LESS: return alpha < reference;
+	case GL_EQUAL: return alpha == reference;
+	case GL_LEQUAL: return alpha <= reference;
+	case GL_GREATER: return alpha > reference;
+	case GL_NOTEQUAL: return alpha != reference;
+	case GL_GEQUAL: return alpha >= reference;
+	default: return true;
+	}
+}
+
+inline glm::vec4 FetchTexel(const SoftwareTexture& texture, int x, int y)
+{
+	const auto texel = &texture.Pixels[((static_cast<std::size_t>(y) * texture.Width) + x) * 4];
+
+	return glm::vec4{texel[0], texel[1], texel[2], texel[3]} * (1.f / 255.f);
+}
+
+/**
+*	@brief Samples the texture like GL_LINEAR with GL_REPEAT
+*/
+glm::vec4 SampleBilinear(const SoftwareTexture& texture, float s, float t)
+{
+	const float u = ((s - std::floor(s)) * texture.Width) - 0.5f;
+	const float v = ((t - std::floor(t)) * texture.Height) - 0.5f;
+
+	const float u0 = std::floor(u);
+	const float v0 = std::floor(v);
+
+	const float fractionU = u - u0;
+	const float fractionV = v - v0;
+
+	const auto wrap = [](int coordinate, int size)
+	{
+		return coordinate < 0 ? coordinate + size : (coordinate >= size ? coordinate - size : coordinate);
+	};
+
+	const int x0 = wrap(static_cast<int>(u0), texture.Width);
+	const int y0 = wrap(static_cast<int>(v0), texture.Height);
+	const int x1 = wrap(x0 + 1, texture.Width);
+	const int y1 = wrap(y0 + 1, texture.Height);
+
+	const glm::vec4 top = glm::mix(FetchTexel(texture, x0, y0), FetchTexel(texture, x1, y0), fractionU);
+	const glm::vec4 bottom = glm::mix(FetchTexel(texture, x0, y1), FetchTexel(texture, x1, y1), fractionU);
+
+	return glm::mix(top, bottom, fractionV);
+}
+
+inline std::uint8_t ToByte(float value)
+{
+	return static_cast<std::uint8_t>((std::clamp(value, 0.f, 1.f) * 255.f) + 0.5f);
+}
+
+bool IsSameState(const SoftwareRasterState& lhs, const SoftwareRasterState& rhs)
+{
+	return lhs.Texture == rhs.Texture
+		&& lhs.BlendMode == rhs.BlendMode
+		&& lhs.AlphaTest == rhs.AlphaTest
+		&& lhs.AlphaFunc == rhs.AlphaFunc
+		&& lhs.AlphaReference == rhs.AlphaReference
+		&& lhs.DepthTest == rhs.DepthTest
+		&& lhs.DepthFunc == rhs.DepthFunc
+		&& lhs.DepthWrite == rhs.DepthWrite
+		&& lhs.FlatShading == rhs.FlatShading
+		&& lhs.Cull == rhs.Cull
+		&& lhs.CullFace == rhs.CullFace;
+}
+
+constexpr int ClipPlaneCount = 6;
+
+//Each plane can add one vertex to the polygon
+constexpr int MaxClippedVertices = 3 + ClipPlaneCount;
+
+/**
+*	@brief Signed distance to a plane of the view volume, positive inside
+*/
+inline float GetClipDistance(const glm::vec4& position, int plane)
+{
+	switch (plane)
+	{
+	case 0: return position.w + position.x;
+	case 1: return position.w - position.x;
+	case 2: return position.w + position.y;
+	case 3: return position.w - position.y;
+	case 4: return position.w + position.z;
+	default: return position.w - position.z;
+	}
+}
+
+inline int GetOutCode(const glm::vec4& position)
+{
+	int code = 0;
+
+	for (int plane = 0; plane < ClipPlaneCount; ++plane)
+	{
+		if (GetClipDistance(position, plane) < 0)
+		{
+			code |= 1 << plane;
+		}
+	}
+
+	return code;
+}
+
+inline SoftwareVertex Interpolate(const SoftwareVertex& from, const SoftwareVertex& to, float fraction)
+{
+	return {glm::mix(from.Position, to.Position, fraction), glm::mix(from.Color, to.Color, fraction), glm::mix(from.TexCoord, to.TexCoord, fraction)};
+}
+
+/**
+*	@brief Clips a convex polygon against a plane of the view volume
+*	@return Number of vertices written to @p output
+*/
+int ClipPolygon(const SoftwareVertex* input, int count, int plane, SoftwareVertex* output)
+{
+	int outputCount = 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		const auto& current = input[i];
+		const auto& next = input[(i + 1) % count];
+
+		const float currentDistance = GetClipDistance(current.Position, plane);
+		const float nextDistance = GetClipDistance(next.Position, plane);
+
+		if (currentDistance >= 0)
+		{
+			output[outputCount++] = current;
+		}
+
+		//Always interpolate from the inside vertex so triangles that share the edge get the same vertex
+		if ((currentDistance >= 0) != (nextDistance >= 0))
+		{
+			output[outputCount++] = currentDistance >= 0
+				? Interpolate(current, next, currentDistance / (currentDistance - nextDistance))
+				: Interpolate(next, current, nextDistance / (nextDistance - currentDistance));
+		}
+	}
+
+	return outputCount;
+}
+}
+
+SoftwareRasterizer::SoftwareRasterizer(WorkerPool& workers)
+	: _workers(workers)
+{
+}
+
+SoftwareRasterizer::~SoftwareRasterizer() = default;
+
+void SoftwareRasterizer::Resize(int width, int height)
+{
+	assert(width > 0 && height > 0);
+
+	_width = width;
+	_height = height;
+
+	_tilesWide = (width + TileSize - 1) / TileSize;
+	_tilesHigh = (height + TileSize - 1) / TileSize;
+
+	_colorBuffer.resize(static_cast<std::size_t>(width) * height * 4);
+
+	//Depths are loaded 4 at a time, which can read past the end of the last row
+	_depthBuffer.resize((static_cast<std::size_t>(width) * height) + 3);
+
+	_states.clear();
+	_triangles.clear();
+
+	_tiles.clear();
+	_tiles.resize(static_cast<std::size_t>(_tilesWide) * _tilesHigh);
+}
+
+void SoftwareRasterizer::Clear(const glm::vec4& color, float depth)
+{
+	const std::uint8_t clearColor[4] = {ToByte(color.r), ToByte(color.g), ToByte(color.b), ToByte(color.a)};
+
+	for (std::size_t i = 0; i < _colorBuffer.size(); i += 4)
+	{
+		std::copy(std::begin(clearColor), std::end(clearColor), _colorBuffer.begin() + i);
+	}
+
+	std::fill(_depthBuffer.begin(), _depthBuffer.end(), depth);
+
+	_states.clear();
+	_triangles.clear();
+
+	for (auto& tile : _tiles)
+	{
+		tile.clear();
+	}
+}
+
+void SoftwareRasterizer::DrawTriangle(const SoftwareRasterState& state,
+	const SoftwareVertex& v0, const SoftwareVertex& v1, const SoftwareVertex& v2)
+{
+	if (state.Cull && state.CullFace == GL_FRONT_AND_BACK)
+	{
+		return;
+	}
+
+	SoftwareVertex vertices[2][MaxClippedVertices] = {{v0, v1, v2}};
+
+	//Flat shaded triangles use the last vertex's color, which clipping would otherwise lose
+	if (state.FlatShading)
+	{
+		vertices[0][0].Color = vertices[0][1].Color = v2.Color;
+	}
+
+	const int outCodes[] = {GetOutCode(v0.Position), GetOutCode(v1.Position), GetOutCode(v2.Position)};
+
+	//Entirely outside one of the planes
+	if ((outCodes[0] & outCodes[1] & outCodes[2]) != 0)
+	{
+		return;
+	}
+
+	if (_states.empty() || !IsSameState(_states.back(), state))
+	{
+		_states.push_back(state);
+	}
+
+	const auto stateIndex = static_cast<std::uint32_t>(_states.size() - 1);
+
+	const int clipPlanes = outCodes[0] | outCodes[1] | outCodes[2];
+
+	if (clipPlanes == 0)
+	{
+		AddTriangle(stateIndex, vertices[0][0], vertices[0][1], vertices[0][2]);
+		return;
+	}
+
+	int count = 3;
+	int current = 0;
+
+	for (int plane = 0; plane < ClipPlaneCount && count >= 3; ++plane)
+	{
+		if (clipPlanes & (1 << plane))
+		{
+			count = ClipPolygon(vertices[current], count, plane, vertices[current ^ 1]);
+			current ^= 1;
+		}
+	}
+
+	for (int i = 1; i + 1 < count; ++i)
+	{
+		AddTriangle(stateIndex, vertices[current][0], vertices[current][i], vertices[current][i + 1]);
+	}
+}
+
+void SoftwareRasterizer::Flush()
+{
+	if (!_triangles.empty())
+	{
+		//Tiles can take very different amounts of time, so they are handed out one at a time
+		_workers.ParallelFor(_tiles.size(), 1, [this](std::size_t begin, std::size_t end)
+			{
+				for (std::size_t i = begin; i < end; ++i)
+				{
+					DrawTile(i);
+				}
+			});
+	}
+
+	_states.clear();
+	_triangles.clear();
+
+	for (auto& tile : _tiles)
+	{
+		tile.clear();
+	}
+}
+
+void SoftwareRasterizer::AddTriangle(std::uint32_t state, const SoftwareVertex& v0, const SoftwareVertex& v1, const SoftwareVertex& v2)
+{
+	const SoftwareVertex* const vertices[] = {&v0, &v1, &v2};
+
+	Triangle triangle;
+
+	triangle.State = state;
+
+	float x[3], y[3];
+
+	for (int i = 0; i < 3; ++i)
+	{
+		const auto& vertex = *vertices[i];
+
+		//Clipping leaves w positive unless the vertex is degenerate
+		if (!(vertex.Position.w > 0))
+		{
+			return;
+		}
+
+		const float inverseW = 1.f / vertex.Position.w;
+
+		//Snap to 1/256th of a pixel like hardware does, so edges shared by triangles are stable
+		x[i] = std::floor((((vertex.Position.x * inverseW * 0.5f) + 0.5f) * _width * 256.f) + 0.5f) * (1.f / 256.f);
+		y[i] = std::floor((((vertex.Position.y * inverseW * 0.5f) + 0.5f) * _height * 256.f) + 0.5f) * (1.f / 256.f);
+
+		triangle.Depth[i] = (vertex.Position.z * inverseW * 0.5f) + 0.5f;
+		triangle.InverseW[i] = inverseW;
+		triangle.Color[i] = glm::clamp(vertex.Color, glm::vec4{0}, glm::vec4{1}) * inverseW;
+		triangle.TexCoord[i] = vertex.TexCoord * inverseW;
+	}
+
+	const float area = ((x[1] - x[0]) * (y[2] - y[0])) - ((x[2] - x[0]) * (y[1] - y[0]));
+
+	if (area == 0 || !std::isfinite(area))
+	{
+		return;
+	}
+
+	const auto& rasterState = _states[state];
+
+	//Window coordinates have y up, so counter-clockwise triangles have a positive area
+	if (rasterState.Cull && ((rasterState.CullFace == GL_FRONT) == (area > 0)))
+	{
+		return;
+	}
+
+	for (int i = 0; i < 3; ++i)
+	{
+		int from = (i + 1) % 3;
+		int to = (i + 2) % 3;
+
+		//Set up shared edges the same way for both triangles so only the sign differs, then no pixel is drawn twice or skipped
+		const bool swap = y[from] > y[to] || (y[from] == y[to] && x[from] > x[to]);
+
+		if (swap)
+		{
+			std::swap(from, to);
+		}
+
+		const float sign = (swap != (area < 0)) ? -1.f : 1.f;
+
+		triangle.EdgeA[i] = sign * (y[from] - y[to]);
+		triangle.EdgeB[i] = sign * (x[to] - x[from]);
+		triangle.EdgeC[i] = sign * ((x[from] * y[to]) - (x[to] * y[from]));
+
+		triangle.EdgeInclusive[i] = triangle.EdgeA[i] > 0 || (triangle.EdgeA[i] == 0 && triangle.EdgeB[i] < 0);
+	}
+
+	triangle.InverseArea = 1.f / std::abs(area);
+	triangle.FlatColor = glm::clamp(v2.Color, glm::vec4{0}, glm::vec4{1});
+
+	triangle.MinX = std::max(0, static_cast<int>(std::floor(std::min({x[0], x[1], x[2]}))));
+	triangle.MinY = std::max(0, static_cast<int>(std::floor(std::min({y[0], y[1], y[2]}))));
+	triangle.MaxX = std::min(_width, static_cast<int>(std::ceil(std::max({x[0], x[1], x[2]}))));
+	triangle.MaxY = std::min(_height, static_cast<int>(std::ceil(std::max({y[0], y[1], y[2]}))));
+
+	if (triangle.MinX >= triangle.MaxX || triangle.MinY >= triangle.MaxY)
+	{
+		return;
+	}
+
+	const auto index = static_cast<std::uint32_t>(_triangles.size());
+
+	_triangles.push_back(triangle);
+
+	for (int tileY = triangle.MinY / TileSize; tileY <= (triangle.MaxY - 1) / TileSize; ++tileY)
+	{
+		for (int tileX = triangle.MinX / TileSize; tileX <= (triangle.MaxX - 1) / TileSize; ++tileX)
+		{
+			_tiles[(static_cast<std::size_t>(tileY) * _tilesWide) + tileX].push_back(index);
+		}
+	}
+}
+
+void SoftwareRasterizer::DrawTile(std::size_t tileIndex)
+{
+	const int tileX = static_cast<int>(tileIndex % _tilesWide) * TileSize;
+	const int tileY = static_cast<int>(tileIndex / _tilesWide) * TileSize;
+
+	for (const auto index : _tiles[tileIndex])
+	{
+		const auto& triangle = _triangles[index];
+
+		DrawTriangleInTile(triangle,
+			std::max(triangle.MinX, tileX), std::max(triangle.MinY, tileY),
+			std::min(triangle.MaxX, tileX + TileSize), std::min(triangle.MaxY, tileY + TileSize));
+	}
+}
+
+void SoftwareRasterizer::DrawTriangleInTile(const Triangle& triangle, int minX, int minY, int maxX, int maxY)
+{
+	const auto& state = _states[triangle.State];
+
+	//Pixel centers
+	const Float4 laneOffsets{0.5f, 1.5f, 2.5f, 3.5f};
+
+	const Float4 zero{0.f};
+	const Float4 one{1.f};
+	const Float4 inverseArea{triangle.InverseArea};
+
+	for (int y = minY; y < maxY; ++y)
+	{
+		const float centerY = y + 0.5f;
+
+		float* const depthRow = &_depthBuffer[static_cast<std::size_t>(y) * _width];
+		std::uint8_t* const colorRow = &_colorBuffer[static_cast<std::size_t>(y) * _width * 4];
+
+		Float4 edgeRow[3];
+
+		for (int i = 0; i < 3; ++i)
+		{
+			edgeRow[i] = Float4{(triangle.EdgeB[i] * centerY) + triangle.EdgeC[i]};
+		}
+
+		for (int x = minX; x < maxX; x += 4)
+		{
+			const Float4 centerX = Float4{static_cast<float>(x)} + laneOffsets;
+
+			int mask = maxX - x >= 4 ? AllLanes : (1 << (maxX - x)) - 1;
+
+			Float4 lambda[3];
+
+			for (int i = 0; i < 3; ++i)
+			{
+				const Float4 edge = (Float4{triangle.EdgeA[i]} * centerX) + edgeRow[i];
+
+				mask &= triangle.EdgeInclusive[i] ? LessEqual(zero, edge) : Less(zero, edge);
+
+				lambda[i] = edge * inverseArea;
+			}
+
+			if (mask == 0)
+			{
+				continue;
+			}
+
+			const auto interpolate = [&](float v0, float v1, float v2)
+			{
+				return (lambda[0] * Float4{v0}) + (lambda[1] * Float4{v1}) + (lambda[2] * Float4{v2});
+			};
+
+			const Float4 depth = Min(Max(interpolate(triangle.Depth[0], triangle.Depth[1], triangle.Depth[2]), zero), one);
+
+			if (state.DepthTest)
+			{
+				mask &= DepthTest(state.DepthFunc, depth, Float4::Load(depthRow + x));
+
+				if (mask == 0)
+				{
+					continue;
+				}
+			}
+
+			const Float4 w = one / interpolate(triangle.InverseW[0], triangle.InverseW[1], triangle.InverseW[2]);
+
+			float depths[4];
+			float colors[4][4];
+			float texCoords[2][4];
+
+			depth.Store(depths);
+
+			for (int c = 0; c < 4; ++c)
+			{
+				(interpolate(triangle.Color[0][c], triangle.Color[1][c], triangle.Color[2][c]) * w).Store(colors[c]);
+			}
+
+			if (state.Texture)
+			{
+				for (int c = 0; c < 2; ++c)
+				{
+					(interpolate(triangle.TexCoord[0][c], triangle.TexCoord[1][c], triangle.TexCoord[2][c]) * w).Store(texCoords[c]);
+				}
+			}
+
+			for (int lane = 0; lane < 4; ++lane)
+			{
+				if (!(mask & (1 << lane)))
+				{
+					continue;
+				}
+
+				glm::vec4 color = state.FlatShading
+					? triangle.FlatColor
+					: glm::clamp(glm::vec4{colors[0][lane], colors[1][lane], colors[2][lane], colors[3][lane]}, glm::vec4{0}, glm::vec4{1});
+
+				//Like GL_MODULATE
+				if (state.Texture)
+				{
+					color *= SampleBilinear(*state.Texture, texCoords[0][lane], texCoords[1][lane]);
+				}
+
+				if (state.AlphaTest && !AlphaTest(state.AlphaFunc, color.a, state.AlphaReference))
+				{
+					continue;
+				}
+
+				//Depth is only written if depth testing is enabled, as in OpenGL
+				if (state.DepthTest && state.DepthWrite)
+				{
+					depthRow[x + lane] = depths[lane];
+				}
+
+				std::uint8_t* const pixel = colorRow + (static_cast<std::size_t>(x + lane) * 4);
+
+				if (state.BlendMode != SoftwareBlendMode::None)
+				{
+					const glm::vec4 destination = glm::vec4{pixel[0], pixel[1], pixel[2], pixel[3]} * (1.f / 255.f);
+
+					const float destinationFactor = state.BlendMode == SoftwareBlendMode::Additive ? 1.f : 1.f - color.a;
+
+					color = (color * color.a) + (destination * destinationFactor);
+				}
+
+				pixel[0] = ToByte(color.r);
+				pixel[1] = ToByte(color.g);
+				pixel[2] = ToByte(color.b);
+				pixel[3] = ToByte(color.a);
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include "graphics/OpenGL.hpp"
+
+#include "utility/WorkerPool.hpp"
+
+namespace graphics
+{
+/**
+*	@brief RGBA8888 image sampled by the software rasterizer. Rows are in the same order as images uploaded to OpenGL
+*/
+struct SoftwareTexture
+{
+	int Width = 0;
+	int Height = 0;
+	std::vector<std::uint8_t> Pixels;
+};
+
+enum class SoftwareBlendMode
+{
+	None = 0,
+
+	//GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+	Alpha,
+
+	//GL_SRC_ALPHA, GL_ONE
+	Additive
+};
+
+/**
+*	@brief Fixed function state used to draw a triangle. Mirrors the OpenGL state used to draw models
+*/
+struct SoftwareRasterState
+{
+	//Modulated with the vertex color. Sampled bilinearly with repeating texture coordinates. Null to use the vertex color only
+	const SoftwareTexture* Texture = nullptr;
+
+	SoftwareBlendMode BlendMode = SoftwareBlendMode::None;
+
+	bool AlphaTest = false;
+	GLenum AlphaFunc = GL_ALWAYS;
+	float AlphaReference = 0;
+
+	bool DepthTest = false;
+	GLenum DepthFunc = GL_LESS;
+	bool DepthWrite = true;
+
+	//Use the color of the last vertex for the whole triangle, like glShadeModel(GL_FLAT)
+	bool FlatShading = false;
+
+	bool Cull = false;
+
+	//Counter-clockwise triangles are front facing
+	GLenum CullFace = GL_BACK;
+};
+
+/**
+*	@brief Vertex with its position in clip space
+*/
+struct SoftwareVertex
+{
+	glm::vec4 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+};
+
+/**
+*	@brief Draws triangles to a color and depth buffer without using a graphics driver.
+*	Triangles are clipped and binned into screen tiles as they are submitted, then rasterized in parallel by Flush.
+*	Each tile draws its triangles in submission order on a single thread, so the result does not depend on the number of threads.
+*	Coverage, depth and attributes are computed for 4 pixels at a time, using SSE2 where available.
+*/
+class SoftwareRasterizer final
+{
+public:
+	static constexpr int TileSize = 64;
+
+	/**
+	*	@param workers Threads used to draw tiles
+	*/
+	explicit SoftwareRasterizer(WorkerPool& workers);
+	~SoftwareRasterizer();
+
+	SoftwareRasterizer(const SoftwareRasterizer&) = delete;
+	SoftwareRasterizer& operator=(const SoftwareRasterizer&) = delete;
+
+	int GetWidth() const { return _width; }
+
+	int GetHeight() const { return _height; }
+
+	/**
+	*	@brief RGBA8888 pixels, bottom row first like the pixels read back from OpenGL. Up to date after Flush
+	*/
+	const std::vector<std::uint8_t>& GetPixels() const { return _colorBuffer; }
+
+	/**
+	*	@brief Resizes the buffers and discards triangles that have not been drawn yet. The buffers must be cleared afterwards
+	*/
+	void Resize(int width, int height);
+
+	/**
+	*	@brief Clears the buffers and discards triangles that have not been drawn yet
+	*/
+	void Clear(const glm::vec4& color, float depth = 1);
+
+	/**
+	*	@brief Clips the triangle against the view volume and adds it to the tiles it covers.
+	*	Nothing is drawn until Flush is called
+	*/
+	void DrawTriangle(const SoftwareRasterState& state, const SoftwareVertex& v0, const SoftwareVertex& v1, const SoftwareVertex& v2);
+
+	/**
+	*	@brief Draws all triangles added since the last flush
+	*/
+	void Flush();
+
+private:
+	/**
+	*	@brief A clipped triangle in window coordinates, set up for rasterization
+	*/
+	struct Triangle
+	{
+		std::uint32_t State;
+
+		//Pixel bounds, clamped to the buffers. The maximum is exclusive
+		int MinX, MinY;
+		int MaxX, MaxY;
+
+		//Edge functions A * x + B * y + C, positive inside. Edge i is opposite vertex i
+		float EdgeA[3];
+		float EdgeB[3];
+		float EdgeC[3];
+
+		//Whether pixels exactly on the edge are inside, following the top-left rule
+		bool EdgeInclusive[3];
+
+		float InverseArea;
+
+		float Depth[3];
+
+		//Attributes are divided by w for perspective correct interpolation
+		float InverseW[3];
+		glm::vec4 Color[3];
+		glm::vec2 TexCoord[3];
+
+		//Color of the last vertex, used for flat shading
+		glm::vec4 FlatColor;
+	};
+
+	void AddTriangle(std::uint32_t state, const SoftwareVertex& v0, const SoftwareVertex& v1, const SoftwareVertex& v2);
+
+	void DrawTile(std::size_t tileIndex);
+
+	void DrawTriangleInTile(const Triangle& triangle, int minX, int minY, int maxX, int maxY);
+
+private:
+	WorkerPool& _workers;
+
+	int _width = 0;
+	int _height = 0;
+
+	int _tilesWide = 0;
+	int _tilesHigh = 0;
+
+	std::vector<std::uint8_t> _colorBuffer;
+	std::vector<float> _depthBuffer;
+
+	std::vector<SoftwareRasterState> _states;
+	std::vector<Triangle> _triangles;
+
+	//Indices of the triangles that cover each tile, in submission order
+	std::vector<std::vector<std::uint32_t>> _tiles;
+};
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include <glm/vec4.hpp>
+
+#include "engine/shared/renderer/studiomodel/IStudioModelRenderer.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+#include "entity/HLMVStudioModelEntity.hpp"
+
+#include "game/entity/BaseEntity.hpp"
+
+#include "graphics/Scene.hpp"
+#include "graphics/SoftwareSceneRenderer.hpp"
+#include "graphics/TextureLoader.hpp"
+
+namespace graphics
+{
+SoftwareSceneRenderer::SoftwareSceneRenderer(WorkerPool& workers)
+	: _rasterizer(workers)
+	, _backend(_rasterizer)
+{
+}
+
+SoftwareSceneRenderer::~SoftwareSceneRenderer() = default;
+
+const std::vector<std::uint8_t>& SoftwareSceneRenderer::Draw(Scene& scene, int width, int height)
+{
+	if (_rasterizer.GetWidth() != width || _rasterizer.GetHeight() != height)
+	{
+		_rasterizer.Resize(width, height);
+	}
+
+	_rasterizer.Clear(glm::vec4{scene.BackgroundColor, 1});
+
+	const auto entity = scene.GetEntity();
+
+	if (!entity)
+	{
+		return _rasterizer.GetPixels();
+	}
+
+	auto model = entity->GetEditableModel();
+
+	//Textures are converted the same way they are uploaded. Models that were never drawn with OpenGL get names only used here
+	std::vector<GLuint> textureIds;
+
+	textureIds.reserve(model->Textures.size());
+
+	for (const auto& texture : model->Textures)
+	{
+		textureIds.push_back(texture->TextureId);
+	}
+
+	const bool hasTextureIds = std::find(textureIds.begin(), textureIds.end(), 0) == textureIds.end();
+
+	_backend.ClearTextures();
+
+	for (std::size_t i = 0; i < model->Textures.size(); ++i)
+	{
+		auto& texture = *model->Textures[i];
+
+		if (!hasTextureIds)
+		{
+			texture.TextureId = static_cast<GLuint>(i + 1);
+		}
+
+		SoftwareTexture image;
+
+		std::tie(image.Width, image.Height) = scene.GetTextureLoader()->ConvertIndexed8(
+			texture.Width, texture.Height, texture.Pixels.data(), texture.Palette, (texture.Flags & STUDIO_NF_MASKED) != 0, image.Pixels);
+
+		_backend.SetTexture(texture.TextureId, std::move(image));
+	}
+
+	const unsigned int windowWidth = scene.GetWindowWidth();
+	const unsigned int windowHeight = scene.GetWindowHeight();
+
+	scene.UpdateWindowSize(width, height);
+
+	const auto camera = scene.GetCurrentCamera();
+
+	_backend.ResetState(camera->GetProjectionMatrix(), camera->GetViewMatrix());
+
+	//Same state as Scene::SetupRenderMode and Scene::DrawModel
+	const auto renderMode = scene.CurrentRenderMode;
+
+	_backend.SetPolygonMode(renderMode == RenderMode::WIREFRAME ? GL_LINE : GL_FILL);
+	_backend.SetEnabled(GL_TEXTURE_2D, renderMode == RenderMode::TEXTURE_SHADED);
+	_backend.SetEnabled(GL_CULL_FACE, renderMode != RenderMode::WIREFRAME && scene.EnableBackfaceCulling);
+	_backend.SetEnabled(GL_DEPTH_TEST, true);
+	_backend.SetShadeModel(renderMode == RenderMode::FLAT_SHADED ? GL_FLAT : GL_SMOOTH);
+
+	const glm::vec3& scale = entity->GetScale();
+
+	_backend.SetCullFace((scale.x * scale.y * scale.z) > 0 ? GL_FRONT : GL_BACK);
+
+	renderer::DrawFlags flags = renderer::DrawFlag::NONE;
+
+	if (scene.CameraIsFirstPerson)
+	{
+		flags |= renderer::DrawFlag::IS_VIEW_MODEL;
+	}
+
+	if (renderMode != RenderMode::TEXTURE_SHADED)
+	{
+		flags |= renderer::DrawFlag::NO_TEXTURES;
+	}
+
+	if (scene.DrawShadows)
+	{
+		flags |= renderer::DrawFlag::DRAW_SHADOWS;
+	}
+
+	if (scene.FixShadowZFighting)
+	{
+		flags |= renderer::DrawFlag::FIX_SHADOW_Z_FIGHTING;
+	}
+
+	//Only the immediate mode path records the skinned vertices without using OpenGL
+	const auto renderer = scene.GetEntityContext()->StudioModelRenderer;
+
+	const bool useVertexBuffers = renderer->ShouldUseVertexBuffers();
+	const bool useGPUSkinning = renderer->ShouldUseGPUSkinning();
+	const bool useTextureArrays = renderer->ShouldUseTextureArrays();
+
+	renderer->SetUseVertexBuffers(false);
+	renderer->SetUseGPUSkinning(false);
+	renderer->SetUseTextureArrays(false);
+
+	renderer->SetDrawCommandBackend(&_backend);
+	renderer->SetViewerOrigin(camera->GetOrigin());
+	renderer->SetViewerRight(camera->GetRightVector());
+	renderer->SetCullingViewProjection(camera->GetProjectionMatrix() * camera->GetViewMatrix());
+
+	renderer->RunFrame();
+
+	entity->Draw(flags);
+
+	renderer->SetCullingViewProjection(std::nullopt);
+	renderer->SetDrawCommandBackend(nullptr);
+
+	renderer->SetUseVertexBuffers(useVertexBuffers);
+	renderer->SetUseGPUSkinning(useGPUSkinning);
+	renderer->SetUseTextureArrays(useTextureArrays);
+
+	scene.UpdateWindowSize(windowWidth, windowHeight);
+
+	for (std::size_t i = 0; i < model->Textures.size(); ++i)
+	{
+		model->Textures[i]->TextureId = textureIds[i];
+	}
+
+	_rasterizer.Flush();
+
+	return _rasterizer.GetPixels();
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "graphics/SoftwareDrawCommandBackend.hpp"
+#include "graphics/SoftwareRasterizer.hpp"
+
+namespace graphics
+{
+class Scene;
+
+/**
+*	@brief Draws a scene's model without a graphics context, using the skinned vertices produced by the scene's model renderer.
+*	Used to draw on machines without a graphics driver and as a reference that doesn't depend on the driver.
+*	Only the background color and the model are drawn, including shadows. The ground, background image and overlays are not.
+*/
+class SoftwareSceneRenderer final
+{
+public:
+	/**
+	*	@param workers Threads used to draw
+	*/
+	explicit SoftwareSceneRenderer(WorkerPool& workers);
+	~SoftwareSceneRenderer();
+
+	SoftwareSceneRenderer(const SoftwareSceneRenderer&) = delete;
+	SoftwareSceneRenderer& operator=(const SoftwareSceneRenderer&) = delete;
+
+	/**
+	*	@brief Draws the scene as seen by its current camera
+	*	@return RGBA8888 pixels, bottom row first like the pixels read back from OpenGL. Valid until the next call
+	*/
+	const std::vector<std::uint8_t>& Draw(Scene& scene, int width, int height);
+
+private:
+	SoftwareRasterizer _rasterizer;
+	SoftwareDrawCommandBackend _backend;
+};
+}
@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <vector>
+
+#include "graphics/TGAFile.hpp"
+
+#include "utility/IOUtils.hpp"
+
+namespace graphics
+{
+namespace tgafile
+{
+namespace
+{
+enum ImageType : std::uint8_t
+{
+	IMAGE_TYPE_TRUECOLOR = 2,
+};
+}
+
+bool SaveTGAFile(const char* fileName, const int width, const int height, const std::uint8_t* rgbaPixels)
+{
+	if (!fileName || !(*fileName))
+		return false;
+
+	if (width <= 0 || width > 0xFFFF || height <= 0 || height > 0xFFFF)
+		return false;
+
+	if (!rgbaPixels)
+		return false;
+
+	FILE* file = utf8_fopen(fileName, "wb");
+
+	if (!file)
+		return false;
+
+	//Written byte by byte to avoid padding and endianness issues. The default origin is the bottom left corner
+	const std::uint8_t header[18] =
+	{
+		0,										//ID length
+		0,										//No color map
+		IMAGE_TYPE_TRUECOLOR,
+		0, 0, 0, 0, 0,							//Color map specification
+		0, 0, 0, 0,								//X and Y origin
+		static_cast<std::uint8_t>(width & 0xFF), static_cast<std::uint8_t>(width >> 8),
+		static_cast<std::uint8_t>(height & 0xFF), static_cast<std::uint8_t>(height >> 8),
+		24,										//Bits per pixel
+		0										//Image descriptor
+	};
+
+	bool success = fwrite(header, sizeof(header), 1, file) == 1;
+
+	std::vector<std::uint8_t> row(static_cast<std::size_t>(width) * 3);
+
+	for (int y = 0; success && y < height; ++y)
+	{
+		const std::uint8_t* source = rgbaPixels + (static_cast<std::size_t>(y) * width * 4);
+
+		//Stored as BGR
+		for (int x = 0; x < width; ++x, source += 4)
+		{
+			row[x * 3] = source[2];
+			row[(x * 3) + 1] = source[1];
+			row[(x * 3) + 2] = source[0];
+		}
+
+		success = fwrite(row.data(), row.size(), 1, file) == 1;
+	}
+
+	fclose(file);
+
+	return success;
+}
+}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace graphics
+{
+namespace tgafile
+{
+/**
+*	Saves an uncompressed 24 bit TGA file.
+*	@param fileName Filename to save to.
+*	@param width Width of the image.
+*	@param height Height of the image.
+*	@param rgbaPixels Pixels as RGBA 8 bit, bottom row first as read back from OpenGL. Alpha is not saved.
+*	@return true on success, false otherwise.
+*/
+bool SaveTGAFile(const char* fileName, const int width, const int height, const std::uint8_t* rgbaPixels);
+}
+}
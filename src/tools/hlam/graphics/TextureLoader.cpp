@@ -76,65 +76,18 @@ void TextureLoader::SetTextureFilters(TextureFilter minFilter, TextureFilter mag
 
 void TextureLoader::UploadRGBA8888(GLuint texture, int width, int height, const byte* rgbaPixels, bool generateMipmaps, bool masked)
 {
-	const auto [newWidth, newHeight] = AdjustImageDimensions(width, height);
-
 	std::vector<byte> pixels;
 
-	if (newWidth != width || newHeight != height)
-	{
-		std::vector<int> col1, col2;
-		std::vector<int> row1, row2;
-		
-		col1.resize(newWidth);
-		col2.resize(newWidth);
-
-		row1.resize(newHeight);
-		row2.resize(newHeight);
-
-		for (int i = 0; i < newWidth; ++i)
-		{
-			col1[i] = (int)((i + 0.25) * (width / (float)newWidth));
-			col2[i] = (int)((i + 0.75) * (width / (float)newWidth));
-		}
-
-		for (int i = 0; i < newHeight; ++i)
-		{
-			row1[i] = (int)((i + 0.25) * (height / (float)newHeight)) * width;
-			row2[i] = (int)((i + 0.75) * (height / (float)newHeight)) * width;
-		}
-
-		pixels.resize(newWidth * newHeight * 4);
-
-		for (int i = 0; i < newHeight; ++i)
-		{
-			for (int j = 0; j < newWidth; ++j)
-			{
-				const auto pix1 = &rgbaPixels[(row1[i] + col1[j]) * 4];
-				const auto pix2 = &rgbaPixels[(row1[i] + col2[j]) * 4];
-				const auto pix3 = &rgbaPixels[(row2[i] + col1[j]) * 4];
-				const auto pix4 = &rgbaPixels[(row2[i] + col2[j]) * 4];
-
-				byte* const pixel = &pixels[((newWidth * i) + j) * 4];
-
-				for (int p = 0; p < 4; ++p)
-				{
-					pixel[p] = (pix1[p] + pix2[p] + pix3[p] + pix4[p]) / 4;
-				}
-
-				//If any of the sampled pixels are transparent the destination pixel is also transparent
-				if (masked && pixel[3] != 0xFF)
-				{
-					pixel[3] = 0x00;
-				}
-			}
-		}
+	const auto [newWidth, newHeight] = ResizeRGBA8888(width, height, rgbaPixels, masked, pixels);
 
+	if (!pixels.empty())
+	{
 		rgbaPixels = pixels.data();
 	}
 
 	glBindTexture(GL_TEXTURE_2D, texture);
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, newWidth, newHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaPixels);
-	SetFilters(texture, generateMipmaps);
+	SetFilters(generateMipmaps);
 
 	if (generateMipmaps)
 	{
@@ -145,6 +98,67 @@ void TextureLoader::UploadRGBA8888(GLuint texture, int width, int height, const
 void TextureLoader::UploadIndexed8(GLuint texture, int width, int height, const byte* pixels, const RGBPalette& palette, bool generateMipmaps, bool masked)
 {
 	//TODO: total size can be too large
+	const auto rgbaPixels = Indexed8ToRGBA8888(width, height, pixels, palette, masked);
+
+	UploadRGBA8888(texture, width, height, rgbaPixels.data(), generateMipmaps, masked);
+}
+
+void TextureLoader::SetFilters(bool hasMipmaps)
+{
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, hasMipmaps ? _glMinFilter : _glMagFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _glMagFilter);
+}
+
+std::pair<int, int> TextureLoader::ConvertIndexed8(int width, int height, const byte* pixels, const RGBPalette& palette, bool masked,
+	std::vector<byte>& rgbaPixels) const
+{
+	rgbaPixels = Indexed8ToRGBA8888(width, height, pixels, palette, masked);
+
+	std::vector<byte> resizedPixels;
+
+	const auto size = ResizeRGBA8888(width, height, rgbaPixels.data(), masked, resizedPixels);
+
+	if (!resizedPixels.empty())
+	{
+		rgbaPixels = std::move(resizedPixels);
+	}
+
+	return size;
+}
+
+std::pair<int, int> TextureLoader::AdjustImageDimensions(int width, int height) const
+{
+	if (!ShouldResizeToPowerOf2())
+	{
+		return {width, height};
+	}
+
+	int newWidth, newHeight;
+
+	for (newWidth = 1; newWidth > 0 && newWidth < width; newWidth <<= 1)
+	{
+	}
+
+	for (newHeight = 1; newHeight > 0 && newHeight < height; newHeight <<= 1)
+	{
+	}
+
+	//If the initial dimensions exceed the largest power of 2 then it should be clamped to that value
+	if (newWidth < 0)
+	{
+		newWidth = 1 << 31;
+	}
+
+	if (newHeight < 0)
+	{
+		newHeight = 1 << 31;
+	}
+
+	return {newWidth, newHeight};
+}
+
+std::vector<byte> TextureLoader::Indexed8ToRGBA8888(int width, int height, const byte* pixels, const RGBPalette& palette, bool masked)
+{
 	RGBPalette localPalette{palette};
 
 	//Sets the mask color to black. This helps limit the bleedover effect caused by resizing and filtering
@@ -175,41 +189,63 @@ void TextureLoader::UploadIndexed8(GLuint texture, int width, int height, const
 		}
 	}
 
-	UploadRGBA8888(texture, width, height, rgbaPixels.data(), generateMipmaps, masked);
+	return rgbaPixels;
 }
 
-void TextureLoader::SetFilters(GLuint texture, bool hasMipmaps)
+std::pair<int, int> TextureLoader::ResizeRGBA8888(int width, int height, const byte* rgbaPixels, bool masked, std::vector<byte>& resizedPixels) const
 {
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, hasMipmaps ? _glMinFilter : _glMagFilter);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, _glMagFilter);
-}
+	const auto [newWidth, newHeight] = AdjustImageDimensions(width, height);
 
-std::pair<int, int> TextureLoader::AdjustImageDimensions(int width, int height) const
-{
-	if (!ShouldResizeToPowerOf2())
+	if (newWidth == width && newHeight == height)
 	{
 		return {width, height};
 	}
 
-	int newWidth, newHeight;
+	std::vector<int> col1, col2;
+	std::vector<int> row1, row2;
+	
+	col1.resize(newWidth);
+	col2.resize(newWidth);
 
-	for (newWidth = 1; newWidth > 0 && newWidth < width; newWidth <<= 1)
-	{
-	}
+	row1.resize(newHeight);
+	row2.resize(newHeight);
 
-	for (newHeight = 1; newHeight > 0 && newHeight < height; newHeight <<= 1)
+	for (int i = 0; i < newWidth; ++i)
 	{
+		col1[i] = (int)((i + 0.25) * (width / (float)newWidth));
+		col2[i] = (int)((i + 0.75) * (width / (float)newWidth));
 	}
 
-	//If the initial dimensions exceed the largest power of 2 then it should be clamped to that value
-	if (newWidth < 0)
+	for (int i = 0; i < newHeight; ++i)
 	{
-		newWidth = 1 << 31;
+		row1[i] = (int)((i + 0.25) * (height / (float)newHeight)) * width;
+		row2[i] = (int)((i + 0.75) * (height / (float)newHeight)) * width;
 	}
 
-	if (newHeight < 0)
+	resizedPixels.resize(newWidth * newHeight * 4);
+
+	for (int i = 0; i < newHeight; ++i)
 	{
-		newHeight = 1 << 31;
+		for (int j = 0; j < newWidth; ++j)
+		{
+			const auto pix1 = &rgbaPixels[(row1[i] + col1[j]) * 4];
+			const auto pix2 = &rgbaPixels[(row1[i] + col2[j]) * 4];
+			const auto pix3 = &rgbaPixels[(row2[i] + col1[j]) * 4];
+			const auto pix4 = &rgbaPixels[(row2[i] + col2[j]) * 4];
+
+			byte* const pixel = &resizedPixels[((newWidth * i) + j) * 4];
+
+			for (int p = 0; p < 4; ++p)
+			{
+				pixel[p] = (pix1[p] + pix2[p] + pix3[p] + pix4[p]) / 4;
+			}
+
+			//If any of the sampled pixels are transparent the destination pixel is also transparent
+			if (masked && pixel[3] != 0xFF)
+			{
+				pixel[3] = 0x00;
+			}
+		}
 	}
 
 	return {newWidth, newHeight};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <utility>
+#include <vector>
 
 #include <GL/glew.h>
 
@@ -53,11 +54,31 @@ public:
 
 	void UploadIndexed8(GLuint texture, int width, int height, const byte* pixels, const RGBPalette& palette, bool generateMipmaps, bool masked);
 
-	void SetFilters(GLuint texture, bool hasMipmaps);
+	/**
+	*	@brief Sets the filters of the texture bound to GL_TEXTURE_2D
+	*/
+	void SetFilters(bool hasMipmaps);
+
+	/**
+	*	@brief Converts an indexed image to RGBA8888 the same way UploadIndexed8 does, including resizing.
+	*	Does not require a graphics context
+	*	@return Dimensions of the converted image
+	*/
+	std::pair<int, int> ConvertIndexed8(int width, int height, const byte* pixels, const RGBPalette& palette, bool masked,
+		std::vector<byte>& rgbaPixels) const;
 
 private:
 	std::pair<int, int> AdjustImageDimensions(int width, int height) const;
 
+	static std::vector<byte> Indexed8ToRGBA8888(int width, int height, const byte* pixels, const RGBPalette& palette, bool masked);
+
+	/**
+	*	@brief Resizes the image if needed
+	*	@param[out] resizedPixels The resized image. Left unchanged if the image does not need resizing
+	*	@return Dimensions of the resized image
+	*/
+	std::pair<int, int> ResizeRGBA8888(int width, int height, const byte* rgbaPixels, bool masked, std::vector<byte>& resizedPixels) const;
+
 private:
 	TextureFilter _minFilter{TextureFilter::Linear};
 	TextureFilter _magFilter{TextureFilter::Linear};
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "graphics/TiledImageRenderer.hpp"
+
+namespace graphics
+{
+TiledImageRenderer::TiledImageRenderer(Scene* scene, int width, int height)
+	: _scene(scene)
+	, _width(width)
+	, _height(height)
+{
+	assert(_scene);
+	assert(_width > 0 && _height > 0);
+}
+
+TiledImageRenderer::~TiledImageRenderer()
+{
+	assert(!_framebuffer.IsValid());
+}
+
+bool TiledImageRenderer::Initialize(int tileSize)
+{
+	Shutdown();
+
+	tileSize = std::min(tileSize, OffscreenFramebuffer::GetMaximumSize());
+
+	//Images smaller than a tile only need one tile
+	const int tileWidth = std::min(_width, tileSize);
+	const int tileHeight = std::min(_height, tileSize);
+
+	if (!_framebuffer.Create(tileWidth, tileHeight))
+	{
+		return false;
+	}
+
+	_readbackQueue.Create(ReadbackBufferCount, tileWidth, tileHeight);
+
+	_tiles.clear();
+
+	for (int y = 0; y < _height; y += tileHeight)
+	{
+		for (int x = 0; x < _width; x += tileWidth)
+		{
+			_tiles.push_back(ImageTile{
+				static_cast<unsigned int>(x),
+				static_cast<unsigned int>(y),
+				static_cast<unsigned int>(std::min(tileWidth, _width - x)),
+				static_cast<unsigned int>(std::min(tileHeight, _height - y))});
+		}
+	}
+
+	_nextTile = 0;
+	_completedTileCount = 0;
+
+	_pixels.resize(static_cast<std::size_t>(_width) * _height * 4);
+
+	return true;
+}
+
+void TiledImageRenderer::Shutdown()
+{
+	_readbackQueue.Destroy();
+	_framebuffer.Destroy();
+}
+
+bool TiledImageRenderer::Step()
+{
+	if (!_framebuffer.IsValid() || IsComplete() || HasFailed())
+	{
+		return IsComplete();
+	}
+
+	_completedTileCount += _readbackQueue.Collect([this](auto tileIndex, auto pixels, auto width, auto height)
+		{
+			CopyTile(tileIndex, pixels, width, height);
+		});
+
+	//Drawing the remaining tiles is pointless
+	if (HasFailed())
+	{
+		return false;
+	}
+
+	if (_nextTile < _tiles.size() && !_readbackQueue.IsFull())
+	{
+		_framebuffer.Bind();
+
+		do
+		{
+			const auto& tile = _tiles[_nextTile];
+
+			_scene->DrawTile(_width, _height, tile);
+
+			_readbackQueue.Read(_nextTile, 0, 0, tile.Width, tile.Height);
+
+			++_nextTile;
+		}
+		while (_nextTile < _tiles.size() && !_readbackQueue.IsFull());
+
+		_framebuffer.Unbind();
+	}
+
+	return IsComplete();
+}
+
+void TiledImageRenderer::CopyTile(std::uint64_t tileIndex, const std::uint8_t* pixels, int width, int height)
+{
+	const auto& tile = _tiles[tileIndex];
+
+	const std::size_t rowSize = static_cast<std::size_t>(width) * 4;
+
+	//Tiles are bottom row first, the image is top row first
+	for (int row = 0; row < height; ++row)
+	{
+		const std::size_t imageRow = _height - 1 - (tile.Y + row);
+
+		std::memcpy(_pixels.data() + ((imageRow * _width) + tile.X) * 4, pixels + (row * rowSize), rowSize);
+	}
+}
+}
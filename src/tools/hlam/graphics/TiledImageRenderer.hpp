@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "graphics/OffscreenFramebuffer.hpp"
+#include "graphics/PixelReadbackQueue.hpp"
+#include "graphics/Scene.hpp"
+
+namespace graphics
+{
+/**
+*	@brief Draws a scene into an image that can be larger than the window or the maximum framebuffer size.
+*	The image is drawn in tiles to an offscreen framebuffer using a projection adjusted to each tile.
+*	Tiles are read back asynchronously and copied into the image once available,
+*	so drawing is split into steps that the caller can run in between handling events.
+*/
+class TiledImageRenderer final
+{
+public:
+	static constexpr int DefaultTileSize = 1024;
+
+	//Tiles that can be read back at the same time
+	static constexpr std::size_t ReadbackBufferCount = 4;
+
+	TiledImageRenderer(Scene* scene, int width, int height);
+	~TiledImageRenderer();
+
+	TiledImageRenderer(const TiledImageRenderer&) = delete;
+	TiledImageRenderer& operator=(const TiledImageRenderer&) = delete;
+
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+
+	std::size_t GetTileCount() const { return _tiles.size(); }
+
+	std::size_t GetCompletedTileCount() const { return _completedTileCount; }
+
+	bool IsComplete() const { return !_tiles.empty() && _completedTileCount == _tiles.size(); }
+
+	/**
+	*	@brief Whether a tile could not be read back. The image can't be completed if so
+	*/
+	bool HasFailed() const { return _readbackQueue.GetFailedCount() > 0; }
+
+	/**
+	*	@brief Creates the framebuffer and readback buffers. The scene's graphics context must be current
+	*	@param tileSize Maximum width and height of a tile. Clamped to what the context supports
+	*	@return Whether the resources were created successfully. Errors are logged
+	*/
+	bool Initialize(int tileSize = DefaultTileSize);
+
+	/**
+	*	@brief Destroys the framebuffer and readback buffers. The scene's graphics context must be current
+	*/
+	void Shutdown();
+
+	/**
+	*	@brief Copies tiles that have been read back into the image and draws tiles until all readback buffers are in use.
+	*	The scene's graphics context must be current. Scene state should not change until the image is complete.
+	*	Does nothing once a tile has failed to be read back
+	*	@return Whether the image is complete
+	*/
+	bool Step();
+
+	/**
+	*	@brief The image as RGBA, top row first
+	*/
+	const std::vector<std::uint8_t>& GetPixels() const { return _pixels; }
+
+	/**
+	*	@brief Moves the image out of the renderer
+	*/
+	std::vector<std::uint8_t> TakePixels() { return std::move(_pixels); }
+
+private:
+	void CopyTile(std::uint64_t tileIndex, const std::uint8_t* pixels, int width, int height);
+
+private:
+	Scene* const _scene;
+
+	const int _width;
+	const int _height;
+
+	std::vector<ImageTile> _tiles;
+
+	std::size_t _nextTile = 0;
+	std::size_t _completedTileCount = 0;
+
+	OffscreenFramebuffer _framebuffer;
+	PixelReadbackQueue _readbackQueue;
+
+	std::vector<std::uint8_t> _pixels;
+};
+}
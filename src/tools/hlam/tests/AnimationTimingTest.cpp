@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/shared/WorldTime.hpp"
+
+#include "entity/HLMVStudioModelEntity.hpp"
+
+#include "game/Events.hpp"
+#include "game/entity/BaseEntity.hpp"
+#include "game/entity/EntityManager.hpp"
+
+#include "graphics/Scene.hpp"
+#include "graphics/TextureLoader.hpp"
+
+#include "soundsystem/ISoundSystem.hpp"
+
+#include "tests/TestStudioModel.hpp"
+
+#include "utility/WorkerPool.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+constexpr int FrameCount = 30;
+constexpr float FPS = 30;
+constexpr float LoopLength = FrameCount - 1;
+
+//Same as the default tick rate. Each step advances the sequence by half a frame
+constexpr float TimeStep = 1 / 60.0f;
+constexpr float FramesPerStep = TimeStep * FPS;
+
+//A little over 3 loops, so the last loop is not complete
+constexpr int StepCount = 179;
+
+const std::vector<int> EventFrames{0, 10, 20, 28};
+
+/**
+*	@brief Records the sound events that the entity plays
+*/
+class RecordingSoundSystem final : public soundsystem::ISoundSystem
+{
+public:
+	bool IsSoundAvailable() const override { return true; }
+
+	bool Initialize(filesystem::IFileSystem*) override { return true; }
+
+	void Shutdown() override {}
+
+	void RunFrame() override {}
+
+	void PlaySound(std::string_view fileName, float, int) override
+	{
+		Sounds.emplace_back(fileName);
+	}
+
+	void StopAllSounds() override {}
+
+	std::vector<std::string> Sounds;
+};
+
+std::string GetEventSound(int frame)
+{
+	return "frame" + std::to_string(frame);
+}
+
+void AddSoundEvents(Sequence& sequence)
+{
+	for (int frame : EventFrames)
+	{
+		auto event = std::make_unique<SequenceEvent>();
+
+		event->Frame = frame;
+		event->EventId = SCRIPT_EVENT_SOUND;
+		event->Options = GetEventSound(frame);
+
+		sequence.SortedEvents.push_back(event.get());
+		sequence.Events.push_back(std::move(event));
+	}
+
+	SortEventsList(sequence.SortedEvents);
+
+	//Looping sequences also fire events near the start of the sequence before wrapping, like GoldSource does.
+	//Leave that out so each event fires exactly once per loop; the entity still loops the sequence
+	sequence.Flags &= ~STUDIO_LOOPING;
+}
+
+/**
+*	@return Distance between two frames, taking wrapping around the end of the sequence into account
+*/
+float GetFrameDistance(float lhs, float rhs)
+{
+	const float distance = std::abs(std::fmod(lhs, LoopLength) - std::fmod(rhs, LoopLength));
+
+	return std::min(distance, LoopLength - distance);
+}
+}
+
+/**
+*	@brief Steps the world time and the entity the way EditorContext::OnTimerTick does
+*	and checks the frames, interpolated frames and animation events that result
+*/
+int main()
+{
+	tests::TestStudioModelSettings settings;
+
+	settings.BoneCount = 4;
+	settings.FrameCount = FrameCount;
+	settings.SequenceBlends = {1};
+	settings.SubmodelCount = 1;
+	settings.VertexCount = 10;
+	settings.MeshCount = 1;
+	settings.TriangleCommandsPerMesh = 1;
+
+	auto studioModel = tests::CreateTestStudioModel(settings);
+
+	auto& sequence = *studioModel->Sequences[0];
+
+	sequence.FPS = FPS;
+
+	AddSoundEvents(sequence);
+
+	WorldTime worldTime;
+	RecordingSoundSystem soundSystem;
+	graphics::TextureLoader textureLoader;
+	WorkerPool workerPool{1};
+
+	graphics::Scene scene{&textureLoader, &soundSystem, &worldTime, &workerPool};
+
+	auto entity = static_cast<HLMVStudioModelEntity*>(scene.GetEntityContext()->EntityManager->Create("studiomodel", scene.GetEntityContext(),
+		glm::vec3(), glm::vec3(), false));
+
+	Check(entity != nullptr, "The entity is created");
+
+	if (!entity)
+	{
+		return 1;
+	}
+
+	entity->SetEditableModel(studioModel.get());
+	entity->Spawn();
+	entity->PlaySound = true;
+	//Starts the animation time
+	entity->SetFrame(0);
+
+	const float startTime = worldTime.GetTime();
+
+	bool framesMatch = true;
+	bool interpolatedFramesMatch = true;
+	bool interpolatedFramesInRange = true;
+	int wraps = 0;
+
+	for (int step = 1; step <= StepCount; ++step)
+	{
+		worldTime.AdvanceTime(TimeStep);
+		scene.Tick();
+
+		const float previousFrame = (step - 1) * FramesPerStep;
+		const float frame = step * FramesPerStep;
+
+		if (std::fmod(frame, LoopLength) < std::fmod(previousFrame, LoopLength))
+		{
+			++wraps;
+		}
+
+		//A fraction of 1 is the current frame
+		for (float fraction : {0.0f, 0.25f, 0.5f, 0.75f, 1.0f})
+		{
+			worldTime.SetInterpolationFraction(fraction);
+
+			const float interpolatedFrame = entity->GetInterpolatedFrame();
+
+			interpolatedFramesInRange = interpolatedFramesInRange && interpolatedFrame >= 0 && interpolatedFrame < LoopLength;
+
+			const float expectedFrame = previousFrame + ((frame - previousFrame) * fraction);
+
+			if (fraction == 1.0f)
+			{
+				framesMatch = framesMatch && GetFrameDistance(interpolatedFrame, expectedFrame) <= 1e-3f;
+			}
+			else
+			{
+				interpolatedFramesMatch = interpolatedFramesMatch && GetFrameDistance(interpolatedFrame, expectedFrame) <= 1e-3f;
+			}
+		}
+
+		worldTime.SetInterpolationFraction(0);
+	}
+
+	Check(std::abs(worldTime.GetTime() - (startTime + (StepCount * TimeStep))) <= 1e-4f, "World time advances by the time step every step");
+	Check(worldTime.GetFrameTime() == TimeStep, "The frame time is the time step");
+	Check(std::abs(worldTime.GetPreviousTime() - (worldTime.GetTime() - TimeStep)) <= 1e-5f, "The previous time is one time step ago");
+
+	Check(wraps == 3, "The sequence wraps once per loop");
+	Check(framesMatch, "Every step advances the sequence by the time step times the frame rate");
+	Check(interpolatedFramesMatch, "Interpolated frames are between the previous and current frame, also right after wrapping");
+	Check(interpolatedFramesInRange, "Interpolated frames stay within the sequence, also when the previous frame is negative");
+
+	//Events fire in the order the frames were reached, once every loop
+	std::vector<std::string> expectedSounds;
+
+	for (int loop = 0; loop * LoopLength < StepCount * FramesPerStep; ++loop)
+	{
+		for (int frame : EventFrames)
+		{
+			if (frame + (loop * LoopLength) < StepCount * FramesPerStep)
+			{
+				expectedSounds.push_back(GetEventSound(frame));
+			}
+		}
+	}
+
+	std::printf("%zu events dispatched, %zu expected\n", soundSystem.Sounds.size(), expectedSounds.size());
+
+	Check(soundSystem.Sounds == expectedSounds, "Every event fires exactly once per loop, in order");
+
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+#include <cstdio>
+#include <vector>
+
+#include "engine/renderer/studiomodel/StudioModelRenderer.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+#include "graphics/CountingDrawCommandBackend.hpp"
+#include "graphics/DrawCommandList.hpp"
+
+#include "tests/TestStudioModel.hpp"
+
+#include "utility/WorkerPool.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+/**
+*	@brief Counts the triangle strips and fans of a submodel, each of which is one draw call in immediate mode
+*/
+std::size_t CountTriangleCommands(const Model& model)
+{
+	std::size_t count = 0;
+
+	for (const auto& mesh : model.Meshes)
+	{
+		for (auto commands = mesh.Triangles.data(); *commands != 0;)
+		{
+			const int vertexCount = *commands < 0 ? -*commands : *commands;
+
+			++count;
+			commands += 1 + (vertexCount * 4);
+		}
+	}
+
+	return count;
+}
+
+void TestTexturingState()
+{
+	graphics::DrawCommandList commands;
+
+	Check(!commands.IsTexturingEnabled(), "Texturing is disabled by default");
+
+	commands.Enable(GL_TEXTURE_2D);
+	Check(commands.IsTexturingEnabled(), "Enabling texturing is tracked");
+
+	commands.PushAttrib(GL_ENABLE_BIT);
+	commands.Disable(GL_TEXTURE_2D);
+	Check(!commands.IsTexturingEnabled(), "Disabling texturing is tracked");
+
+	commands.PushAttrib(GL_DEPTH_BUFFER_BIT);
+	commands.Enable(GL_TEXTURE_2D);
+	commands.PopAttrib();
+	Check(commands.IsTexturingEnabled(), "Popping attributes without the enable bit keeps texturing");
+
+	commands.PopAttrib();
+	Check(commands.IsTexturingEnabled(), "Popping the enable bit restores texturing");
+
+	commands.Disable(GL_TEXTURE_2D);
+	commands.Clear();
+	Check(!commands.IsTexturingEnabled(), "Clearing keeps the texturing state");
+}
+}
+
+int main()
+{
+	TestTexturingState();
+
+	tests::TestStudioModelSettings settings;
+
+	settings.SubmodelCount = 2;
+	settings.MeshCount = 4;
+	settings.TriangleCommandsPerMesh = 50;
+
+	auto studioModel = tests::CreateTestStudioModel(settings);
+
+	//Textures are never uploaded, but they need distinct names to be bound
+	for (std::size_t i = 0; i < studioModel->Textures.size(); ++i)
+	{
+		studioModel->Textures[i]->TextureId = static_cast<GLuint>(i + 1);
+	}
+
+	auto& submodel = studioModel->Bodyparts[0]->Models[0];
+	const std::size_t expectedDrawCalls = CountTriangleCommands(submodel);
+
+	//Half of the meshes share a texture with another mesh
+	for (std::size_t i = 0; i < submodel.Meshes.size(); ++i)
+	{
+		submodel.Meshes[i].SkinRef = static_cast<int>(i / 2);
+	}
+
+	const unsigned int expectedTextureBinds = static_cast<unsigned int>((submodel.Meshes.size() + 1) / 2);
+
+	graphics::CountingDrawCommandBackend backend;
+
+	WorkerPool workerPool;
+
+	//Only the immediate mode path draws without using OpenGL directly
+	StudioModelRenderer renderer{&workerPool};
+
+	renderer.Initialize();
+	renderer.SetUseVertexBuffers(false);
+	renderer.SetUseGPUSkinning(false);
+	renderer.SetUseTextureArrays(false);
+	renderer.SetDrawCommandBackend(&backend);
+
+	ModelRenderInfo renderInfo{};
+
+	renderInfo.Scale = glm::vec3{1};
+	renderInfo.Model = studioModel.get();
+	renderInfo.Transparency = 1;
+
+	std::vector<std::size_t> frameCommandCounts;
+
+	for (int frame = 0; frame < 2; ++frame)
+	{
+		backend.Reset();
+		renderer.RunFrame();
+
+		const unsigned int polygons = renderer.DrawModel(&renderInfo, renderer::DrawFlag::NONE);
+
+		std::printf("Frame %d: %u lists, %zu commands, %u draw calls, %u state changes, %u texture binds\n",
+			frame, backend.GetListCount(), backend.GetCommandCount(),
+			backend.GetStatistics().DrawCalls, backend.GetStatistics().StateChanges, backend.GetStatistics().TextureBinds);
+
+		int expectedPolygons = 0;
+
+		for (const auto& mesh : submodel.Meshes)
+		{
+			expectedPolygons += mesh.NumTriangles;
+		}
+
+		Check(polygons == static_cast<unsigned int>(expectedPolygons), "All polygons of the submodel are drawn");
+		Check(backend.GetListCount() > 0, "Commands are executed by the backend");
+		Check(backend.GetCount(graphics::DrawCommandType::Primitive) == expectedDrawCalls, "Each triangle command is one primitive");
+		Check(backend.GetStatistics().DrawCalls == expectedDrawCalls, "No draw calls besides the primitives");
+		Check(backend.GetCount(graphics::DrawCommandType::DrawElements) == 0, "Immediate mode doesn't draw elements");
+		Check(backend.GetStatistics().TextureBinds == expectedTextureBinds, "Each texture is bound once");
+
+		frameCommandCounts.push_back(backend.GetCommandCount());
+	}
+
+	Check(frameCommandCounts[0] == frameCommandCounts[1], "Drawing the same model twice records the same commands");
+
+	{
+		backend.Reset();
+		renderer.DrawModel(&renderInfo, renderer::DrawFlag::NONE);
+
+		const auto enables = backend.GetCount(graphics::DrawCommandType::Enable);
+		const auto disables = backend.GetCount(graphics::DrawCommandType::Disable);
+
+		backend.Reset();
+		renderer.DrawModel(&renderInfo, renderer::DrawFlag::NO_TEXTURES);
+
+		Check(backend.GetCount(graphics::DrawCommandType::Enable) == enables - 1
+			&& backend.GetCount(graphics::DrawCommandType::Disable) == disables + 1,
+			"Drawing without textures records texturing as disabled");
+	}
+
+	renderer.Shutdown();
+
+	return Failures == 0 ? 0 : 1;
+}
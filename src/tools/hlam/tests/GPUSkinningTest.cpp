@@ -0,0 +1,67 @@
+#include <cstdio>
+
+#include "application/OffscreenGraphicsContext.hpp"
+
+#include "core/shared/Logging.hpp"
+
+#include "engine/renderer/studiomodel/StudioModelRenderer.hpp"
+
+#include "utility/WorkerPool.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+//Tells ctest that the test was skipped
+constexpr int SkipReturnCode = 77;
+}
+
+/**
+*	@brief Compiles and links the GLSL skinning program in an OpenGL 3.0 context created with EGL.
+*	Skipped if no such context can be created, for instance if there is no EGL driver.
+*/
+int main()
+{
+	//Shader compiler and linker errors are logged
+	logging().SetLogListener(GetStdOutLogListener());
+
+	OffscreenGraphicsContext context;
+
+	if (!context.Create())
+	{
+		std::printf("SKIPPED: Couldn't create an OpenGL 3.0 context\n");
+		return SkipReturnCode;
+	}
+
+	context.Begin();
+
+	std::printf("OpenGL %s, %s\n", reinterpret_cast<const char*>(glGetString(GL_VERSION)), reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+
+	{
+		WorkerPool workerPool{1};
+		StudioModelRenderer renderer{&workerPool};
+
+		renderer.Initialize();
+
+		Check(renderer.IsGPUSkinningSupported(), "The skinning program compiles and links");
+		Check(renderer.IsGPUSkinningSupported(), "The skinning program is reused");
+		Check(glGetError() == GL_NO_ERROR, "Setting up the skinning program causes no OpenGL errors");
+
+		renderer.Shutdown();
+	}
+
+	context.End();
+
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "engine/renderer/studiomodel/StudioSkinning.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+//Light values are in [0, 1] and end up as 8 bit colors, so this is far below anything visible.
+//It allows for a few units in the last place from dividing by lambert instead of multiplying by its inverse
+//and from subtracting in single instead of double precision
+constexpr float MaximumError = 1.0f / (1 << 22);
+
+/**
+*	@brief The per-normal calculation before the lambert terms were precomputed
+*/
+float CalculateOriginal(const LightingParameters& lighting, float lightcos)
+{
+	float illum = lighting.Ambient;
+
+	if (lightcos > 1.0f) lightcos = 1;
+
+	illum += lighting.Shade;
+
+	lightcos = (lightcos + (lighting.Lambert - 1.0f)) / lighting.Lambert; // do modified hemispherical lighting
+	if (lightcos > 0.0f) illum = illum + -lightcos * static_cast<double>(lighting.Shade);
+
+	if (illum <= 0) illum = 0;
+
+	if (illum > 1.0f)
+		illum *= 1.0f / illum;
+
+	return illum;
+}
+
+/**
+*	@brief Sets up the parameters the same way as StudioModelRenderer::GetLightingParameters
+*/
+LightingParameters CreateLighting(int ambientlight, int shadelight, float lambert)
+{
+	LightingParameters lighting;
+
+	lighting.Ambient = std::max(0.1f, ambientlight / 255.0f);
+	lighting.Shade = shadelight / 255.0f;
+	lighting.Lambert = std::max(1.0f, lambert);
+	//The illumination is the same for all components, so compare a single one
+	lighting.LightColor = glm::vec3{1};
+
+	lighting.AmbientAndShade = lighting.Ambient + lighting.Shade;
+	lighting.InverseLambert = 1.0f / lighting.Lambert;
+	lighting.LambertOffset = (lighting.Lambert - 1.0f) * lighting.InverseLambert;
+
+	return lighting;
+}
+}
+
+/**
+*	@brief Compares LightingParameters::Calculate against the calculation it replaced
+*	over the range of light cosines and lambert factors that the renderer uses
+*/
+int main()
+{
+	float maximumError = 0;
+	long long identical = 0;
+	long long total = 0;
+
+	for (int ambientlight = 0; ambientlight <= 255; ambientlight += 15)
+	{
+		for (int shadelight = 0; shadelight <= 255; shadelight += 15)
+		{
+			//1.5 is the default lambert factor. Values below 1 are clamped to 1
+			for (float lambert : {0.5f, 1.0f, 1.25f, 1.5f, 2.0f, 3.0f, 4.0f, 10.0f})
+			{
+				const auto lighting = CreateLighting(ambientlight, shadelight, lambert);
+
+				//Normals are unit length, so the cosine is in [-1, 1]. Values slightly outside are included for rounding errors
+				for (int i = -1100; i <= 1100; ++i)
+				{
+					const float lightcos = i / 1000.0f;
+
+					const float original = CalculateOriginal(lighting, lightcos);
+					const float current = lighting.Calculate(lightcos).x;
+
+					const float error = std::abs(original - current);
+
+					maximumError = std::max(maximumError, error);
+
+					if (original == current)
+					{
+						++identical;
+					}
+
+					++total;
+				}
+			}
+		}
+	}
+
+	std::printf("Maximum error: %g (bound %g), %lld of %lld values identical\n", maximumError, MaximumError, identical, total);
+
+	Check(maximumError <= MaximumError, "Light values are within the error bound of the original calculation");
+
+	const auto lighting = CreateLighting(255, 255, 1.5f);
+	Check(lighting.Calculate(-1).x == 1.0f, "Light values above 1 are clamped to exactly 1");
+
+	return Failures == 0 ? 0 : 1;
+}
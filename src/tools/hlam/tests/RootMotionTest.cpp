@@ -0,0 +1,229 @@
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+#include "tests/TestStudioModel.hpp"
+
+#include "utility/mathlib.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+bool IsNear(float lhs, float rhs, float tolerance = 1e-3f)
+{
+	return std::abs(lhs - rhs) <= tolerance;
+}
+
+bool IsNear(const glm::vec3& lhs, const glm::vec3& rhs, float tolerance = 1e-3f)
+{
+	return glm::length(lhs - rhs) <= tolerance;
+}
+
+constexpr int FrameCount = 30;
+constexpr float LinearSpeed = 30;
+constexpr float YawScale = 0.001f;
+
+//Motion along X accelerates, so sampling the curve differs from scaling linear movement
+float ExpectedX(float frame)
+{
+	return frame * frame * 10;
+}
+
+float ExpectedYaw(int frame)
+{
+	return frame * 100 * YawScale;
+}
+
+std::vector<mstudioanimvalue_t> CreateAnimValues(short (*valueForFrame)(int))
+{
+	std::vector<mstudioanimvalue_t> values;
+
+	mstudioanimvalue_t header;
+
+	header.num.valid = FrameCount;
+	header.num.total = FrameCount;
+
+	values.push_back(header);
+
+	for (int frame = 0; frame < FrameCount; ++frame)
+	{
+		mstudioanimvalue_t value;
+		value.value = valueForFrame(frame);
+		values.push_back(value);
+	}
+
+	return values;
+}
+
+/**
+*	@brief Replaces the motion bone's animation with known movement along X and a known yaw.
+*	The sequence only moves along X, so movement along Y comes from linear movement only.
+*/
+void SetKnownMotion(EditableStudioModel& studioModel, Sequence& sequence)
+{
+	auto& bone = *studioModel.Bones[sequence.MotionBone];
+
+	for (auto& axis : bone.Axes)
+	{
+		axis.Value = 0;
+		axis.Scale = 1;
+		axis.Controller = nullptr;
+	}
+
+	bone.Axes[5].Scale = YawScale;
+
+	auto& animation = sequence.AnimationBlends[0][sequence.MotionBone];
+
+	for (auto& data : animation.Data)
+	{
+		data.clear();
+	}
+
+	animation.Data[0] = CreateAnimValues([](int frame) { return static_cast<short>(ExpectedX(static_cast<float>(frame))); });
+	//Not a motion axis, so not part of the root motion
+	animation.Data[2] = CreateAnimValues([](int frame) { return static_cast<short>(frame * 7); });
+	animation.Data[5] = CreateAnimValues([](int frame) { return static_cast<short>(frame * 100); });
+
+	sequence.MotionType = STUDIO_X;
+	sequence.LinearMovement = glm::vec3{0, LinearSpeed, 0};
+}
+
+glm::vec3 ExpectedPosition(float frame)
+{
+	return glm::vec3{ExpectedX(frame), LinearSpeed * frame / (FrameCount - 1), 0};
+}
+
+void TestCalculateRootMotion(const Sequence& sequence)
+{
+	const auto& rootMotion = sequence.RootMotion;
+
+	Check(rootMotion.Positions.size() == FrameCount, "There is a root motion position for every frame");
+	Check(rootMotion.Yaws.size() == FrameCount, "There is a root motion yaw for every frame");
+	Check(rootMotion.CumulativeDistances.size() == FrameCount, "There is a cumulative distance for every frame");
+
+	if (rootMotion.Positions.size() != FrameCount || rootMotion.Yaws.size() != FrameCount || rootMotion.CumulativeDistances.size() != FrameCount)
+	{
+		return;
+	}
+
+	bool positionsMatch = true;
+	bool yawsMatch = true;
+	bool distancesMatch = IsNear(rootMotion.CumulativeDistances[0], 0);
+
+	for (int frame = 0; frame < FrameCount; ++frame)
+	{
+		positionsMatch = positionsMatch && IsNear(rootMotion.Positions[frame], ExpectedPosition(static_cast<float>(frame)));
+		yawsMatch = yawsMatch && IsNear(rootMotion.Yaws[frame], ExpectedYaw(frame));
+
+		if (frame > 0)
+		{
+			const auto delta = ExpectedPosition(static_cast<float>(frame)) - ExpectedPosition(static_cast<float>(frame - 1));
+			const float expectedDistance = rootMotion.CumulativeDistances[frame - 1] + glm::length(glm::vec2{delta.x, delta.y});
+
+			distancesMatch = distancesMatch && IsNear(rootMotion.CumulativeDistances[frame], expectedDistance, 1e-2f);
+		}
+	}
+
+	Check(positionsMatch, "Root motion follows the motion bone along motion axes plus linear movement");
+	Check(yawsMatch, "Root motion yaws follow the motion bone's rotation");
+	Check(distancesMatch, "Cumulative distances add up the movement along the ground plane");
+	Check(IsNear(rootMotion.TotalDistance, rootMotion.CumulativeDistances.back()), "Total distance is the distance up to the last frame");
+
+	Check(IsNear(GetRootMotionSpeed(sequence), rootMotion.TotalDistance * sequence.FPS / (FrameCount - 1)),
+		"Root motion speed is the total distance over the sequence's duration");
+}
+
+void TestGetRootMotionPosition(const SequenceRootMotion& rootMotion)
+{
+	Check(IsNear(GetRootMotionPosition(rootMotion, 2), ExpectedPosition(2)), "Whole frames return the frame's position");
+	Check(IsNear(GetRootMotionPosition(rootMotion, 2.5f), (ExpectedPosition(2) + ExpectedPosition(3)) * 0.5f),
+		"Fractional frames interpolate between frames");
+	Check(IsNear(GetRootMotionPosition(rootMotion, -1), ExpectedPosition(0)), "Frames before the first frame are clamped");
+	Check(IsNear(GetRootMotionPosition(rootMotion, FrameCount + 5.f), ExpectedPosition(FrameCount - 1)),
+		"Frames after the last frame are clamped");
+	Check(IsNear(GetRootMotionPosition(SequenceRootMotion{}, 3), glm::vec3{0}), "Sequences without root motion don't move");
+
+	Check(IsNear(GetRootMotionYaw(rootMotion, 2.5f), (ExpectedYaw(2) + ExpectedYaw(3)) * 0.5f), "Yaws interpolate between frames");
+
+	SequenceRootMotion aroundBoundary;
+	aroundBoundary.Yaws = {3.0f, -3.0f};
+
+	Check(IsNear(std::abs(GetRootMotionYaw(aroundBoundary, 0.5f)), PI<float>),
+		"Yaws interpolate along the shortest arc across the -pi/pi boundary");
+}
+
+/**
+*	@brief Steps the frame the way the floor scroll in Scene::DrawModel does, with the sequence looping
+*/
+void TestFloorScroll(const SequenceRootMotion& rootMotion)
+{
+	const float lastFrame = FrameCount - 1;
+
+	Check(IsNear(GetRootMotionDelta(rootMotion, 2, 5), ExpectedPosition(5) - ExpectedPosition(2)),
+		"Moving forward scrolls by the movement between the frames");
+	Check(IsNear(GetRootMotionDelta(rootMotion, 27, 2),
+		ExpectedPosition(lastFrame) - ExpectedPosition(27) + ExpectedPosition(2)),
+		"Wrapping around scrolls by the movement to the end plus the movement from the start");
+
+	const float step = 0.7f;
+	const int loops = 3;
+
+	float previousFrame = 0;
+	float frame = 0;
+	glm::vec3 scrolled{0};
+
+	for (float total = step; total <= loops * lastFrame + 4; total += step)
+	{
+		frame = std::fmod(total, lastFrame);
+		scrolled += GetRootMotionDelta(rootMotion, previousFrame, frame);
+		previousFrame = frame;
+	}
+
+	//Each loop moves the entity by the position of the last frame
+	const glm::vec3 expected = ExpectedPosition(lastFrame) * static_cast<float>(loops) + GetRootMotionPosition(rootMotion, frame);
+
+	Check(IsNear(scrolled, expected, 0.1f), "Scrolling over several loops moves by the root motion of each loop");
+}
+}
+
+/**
+*	@brief Checks the precomputed root motion curves against a motion bone with known movement
+*/
+int main()
+{
+	tests::TestStudioModelSettings settings;
+
+	settings.BoneCount = 4;
+	settings.FrameCount = FrameCount;
+	settings.SequenceBlends = {1};
+
+	auto studioModel = tests::CreateTestStudioModel(settings);
+
+	auto& sequence = *studioModel->Sequences[0];
+
+	SetKnownMotion(*studioModel, sequence);
+
+	CalculateRootMotion(*studioModel);
+
+	TestCalculateRootMotion(sequence);
+	TestGetRootMotionPosition(sequence.RootMotion);
+	TestFloorScroll(sequence.RootMotion);
+
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+#include <cstdio>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <glm/common.hpp>
+
+#include "engine/shared/studiomodel/BoneTransformer.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+#include "tests/TestStudioModel.hpp"
+
+#include "utility/WorkerPool.hpp"
+#include "utility/mathlib.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+using BBox = std::pair<glm::vec3, glm::vec3>;
+
+/**
+*	@brief Evaluates every pose of every sequence on a single thread, without any of the optimizations of the real implementation
+*/
+std::vector<BBox> CalculateReferenceBBoxes(const EditableStudioModel& studioModel)
+{
+	std::vector<BBox> bboxes;
+
+	BoneTransformer boneTransformer;
+
+	for (std::size_t i = 0; i < studioModel.Sequences.size(); ++i)
+	{
+		const auto& sequence = *studioModel.Sequences[i];
+
+		std::vector<byte> blendersX{0};
+		std::vector<byte> blendersY{0};
+
+		if (sequence.AnimationBlends.size() == 9)
+		{
+			blendersX = blendersY = {0, 127, 255};
+		}
+		else if (sequence.AnimationBlends.size() > 1)
+		{
+			blendersX = {0, 255};
+
+			if (sequence.AnimationBlends[0].size() == 4)
+			{
+				blendersY = {0, 255};
+			}
+		}
+
+		BBox bbox{glm::vec3{std::numeric_limits<float>::max()}, glm::vec3{std::numeric_limits<float>::lowest()}};
+
+		for (int frame = 0; frame < sequence.NumFrames; ++frame)
+		{
+			for (auto x : blendersX)
+			{
+				for (auto y : blendersY)
+				{
+					const auto& bones = boneTransformer.SetUpBones(studioModel,
+						{static_cast<int>(i), static_cast<float>(frame), glm::vec3{1}, {x, y}, {}, 0});
+
+					for (const auto& bodypart : studioModel.Bodyparts)
+					{
+						for (const auto& model : bodypart->Models)
+						{
+							for (const auto& vertex : model.Vertices)
+							{
+								glm::vec3 position;
+								VectorTransform(vertex.Vertex, bones[vertex.Bone->ArrayIndex], position);
+
+								bbox.first = glm::min(bbox.first, position);
+								bbox.second = glm::max(bbox.second, position);
+							}
+						}
+					}
+				}
+			}
+		}
+
+		bboxes.push_back(bbox);
+	}
+
+	return bboxes;
+}
+
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+}
+
+int main()
+{
+	tests::TestStudioModelSettings settings;
+
+	settings.SequenceBlends = {1, 2, 4, 9, 1};
+
+	auto studioModel = tests::CreateTestStudioModel(settings);
+
+	const auto reference = CalculateReferenceBBoxes(*studioModel);
+
+	BBox referenceHull = reference[0];
+
+	for (const auto& bbox : reference)
+	{
+		referenceHull.first = glm::min(referenceHull.first, bbox.first);
+		referenceHull.second = glm::max(referenceHull.second, bbox.second);
+	}
+
+	//Minimum and maximum do not depend on evaluation order, so results must be identical for any number of threads
+	for (unsigned int threadCount : {1u, 2u, 3u, 8u})
+	{
+		std::size_t lastCompleted = 0;
+		std::size_t lastTotal = 0;
+		bool progressIncreases = true;
+
+		WorkerPool workerPool{threadCount};
+
+		const auto data = CalculateSequenceBBoxesData(*studioModel, workerPool, [&](std::size_t completed, std::size_t total)
+			{
+				progressIncreases = progressIncreases && completed >= lastCompleted && completed <= total;
+				lastCompleted = completed;
+				lastTotal = total;
+				return true;
+			});
+
+		std::printf("%u threads\n", threadCount);
+
+		Check(data.has_value(), "Calculation completes");
+
+		if (!data)
+		{
+			continue;
+		}
+
+		Check(progressIncreases, "Progress increases");
+		Check(lastCompleted > 0 && lastCompleted == lastTotal, "Progress reaches the total");
+		Check(data->second.SequenceBBoxes == reference, "Sequence bounding boxes match the reference");
+		Check(data->second.Hull == referenceHull, "Hull is the union of all sequence bounding boxes");
+
+		Check(data->first.Hull == std::make_pair(studioModel->BoundingMin, studioModel->BoundingMax), "Old data contains the current hull");
+	}
+
+	{
+		WorkerPool workerPool{4};
+		std::size_t calls = 0;
+
+		const auto data = CalculateSequenceBBoxesData(*studioModel, workerPool, [&](std::size_t, std::size_t)
+			{
+				return ++calls < 2;
+			});
+
+		Check(!data.has_value(), "Calculation can be cancelled");
+	}
+
+	{
+		WorkerPool workerPool;
+
+		auto data = CalculateSequenceBBoxesData(*studioModel, workerPool, {});
+
+		ApplySequenceBBoxesData(*studioModel, data->second);
+
+		Check(std::make_pair(studioModel->BoundingMin, studioModel->BoundingMax) == referenceHull, "Applying the data updates the hull");
+
+		ApplySequenceBBoxesData(*studioModel, data->first);
+
+		Check(std::make_pair(studioModel->BoundingMin, studioModel->BoundingMax) == data->first.Hull, "Applying the old data restores the hull");
+	}
+
+	return Failures == 0 ? 0 : 1;
+}
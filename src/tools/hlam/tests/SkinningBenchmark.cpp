@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <glm/geometric.hpp>
+
+#include "engine/renderer/studiomodel/StudioSkinning.hpp"
+#include "engine/shared/studiomodel/BoneTransformer.hpp"
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+#include "tests/TestStudioModel.hpp"
+
+#include "utility/Float4.hpp"
+#include "utility/WorkerPool.hpp"
+
+using namespace studiomdl;
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+//Same batch size as the renderer
+constexpr std::size_t BatchSize = 2048;
+
+/**
+*	@brief Inputs and outputs of the skinning kernels for one submodel
+*/
+struct SkinningData
+{
+	const Model* Submodel = nullptr;
+	const glm::mat3x4* BoneTransforms = nullptr;
+
+	std::vector<SkinningMesh> Meshes;
+
+	LightingParameters Lighting;
+
+	std::vector<glm::vec3> LightVectors;
+	std::vector<glm::vec3> ChromeRight;
+	std::vector<glm::vec3> ChromeUp;
+
+	std::vector<glm::vec3> Vertices;
+	std::vector<glm::vec3> LightValues;
+	std::vector<glm::vec2> Chrome;
+
+	std::size_t GetElementCount() const { return Submodel->Vertices.size() + Submodel->Normals.size(); }
+};
+
+/**
+*	@brief The plain scalar loops that the kernels replaced, one vertex and one normal at a time
+*/
+void ReferenceSkinning(SkinningData& data)
+{
+	for (std::size_t i = 0; i < data.Submodel->Vertices.size(); ++i)
+	{
+		const auto& vertex = data.Submodel->Vertices[i];
+		const auto& transform = data.BoneTransforms[vertex.Bone->ArrayIndex];
+
+		data.Vertices[i] = glm::vec3{
+			glm::dot(vertex.Vertex, glm::vec3{transform[0]}) + transform[0][3],
+			glm::dot(vertex.Vertex, glm::vec3{transform[1]}) + transform[1][3],
+			glm::dot(vertex.Vertex, glm::vec3{transform[2]}) + transform[2][3]};
+	}
+
+	for (const auto& mesh : data.Meshes)
+	{
+		for (std::size_t i = mesh.FirstNormal; i < mesh.FirstNormal + mesh.NormalCount; ++i)
+		{
+			const auto& normal = data.Submodel->Normals[i];
+			const int bone = normal.Bone->ArrayIndex;
+
+			if (mesh.Flags & STUDIO_NF_FULLBRIGHT)
+			{
+				data.LightValues[i] = glm::vec3{1, 1, 1};
+			}
+			else if (mesh.Flags & STUDIO_NF_FLATSHADE)
+			{
+				data.LightValues[i] = data.Lighting.FlatShadeLight;
+			}
+			else
+			{
+				data.LightValues[i] = data.Lighting.Calculate(glm::dot(normal.Vertex, data.LightVectors[bone]));
+			}
+
+			if (mesh.Flags & STUDIO_NF_CHROME)
+			{
+				data.Chrome[i] = glm::vec2{
+					(glm::dot(normal.Vertex, data.ChromeRight[bone]) + 1.0f) * 0.5f,
+					(glm::dot(normal.Vertex, data.ChromeUp[bone]) + 1.0f) * 0.5f};
+			}
+		}
+	}
+}
+
+/**
+*	@brief Runs the kernels the same way the renderer does, with vertices and normals as one range
+*/
+void KernelSkinning(SkinningData& data, WorkerPool& workerPool)
+{
+	const auto vertexCount = data.Submodel->Vertices.size();
+	const NormalLightingVectors vectors{data.LightVectors.data(), data.ChromeRight.data(), data.ChromeUp.data()};
+
+	workerPool.ParallelFor(data.GetElementCount(), BatchSize, [&](std::size_t begin, std::size_t end)
+		{
+			if (begin < vertexCount)
+			{
+				SkinVertices(data.Submodel->Vertices.data(), data.BoneTransforms, data.Vertices.data(), begin, std::min(end, vertexCount));
+			}
+
+			if (end > vertexCount)
+			{
+				LightNormals(data.Submodel->Normals.data(), data.Meshes.data(), data.Meshes.size(), data.Lighting, vectors,
+					data.LightValues.data(), data.Chrome.data(), std::max(begin, vertexCount) - vertexCount, end - vertexCount);
+			}
+		});
+}
+
+template<typename T>
+bool AreIdentical(const std::vector<T>& lhs, const std::vector<T>& rhs)
+{
+	return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0;
+}
+
+template<typename Function>
+double MeasureElementsPerSecond(const SkinningData& data, int iterations, Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		function();
+	}
+
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	return (static_cast<double>(data.GetElementCount()) * iterations) / std::max(elapsed.count(), 1e-9);
+}
+
+void RunBenchmark(const char* name, const Model& model, const EditableStudioModel& studioModel, const glm::mat3x4* boneTransforms, int iterations)
+{
+	SkinningData reference;
+
+	reference.Submodel = &model;
+	reference.BoneTransforms = boneTransforms;
+
+	std::size_t firstNormal = 0;
+
+	for (const auto& mesh : model.Meshes)
+	{
+		reference.Meshes.push_back({firstNormal, static_cast<std::size_t>(mesh.NumNorms), studioModel.SkinFamilies[0][mesh.SkinRef]->Flags});
+		firstNormal += mesh.NumNorms;
+	}
+
+	//Same values as the renderer calculates from its default light
+	reference.Lighting.Ambient = 32 / 255.0f;
+	reference.Lighting.Shade = 192 / 255.0f;
+	reference.Lighting.Lambert = 1.5f;
+	reference.Lighting.LightColor = glm::vec3{1.0f, 0.9f, 0.8f};
+	reference.Lighting.AmbientAndShade = reference.Lighting.Ambient + reference.Lighting.Shade;
+	reference.Lighting.InverseLambert = 1.0f / reference.Lighting.Lambert;
+	reference.Lighting.LambertOffset = (reference.Lighting.Lambert - 1.0f) * reference.Lighting.InverseLambert;
+	reference.Lighting.FlatShadeLight = glm::vec3{0.5f} * reference.Lighting.LightColor;
+
+	for (std::size_t i = 0; i < studioModel.Bones.size(); ++i)
+	{
+		const float angle = static_cast<float>(i);
+
+		reference.LightVectors.push_back(glm::normalize(glm::vec3{std::cos(angle), std::sin(angle), -1.0f}));
+		reference.ChromeRight.push_back(glm::normalize(glm::vec3{std::sin(angle), 1.0f, std::cos(angle)}));
+		reference.ChromeUp.push_back(glm::normalize(glm::vec3{1.0f, std::cos(angle), std::sin(angle)}));
+	}
+
+	reference.Vertices.resize(model.Vertices.size());
+	reference.LightValues.resize(model.Normals.size());
+	reference.Chrome.resize(model.Normals.size());
+
+	SkinningData singleThreaded = reference;
+	SkinningData multiThreaded = reference;
+
+	WorkerPool singleThread{1};
+	WorkerPool allThreads;
+
+	ReferenceSkinning(reference);
+	KernelSkinning(singleThreaded, singleThread);
+	KernelSkinning(multiThreaded, allThreads);
+
+	Check(AreIdentical(reference.Vertices, singleThreaded.Vertices), "Kernel vertices are identical to the scalar loop");
+	Check(AreIdentical(reference.LightValues, singleThreaded.LightValues), "Kernel light values are identical to the scalar loop");
+	Check(AreIdentical(reference.Chrome, singleThreaded.Chrome), "Kernel chrome coordinates are identical to the scalar loop");
+	Check(AreIdentical(reference.Vertices, multiThreaded.Vertices), "Multithreaded vertices are identical to the scalar loop");
+	Check(AreIdentical(reference.LightValues, multiThreaded.LightValues), "Multithreaded light values are identical to the scalar loop");
+	Check(AreIdentical(reference.Chrome, multiThreaded.Chrome), "Multithreaded chrome coordinates are identical to the scalar loop");
+
+	const double scalarRate = MeasureElementsPerSecond(reference, iterations, [&] { ReferenceSkinning(reference); });
+	const double kernelRate = MeasureElementsPerSecond(singleThreaded, iterations, [&] { KernelSkinning(singleThreaded, singleThread); });
+	const double threadedRate = MeasureElementsPerSecond(multiThreaded, iterations, [&] { KernelSkinning(multiThreaded, allThreads); });
+
+	std::printf("%s: %zu vertices and normals\n", name, reference.GetElementCount());
+	std::printf("  Scalar loop:            %8.1f million per second\n", scalarRate / 1e6);
+	std::printf("  Kernels, 1 thread:      %8.1f million per second (%.2fx)\n", kernelRate / 1e6, kernelRate / scalarRate);
+	std::printf("  Kernels, %2u threads:    %8.1f million per second (%.2fx)\n",
+		allThreads.GetThreadCount(), threadedRate / 1e6, threadedRate / scalarRate);
+}
+}
+
+/**
+*	@brief Checks that the skinning kernels produce the same results as plain scalar loops and measures how fast they are.
+*	@param argv[1] Number of times each variant is run. Defaults to 200
+*/
+int main(int argc, char* argv[])
+{
+	const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+
+#ifdef FLOAT4_SSE2
+	std::printf("Using SSE2\n");
+#else
+	std::printf("Using the scalar Float4 fallback\n");
+#endif
+
+	tests::TestStudioModelSettings settings;
+
+	settings.SubmodelCount = 1;
+	//Triangle commands store vertex indices as shorts
+	settings.VertexCount = 30000;
+	settings.TriangleCommandsPerMesh = 1;
+	settings.TextureFlags = {0, 0, STUDIO_NF_CHROME, 0, STUDIO_NF_FLATSHADE, 0, STUDIO_NF_CHROME | STUDIO_NF_FULLBRIGHT, 0};
+	settings.MeshCount = static_cast<int>(settings.TextureFlags.size());
+
+	const auto studioModel = tests::CreateTestStudioModel(settings);
+
+	BoneTransformer boneTransformer;
+
+	const auto& boneTransforms = boneTransformer.SetUpBones(*studioModel, {0, 0.f, glm::vec3{1}, {}, {}, 0});
+
+	auto& model = studioModel->Bodyparts[0]->Models[0];
+
+	//Vertices attached to random bones are the worst case for the bone runs
+	RunBenchmark("Random bones", model, *studioModel, boneTransforms.data(), iterations);
+
+	//Compiled models store vertices and normals sorted by bone
+	const auto byBone = [](const ModelVertexInfo& lhs, const ModelVertexInfo& rhs)
+	{
+		return lhs.Bone->ArrayIndex < rhs.Bone->ArrayIndex;
+	};
+
+	std::stable_sort(model.Vertices.begin(), model.Vertices.end(), byBone);
+	std::stable_sort(model.Normals.begin(), model.Normals.end(), byBone);
+
+	RunBenchmark("Sorted by bone", model, *studioModel, boneTransforms.data(), iterations);
+
+	return Failures == 0 ? 0 : 1;
+}
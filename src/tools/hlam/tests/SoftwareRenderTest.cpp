@@ -0,0 +1,260 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/shared/WorldTime.hpp"
+
+#include "entity/HLMVStudioModelEntity.hpp"
+
+#include "game/entity/BaseEntity.hpp"
+#include "game/entity/EntityManager.hpp"
+
+#include "graphics/Camera.hpp"
+#include "graphics/Scene.hpp"
+#include "graphics/SoftwareSceneRenderer.hpp"
+#include "graphics/TextureLoader.hpp"
+
+#include "soundsystem/DummySoundSystem.hpp"
+
+#include "tests/TestStudioModel.hpp"
+
+#include "utility/WorkerPool.hpp"
+
+namespace
+{
+int Failures = 0;
+
+void Check(bool condition, const char* description)
+{
+	if (!condition)
+	{
+		std::printf("FAILED: %s\n", description);
+		++Failures;
+	}
+}
+
+constexpr int ImageWidth = 128;
+constexpr int ImageHeight = 96;
+
+//Differences allowed between the image and the golden image, to allow for different rounding of floating point math between compilers
+constexpr int MaximumChannelDifference = 2;
+constexpr double MaximumDifferentPixels = 0.005;
+
+/**
+*	@brief Draws the test model with the software renderer using the given number of threads
+*	@return RGBA8888 pixels, bottom row first
+*/
+std::vector<std::uint8_t> DrawTestModel(unsigned int threadCount)
+{
+	tests::TestStudioModelSettings settings;
+
+	settings.BoneCount = 20;
+	settings.SubmodelCount = 1;
+	settings.VertexCount = 2000;
+	settings.TriangleCommandsPerMesh = 100;
+	settings.TextureFlags = {0, STUDIO_NF_CHROME, STUDIO_NF_FLATSHADE, STUDIO_NF_MASKED};
+
+	const auto model = tests::CreateTestStudioModel(settings);
+
+	WorldTime worldTime;
+	soundsystem::DummySoundSystem soundSystem;
+	graphics::TextureLoader textureLoader;
+	WorkerPool workerPool{threadCount};
+
+	graphics::Scene scene{&textureLoader, &soundSystem, &worldTime, &workerPool};
+
+	scene.BackgroundColor = glm::vec3{0.2f, 0.4f, 0.6f};
+	scene.DrawShadows = true;
+
+	auto entity = static_cast<HLMVStudioModelEntity*>(scene.GetEntityContext()->EntityManager->Create("studiomodel", scene.GetEntityContext(),
+		glm::vec3(), glm::vec3(), false));
+
+	if (!entity)
+	{
+		return {};
+	}
+
+	entity->SetEditableModel(model.get());
+	entity->Spawn();
+	entity->SetSequence(3);
+	entity->SetFrame(7.5f);
+	entity->SetBlending(0, 200);
+	entity->SetBlending(1, 60);
+	scene.SetEntity(entity);
+
+	graphics::Camera camera;
+
+	camera.SetProperties(glm::vec3{-70, 10, 0}, 0, -10);
+	scene.SetCurrentCamera(&camera);
+
+	graphics::SoftwareSceneRenderer renderer{workerPool};
+
+	auto pixels = renderer.Draw(scene, ImageWidth, ImageHeight);
+
+	scene.SetCurrentCamera(nullptr);
+
+	return pixels;
+}
+
+/**
+*	@brief Reads a binary PPM image, converting it to RGBA8888 with the bottom row first
+*/
+bool LoadPPM(const char* fileName, std::vector<std::uint8_t>& pixels)
+{
+	std::unique_ptr<FILE, decltype(::fclose)*> file{std::fopen(fileName, "rb"), &::fclose};
+
+	if (!file)
+	{
+		return false;
+	}
+
+	int width, height, maximum;
+
+	if (std::fscanf(file.get(), "P6 %d %d %d", &width, &height, &maximum) != 3 || width != ImageWidth || height != ImageHeight || maximum != 255)
+	{
+		return false;
+	}
+
+	//Single whitespace character after the header
+	std::fgetc(file.get());
+
+	std::vector<std::uint8_t> rgb(static_cast<std::size_t>(width) * height * 3);
+
+	if (std::fread(rgb.data(), 1, rgb.size(), file.get()) != rgb.size())
+	{
+		return false;
+	}
+
+	pixels.resize(static_cast<std::size_t>(width) * height * 4);
+
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			const auto source = &rgb[((static_cast<std::size_t>(height - 1 - y) * width) + x) * 3];
+			const auto destination = &pixels[((static_cast<std::size_t>(y) * width) + x) * 4];
+
+			destination[0] = source[0];
+			destination[1] = source[1];
+			destination[2] = source[2];
+			destination[3] = 255;
+		}
+	}
+
+	return true;
+}
+
+bool SavePPM(const char* fileName, const std::vector<std::uint8_t>& pixels)
+{
+	std::unique_ptr<FILE, decltype(::fclose)*> file{std::fopen(fileName, "wb"), &::fclose};
+
+	if (!file)
+	{
+		return false;
+	}
+
+	std::fprintf(file.get(), "P6\n%d %d\n255\n", ImageWidth, ImageHeight);
+
+	for (int y = ImageHeight - 1; y >= 0; --y)
+	{
+		for (int x = 0; x < ImageWidth; ++x)
+		{
+			std::fwrite(&pixels[((static_cast<std::size_t>(y) * ImageWidth) + x) * 4], 1, 3, file.get());
+		}
+	}
+
+	return true;
+}
+
+/**
+*	@return Number of pixels whose color differs by more than the allowed difference in any channel. Alpha is not compared
+*/
+std::size_t CountDifferentPixels(const std::vector<std::uint8_t>& lhs, const std::vector<std::uint8_t>& rhs)
+{
+	std::size_t count = 0;
+
+	for (std::size_t i = 0; i < lhs.size(); i += 4)
+	{
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			if (std::abs(lhs[i + channel] - rhs[i + channel]) > MaximumChannelDifference)
+			{
+				++count;
+				break;
+			}
+		}
+	}
+
+	return count;
+}
+}
+
+/**
+*	@brief Draws the test model with the software renderer and checks that the image does not depend on the number of threads
+*	and matches the golden image.
+*	@param argv[1] Golden image, a binary PPM file
+*	@param argv[2] Pass --update to replace the golden image with the current image, after checking the change by hand
+*/
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::printf("Usage: %s <golden image> [--update]\n", argv[0]);
+		return 1;
+	}
+
+	const auto singleThreaded = DrawTestModel(1);
+	const auto multiThreaded = DrawTestModel(4);
+
+	Check(singleThreaded.size() == static_cast<std::size_t>(ImageWidth) * ImageHeight * 4, "The image is drawn at the requested size");
+
+	if (Failures > 0)
+	{
+		return 1;
+	}
+
+	Check(singleThreaded == multiThreaded, "The image is identical when drawn with 1 and 4 threads");
+
+	//Make sure the model was drawn, so a blank image can't pass
+	const std::vector<std::uint8_t> background{51, 102, 153, 255};
+	std::size_t modelPixels = 0;
+
+	for (std::size_t i = 0; i < singleThreaded.size(); i += 4)
+	{
+		for (std::size_t channel = 0; channel < 3; ++channel)
+		{
+			if (std::abs(singleThreaded[i + channel] - background[channel]) > 1)
+			{
+				++modelPixels;
+				break;
+			}
+		}
+	}
+
+	Check(modelPixels > singleThreaded.size() / 4 / 10, "The model covers part of the image");
+
+	if (argc > 2 && std::string{argv[2]} == "--update")
+	{
+		Check(SavePPM(argv[1], singleThreaded), "The golden image is saved");
+		return Failures == 0 ? 0 : 1;
+	}
+
+	std::vector<std::uint8_t> golden;
+
+	if (!LoadPPM(argv[1], golden))
+	{
+		std::printf("FAILED: Could not load golden image \"%s\"\n", argv[1]);
+		return 1;
+	}
+
+	const auto differentPixels = CountDifferentPixels(singleThreaded, golden);
+
+	std::printf("%zu of %d pixels differ from the golden image\n", differentPixels, ImageWidth * ImageHeight);
+
+	Check(differentPixels <= ImageWidth * ImageHeight * MaximumDifferentPixels, "The image matches the golden image");
+
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <random>
+
+#include <glm/geometric.hpp>
+
+#include "tests/TestStudioModel.hpp"
+
+using namespace studiomdl;
+
+namespace tests
+{
+namespace
+{
+//The standard distributions are implementation defined, so values are derived from the engine directly.
+//This keeps the model the same on every platform, which images drawn of it rely on
+float Unit(std::mt19937& random)
+{
+	return (random() >> 8) * (2.0f / (1 << 24)) - 1.0f;
+}
+
+short AnimValue(std::mt19937& random)
+{
+	return static_cast<short>(static_cast<int>(random() % 6001) - 3000);
+}
+}
+
+std::unique_ptr<EditableStudioModel> CreateTestStudioModel(const TestStudioModelSettings& settings)
+{
+	std::mt19937 random{settings.Seed};
+
+	auto model = std::make_unique<EditableStudioModel>();
+
+	for (int i = 0; i < settings.BoneCount; ++i)
+	{
+		auto bone = std::make_unique<Bone>();
+
+		bone->Name = "bone" + std::to_string(i);
+		bone->ArrayIndex = i;
+		bone->Parent = i > 0 ? model->Bones[random() % i].get() : nullptr;
+
+		for (int axis = 0; axis < STUDIO_NUM_COORDINATE_AXES; ++axis)
+		{
+			//Positions first, then rotations
+			const bool isPosition = axis < 3;
+
+			bone->Axes[axis].Value = isPosition ? Unit(random) * 3 : Unit(random);
+			bone->Axes[axis].Scale = isPosition ? 0.01f : 0.0005f;
+		}
+
+		model->Bones.push_back(std::move(bone));
+	}
+
+	for (std::size_t i = 0; i < settings.SequenceBlends.size(); ++i)
+	{
+		auto sequence = std::make_unique<Sequence>();
+
+		sequence->Label = "sequence" + std::to_string(i);
+		sequence->NumFrames = settings.FrameCount;
+		sequence->FPS = 30;
+		sequence->MotionType = STUDIO_X;
+		sequence->MotionBone = 0;
+
+		for (int blend = 0; blend < settings.SequenceBlends[i]; ++blend)
+		{
+			std::vector<Animation> animations(settings.BoneCount);
+
+			for (auto& animation : animations)
+			{
+				for (auto& data : animation.Data)
+				{
+					//Leave some axes unanimated
+					if (random() % 3 == 0)
+					{
+						continue;
+					}
+
+					mstudioanimvalue_t header;
+
+					header.num.valid = static_cast<byte>(settings.FrameCount);
+					header.num.total = static_cast<byte>(settings.FrameCount);
+
+					data.push_back(header);
+
+					for (int frame = 0; frame < settings.FrameCount; ++frame)
+					{
+						mstudioanimvalue_t value;
+						value.value = AnimValue(random);
+						data.push_back(value);
+					}
+				}
+			}
+
+			sequence->AnimationBlends.push_back(std::move(animations));
+		}
+
+		model->Sequences.push_back(std::move(sequence));
+	}
+
+	const int textureCount = std::max(1, settings.MeshCount);
+
+	for (int i = 0; i < textureCount; ++i)
+	{
+		auto texture = std::make_unique<Texture>();
+
+		texture->Name = "texture" + std::to_string(i) + ".bmp";
+		texture->Flags = settings.TextureFlags.empty() ? 0 : settings.TextureFlags[i % settings.TextureFlags.size()];
+		texture->Width = 64;
+		texture->Height = 64;
+		texture->ArrayIndex = i;
+		texture->Pixels.resize(texture->Width * texture->Height);
+
+		for (int y = 0; y < texture->Height; ++y)
+		{
+			for (int x = 0; x < texture->Width; ++x)
+			{
+				texture->Pixels[(y * texture->Width) + x] = static_cast<byte>(((x / 4) * 7 + (y / 4) * 13 + i * 31) & 0xFF);
+			}
+		}
+
+		for (auto& color : texture->Palette)
+		{
+			color = {static_cast<byte>(random() & 0xFF), static_cast<byte>(random() & 0xFF), static_cast<byte>(random() & 0xFF)};
+		}
+
+		model->Textures.push_back(std::move(texture));
+	}
+
+	model->SkinFamilies.emplace_back();
+
+	for (const auto& texture : model->Textures)
+	{
+		model->SkinFamilies[0].push_back(texture.get());
+	}
+
+	auto bodypart = std::make_unique<Bodypart>();
+
+	bodypart->Name = "body";
+	bodypart->Base = 1;
+
+	for (int i = 0; i < settings.SubmodelCount; ++i)
+	{
+		Model submodel;
+
+		submodel.Name = "submodel" + std::to_string(i);
+
+		for (int vertex = 0; vertex < settings.VertexCount; ++vertex)
+		{
+			const glm::vec3 direction = glm::normalize(glm::vec3{Unit(random), Unit(random), Unit(random)});
+
+			submodel.Vertices.push_back({direction * 20.f, model->Bones[random() % settings.BoneCount].get()});
+			submodel.Normals.push_back({direction, model->Bones[random() % settings.BoneCount].get()});
+		}
+
+		//Each mesh uses its own range of normals, like compiled models
+		const int normalsPerMesh = settings.VertexCount / textureCount;
+
+		for (int meshIndex = 0; meshIndex < textureCount; ++meshIndex)
+		{
+			Mesh mesh;
+
+			mesh.SkinRef = meshIndex;
+			mesh.NumNorms = meshIndex + 1 < textureCount ? normalsPerMesh : settings.VertexCount - (normalsPerMesh * meshIndex);
+
+			for (int command = 0; command < settings.TriangleCommandsPerMesh; ++command)
+			{
+				const int count = 3 + (random() % 6);
+
+				//Negative counts are fans, positive counts are strips
+				mesh.Triangles.push_back(static_cast<short>((random() & 1) ? -count : count));
+
+				for (int vertex = 0; vertex < count; ++vertex)
+				{
+					mesh.Triangles.push_back(static_cast<short>(random() % settings.VertexCount));
+					mesh.Triangles.push_back(static_cast<short>((meshIndex * normalsPerMesh) + (random() % std::max(1, mesh.NumNorms))));
+					mesh.Triangles.push_back(static_cast<short>(random() % 64));
+					mesh.Triangles.push_back(static_cast<short>(random() % 64));
+				}
+
+				mesh.NumTriangles += count - 2;
+			}
+
+			mesh.Triangles.push_back(0);
+
+			submodel.Meshes.push_back(std::move(mesh));
+		}
+
+		bodypart->Models.push_back(std::move(submodel));
+	}
+
+	model->Bodyparts.push_back(std::move(bodypart));
+
+	CalculateRootMotion(*model);
+
+	return model;
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "engine/shared/studiomodel/EditableStudioModel.hpp"
+
+namespace tests
+{
+/**
+*	@brief Describes a procedurally generated studio model
+*/
+struct TestStudioModelSettings
+{
+	int BoneCount = 40;
+	int FrameCount = 30;
+
+	//Number of animation blends of each sequence. 4 is a 2x2 blend, 9 is a 3x3 blend
+	std::vector<int> SequenceBlends{1, 2, 4, 9};
+
+	int SubmodelCount = 2;
+
+	//Per submodel
+	int VertexCount = 1000;
+
+	//Per submodel. Each mesh uses a different texture
+	int MeshCount = 4;
+
+	//Number of triangle strips and fans in each mesh
+	int TriangleCommandsPerMesh = 50;
+
+	//Texture flags of each mesh, repeated if there are more meshes
+	std::vector<int> TextureFlags{0};
+
+	unsigned int Seed = 1;
+};
+
+/**
+*	@brief Creates a model with random bone positions, animations, vertices and textures.
+*	The same settings always produce the same model. Textures are not uploaded.
+*/
+std::unique_ptr<studiomdl::EditableStudioModel> CreateTestStudioModel(const TestStudioModelSettings& settings = {});
+}
@@ -1,17 +1,22 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <iterator>
 #include <stdexcept>
 
+#include <QGuiApplication>
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
+#include <QScreen>
 
 #include "core/shared/WorldTime.hpp"
 
 #include "filesystem/FileSystem.hpp"
 #include "filesystem/IFileSystem.hpp"
 
+#include "graphics/FrameProfiler.hpp"
+
 #include "soundsystem/DummySoundSystem.hpp"
 #include "soundsystem/ISoundSystem.hpp"
 #include "soundsystem/SoundSystem.hpp"
@@ -27,6 +32,8 @@
 #include "ui/settings/GeneralSettings.hpp"
 #include "ui/settings/RecentFilesSettings.hpp"
 
+#include "utility/WorkerPool.hpp"
+
 namespace ui
 {
 EditorContext::EditorContext(
@@ -51,6 +58,8 @@ EditorContext::EditorContext(
 		? std::unique_ptr<soundsystem::ISoundSystem>(std::make_unique<soundsystem::SoundSystem>())
 		: std::make_unique<soundsystem::DummySoundSystem>())
 	, _worldTime(std::make_unique<WorldTime>())
+	, _frameProfiler(std::make_unique<graphics::FrameProfiler>())
+	, _workerPool(std::make_unique<WorkerPool>())
 	, _assetProviderRegistry(std::move(assetProviderRegistry))
 {
 	_settings->setParent(this);
@@ -63,7 +72,6 @@ EditorContext::EditorContext(
 	}
 
 	connect(_timer, &QTimer::timeout, this, &EditorContext::OnTimerTick);
-	connect(_generalSettings.get(), &settings::GeneralSettings::TickRateChanged, this, &EditorContext::OnTickRateChanged);
 }
 
 EditorContext::~EditorContext()
@@ -103,11 +111,44 @@ void EditorContext::SetOffscreenSurface(QOffscreenSurface* offscreenSurface)
 
 void EditorContext::StartTimer()
 {
-	_timer->start(1000 / _generalSettings->GetTickRate());
+	//The simulation runs in fixed steps independent of this timer, and rendering interpolates between them,
+	//so the timer only needs to fire as often as the display refreshes
+	double refreshRate = DefaultRefreshRate;
+
+	if (auto screen = QGuiApplication::primaryScreen(); screen && screen->refreshRate() > 0)
+	{
+		refreshRate = screen->refreshRate();
+	}
+
+	_accumulatedTime = 0;
+
+	_timer->start(std::max(1, static_cast<int>(std::lround(1000 / refreshRate))));
+}
+
+void EditorContext::PauseTimer()
+{
+	if (_timerPauseCount++ == 0)
+	{
+		_resumeTimer = _timer->isActive();
+		_timer->stop();
+	}
+}
+
+void EditorContext::ResumeTimer()
+{
+	assert(_timerPauseCount > 0);
+
+	if (--_timerPauseCount == 0 && _resumeTimer)
+	{
+		_resumeTimer = false;
+		StartTimer();
+	}
 }
 
 void EditorContext::OnTimerTick()
 {
+	graphics::ScopedProfile profile{_frameProfiler.get(), graphics::ProfileStage::Simulation};
+
 	const auto timeMillis{std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count()};
 
 	const double currentTime = timeMillis / 1000.0;
@@ -115,29 +156,29 @@ void EditorContext::OnTimerTick()
 	double flFrameTime = currentTime - _worldTime->GetPreviousRealTime();
 
 	_worldTime->SetRealTime(currentTime);
+	_worldTime->SetPreviousRealTime(currentTime);
 
 	if (flFrameTime > 1.0)
 	{
 		flFrameTime = 0.1;
 	}
 
-#if false
-	if (flFrameTime < (1.0 / /*max_fps.GetFloat()*/60.0f))
-	{
-		return;
-	}
-#endif
+	const double timeStep = 1.0 / _generalSettings->GetTickRate();
 
-	_worldTime->TimeChanged(currentTime);
+	//Limit the amount of simulated time per update so a stall doesn't cause a burst of catch-up steps
+	const int maxSteps = std::max(1, static_cast<int>(std::ceil(MaxSimulatedTimePerUpdate / timeStep)));
 
-	emit Tick();
-}
+	_accumulatedTime = std::min(_accumulatedTime + flFrameTime, maxSteps * timeStep);
 
-void EditorContext::OnTickRateChanged(int value)
-{
-	if (_timer->isActive())
+	while (_accumulatedTime >= timeStep)
 	{
-		StartTimer();
+		_accumulatedTime -= timeStep;
+
+		_worldTime->AdvanceTime(static_cast<float>(timeStep));
+
+		emit Tick();
 	}
+
+	_worldTime->SetInterpolationFraction(static_cast<float>(_accumulatedTime / timeStep));
 }
 }
@@ -12,8 +12,14 @@
 class QOffscreenSurface;
 class QOpenGLContext;
 
+class WorkerPool;
 class WorldTime;
 
+namespace graphics
+{
+class FrameProfiler;
+}
+
 namespace filesystem
 {
 class IFileSystem;
@@ -52,6 +58,12 @@ class EditorContext final : public QObject
 	Q_OBJECT
 
 public:
+	//Maximum amount of time simulated in a single timer update
+	static constexpr double MaxSimulatedTimePerUpdate{0.1};
+
+	//Used to update the simulation when the display's refresh rate is unknown
+	static constexpr double DefaultRefreshRate{60};
+
 	EditorContext(
 		QSettings* settings,
 		const std::shared_ptr<settings::GeneralSettings>& generalSettings,
@@ -85,6 +97,13 @@ public:
 
 	WorldTime* GetWorldTime() const { return _worldTime.get(); }
 
+	graphics::FrameProfiler* GetFrameProfiler() const { return _frameProfiler.get(); }
+
+	/**
+	*	@brief Threads shared by all scenes. Scenes are drawn on the main thread one at a time, so they never use it at the same time
+	*/
+	WorkerPool* GetWorkerPool() const { return _workerPool.get(); }
+
 	assets::IAssetProviderRegistry* GetAssetProviderRegistry() const { return _assetProviderRegistry.get(); }
 
 	QOpenGLContext* GetOffscreenContext() const { return _offscreenContext; }
@@ -97,17 +116,23 @@ public:
 
 	void StartTimer();
 
+	/**
+	*	@brief Stops the timer so the simulation doesn't advance. Pauses are counted:
+	*	the timer only starts again once every call has been matched by a call to ResumeTimer, and only if it was running before
+	*/
+	void PauseTimer();
+
+	void ResumeTimer();
+
 signals:
 	/**
-	*	@brief Emitted every time a frame tick occurs
+	*	@brief Emitted for every fixed simulation step. The step size is determined by the tick rate setting
 	*/
 	void Tick();
 
 private slots:
 	void OnTimerTick();
 
-	void OnTickRateChanged(int value);
-
 private:
 	QSettings* const _settings;
 
@@ -123,6 +148,15 @@ private:
 	const std::unique_ptr<filesystem::IFileSystem> _fileSystem;
 	const std::unique_ptr<soundsystem::ISoundSystem> _soundSystem;
 	const std::unique_ptr<WorldTime> _worldTime;
+	const std::unique_ptr<graphics::FrameProfiler> _frameProfiler;
+	const std::unique_ptr<WorkerPool> _workerPool;
+
+	//Real time that has not been simulated yet
+	double _accumulatedTime{0};
+
+	//Calls to PauseTimer that haven't been matched by ResumeTimer yet, and whether the timer was running before the first one
+	int _timerPauseCount{0};
+	bool _resumeTimer{false};
 
 	const std::unique_ptr<assets::IAssetProviderRegistry> _assetProviderRegistry;
 
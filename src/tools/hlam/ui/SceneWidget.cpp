@@ -1,9 +1,14 @@
+#include <algorithm>
 #include <cassert>
 
 #include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
 #include <QWheelEvent>
 #include <QWidget>
 
+#include "entity/HLMVStudioModelEntity.hpp"
+
 #include "graphics/Scene.hpp"
 #include "ui/SceneWidget.hpp"
 
@@ -17,19 +22,129 @@ SceneWidget::SceneWidget(graphics::Scene* scene, QWidget* parent)
 	assert(nullptr != _scene);
 
 	_container->setFocusPolicy(Qt::FocusPolicy::WheelFocus);
-
-	connect(this, &SceneWidget::frameSwapped, this, qOverload<>(&SceneWidget::update));
 }
 
 SceneWidget::~SceneWidget()
 {
 	makeCurrent();
 
+	_gpuFrameTimer.Destroy();
+
 	_scene->Shutdown();
 
 	doneCurrent();
 }
 
+void SceneWidget::SetRenderContinuously(bool value)
+{
+	if (_renderContinuously == value)
+	{
+		return;
+	}
+
+	_renderContinuously = value;
+
+	if (_renderContinuously)
+	{
+		connect(this, &SceneWidget::frameSwapped, this, qOverload<>(&SceneWidget::update));
+		update();
+	}
+	else
+	{
+		disconnect(this, &SceneWidget::frameSwapped, this, qOverload<>(&SceneWidget::update));
+	}
+}
+
+void SceneWidget::RedrawIfChanged()
+{
+	if (_renderContinuously)
+	{
+		return;
+	}
+
+	const auto entity = _scene->GetEntity();
+
+	if (entity ? (!_drawnRenderInfo || *_drawnRenderInfo != entity->GetRenderInfo()) : _drawnRenderInfo.has_value())
+	{
+		update();
+	}
+	else
+	{
+		++_skippedFramesCount;
+	}
+}
+
+bool SceneWidget::CanInputChangeScene(QEvent* event)
+{
+	switch (event->type())
+	{
+	case QEvent::MouseButtonPress:
+	case QEvent::MouseButtonRelease:
+	case QEvent::MouseButtonDblClick:
+	case QEvent::KeyPress:
+	case QEvent::KeyRelease:
+	case QEvent::Wheel:
+		return true;
+
+	case QEvent::MouseMove:
+		//Hovering doesn't change anything, dragging does
+		return static_cast<QMouseEvent*>(event)->buttons() != Qt::MouseButton::NoButton;
+
+	default:
+		return false;
+	}
+}
+
+bool SceneWidget::event(QEvent* event)
+{
+	if (!_renderContinuously && CanInputChangeScene(event))
+	{
+		update();
+	}
+
+	return QOpenGLWindow::event(event);
+}
+
+bool SceneWidget::eventFilter(QObject* watched, QEvent* event)
+{
+	//Panels in the containing window edit the scene directly. Hidden scenes are drawn once they are shown again
+	if (!_renderContinuously && _container->isVisible() && CanInputChangeScene(event))
+	{
+		update();
+	}
+
+	return QOpenGLWindow::eventFilter(watched, event);
+}
+
+void SceneWidget::exposeEvent(QExposeEvent* event)
+{
+	WatchContainingWindow();
+
+	QOpenGLWindow::exposeEvent(event);
+}
+
+void SceneWidget::WatchContainingWindow()
+{
+	const auto window = _container->window()->windowHandle();
+
+	if (_containingWindow == window)
+	{
+		return;
+	}
+
+	if (_containingWindow)
+	{
+		_containingWindow->removeEventFilter(this);
+	}
+
+	_containingWindow = window;
+
+	if (_containingWindow)
+	{
+		_containingWindow->installEventFilter(this);
+	}
+}
+
 void SceneWidget::wheelEvent(QWheelEvent* event)
 {
 	//Ugly hack: when this window has focus it eats all wheel events even when the mouse is not over it.
@@ -58,6 +173,8 @@ void SceneWidget::initializeGL()
 	//TODO: since we're sharing contexts this can probably be done elsewhere to avoid multiple calls
 	_scene->Initialize();
 
+	_gpuFrameTimer.Create();
+
 	emit CreateDeviceResources();
 }
 
@@ -76,7 +193,127 @@ void SceneWidget::paintGL()
 	{
 		//TODO: this is temporary until window sized resources can be decoupled from the scene class
 		_scene->UpdateWindowSize(static_cast<unsigned int>(size.width()), static_cast<unsigned int>(size.height()));
+
+		const auto profiler = _scene->GetFrameProfiler();
+
+		if (profiler)
+		{
+			profiler->BeginFrame();
+			_gpuFrameTimer.BeginFrame(*profiler);
+		}
+
 		_scene->Draw();
+
+		if (profiler)
+		{
+			_gpuFrameTimer.EndFrame();
+			profiler->EndFrame();
+
+			if (profiler->IsEnabled())
+			{
+				DrawFrameProfilerOverlay(*profiler);
+			}
+		}
+
+		if (const auto entity = _scene->GetEntity(); entity)
+		{
+			_drawnRenderInfo = entity->GetRenderInfo();
+		}
+		else
+		{
+			_drawnRenderInfo.reset();
+		}
+
+		++_drawnFramesCount;
+	}
+}
+
+void SceneWidget::DrawFrameProfilerOverlay(const graphics::FrameProfiler& profiler)
+{
+	const auto& frames = profiler.GetFrames();
+	const auto average = profiler.GetAverage();
+	const auto maximum = profiler.GetMaximum();
+
+	QStringList lines;
+
+	lines.append(QString{"Frame: %1 ms (max %2 ms)"}.arg(average.FrameTime, 0, 'f', 2).arg(maximum.FrameTime, 0, 'f', 2));
+
+	if (average.GPUTime >= 0)
+	{
+		lines.append(QString{"GPU: %1 ms (max %2 ms)"}.arg(average.GPUTime, 0, 'f', 2).arg(maximum.GPUTime, 0, 'f', 2));
+	}
+	else
+	{
+		lines.append("GPU: not available");
+	}
+
+	for (std::size_t i = 0; i < graphics::ProfileStageCount; ++i)
+	{
+		lines.append(QString{"%1: %2 ms (max %3 ms)"}
+			.arg(graphics::ProfileStageToString(static_cast<graphics::ProfileStage>(i)))
+			.arg(average.Stages[i], 0, 'f', 3)
+			.arg(maximum.Stages[i], 0, 'f', 3));
+	}
+
+	//The painter changes state that the scene expects to be unchanged
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glPushClientAttrib(GL_CLIENT_ALL_ATTRIB_BITS);
+
+	{
+		QPainter painter{this};
+
+		const QFontMetrics metrics{painter.font()};
+
+		const int margin = 4;
+		const int lineHeight = metrics.height();
+		const int graphHeight = 40;
+
+		int textWidth = 0;
+
+		for (const auto& line : lines)
+		{
+			textWidth = std::max(textWidth, metrics.horizontalAdvance(line));
+		}
+
+		const int width = std::max(textWidth, static_cast<int>(graphics::FrameProfiler::MaxFrames)) + (margin * 2);
+		const int height = (lineHeight * lines.size()) + graphHeight + (margin * 3);
+
+		painter.fillRect(0, 0, width, height, QColor{0, 0, 0, 160});
+
+		painter.setPen(Qt::white);
+
+		for (int i = 0; i < lines.size(); ++i)
+		{
+			painter.drawText(margin, margin + (lineHeight * i) + metrics.ascent(), lines[i]);
+		}
+
+		//Frame time graph, one pixel per frame. The scale grows to fit spikes but never shows less than 30 FPS
+		const int graphBottom = height - margin;
+		const double graphScale = graphHeight / std::max(maximum.FrameTime, 1000.0 / 30.0);
+
+		int x = margin;
+
+		for (const auto& frame : frames)
+		{
+			const int barHeight = std::max(1, static_cast<int>(frame.FrameTime * graphScale));
+
+			painter.fillRect(x, graphBottom - barHeight, 1, barHeight, frame.FrameTime > (1000.0 / 60.0) ? Qt::red : Qt::green);
+			++x;
+		}
+
+		//60 FPS reference line
+		const int referenceY = graphBottom - static_cast<int>((1000.0 / 60.0) * graphScale);
+
+		painter.setPen(Qt::yellow);
+		painter.drawLine(margin, referenceY, margin + static_cast<int>(graphics::FrameProfiler::MaxFrames), referenceY);
 	}
+
+	glPopClientAttrib();
+	glPopAttrib();
+
+	//Not part of the attribute stack
+	glUseProgram(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 }
@@ -1,11 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 
 #include <GL/glew.h>
 
 #include <QOpenGLWindow>
+#include <QPointer>
 
+#include "engine/shared/renderer/studiomodel/ModelRenderInfo.hpp"
+
+#include "graphics/FrameProfiler.hpp"
 #include "graphics/IGraphicsContext.hpp"
 
 namespace graphics
@@ -38,7 +44,10 @@ private:
 };
 
 /**
-*	@brief Renders a scene to an OpenGL window
+*	@brief Renders a scene to an OpenGL window.
+*	By default the scene is only redrawn when it may have changed: on user input in this window or in the window that contains it
+*	while it is visible, when RedrawIfChanged finds that the entity changed on its own, for instance because it is animating,
+*	and when update is called because something else changed the scene.
 *	TODO: rework this so it isn't tied directly to OpenGL (allow D3D or Vulkan backends)
 */
 class SceneWidget final : public QOpenGLWindow
@@ -53,6 +62,23 @@ public:
 
 	graphics::Scene* GetScene() { return _scene; }
 
+	bool IsRenderingContinuously() const { return _renderContinuously; }
+
+	std::uint64_t GetDrawnFramesCount() const { return _drawnFramesCount; }
+
+	/**
+	*	@brief Number of times RedrawIfChanged found nothing to redraw
+	*/
+	std::uint64_t GetSkippedFramesCount() const { return _skippedFramesCount; }
+
+public slots:
+	void SetRenderContinuously(bool value);
+
+	/**
+	*	@brief Schedules a redraw if the entity changed since the last frame. Call after simulation updates
+	*/
+	void RedrawIfChanged();
+
 signals:
 	void CreateDeviceResources();
 
@@ -61,6 +87,12 @@ signals:
 	void WheelEvent(QWheelEvent* event);
 
 protected:
+	bool event(QEvent* event) override;
+
+	bool eventFilter(QObject* watched, QEvent* event) override;
+
+	void exposeEvent(QExposeEvent* event) override;
+
 	void mousePressEvent(QMouseEvent* event) override final
 	{
 		emit MouseEvent(event);
@@ -82,8 +114,38 @@ protected:
 	void resizeGL(int w, int h) override;
 	void paintGL() override;
 
+private:
+	/**
+	*	@brief Whether the event is input that can change the camera, the model or the settings used to draw it
+	*/
+	static bool CanInputChangeScene(QEvent* event);
+
+	/**
+	*	@brief Watches the input of the window that contains this one. The container can be moved to another window
+	*/
+	void WatchContainingWindow();
+
+	/**
+	*	@brief Draws the profiler's recent frame times on top of the scene
+	*/
+	void DrawFrameProfilerOverlay(const graphics::FrameProfiler& profiler);
+
 private:
 	QWidget* const _container;
 	graphics::Scene* const _scene;
+
+	bool _renderContinuously = false;
+
+	//Window whose input is being watched
+	QPointer<QWindow> _containingWindow;
+
+	//Entity state drawn in the last frame
+	std::optional<studiomdl::ModelRenderInfo> _drawnRenderInfo;
+
+	std::uint64_t _drawnFramesCount = 0;
+	std::uint64_t _skippedFramesCount = 0;
+
+	//Queries belong to this window's context
+	graphics::GPUFrameTimer _gpuFrameTimer;
 };
 }
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <QDir>
+#include <QFileInfo>
+#include <QImage>
+#include <QMessageBox>
+
+#include "entity/HLMVStudioModelEntity.hpp"
+
+#include "graphics/IGraphicsContext.hpp"
+#include "graphics/ImageSequenceRenderer.hpp"
+#include "graphics/Scene.hpp"
+#include "graphics/TGAFile.hpp"
+
+#include "ui/EditorContext.hpp"
+
+#include "ui/assets/studiomodel/SequenceExportTask.hpp"
+
+namespace ui::assets::studiomodel
+{
+static bool SaveImageFile(const QString& fileName, const std::vector<std::uint8_t>& pixels, int width, int height)
+{
+	if (QFileInfo{fileName}.suffix().compare("tga", Qt::CaseSensitivity::CaseInsensitive) == 0)
+	{
+		return graphics::tgafile::SaveTGAFile(fileName.toStdString().c_str(), width, height, pixels.data());
+	}
+
+	const QImage image{pixels.data(), width, height, width * 4, QImage::Format::Format_RGBA8888};
+
+	//Pixels are bottom row first. Blending can leave the framebuffer partially transparent, which isn't part of what's shown in the window
+	return image.mirrored().convertToFormat(QImage::Format::Format_RGB888).save(fileName);
+}
+
+SequenceExportTask::SequenceExportTask(EditorContext* editorContext, graphics::Scene* scene, HLMVStudioModelEntity* entity,
+	double frameRate, int width, int height, std::size_t imageCount, QString&& fileName, QWidget* parentWidget)
+	: _editorContext(editorContext)
+	, _scene(scene)
+	, _entity(entity)
+	, _parentWidget(parentWidget)
+	, _frameRate(frameRate)
+	, _fileName(std::move(fileName))
+	, _renderer(std::make_unique<graphics::ImageSequenceRenderer>(scene, width, height, imageCount))
+{
+	//Images are read back asynchronously, so check often whether they are ready without spinning
+	_timer.setInterval(1);
+
+	connect(&_timer, &QTimer::timeout, this, &SequenceExportTask::OnStep);
+}
+
+SequenceExportTask::~SequenceExportTask()
+{
+	StopDrawing();
+
+	//Don't abandon saves in progress
+	for (auto& save : _pendingSaves)
+	{
+		save.Result.wait();
+	}
+}
+
+bool SequenceExportTask::Start()
+{
+	const auto context = _scene->GetGraphicsContext();
+
+	context->Begin();
+	const bool initialized = _renderer->Initialize();
+	context->End();
+
+	if (!initialized)
+	{
+		QMessageBox::critical(_parentWidget, "Error", "Could not create the framebuffer used to draw the images");
+		StopDrawing();
+		return false;
+	}
+
+	//The frame is set for each image
+	_editorContext->PauseTimer();
+	_simulationPaused = true;
+
+	_originalFrame = _entity->GetFrame();
+
+	_progress = new QProgressDialog("Exporting sequence...", "Cancel", 0, static_cast<int>(_renderer->GetImageCount()), _parentWidget);
+	_progress->setWindowModality(Qt::WindowModality::WindowModal);
+	_progress->setAttribute(Qt::WidgetAttribute::WA_DeleteOnClose);
+
+	connect(_progress, &QProgressDialog::canceled, this, &SequenceExportTask::OnCanceled);
+
+	//Show it right away so the scene can't be changed while images are being drawn
+	_progress->setMinimumDuration(0);
+	_progress->setValue(0);
+
+	_timer.start();
+
+	return true;
+}
+
+void SequenceExportTask::OnStep()
+{
+	if (!CollectSavedImages())
+	{
+		OnCanceled();
+		return;
+	}
+
+	if (_renderer)
+	{
+		//Keep enough images in flight to use every worker without buffering the whole sequence in memory
+		const std::size_t maxPendingSaves = std::max(2u, std::thread::hardware_concurrency());
+
+		const auto context = _scene->GetGraphicsContext();
+
+		context->Begin();
+
+		const bool complete = _renderer->Step(
+			[this](auto index)
+			{
+				PrepareImage(index);
+			},
+			[this](auto index, auto pixels, auto width, auto height)
+			{
+				SaveImage(index, pixels, width, height);
+			},
+			_pendingSaves.size() < maxPendingSaves);
+
+		context->End();
+
+		if (_renderer->HasFailed())
+		{
+			//The message box runs an event loop
+			_timer.stop();
+
+			QMessageBox::critical(_parentWidget, "Error", "An error occurred while reading back the images");
+
+			OnCanceled();
+			return;
+		}
+
+		if (complete)
+		{
+			StopDrawing();
+		}
+	}
+
+	if (_progress)
+	{
+		_progress->setValue(static_cast<int>(_savedImageCount));
+	}
+
+	if (!_renderer && _pendingSaves.empty())
+	{
+		_timer.stop();
+
+		if (_progress)
+		{
+			_progress->disconnect(this);
+			_progress->close();
+		}
+
+		deleteLater();
+	}
+}
+
+void SequenceExportTask::OnCanceled()
+{
+	StopDrawing();
+
+	_timer.stop();
+
+	if (_progress)
+	{
+		_progress->disconnect(this);
+		_progress->close();
+	}
+
+	deleteLater();
+}
+
+QString SequenceExportTask::GetImageFileName(std::size_t index) const
+{
+	const QFileInfo fileInfo{_fileName};
+
+	return QString{"%1%2%3_%4.%5"}
+		.arg(fileInfo.path())
+		.arg(QDir::separator())
+		.arg(fileInfo.completeBaseName())
+		.arg(index, 4, 10, QChar{'0'})
+		.arg(fileInfo.suffix());
+}
+
+void SequenceExportTask::PrepareImage(std::size_t index)
+{
+	float frameRate, groundSpeed;
+	_entity->GetSequenceInfo(frameRate, groundSpeed);
+
+	_entity->SetFrame(static_cast<float>((index / _frameRate) * frameRate));
+	_entity->ResetFrameInterpolation();
+}
+
+void SequenceExportTask::SaveImage(std::uint64_t index, const std::uint8_t* pixels, int width, int height)
+{
+	//The pixels are only valid during this call
+	std::vector<std::uint8_t> copy(pixels, pixels + (static_cast<std::size_t>(width) * height * 4));
+
+	_pendingSaves.push_back(PendingSave{static_cast<std::size_t>(index),
+		std::async(std::launch::async, [pixels = std::move(copy), width, height, fileName = GetImageFileName(index)]()
+			{
+				return SaveImageFile(fileName, pixels, width, height);
+			})});
+}
+
+bool SequenceExportTask::CollectSavedImages()
+{
+	while (!_pendingSaves.empty())
+	{
+		auto& save = _pendingSaves.front();
+
+		if (save.Result.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+		{
+			break;
+		}
+
+		const std::size_t index = save.Index;
+		const bool saved = save.Result.get();
+
+		_pendingSaves.pop_front();
+
+		if (!saved)
+		{
+			//The message box runs an event loop
+			_timer.stop();
+
+			QMessageBox::critical(_parentWidget, "Error", QString{"An error occurred while saving image \"%1\""}.arg(GetImageFileName(index)));
+			return false;
+		}
+
+		++_savedImageCount;
+	}
+
+	return true;
+}
+
+void SequenceExportTask::StopDrawing()
+{
+	if (_renderer)
+	{
+		const auto context = _scene->GetGraphicsContext();
+
+		context->Begin();
+		_renderer->Shutdown();
+		context->End();
+
+		_renderer.reset();
+	}
+
+	if (_originalFrame)
+	{
+		_entity->SetFrame(*_originalFrame);
+		_entity->ResetFrameInterpolation();
+		_originalFrame.reset();
+	}
+
+	if (_simulationPaused)
+	{
+		_simulationPaused = false;
+		_editorContext->ResumeTimer();
+	}
+}
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+
+#include <QObject>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QString>
+#include <QTimer>
+
+class HLMVStudioModelEntity;
+class QWidget;
+
+namespace graphics
+{
+class ImageSequenceRenderer;
+class Scene;
+}
+
+namespace ui
+{
+class EditorContext;
+
+namespace assets::studiomodel
+{
+/**
+*	@brief Exports the entity's current sequence as one image per frame.
+*	Frames are drawn offscreen and read back asynchronously, then encoded and saved on worker threads.
+*	Simulation is paused while frames are being drawn.
+*	Deletes itself once all images have been saved or the task has been canceled.
+*	Must be deleted before the scene and its graphics context.
+*/
+class SequenceExportTask final : public QObject
+{
+	Q_OBJECT
+
+public:
+	SequenceExportTask(EditorContext* editorContext, graphics::Scene* scene, HLMVStudioModelEntity* entity,
+		double frameRate, int width, int height, std::size_t imageCount, QString&& fileName, QWidget* parentWidget);
+	~SequenceExportTask();
+
+	/**
+	*	@brief Creates the resources used to draw the images and starts drawing them
+	*	@return Whether the task was started. The caller must delete the task if not
+	*/
+	bool Start();
+
+private slots:
+	void OnStep();
+
+	void OnCanceled();
+
+private:
+	QString GetImageFileName(std::size_t index) const;
+
+	void PrepareImage(std::size_t index);
+
+	void SaveImage(std::uint64_t index, const std::uint8_t* pixels, int width, int height);
+
+	/**
+	*	@brief Removes finished saves from the queue
+	*	@return Whether all of them succeeded. An error is shown if not
+	*/
+	bool CollectSavedImages();
+
+	void StopDrawing();
+
+private:
+	struct PendingSave
+	{
+		std::size_t Index;
+		std::future<bool> Result;
+	};
+
+	EditorContext* const _editorContext;
+	graphics::Scene* const _scene;
+	HLMVStudioModelEntity* const _entity;
+	QWidget* const _parentWidget;
+
+	const double _frameRate;
+
+	const QString _fileName;
+
+	std::unique_ptr<graphics::ImageSequenceRenderer> _renderer;
+
+	QTimer _timer;
+
+	//Owned by the parent widget, which may be destroyed first
+	QPointer<QProgressDialog> _progress;
+
+	bool _simulationPaused = false;
+
+	//Frame to restore once done
+	std::optional<float> _originalFrame;
+
+	//Saves in progress, oldest first. Limited so readback doesn't run too far ahead of the workers
+	std::deque<PendingSave> _pendingSaves;
+
+	std::size_t _savedImageCount = 0;
+};
+}
+}
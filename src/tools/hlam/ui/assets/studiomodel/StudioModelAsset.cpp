@@ -8,6 +8,7 @@
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QImage>
+#include <QInputDialog>
 #include <QMenu>
 #include <QMessageBox>
 
@@ -23,6 +24,7 @@
 #include "game/entity/BaseEntityList.hpp"
 #include "game/entity/EntityManager.hpp"
 
+#include "graphics/FrameProfiler.hpp"
 #include "graphics/Scene.hpp"
 #include "graphics/TextureLoader.hpp"
 
@@ -33,9 +35,12 @@
 #include "ui/SceneWidget.hpp"
 #include "ui/StateSnapshot.hpp"
 
+#include "ui/assets/studiomodel/SequenceExportTask.hpp"
 #include "ui/assets/studiomodel/StudioModelAsset.hpp"
 #include "ui/assets/studiomodel/StudioModelColors.hpp"
 #include "ui/assets/studiomodel/StudioModelEditWidget.hpp"
+#include "ui/assets/studiomodel/StudioModelExportSequenceDialog.hpp"
+#include "ui/assets/studiomodel/TiledScreenshotTask.hpp"
 #include "ui/assets/studiomodel/compiler/StudioModelCompilerFrontEnd.hpp"
 #include "ui/assets/studiomodel/compiler/StudioModelDecompilerFrontEnd.hpp"
 
@@ -46,6 +51,7 @@
 #include "ui/camera_operators/FreeLookCameraOperator.hpp"
 
 #include "ui/settings/ColorSettings.hpp"
+#include "ui/settings/GeneralSettings.hpp"
 #include "ui/settings/StudioModelSettings.hpp"
 
 #include "utility/IOUtils.hpp"
@@ -55,9 +61,7 @@ namespace ui::assets::studiomodel
 const QString StudioModelExtension{QStringLiteral("mdl")};
 const QString StudioModelPS2Extension{QStringLiteral("dol")};
 
-const float InitialCameraYaw{180};
-
-static std::pair<float, float> GetCenteredValues(HLMVStudioModelEntity* entity)
+std::pair<float, float> GetCenteredValues(HLMVStudioModelEntity* entity)
 {
 	glm::vec3 min, max;
 	entity->ExtractBbox(min, max);
@@ -89,7 +93,8 @@ StudioModelAsset::StudioModelAsset(QString&& fileName,
 	, _provider(provider)
 	, _editableStudioModel(std::move(editableStudioModel))
 	, _textureLoader(std::make_unique<graphics::TextureLoader>())
-	, _scene(std::make_unique<graphics::Scene>(_textureLoader.get(), editorContext->GetSoundSystem(), editorContext->GetWorldTime()))
+	, _scene(std::make_unique<graphics::Scene>(_textureLoader.get(), editorContext->GetSoundSystem(), editorContext->GetWorldTime(),
+		editorContext->GetWorkerPool()))
 	, _cameraOperators(new camera_operators::CameraOperators(this))
 {
 	PushInputSink(this);
@@ -99,6 +104,10 @@ StudioModelAsset::StudioModelAsset(QString&& fileName,
 	UpdateColors();
 
 	_scene->FloorLength = _provider->GetStudioModelSettings()->GetFloorLength();
+	_scene->SetUseVertexBuffers(_provider->GetStudioModelSettings()->ShouldUseVertexBuffers());
+	_scene->SetUseGPUSkinning(_provider->GetStudioModelSettings()->ShouldUseGPUSkinning());
+	_scene->SetUseTextureArrays(_provider->GetStudioModelSettings()->ShouldUseTextureArrays());
+	_scene->SetFrameProfiler(editorContext->GetFrameProfiler());
 
 	auto entity = static_cast<HLMVStudioModelEntity*>(_scene->GetEntityContext()->EntityManager->Create("studiomodel", _scene->GetEntityContext(),
 		glm::vec3(), glm::vec3(), false));
@@ -142,12 +151,19 @@ StudioModelAsset::StudioModelAsset(QString&& fileName,
 	connect(_editorContext, &EditorContext::Tick, this, &StudioModelAsset::OnTick);
 	connect(_editorContext->GetColorSettings(), &settings::ColorSettings::ColorsChanged, this, &StudioModelAsset::UpdateColors);
 	connect(_provider->GetStudioModelSettings(), &settings::StudioModelSettings::FloorLengthChanged, this, &StudioModelAsset::OnFloorLengthChanged);
+	connect(_provider->GetStudioModelSettings(), &settings::StudioModelSettings::UseVertexBuffersChanged, this, &StudioModelAsset::OnUseVertexBuffersChanged);
+	connect(_provider->GetStudioModelSettings(), &settings::StudioModelSettings::UseGPUSkinningChanged, this, &StudioModelAsset::OnUseGPUSkinningChanged);
+	connect(_provider->GetStudioModelSettings(), &settings::StudioModelSettings::UseTextureArraysChanged, this, &StudioModelAsset::OnUseTextureArraysChanged);
 }
 
 StudioModelAsset::~StudioModelAsset()
 {
 	PopInputSink();
 
+	//These use the scene widget's graphics context
+	delete _screenshotTask;
+	delete _sequenceExportTask;
+
 	delete _editWidget;
 }
 
@@ -177,6 +193,18 @@ void StudioModelAsset::PopulateAssetMenu(QMenu* menu)
 	menu->addSeparator();
 
 	menu->addAction("Take Screenshot...", this, &StudioModelAsset::OnTakeScreenshot);
+	menu->addAction("Take High-Resolution Screenshot...", this, &StudioModelAsset::OnTakeHighResolutionScreenshot);
+	menu->addAction("Export Sequence As Images...", this, &StudioModelAsset::OnExportSequenceAsImages);
+
+	menu->addSeparator();
+
+	{
+		const auto showFrameProfiler = menu->addAction("Show Frame Profiler", this, &StudioModelAsset::OnShowFrameProfiler);
+		showFrameProfiler->setCheckable(true);
+		showFrameProfiler->setChecked(_editorContext->GetFrameProfiler()->IsEnabled());
+	}
+
+	menu->addAction("Save Frame Profile...", this, &StudioModelAsset::OnSaveFrameProfile);
 }
 
 QWidget* StudioModelAsset::GetEditWidget()
@@ -191,6 +219,8 @@ QWidget* StudioModelAsset::GetEditWidget()
 	_editWidget->connect(_editWidget->GetSceneWidget(), &SceneWidget::MouseEvent, this, &StudioModelAsset::OnSceneWidgetMouseEvent);
 	_editWidget->connect(_editWidget->GetSceneWidget(), &SceneWidget::WheelEvent, this, &StudioModelAsset::OnSceneWidgetWheelEvent);
 
+	SetupSceneWidget(_editWidget->GetSceneWidget());
+
 	return _editWidget;
 }
 
@@ -205,6 +235,8 @@ void StudioModelAsset::SetupFullscreenWidget(FullscreenWidget* fullscreenWidget)
 
 	//Filter key events on the scene widget so we can capture exit even if it has focus
 	sceneWidget->installEventFilter(fullscreenWidget);
+
+	SetupSceneWidget(sceneWidget);
 }
 
 void StudioModelAsset::Save()
@@ -329,6 +361,26 @@ void StudioModelAsset::LoadEntityFromSnapshot(StateSnapshot* snapshot)
 	}
 }
 
+void StudioModelAsset::SetupSceneWidget(SceneWidget* sceneWidget)
+{
+	const auto generalSettings = _editorContext->GetGeneralSettings();
+
+	sceneWidget->SetRenderContinuously(generalSettings->ShouldRenderContinuously());
+
+	sceneWidget->connect(generalSettings, &settings::GeneralSettings::RenderContinuouslyChanged, sceneWidget, &SceneWidget::SetRenderContinuously);
+
+	//Connected after the editor context, so this runs once the simulation has been updated
+	sceneWidget->connect(_editorContext->GetTimer(), &QTimer::timeout, sceneWidget, &SceneWidget::RedrawIfChanged);
+
+	//Edits are usually caused by input, but changes made any other way must be shown as well
+	sceneWidget->connect(this, &StudioModelAsset::ModelChanged, sceneWidget, [sceneWidget]
+		{
+			sceneWidget->update();
+		});
+
+	sceneWidget->connect(this, &StudioModelAsset::SceneChanged, sceneWidget, qOverload<>(&SceneWidget::update));
+}
+
 void StudioModelAsset::OnTick()
 {
 	//TODO: update asset-local world time
@@ -374,6 +426,8 @@ void StudioModelAsset::OnCameraChanged(camera_operators::CameraOperator* previou
 {
 	_scene->SetCurrentCamera(current != nullptr ? current->GetCamera() : nullptr);
 	_scene->CameraIsFirstPerson = current == _firstPersonCamera;
+
+	EmitSceneChanged();
 }
 
 static glm::vec3 ColorToVector(const QColor& color)
@@ -390,11 +444,36 @@ void StudioModelAsset::UpdateColors()
 	_scene->CrosshairColor = ColorToVector(colorSettings->GetColor(CrosshairColor.Name));
 	_scene->SetLightColor(ColorToVector(colorSettings->GetColor(LightColor.Name)));
 	_scene->SetWireframeColor(ColorToVector(colorSettings->GetColor(WireframeColor.Name)));
+
+	EmitSceneChanged();
 }
 
 void StudioModelAsset::OnFloorLengthChanged(int length)
 {
 	_scene->FloorLength = length;
+
+	EmitSceneChanged();
+}
+
+void StudioModelAsset::OnUseVertexBuffersChanged(bool value)
+{
+	_scene->SetUseVertexBuffers(value);
+
+	EmitSceneChanged();
+}
+
+void StudioModelAsset::OnUseGPUSkinningChanged(bool value)
+{
+	_scene->SetUseGPUSkinning(value);
+
+	EmitSceneChanged();
+}
+
+void StudioModelAsset::OnUseTextureArraysChanged(bool value)
+{
+	_scene->SetUseTextureArrays(value);
+
+	EmitSceneChanged();
 }
 
 void StudioModelAsset::OnPreviousCamera()
@@ -467,6 +546,8 @@ void StudioModelAsset::OnLoadGroundTexture()
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		_scene->GetGraphicsContext()->End();
+
+		EmitSceneChanged();
 	}
 }
 
@@ -478,6 +559,8 @@ void StudioModelAsset::OnUnloadGroundTexture()
 		glDeleteTextures(1, &_scene->GroundTexture);
 		_scene->GroundTexture = 0;
 		_scene->GetGraphicsContext()->End();
+
+		EmitSceneChanged();
 	}
 }
 
@@ -511,6 +594,8 @@ void StudioModelAsset::OnLoadBackgroundTexture()
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		_scene->GetGraphicsContext()->End();
+
+		EmitSceneChanged();
 	}
 }
 
@@ -522,6 +607,8 @@ void StudioModelAsset::OnUnloadBackgroundTexture()
 		glDeleteTextures(1, &_scene->BackgroundTexture);
 		_scene->BackgroundTexture = 0;
 		_scene->GetGraphicsContext()->End();
+
+		EmitSceneChanged();
 	}
 }
 
@@ -569,6 +656,133 @@ void StudioModelAsset::OnTakeScreenshot()
 	}
 }
 
+void StudioModelAsset::OnTakeHighResolutionScreenshot()
+{
+	if (_screenshotTask)
+	{
+		QMessageBox::information(nullptr, "Take High-Resolution Screenshot", "The previous screenshot is still being saved");
+		return;
+	}
+
+	GetEditWidget();
+
+	const auto sceneWidget = _editWidget->GetSceneWidget();
+
+	//Use the same framing as the view
+	const QSize viewSize{sceneWidget->size() * sceneWidget->devicePixelRatio()};
+
+	bool ok = false;
+
+	const int scale = QInputDialog::getInt(nullptr, "Take High-Resolution Screenshot",
+		QString{"Image size as a multiple of the %1 x %2 view:"}.arg(viewSize.width()).arg(viewSize.height()),
+		4, 1, 16, 1, &ok);
+
+	if (!ok)
+	{
+		return;
+	}
+
+	QString fileName{QFileDialog::getSaveFileName(nullptr, {}, {}, qt::GetImagesFileFilter())};
+
+	if (fileName.isEmpty())
+	{
+		return;
+	}
+
+	auto task = std::make_unique<TiledScreenshotTask>(_editorContext, _scene.get(),
+		viewSize.width() * scale, viewSize.height() * scale, std::move(fileName), _editWidget);
+
+	if (task->Start())
+	{
+		_screenshotTask = task.release();
+	}
+}
+
+void StudioModelAsset::OnExportSequenceAsImages()
+{
+	if (_sequenceExportTask)
+	{
+		QMessageBox::information(nullptr, "Export Sequence As Images", "The previous export is still being saved");
+		return;
+	}
+
+	const auto entity = _scene->GetEntity();
+
+	if (!entity || entity->GetSequence() < 0)
+	{
+		QMessageBox::information(nullptr, "Export Sequence As Images", "This model has no sequences");
+		return;
+	}
+
+	GetEditWidget();
+
+	const auto sceneWidget = _editWidget->GetSceneWidget();
+
+	const auto& sequence = *_editableStudioModel->Sequences[entity->GetSequence()];
+
+	float frameRate, groundSpeed;
+	entity->GetSequenceInfo(frameRate, groundSpeed);
+
+	StudioModelExportSequenceDialog dialog{QString::fromStdString(sequence.Label), frameRate, sequence.NumFrames,
+		sceneWidget->size() * sceneWidget->devicePixelRatio(), _editWidget};
+
+	if (dialog.exec() != QDialog::DialogCode::Accepted)
+	{
+		return;
+	}
+
+	const QSize imageSize{dialog.GetImageSize()};
+
+	auto task = std::make_unique<SequenceExportTask>(_editorContext, _scene.get(), entity,
+		dialog.GetFrameRate(), imageSize.width(), imageSize.height(), dialog.GetImageCount(), dialog.GetFileName(), _editWidget);
+
+	if (task->Start())
+	{
+		_sequenceExportTask = task.release();
+	}
+}
+
+void StudioModelAsset::OnShowFrameProfiler(bool checked)
+{
+	_editorContext->GetFrameProfiler()->SetEnabled(checked);
+
+	if (_editWidget)
+	{
+		_editWidget->GetSceneWidget()->update();
+	}
+}
+
+void StudioModelAsset::OnSaveFrameProfile()
+{
+	const auto profiler = _editorContext->GetFrameProfiler();
+
+	if (profiler->GetFrames().empty())
+	{
+		QMessageBox::information(nullptr, "Save Frame Profile", "No frames have been profiled yet. Enable the frame profiler first.");
+		return;
+	}
+
+	const QFileInfo fileInfo{GetFileName()};
+
+	const auto suggestedFileName{QString{"%1%2%3_frameprofile.csv"}.arg(fileInfo.path()).arg(QDir::separator()).arg(fileInfo.completeBaseName())};
+
+	const QString fileName{QFileDialog::getSaveFileName(nullptr, {}, suggestedFileName, "CSV Files (*.csv);;All Files (*.*)")};
+
+	if (!fileName.isEmpty())
+	{
+		if (FILE* file = utf8_fopen(fileName.toStdString().c_str(), "w"); file)
+		{
+			profiler->WriteCSV(file);
+
+			fclose(file);
+		}
+		else
+		{
+			QMessageBox::critical(nullptr, "Error", QString{"Could not open file \"%1\" for writing"}.arg(fileName));
+		}
+	}
+}
+
 StudioModelAssetProvider::~StudioModelAssetProvider() = default;
 
 QString StudioModelAssetProvider::GetProviderName() const
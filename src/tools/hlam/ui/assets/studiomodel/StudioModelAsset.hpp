@@ -3,9 +3,11 @@
 #include <cassert>
 #include <memory>
 #include <stack>
+#include <utility>
 #include <vector>
 
 #include <QObject>
+#include <QPointer>
 
 #include "engine/shared/studiomodel/EditableStudioModel.hpp"
 
@@ -14,6 +16,8 @@
 #include "ui/IInputSink.hpp"
 #include "ui/assets/Assets.hpp"
 
+class HLMVStudioModelEntity;
+
 namespace graphics
 {
 class TextureLoader;
@@ -21,6 +25,7 @@ class TextureLoader;
 
 namespace ui
 {
+class SceneWidget;
 class StateSnapshot;
 
 namespace camera_operators
@@ -38,7 +43,16 @@ namespace assets::studiomodel
 {
 class ModelChangeEvent;
 class StudioModelAsset;
+class SequenceExportTask;
 class StudioModelEditWidget;
+class TiledScreenshotTask;
+
+const float InitialCameraYaw{180};
+
+/**
+*	@brief Gets the height to center the view on and the distance to view the entity's model from so all of it is visible
+*/
+std::pair<float, float> GetCenteredValues(HLMVStudioModelEntity* entity);
 
 class StudioModelAssetProvider final : public AssetProvider
 {
@@ -126,8 +140,19 @@ public:
 		GetUndoStack()->push(command);
 	}
 
+	/**
+	*	@brief Call when the scene has been changed in a way that isn't caused by input in the window that shows it
+	*/
+	void EmitSceneChanged()
+	{
+		emit SceneChanged();
+	}
+
 	void EmitModelChanged(const ModelChangeEvent& event)
 	{
+		//All edits are reported here
+		++_editableStudioModel->Revision;
+
 		emit ModelChanged(event);
 	}
 
@@ -135,11 +160,18 @@ private:
 	void SaveEntityToSnapshot(StateSnapshot* snapshot);
 	void LoadEntityFromSnapshot(StateSnapshot* snapshot);
 
+	/**
+	*	@brief Applies the redraw settings to a scene widget and keeps them up to date
+	*/
+	void SetupSceneWidget(SceneWidget* sceneWidget);
+
 signals:
 	void Tick();
 
 	void ModelChanged(const ModelChangeEvent& event);
 
+	void SceneChanged();
+
 	void SaveSnapshot(StateSnapshot* snapshot);
 
 	void LoadSnapshot(StateSnapshot* snapshot);
@@ -157,6 +189,12 @@ private slots:
 
 	void OnFloorLengthChanged(int length);
 
+	void OnUseVertexBuffersChanged(bool value);
+
+	void OnUseGPUSkinningChanged(bool value);
+
+	void OnUseTextureArraysChanged(bool value);
+
 	void OnPreviousCamera();
 	void OnNextCamera();
 
@@ -174,6 +212,14 @@ private slots:
 
 	void OnTakeScreenshot();
 
+	void OnTakeHighResolutionScreenshot();
+
+	void OnExportSequenceAsImages();
+
+	void OnShowFrameProfiler(bool checked);
+
+	void OnSaveFrameProfile();
+
 private:
 	EditorContext* const _editorContext;
 	const StudioModelAssetProvider* const _provider;
@@ -188,6 +234,9 @@ private:
 	camera_operators::CameraOperator* _firstPersonCamera;
 
 	StudioModelEditWidget* _editWidget{};
+
+	QPointer<TiledScreenshotTask> _screenshotTask;
+	QPointer<SequenceExportTask> _sequenceExportTask;
 };
 }
 }
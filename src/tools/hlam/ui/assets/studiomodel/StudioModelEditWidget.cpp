@@ -78,7 +78,7 @@ StudioModelEditWidget::StudioModelEditWidget(
 
 	_dockPanels->setCurrentWidget(modelDisplayPanel);
 
-	const auto infoBar = new InfoBar(_asset, _controlAreaWidget);
+	const auto infoBar = new InfoBar(_asset, _sceneWidget, _controlAreaWidget);
 	_timeline = new Timeline(_asset, _controlAreaWidget);
 
 	auto layout = new QVBoxLayout(this);
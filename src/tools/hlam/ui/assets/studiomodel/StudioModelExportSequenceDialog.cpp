@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+
+#include <QFileDialog>
+
+#include "qt/QtUtilities.hpp"
+
+#include "ui/assets/studiomodel/StudioModelExportSequenceDialog.hpp"
+
+namespace ui::assets::studiomodel
+{
+StudioModelExportSequenceDialog::StudioModelExportSequenceDialog(const QString& sequenceName, float sequenceFrameRate, int sequenceFrameCount,
+	const QSize& imageSize, QWidget* parent)
+	: QDialog(parent)
+	, _sequenceFrameRate(sequenceFrameRate)
+	, _sequenceFrameCount(sequenceFrameCount)
+{
+	_ui.setupUi(this);
+
+	connect(_ui.FileName, &QLineEdit::textChanged, this, &StudioModelExportSequenceDialog::OnFileNameChanged);
+	connect(_ui.BrowseFileName, &QPushButton::clicked, this, &StudioModelExportSequenceDialog::OnBrowseFileName);
+
+	connect(_ui.FrameRate, qOverload<double>(&QDoubleSpinBox::valueChanged), this, &StudioModelExportSequenceDialog::UpdateImageCount);
+
+	_ui.SequenceNameLabel->setText(sequenceName);
+
+	_ui.FrameRate->setValue(_sequenceFrameRate);
+	_ui.ImageWidth->setValue(imageSize.width());
+	_ui.ImageHeight->setValue(imageSize.height());
+
+	_ui.OkButton->setEnabled(false);
+
+	UpdateImageCount();
+}
+
+StudioModelExportSequenceDialog::~StudioModelExportSequenceDialog() = default;
+
+QString StudioModelExportSequenceDialog::GetFileName() const
+{
+	return _ui.FileName->text();
+}
+
+double StudioModelExportSequenceDialog::GetFrameRate() const
+{
+	return _ui.FrameRate->value();
+}
+
+QSize StudioModelExportSequenceDialog::GetImageSize() const
+{
+	return {_ui.ImageWidth->value(), _ui.ImageHeight->value()};
+}
+
+std::size_t StudioModelExportSequenceDialog::GetImageCount() const
+{
+	if (_sequenceFrameCount <= 1 || _sequenceFrameRate <= 0)
+	{
+		return 1;
+	}
+
+	//Sequences wrap around to the first frame after NumFrames - 1 frames, so the end itself isn't included
+	const double duration = (_sequenceFrameCount - 1) / static_cast<double>(_sequenceFrameRate);
+
+	return std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil((duration * GetFrameRate()) - 0.0001)));
+}
+
+void StudioModelExportSequenceDialog::OnFileNameChanged()
+{
+	_ui.OkButton->setEnabled(!_ui.FileName->text().isEmpty());
+}
+
+void StudioModelExportSequenceDialog::OnBrowseFileName()
+{
+	//TGA files are written by the exporter itself, so they are always available
+	QString selectedFilter{"PNG Files (*.png)"};
+
+	const QString fileName = QFileDialog::getSaveFileName(this, "Select Image Filename", {},
+		"TGA Files (*.tga);;" + qt::GetSeparatedImagesFileFilter(), &selectedFilter);
+
+	if (!fileName.isEmpty())
+	{
+		_ui.FileName->setText(fileName);
+	}
+}
+
+void StudioModelExportSequenceDialog::UpdateImageCount()
+{
+	const auto count = GetImageCount();
+
+	_ui.FrameCountLabel->setText(QString{"%1 %2 will be exported"}.arg(count).arg(count == 1 ? "image" : "images"));
+}
+}
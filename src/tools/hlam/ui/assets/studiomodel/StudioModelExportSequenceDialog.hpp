@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+
+#include <QDialog>
+#include <QSize>
+#include <QString>
+
+#include "ui_StudioModelExportSequenceDialog.h"
+
+namespace ui::assets::studiomodel
+{
+class StudioModelExportSequenceDialog final : public QDialog
+{
+public:
+	StudioModelExportSequenceDialog(const QString& sequenceName, float sequenceFrameRate, int sequenceFrameCount,
+		const QSize& imageSize, QWidget* parent = nullptr);
+	~StudioModelExportSequenceDialog();
+
+	QString GetFileName() const;
+
+	double GetFrameRate() const;
+
+	QSize GetImageSize() const;
+
+	/**
+	*	@brief Number of images needed to show the whole sequence once at the chosen frame rate
+	*/
+	std::size_t GetImageCount() const;
+
+private slots:
+	void OnFileNameChanged();
+	void OnBrowseFileName();
+
+	void UpdateImageCount();
+
+private:
+	Ui_StudioModelExportSequenceDialog _ui;
+
+	const float _sequenceFrameRate;
+	const int _sequenceFrameCount;
+};
+}
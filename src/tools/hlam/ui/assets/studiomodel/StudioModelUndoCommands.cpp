@@ -63,6 +63,9 @@ void ChangeBonePropertyCommand::Apply(int index, const ChangeBoneProperties& old
 			bone.Axes[(j * newValue.Scales[j].length()) + i].Scale = newValue.Scales[j][i];
 		}
 	}
+
+	//Bone positions and scales are part of the root motion
+	studiomdl::CalculateRootMotion(*model);
 }
 
 void ChangeBoneControllerFromBoneCommand::Apply(int index, const int& oldValue, const int& newValue)
@@ -210,6 +213,8 @@ void ChangeModelOriginCommand::Apply(const ChangeModelOriginData& oldValue, cons
 			bone.Axes[i].Value = data.BonePosition[i];
 		}
 	}
+
+	studiomdl::CalculateRootMotion(*model);
 }
 
 void ChangeModelMeshesScaleCommand::Apply(const studiomdl::ScaleMeshesData& oldValue, const studiomdl::ScaleMeshesData& newValue)
@@ -222,6 +227,11 @@ void ChangeModelBonesScaleCommand::Apply(const std::vector<studiomdl::ScaleBones
 	ApplyScaleBonesData(*_asset->GetScene()->GetEntity()->GetEditableModel(), newValue);
 }
 
+void ChangeSequenceBBoxesCommand::Apply(const studiomdl::SequenceBBoxesData& oldValue, const studiomdl::SequenceBBoxesData& newValue)
+{
+	ApplySequenceBBoxesData(*_asset->GetScene()->GetEntity()->GetEditableModel(), newValue);
+}
+
 void ChangeHitboxBoneCommand::Apply(int index, const int& oldValue, const int& newValue)
 {
 	auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
@@ -342,5 +352,7 @@ void FlipNormalsCommand::Apply(int index, const std::vector<glm::vec3>& oldValue
 			}
 		}
 	}
+
+	++model->GeometryRevision;
 }
 }
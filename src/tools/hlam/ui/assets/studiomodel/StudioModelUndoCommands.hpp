@@ -21,6 +21,7 @@ namespace studiomdl
 {
 struct ScaleBonesBoneData;
 struct ScaleMeshesData;
+struct SequenceBBoxesData;
 }
 
 namespace ui::assets::studiomodel
@@ -51,6 +52,7 @@ enum class ModelChangeId
 	ChangeModelOrigin,
 	ChangeModelMeshesScale,
 	ChangeModelBonesScale,
+	ChangeSequenceBBoxes,
 
 	ChangeHitboxBone,
 	ChangeHitboxHitgroup,
@@ -916,6 +918,20 @@ protected:
 	void Apply(const std::vector<studiomdl::ScaleBonesBoneData>& oldValue, const std::vector<studiomdl::ScaleBonesBoneData>& newValue) override;
 };
 
+class ChangeSequenceBBoxesCommand : public ModelUndoCommand<studiomdl::SequenceBBoxesData>
+{
+public:
+	ChangeSequenceBBoxesCommand(
+		StudioModelAsset* asset, studiomdl::SequenceBBoxesData&& oldData, studiomdl::SequenceBBoxesData&& newData)
+		: ModelUndoCommand(asset, ModelChangeId::ChangeSequenceBBoxes, std::move(oldData), std::move(newData))
+	{
+		setText("Recalculate sequence and model bounding boxes");
+	}
+
+protected:
+	void Apply(const studiomdl::SequenceBBoxesData& oldValue, const studiomdl::SequenceBBoxesData& newValue) override;
+};
+
 class ChangeHitboxBoneCommand : public ModelListUndoCommand<int>
 {
 public:
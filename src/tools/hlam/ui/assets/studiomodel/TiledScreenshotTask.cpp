@@ -0,0 +1,183 @@
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include <QImage>
+#include <QMessageBox>
+
+#include "graphics/IGraphicsContext.hpp"
+#include "graphics/Scene.hpp"
+#include "graphics/TiledImageRenderer.hpp"
+
+#include "ui/EditorContext.hpp"
+
+#include "ui/assets/studiomodel/TiledScreenshotTask.hpp"
+
+namespace ui::assets::studiomodel
+{
+TiledScreenshotTask::TiledScreenshotTask(EditorContext* editorContext, graphics::Scene* scene, int width, int height, QString&& fileName,
+	QWidget* parentWidget)
+	: _editorContext(editorContext)
+	, _scene(scene)
+	, _parentWidget(parentWidget)
+	, _fileName(std::move(fileName))
+	, _renderer(std::make_unique<graphics::TiledImageRenderer>(scene, width, height))
+{
+	//Tiles are read back asynchronously, so check often whether they are ready without spinning
+	_timer.setInterval(1);
+
+	connect(&_timer, &QTimer::timeout, this, &TiledScreenshotTask::OnStep);
+}
+
+TiledScreenshotTask::~TiledScreenshotTask()
+{
+	StopDrawing();
+
+	//Don't abandon a save in progress
+	if (_saveResult.valid())
+	{
+		_saveResult.wait();
+	}
+}
+
+bool TiledScreenshotTask::Start()
+{
+	const auto context = _scene->GetGraphicsContext();
+
+	context->Begin();
+	const bool initialized = _renderer->Initialize();
+	context->End();
+
+	if (!initialized)
+	{
+		QMessageBox::critical(_parentWidget, "Error", "Could not create the framebuffer used to draw the screenshot");
+		StopDrawing();
+		return false;
+	}
+
+	//Every tile must show the same frame
+	_editorContext->PauseTimer();
+	_simulationPaused = true;
+
+	_progress = new QProgressDialog("Drawing screenshot...", "Cancel", 0, static_cast<int>(_renderer->GetTileCount()), _parentWidget);
+	_progress->setWindowModality(Qt::WindowModality::WindowModal);
+	_progress->setAttribute(Qt::WidgetAttribute::WA_DeleteOnClose);
+
+	connect(_progress, &QProgressDialog::canceled, this, &TiledScreenshotTask::OnCanceled);
+
+	//Show it right away so the scene can't be changed while tiles are being drawn
+	_progress->setMinimumDuration(0);
+	_progress->setValue(0);
+
+	_timer.start();
+
+	return true;
+}
+
+void TiledScreenshotTask::OnStep()
+{
+	if (_renderer)
+	{
+		const auto context = _scene->GetGraphicsContext();
+
+		context->Begin();
+		const bool complete = _renderer->Step();
+		context->End();
+
+		if (_renderer->HasFailed())
+		{
+			StopDrawing();
+			_timer.stop();
+
+			QMessageBox::critical(_parentWidget, "Error", "An error occurred while reading back the screenshot");
+
+			deleteLater();
+			return;
+		}
+
+		if (_progress)
+		{
+			_progress->setValue(static_cast<int>(_renderer->GetCompletedTileCount()));
+		}
+
+		if (!complete)
+		{
+			return;
+		}
+
+		const int width = _renderer->GetWidth();
+		const int height = _renderer->GetHeight();
+
+		auto pixels = _renderer->TakePixels();
+
+		StopDrawing();
+
+		//Encoding large images takes a while, so don't make the editor wait for it
+		_saveResult = std::async(std::launch::async, [pixels = std::move(pixels), width, height, fileName = _fileName]()
+			{
+				const QImage image{pixels.data(), width, height, width * 4, QImage::Format::Format_RGBA8888};
+
+				//Blending can leave the framebuffer partially transparent, which isn't part of what's shown in the window
+				return image.convertToFormat(QImage::Format::Format_RGB888).save(fileName);
+			});
+
+		return;
+	}
+
+	if (_saveResult.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+	{
+		return;
+	}
+
+	_timer.stop();
+
+	if (!_saveResult.get())
+	{
+		QMessageBox::critical(_parentWidget, "Error", "An error occurred while saving screenshot");
+	}
+
+	deleteLater();
+}
+
+void TiledScreenshotTask::OnCanceled()
+{
+	StopDrawing();
+
+	_timer.stop();
+
+	deleteLater();
+}
+
+void TiledScreenshotTask::StopDrawing()
+{
+	if (_renderer)
+	{
+		const auto context = _scene->GetGraphicsContext();
+
+		context->Begin();
+		_renderer->Shutdown();
+		context->End();
+
+		_renderer.reset();
+	}
+
+	if (_progress)
+	{
+		//Don't treat closing the dialog as canceling
+		_progress->disconnect(this);
+		_progress->close();
+		_progress = nullptr;
+	}
+
+	ResumeSimulation();
+}
+
+void TiledScreenshotTask::ResumeSimulation()
+{
+	if (_simulationPaused)
+	{
+		_simulationPaused = false;
+		_editorContext->ResumeTimer();
+	}
+}
+}
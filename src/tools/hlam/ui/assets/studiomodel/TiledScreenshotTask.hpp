@@ -0,0 +1,76 @@
+#pragma once
+
+#include <future>
+#include <memory>
+
+#include <QObject>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QString>
+#include <QTimer>
+
+class QWidget;
+
+namespace graphics
+{
+class Scene;
+class TiledImageRenderer;
+}
+
+namespace ui
+{
+class EditorContext;
+
+namespace assets::studiomodel
+{
+/**
+*	@brief Draws a screenshot that can be larger than the window in tiles, then saves it on a background thread.
+*	Simulation is paused while tiles are being drawn so they all show the same frame.
+*	Deletes itself once the screenshot has been saved or the task has been canceled.
+*	Must be deleted before the scene and its graphics context.
+*/
+class TiledScreenshotTask final : public QObject
+{
+	Q_OBJECT
+
+public:
+	TiledScreenshotTask(EditorContext* editorContext, graphics::Scene* scene, int width, int height, QString&& fileName,
+		QWidget* parentWidget);
+	~TiledScreenshotTask();
+
+	/**
+	*	@brief Creates the resources used to draw the screenshot and starts drawing it
+	*	@return Whether the task was started. The caller must delete the task if not
+	*/
+	bool Start();
+
+private slots:
+	void OnStep();
+
+	void OnCanceled();
+
+private:
+	void StopDrawing();
+
+	void ResumeSimulation();
+
+private:
+	EditorContext* const _editorContext;
+	graphics::Scene* const _scene;
+	QWidget* const _parentWidget;
+
+	const QString _fileName;
+
+	std::unique_ptr<graphics::TiledImageRenderer> _renderer;
+
+	QTimer _timer;
+
+	//Owned by the parent widget, which may be destroyed first
+	QPointer<QProgressDialog> _progress;
+
+	bool _simulationPaused = false;
+
+	std::future<bool> _saveResult;
+};
+}
+}
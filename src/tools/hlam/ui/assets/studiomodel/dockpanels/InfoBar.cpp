@@ -2,16 +2,21 @@
 
 #include "entity/HLMVStudioModelEntity.hpp"
 
+#include "ui/SceneWidget.hpp"
+
 #include "ui/assets/studiomodel/StudioModelAsset.hpp"
 #include "ui/assets/studiomodel/dockpanels/InfoBar.hpp"
 
 namespace ui::assets::studiomodel
 {
-InfoBar::InfoBar(StudioModelAsset* asset, QWidget* parent)
+InfoBar::InfoBar(StudioModelAsset* asset, SceneWidget* sceneWidget, QWidget* parent)
 	: QWidget(parent)
 	, _asset(asset)
+	, _sceneWidget(sceneWidget)
 {
 	_ui.setupUi(this);
+
+	connect(_asset, &StudioModelAsset::Tick, this, &InfoBar::OnTick);
 }
 
 InfoBar::~InfoBar() = default;
@@ -20,6 +25,47 @@ void InfoBar::OnDraw()
 {
 	++_currentFPS;
 
+	UpdateFPS();
+
+	const unsigned int drawnPolygonsCount = _asset->GetScene()->GetDrawnPolygonsCount();
+
+	//Don't update if it's identical. Prevents flickering
+	if (_oldDrawnPolygonsCount != drawnPolygonsCount)
+	{
+		_oldDrawnPolygonsCount = drawnPolygonsCount;
+		_ui.DrawnPolygonsCountLabel->setText(QString::number(drawnPolygonsCount));
+	}
+
+	const auto& counters = _asset->GetScene()->GetRenderStateCounters();
+
+	const unsigned int stateChangesCount = counters.GetStateChangesCount();
+
+	if (_oldStateChangesCount != stateChangesCount)
+	{
+		_oldStateChangesCount = stateChangesCount;
+		_ui.StateChangesCountLabel->setText(QString::number(stateChangesCount));
+		_ui.StateChangesCountLabel->setToolTip(
+			QString{"Texture binds: %1\nBlend changes: %2\nDepth mask changes: %3\nAlpha test changes: %4\nBuffer binds: %5\nMeshes drawn: %6\nModels culled: %7\nSubmodels culled: %8\nInstanced draws: %9"}
+				.arg(counters.TextureBinds)
+				.arg(counters.BlendChanges)
+				.arg(counters.DepthMaskChanges)
+				.arg(counters.AlphaTestChanges)
+				.arg(counters.BufferBinds)
+				.arg(counters.MeshesDrawn)
+				.arg(counters.ModelsCulled)
+				.arg(counters.SubmodelsCulled)
+				.arg(counters.InstancedDraws));
+	}
+}
+
+void InfoBar::OnTick()
+{
+	//Frames are only drawn when something changed, so the frame rate has to be updated when nothing is drawn as well
+	UpdateFPS();
+}
+
+void InfoBar::UpdateFPS()
+{
 	const long long currentTick = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
 
 	if (_lastFPSUpdate == 0 || ((currentTick - _lastFPSUpdate) >= 1000))
@@ -27,17 +73,27 @@ void InfoBar::OnDraw()
 		_lastFPSUpdate = currentTick;
 
 		_ui.FPSLabel->setText(QString::number(_currentFPS));
+		_ui.FPSLabel->setToolTip(QString{"Frames drawn: %1\nUpdates without changes: %2"}
+			.arg(_sceneWidget->GetDrawnFramesCount())
+			.arg(_sceneWidget->GetSkippedFramesCount()));
 
-		_currentFPS = 0;
-	}
+		const auto& crowd = _asset->GetScene()->GetCrowdStatistics();
 
-	const unsigned int drawnPolygonsCount = _asset->GetScene()->GetDrawnPolygonsCount();
+		if (crowd.InstanceCount > 0)
+		{
+			_ui.DrawnPolygonsCountLabel->setToolTip(
+				QString{"Crowd copies: %1\nCrowd poses: %2\nCrowd draw time: %3 ms\nPer copy: %4 us"}
+					.arg(crowd.InstanceCount)
+					.arg(crowd.PoseCount)
+					.arg(crowd.DrawTime, 0, 'f', 3)
+					.arg((crowd.DrawTime * 1000) / crowd.InstanceCount, 0, 'f', 1));
+		}
+		else
+		{
+			_ui.DrawnPolygonsCountLabel->setToolTip({});
+		}
 
-	//Don't update if it's identical. Prevents flickering
-	if (_oldDrawnPolygonsCount != drawnPolygonsCount)
-	{
-		_oldDrawnPolygonsCount = drawnPolygonsCount;
-		_ui.DrawnPolygonsCountLabel->setText(QString::number(drawnPolygonsCount));
+		_currentFPS = 0;
 	}
 }
 }
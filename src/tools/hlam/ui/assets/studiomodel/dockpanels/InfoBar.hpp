@@ -6,6 +6,11 @@
 
 #include "core/shared/Utility.hpp"
 
+namespace ui
+{
+class SceneWidget;
+}
+
 namespace ui::assets::studiomodel
 {
 class StudioModelAsset;
@@ -13,21 +18,28 @@ class StudioModelAsset;
 class InfoBar final : public QWidget
 {
 public:
-	InfoBar(StudioModelAsset* asset, QWidget* parent = nullptr);
+	InfoBar(StudioModelAsset* asset, SceneWidget* sceneWidget, QWidget* parent = nullptr);
 
 	~InfoBar();
 
 public slots:
 	void OnDraw();
 
+	void OnTick();
+
+private:
+	void UpdateFPS();
+
 private:
 	Ui_InfoBar _ui;
 
 	StudioModelAsset* const _asset;
+	SceneWidget* const _sceneWidget;
 
 	long long _lastFPSUpdate{0};
 	unsigned int _currentFPS{0};
 
 	unsigned int _oldDrawnPolygonsCount{0};
+	unsigned int _oldStateChangesCount{0};
 };
 }
@@ -1,10 +1,12 @@
 #include <limits>
 #include <string_view>
 
+#include <QProgressDialog>
 #include <QSignalBlocker>
 
 #include "entity/HLMVStudioModelEntity.hpp"
 
+#include "ui/EditorContext.hpp"
 #include "ui/StateSnapshot.hpp"
 
 #include "ui/assets/studiomodel/StudioModelAsset.hpp"
@@ -75,6 +77,7 @@ StudioModelModelDataPanel::StudioModelModelDataPanel(StudioModelAsset* asset, QW
 
 	connect(_ui.BBoxMin, &Vector3Edit::ValueChanged, this, &StudioModelModelDataPanel::OnBBoxMinChanged);
 	connect(_ui.BBoxMax, &Vector3Edit::ValueChanged, this, &StudioModelModelDataPanel::OnBBoxMaxChanged);
+	connect(_ui.RecalculateSequenceBBoxes, &QPushButton::clicked, this, &StudioModelModelDataPanel::OnRecalculateSequenceBBoxes);
 
 	connect(_ui.CBoxMin, &Vector3Edit::ValueChanged, this, &StudioModelModelDataPanel::OnCBoxMinChanged);
 	connect(_ui.CBoxMax, &Vector3Edit::ValueChanged, this, &StudioModelModelDataPanel::OnCBoxMaxChanged);
@@ -128,6 +131,19 @@ void StudioModelModelDataPanel::OnModelChanged(const ModelChangeEvent& event)
 		break;
 	}
 
+	case ModelChangeId::ChangeSequenceBBoxes:
+	{
+		//The model's bounding box is recalculated along with the sequence bounding boxes
+		auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
+
+		const QSignalBlocker min{_ui.BBoxMin};
+		const QSignalBlocker max{_ui.BBoxMax};
+
+		_ui.BBoxMin->SetValue(model->BoundingMin);
+		_ui.BBoxMax->SetValue(model->BoundingMax);
+		break;
+	}
+
 	case ModelChangeId::ChangeCBox:
 	{
 		const auto& change = static_cast<const ModelCBoxChangeEvent&>(event);
@@ -327,6 +343,34 @@ void StudioModelModelDataPanel::OnBBoxMaxChanged(const glm::vec3& value)
 	_asset->AddUndoCommand(new ChangeBBoxCommand(_asset, {model->BoundingMin, model->BoundingMax}, {model->BoundingMin, value}));
 }
 
+void StudioModelModelDataPanel::OnRecalculateSequenceBBoxes()
+{
+	auto entity = _asset->GetScene()->GetEntity();
+
+	QProgressDialog progress{"Recalculating bounding boxes...", "Cancel", 0, 0, this};
+
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+
+	auto data{studiomdl::CalculateSequenceBBoxesData(*entity->GetEditableModel(), *_asset->GetEditorContext()->GetWorkerPool(),
+		[&](std::size_t completed, std::size_t total)
+		{
+			if (progress.maximum() != static_cast<int>(total))
+			{
+				progress.setMaximum(static_cast<int>(total));
+			}
+
+			progress.setValue(static_cast<int>(completed));
+
+			return !progress.wasCanceled();
+		})};
+
+	if (data)
+	{
+		_asset->AddUndoCommand(new ChangeSequenceBBoxesCommand(_asset, std::move(data->first), std::move(data->second)));
+	}
+}
+
 void StudioModelModelDataPanel::OnCBoxMinChanged(const glm::vec3& value)
 {
 	auto model = _asset->GetScene()->GetEntity()->GetEditableModel();
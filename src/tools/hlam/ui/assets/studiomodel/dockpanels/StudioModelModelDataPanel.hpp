@@ -44,6 +44,8 @@ private slots:
 	void OnBBoxMinChanged(const glm::vec3& value);
 	void OnBBoxMaxChanged(const glm::vec3& value);
 
+	void OnRecalculateSequenceBBoxes();
+
 	void OnCBoxMinChanged(const glm::vec3& value);
 	void OnCBoxMaxChanged(const glm::vec3& value);
 
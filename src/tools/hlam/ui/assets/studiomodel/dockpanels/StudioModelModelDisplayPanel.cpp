@@ -13,6 +13,10 @@ StudioModelModelDisplayPanel::StudioModelModelDisplayPanel(StudioModelAsset* ass
 
 	_ui.GroundTextureSize->setValue(_asset->GetScene()->FloorTextureLength);
 
+	_ui.CrowdSize->setValue(_asset->GetScene()->CrowdSize);
+	_ui.CrowdSequenceCount->setValue(_asset->GetScene()->CrowdSequenceCount);
+	_ui.CrowdFrameOffsetCount->setValue(_asset->GetScene()->CrowdFrameOffsetCount);
+
 	connect(_ui.RenderModeComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, &StudioModelModelDisplayPanel::OnRenderModeChanged);
 
 	connect(_ui.OpacitySlider, &QSlider::valueChanged, this, &StudioModelModelDisplayPanel::OnOpacityChanged);
@@ -50,6 +54,11 @@ StudioModelModelDisplayPanel::StudioModelModelDisplayPanel(StudioModelAsset* ass
 	connect(_ui.EnableGroundTextureTiling, &QGroupBox::toggled, this, &StudioModelModelDisplayPanel::OnEnableGroundTextureTilingChanged);
 	connect(_ui.GroundTextureSize, qOverload<int>(&QSpinBox::valueChanged), this, &StudioModelModelDisplayPanel::OnGroundTextureSizeChanged);
 
+	connect(_ui.ShowCrowd, &QGroupBox::toggled, this, &StudioModelModelDisplayPanel::OnShowCrowdChanged);
+	connect(_ui.CrowdSize, qOverload<int>(&QSpinBox::valueChanged), this, &StudioModelModelDisplayPanel::OnCrowdSizeChanged);
+	connect(_ui.CrowdSequenceCount, qOverload<int>(&QSpinBox::valueChanged), this, &StudioModelModelDisplayPanel::OnCrowdSequenceCountChanged);
+	connect(_ui.CrowdFrameOffsetCount, qOverload<int>(&QSpinBox::valueChanged), this, &StudioModelModelDisplayPanel::OnCrowdFrameOffsetCountChanged);
+
 	_ui.RenderModeComboBox->setCurrentIndex(static_cast<int>(_asset->GetScene()->CurrentRenderMode));
 }
 
@@ -205,4 +214,24 @@ void StudioModelModelDisplayPanel::OnGroundTextureSizeChanged()
 {
 	_asset->GetScene()->FloorTextureLength = _ui.GroundTextureSize->value();
 }
+
+void StudioModelModelDisplayPanel::OnShowCrowdChanged()
+{
+	_asset->GetScene()->ShowCrowd = _ui.ShowCrowd->isChecked();
+}
+
+void StudioModelModelDisplayPanel::OnCrowdSizeChanged()
+{
+	_asset->GetScene()->CrowdSize = _ui.CrowdSize->value();
+}
+
+void StudioModelModelDisplayPanel::OnCrowdSequenceCountChanged()
+{
+	_asset->GetScene()->CrowdSequenceCount = _ui.CrowdSequenceCount->value();
+}
+
+void StudioModelModelDisplayPanel::OnCrowdFrameOffsetCountChanged()
+{
+	_asset->GetScene()->CrowdFrameOffsetCount = _ui.CrowdFrameOffsetCount->value();
+}
 }
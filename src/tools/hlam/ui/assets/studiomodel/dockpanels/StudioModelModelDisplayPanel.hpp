@@ -52,6 +52,11 @@ private:
 	void OnEnableGroundTextureTilingChanged();
 	void OnGroundTextureSizeChanged();
 
+	void OnShowCrowdChanged();
+	void OnCrowdSizeChanged();
+	void OnCrowdSequenceCountChanged();
+	void OnCrowdFrameOffsetCountChanged();
+
 private:
 	Ui_StudioModelModelDisplayPanel _ui;
 	StudioModelAsset* const _asset;
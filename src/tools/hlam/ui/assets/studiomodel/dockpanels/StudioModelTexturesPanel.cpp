@@ -836,6 +836,8 @@ void StudioModelTexturesPanel::RemapTexture(int index)
 		graphicsContext->Begin();
 		model->ReplaceTexture(*_asset->GetTextureLoader(), &texture, texture.Pixels.data(), palette);
 		graphicsContext->End();
+
+		_asset->EmitSceneChanged();
 	}
 }
 
@@ -1126,6 +1128,8 @@ void StudioModelTexturesPanel::OnTextureFiltersChanged()
 	graphicsContext->Begin();
 	_asset->GetScene()->GetEntity()->GetEditableModel()->UpdateFilters(*textureLoader);
 	graphicsContext->End();
+
+	_asset->EmitSceneChanged();
 }
 
 void StudioModelTexturesPanel::OnPowerOf2TexturesChanged()
@@ -1137,5 +1141,7 @@ void StudioModelTexturesPanel::OnPowerOf2TexturesChanged()
 	graphicsContext->Begin();
 	_asset->GetScene()->GetEntity()->GetEditableModel()->ReuploadTextures(*_asset->GetTextureLoader());
 	graphicsContext->End();
+
+	_asset->EmitSceneChanged();
 }
 }
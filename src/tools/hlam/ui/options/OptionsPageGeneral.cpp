@@ -49,6 +49,7 @@ OptionsPageGeneralWidget::OptionsPageGeneralWidget(
 	_ui.UseSingleInstance->setChecked(_generalSettings->ShouldUseSingleInstance());
 	_ui.MaxRecentFiles->setValue(_recentFilesSettings->GetMaxRecentFiles());
 	_ui.TickRate->setValue(_generalSettings->GetTickRate());
+	_ui.RenderContinuously->setChecked(_generalSettings->ShouldRenderContinuously());
 	_ui.InvertMouseX->setChecked(_generalSettings->ShouldInvertMouseX());
 	_ui.InvertMouseY->setChecked(_generalSettings->ShouldInvertMouseY());
 	_ui.MouseSensitivitySlider->setValue(_generalSettings->GetMouseSensitivity());
@@ -71,6 +72,7 @@ void OptionsPageGeneralWidget::ApplyChanges(QSettings& settings)
 	_generalSettings->SetUseSingleInstance(_ui.UseSingleInstance->isChecked());
 	_recentFilesSettings->SetMaxRecentFiles(_ui.MaxRecentFiles->value());
 	_generalSettings->SetTickRate(_ui.TickRate->value());
+	_generalSettings->SetRenderContinuously(_ui.RenderContinuously->isChecked());
 	_generalSettings->SetInvertMouseX(_ui.InvertMouseX->isChecked());
 	_generalSettings->SetInvertMouseY(_ui.InvertMouseY->isChecked());
 	_generalSettings->SetMouseSensitivity(_ui.MouseSensitivitySlider->value());
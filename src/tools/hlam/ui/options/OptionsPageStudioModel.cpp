@@ -35,6 +35,9 @@ OptionsPageStudioModelWidget::OptionsPageStudioModelWidget(EditorContext* editor
 
 	_ui.AutodetectViewmodels->setChecked(_studioModelSettings->ShouldAutodetectViewmodels());
 	_ui.PowerOf2Textures->setChecked(_studioModelSettings->ShouldResizeTexturesToPowerOf2());
+	_ui.UseVertexBuffers->setChecked(_studioModelSettings->ShouldUseVertexBuffers());
+	_ui.UseGPUSkinning->setChecked(_studioModelSettings->ShouldUseGPUSkinning());
+	_ui.UseTextureArrays->setChecked(_studioModelSettings->ShouldUseTextureArrays());
 
 	_ui.FloorLengthSlider->setRange(_studioModelSettings->MinimumFloorLength, _studioModelSettings->MaximumFloorLength);
 	_ui.FloorLengthSpinner->setRange(_studioModelSettings->MinimumFloorLength, _studioModelSettings->MaximumFloorLength);
@@ -64,6 +67,9 @@ void OptionsPageStudioModelWidget::ApplyChanges(QSettings& settings)
 	_studioModelSettings->SetAutodetectViewmodels(_ui.AutodetectViewmodels->isChecked());
 	_studioModelSettings->SetResizeTexturesToPowerOf2(_ui.PowerOf2Textures->isChecked());
 	_studioModelSettings->SetFloorLength(_ui.FloorLengthSlider->value());
+	_studioModelSettings->SetUseVertexBuffers(_ui.UseVertexBuffers->isChecked());
+	_studioModelSettings->SetUseGPUSkinning(_ui.UseGPUSkinning->isChecked());
+	_studioModelSettings->SetUseTextureArrays(_ui.UseTextureArrays->isChecked());
 	_studioModelSettings->SetStudiomdlCompilerFileName(_ui.Compiler->text());
 	_studioModelSettings->SetStudiomdlDecompilerFileName(_ui.Decompiler->text());
 
@@ -16,6 +16,8 @@ public:
 	static constexpr int MinimumTickRate{1};
 	static constexpr int MaximumTickRate{1000};
 
+	static constexpr bool DefaultRenderContinuously{false};
+
 	static constexpr int DefaultMouseSensitivity{5};
 	static constexpr int MinimumMouseSensitivity{1};
 	static constexpr int MaximumMouseSensitivity{20};
@@ -43,6 +45,7 @@ public:
 
 		settings.beginGroup("general");
 		_tickRate = std::clamp(settings.value("TickRate", DefaultTickRate).toInt(), MinimumTickRate, MaximumTickRate);
+		_renderContinuously = settings.value("RenderContinuously", DefaultRenderContinuously).toBool();
 		settings.endGroup();
 
 		settings.beginGroup("mouse");
@@ -65,6 +68,7 @@ public:
 
 		settings.beginGroup("general");
 		settings.setValue("TickRate", _tickRate);
+		settings.setValue("RenderContinuously", _renderContinuously);
 		settings.endGroup();
 
 		settings.beginGroup("mouse");
@@ -97,6 +101,20 @@ public:
 		}
 	}
 
+	/**
+	*	@brief Whether scene views redraw at the display refresh rate instead of only when something changed
+	*/
+	bool ShouldRenderContinuously() const { return _renderContinuously; }
+
+	void SetRenderContinuously(bool value)
+	{
+		if (_renderContinuously != value)
+		{
+			_renderContinuously = value;
+			emit RenderContinuouslyChanged(_renderContinuously);
+		}
+	}
+
 	bool ShouldInvertMouseX() const { return _invertMouseX; }
 
 	void SetInvertMouseX(bool value)
@@ -140,10 +158,13 @@ public:
 signals:
 	void TickRateChanged(int value);
 
+	void RenderContinuouslyChanged(bool value);
+
 private:
 	bool _useSingleInstance{DefaultUseSingleInstance};
 
 	int _tickRate{DefaultTickRate};
+	bool _renderContinuously{DefaultRenderContinuously};
 
 	bool _invertMouseX{false};
 	bool _invertMouseY{false};
@@ -17,6 +17,9 @@ class StudioModelSettings final : public QObject
 public:
 	static constexpr bool DefaultAutodetectViewmodels{true};
 	static constexpr bool DefaultPowerOf2Textures{true};
+	static constexpr bool DefaultUseVertexBuffers{false};
+	static constexpr bool DefaultUseGPUSkinning{false};
+	static constexpr bool DefaultUseTextureArrays{false};
 
 	static constexpr int MinimumFloorLength = 0;
 	static constexpr int MaximumFloorLength = 2048;
@@ -39,6 +42,9 @@ public:
 		_autodetectViewModels = settings.value("AutodetectViewmodels", DefaultAutodetectViewmodels).toBool();
 		_powerOf2Textures = settings.value("PowerOf2Textures", DefaultPowerOf2Textures).toBool();
 		_floorLength = std::clamp(settings.value("FloorLength", DefaultFloorLength).toInt(), MinimumFloorLength, MaximumFloorLength);
+		_useVertexBuffers = settings.value("UseVertexBuffers", DefaultUseVertexBuffers).toBool();
+		_useGPUSkinning = settings.value("UseGPUSkinning", DefaultUseGPUSkinning).toBool();
+		_useTextureArrays = settings.value("UseTextureArrays", DefaultUseTextureArrays).toBool();
 		_studiomdlCompilerFileName = settings.value("CompilerFileName").toString();
 		_studiomdlDecompilerFileName = settings.value("DecompilerFileName").toString();
 
@@ -68,6 +74,9 @@ public:
 		settings.setValue("AutodetectViewmodels", _autodetectViewModels);
 		settings.setValue("PowerOf2Textures", _powerOf2Textures);
 		settings.setValue("FloorLength", _floorLength);
+		settings.setValue("UseVertexBuffers", _useVertexBuffers);
+		settings.setValue("UseGPUSkinning", _useGPUSkinning);
+		settings.setValue("UseTextureArrays", _useTextureArrays);
 		settings.setValue("CompilerFileName", _studiomdlCompilerFileName);
 		settings.setValue("DecompilerFileName", _studiomdlDecompilerFileName);
 
@@ -122,6 +131,42 @@ public:
 		}
 	}
 
+	bool ShouldUseVertexBuffers() const { return _useVertexBuffers; }
+
+	void SetUseVertexBuffers(bool value)
+	{
+		if (_useVertexBuffers != value)
+		{
+			_useVertexBuffers = value;
+
+			emit UseVertexBuffersChanged(_useVertexBuffers);
+		}
+	}
+
+	bool ShouldUseGPUSkinning() const { return _useGPUSkinning; }
+
+	void SetUseGPUSkinning(bool value)
+	{
+		if (_useGPUSkinning != value)
+		{
+			_useGPUSkinning = value;
+
+			emit UseGPUSkinningChanged(_useGPUSkinning);
+		}
+	}
+
+	bool ShouldUseTextureArrays() const { return _useTextureArrays; }
+
+	void SetUseTextureArrays(bool value)
+	{
+		if (_useTextureArrays != value)
+		{
+			_useTextureArrays = value;
+
+			emit UseTextureArraysChanged(_useTextureArrays);
+		}
+	}
+
 	QString GetStudiomdlCompilerFileName() const { return _studiomdlCompilerFileName; }
 
 	void SetStudiomdlCompilerFileName(const QString& fileName)
@@ -139,12 +184,22 @@ public:
 signals:
 	void FloorLengthChanged(int length);
 
+	void UseVertexBuffersChanged(bool value);
+
+	void UseGPUSkinningChanged(bool value);
+
+	void UseTextureArraysChanged(bool value);
+
 private:
 	bool _autodetectViewModels{DefaultAutodetectViewmodels};
 	bool _powerOf2Textures{DefaultPowerOf2Textures};
 
 	int _floorLength = DefaultFloorLength;
 
+	bool _useVertexBuffers{DefaultUseVertexBuffers};
+	bool _useGPUSkinning{DefaultUseGPUSkinning};
+	bool _useTextureArrays{DefaultUseTextureArrays};
+
 	QString _studiomdlCompilerFileName;
 	QString _studiomdlDecompilerFileName;
 
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLOAT4_SSE2
+#include <emmintrin.h>
+#endif
+
+/**
+*	@brief 4 floats processed together. The scalar version gives the same results as the SSE2 version
+*/
+struct Float4
+{
+	Float4() = default;
+
+#ifdef FLOAT4_SSE2
+	Float4(__m128 value)
+		: Value(value)
+	{
+	}
+
+	explicit Float4(float value)
+		: Value(_mm_set1_ps(value))
+	{
+	}
+
+	Float4(float x, float y, float z, float w)
+		: Value(_mm_setr_ps(x, y, z, w))
+	{
+	}
+
+	static Float4 Load(const float* data) { return _mm_loadu_ps(data); }
+
+	void Store(float* data) const { _mm_storeu_ps(data, Value); }
+
+	/**
+	*	@brief Stores the first 3 floats only, so a vector can be written without touching the memory after it
+	*/
+	void Store3(float* data) const
+	{
+		_mm_storel_pi(reinterpret_cast<__m64*>(data), Value);
+		_mm_store_ss(data + 2, _mm_movehl_ps(Value, Value));
+	}
+
+	__m128 Value;
+#else
+	explicit Float4(float value)
+		: Value{value, value, value, value}
+	{
+	}
+
+	Float4(float x, float y, float z, float w)
+		: Value{x, y, z, w}
+	{
+	}
+
+	static Float4 Load(const float* data) { return {data[0], data[1], data[2], data[3]}; }
+
+	void Store(float* data) const { std::copy(Value.begin(), Value.end(), data); }
+
+	/**
+	*	@brief Stores the first 3 floats only, so a vector can be written without touching the memory after it
+	*/
+	void Store3(float* data) const { std::copy(Value.begin(), Value.begin() + 3, data); }
+
+	std::array<float, 4> Value;
+#endif
+};
+
+#ifdef FLOAT4_SSE2
+inline Float4 operator+(Float4 lhs, Float4 rhs) { return _mm_add_ps(lhs.Value, rhs.Value); }
+inline Float4 operator-(Float4 lhs, Float4 rhs) { return _mm_sub_ps(lhs.Value, rhs.Value); }
+inline Float4 operator*(Float4 lhs, Float4 rhs) { return _mm_mul_ps(lhs.Value, rhs.Value); }
+inline Float4 operator/(Float4 lhs, Float4 rhs) { return _mm_div_ps(lhs.Value, rhs.Value); }
+
+inline Float4 Min(Float4 lhs, Float4 rhs) { return _mm_min_ps(lhs.Value, rhs.Value); }
+inline Float4 Max(Float4 lhs, Float4 rhs) { return _mm_max_ps(lhs.Value, rhs.Value); }
+
+//Comparisons return a mask with a bit set for each lane where the comparison is true
+inline int Less(Float4 lhs, Float4 rhs) { return _mm_movemask_ps(_mm_cmplt_ps(lhs.Value, rhs.Value)); }
+inline int LessEqual(Float4 lhs, Float4 rhs) { return _mm_movemask_ps(_mm_cmple_ps(lhs.Value, rhs.Value)); }
+inline int Equal(Float4 lhs, Float4 rhs) { return _mm_movemask_ps(_mm_cmpeq_ps(lhs.Value, rhs.Value)); }
+#else
+namespace float4
+{
+template<typename Operation>
+inline Float4 Apply(const Float4& lhs, const Float4& rhs, Operation operation)
+{
+	return {operation(lhs.Value[0], rhs.Value[0]), operation(lhs.Value[1], rhs.Value[1]),
+		operation(lhs.Value[2], rhs.Value[2]), operation(lhs.Value[3], rhs.Value[3])};
+}
+
+template<typename Operation>
+inline int Compare(const Float4& lhs, const Float4& rhs, Operation operation)
+{
+	int mask = 0;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (operation(lhs.Value[i], rhs.Value[i]))
+		{
+			mask |= 1 << i;
+		}
+	}
+
+	return mask;
+}
+}
+
+inline Float4 operator+(Float4 lhs, Float4 rhs) { return float4::Apply(lhs, rhs, [](float a, float b) { return a + b; }); }
+inline Float4 operator-(Float4 lhs, Float4 rhs) { return float4::Apply(lhs, rhs, [](float a, float b) { return a - b; }); }
+inline Float4 operator*(Float4 lhs, Float4 rhs) { return float4::Apply(lhs, rhs, [](float a, float b) { return a * b; }); }
+inline Float4 operator/(Float4 lhs, Float4 rhs) { return float4::Apply(lhs, rhs, [](float a, float b) { return a / b; }); }
+
+//Same operand order as minps and maxps, which return the second operand if either is NaN
+inline Float4 Min(Float4 lhs, Float4 rhs) { return float4::Apply(lhs, rhs, [](float a, float b) { return a < b ? a : b; }); }
+inline Float4 Max(Float4 lhs, Float4 rhs) { return float4::Apply(lhs, rhs, [](float a, float b) { return a > b ? a : b; }); }
+
+//Comparisons return a mask with a bit set for each lane where the comparison is true
+inline int Less(Float4 lhs, Float4 rhs) { return float4::Compare(lhs, rhs, [](float a, float b) { return a < b; }); }
+inline int LessEqual(Float4 lhs, Float4 rhs) { return float4::Compare(lhs, rhs, [](float a, float b) { return a <= b; }); }
+inline int Equal(Float4 lhs, Float4 rhs) { return float4::Compare(lhs, rhs, [](float a, float b) { return a == b; }); }
+#endif
@@ -0,0 +1,113 @@
+#include <algorithm>
+
+#include "utility/WorkerPool.hpp"
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+{
+	if (threadCount == 0)
+	{
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	_threads.reserve(threadCount - 1);
+
+	for (unsigned int i = 1; i < threadCount; ++i)
+	{
+		_threads.emplace_back(&WorkerPool::WorkerMain, this);
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard lock{_mutex};
+		_shutdown = true;
+	}
+
+	_workAvailable.notify_all();
+
+	for (auto& thread : _threads)
+	{
+		thread.join();
+	}
+}
+
+void WorkerPool::ParallelFor(std::size_t count, std::size_t batchSize, const Task& task)
+{
+	batchSize = std::max<std::size_t>(1, batchSize);
+
+	if (_threads.empty() || count <= batchSize)
+	{
+		if (count > 0)
+		{
+			task(0, count);
+		}
+
+		return;
+	}
+
+	std::lock_guard callLock{_callMutex};
+
+	{
+		std::lock_guard lock{_mutex};
+
+		_task = &task;
+		_count = count;
+		_batchSize = batchSize;
+		_nextBatch = 0;
+		_activeWorkers = static_cast<unsigned int>(_threads.size());
+		++_generation;
+	}
+
+	_workAvailable.notify_all();
+
+	RunBatches();
+
+	std::unique_lock lock{_mutex};
+
+	_workDone.wait(lock, [this] { return _activeWorkers == 0; });
+
+	_task = nullptr;
+}
+
+void WorkerPool::WorkerMain()
+{
+	unsigned int lastGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock lock{_mutex};
+
+			_workAvailable.wait(lock, [&] { return _shutdown || _generation != lastGeneration; });
+
+			if (_shutdown)
+			{
+				return;
+			}
+
+			lastGeneration = _generation;
+		}
+
+		RunBatches();
+
+		{
+			std::lock_guard lock{_mutex};
+			--_activeWorkers;
+		}
+
+		_workDone.notify_one();
+	}
+}
+
+void WorkerPool::RunBatches()
+{
+	const auto batchCount = (_count + _batchSize - 1) / _batchSize;
+
+	for (std::size_t batch; (batch = _nextBatch++) < batchCount;)
+	{
+		const auto begin = batch * _batchSize;
+
+		(*_task)(begin, std::min(begin + _batchSize, _count));
+	}
+}
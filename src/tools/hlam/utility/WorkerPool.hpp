@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+*	@brief Persistent set of worker threads that split index ranges between themselves and the calling thread
+*/
+class WorkerPool final
+{
+public:
+	using Task = std::function<void(std::size_t begin, std::size_t end)>;
+
+	/**
+	*	@param threadCount Total number of threads to use, including the calling thread. 0 to use the number of hardware threads
+	*/
+	explicit WorkerPool(unsigned int threadCount = 0);
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	/**
+	*	@brief Total number of threads used, including the calling thread
+	*/
+	unsigned int GetThreadCount() const { return static_cast<unsigned int>(_threads.size()) + 1; }
+
+	/**
+	*	@brief Invokes @p task on batches of at most @p batchSize indices until [0, count) has been covered.
+	*	Blocks until all batches have finished. Runs on the calling thread only if there is only one batch.
+	*	Calls from different threads are run one after the other. Not reentrant: must not be called from a task.
+	*/
+	void ParallelFor(std::size_t count, std::size_t batchSize, const Task& task);
+
+private:
+	void WorkerMain();
+
+	void RunBatches();
+
+private:
+	std::vector<std::thread> _threads;
+
+	//Held for the duration of a call so the pool can be shared
+	std::mutex _callMutex;
+
+	std::mutex _mutex;
+	std::condition_variable _workAvailable;
+	std::condition_variable _workDone;
+
+	bool _shutdown = false;
+	unsigned int _generation = 0;
+	unsigned int _activeWorkers = 0;
+
+	const Task* _task = nullptr;
+	std::size_t _count = 0;
+	std::size_t _batchSize = 0;
+	std::atomic<std::size_t> _nextBatch{0};
+};